@@ -13,12 +13,259 @@
 // limitations under the License.
 
 #include "ann_activation_functions.h"
+#include "platform_abstraction_layer.h"
+
+#include <immintrin.h>
+#include <algorithm>
 
 namespace ann {
 
 ActivationFunctionPfn g_activation_function = nullptr;
 ActivationFunctionPfn g_gate_activation_function = nullptr;
 
+ActivationArrayPfn g_activation_array = nullptr;
+ActivationArrayPfn g_gate_activation_array = nullptr;
+
+// exp() approximation constants (the Cephes expf polynomial)
+//
+// exp(x) = 2^n * exp(r), where n = round(x / ln(2)) and r = x - n * ln(2),
+// with ln(2) split into a high and a low part to keep r accurate.
+//
+// The input is clamped to [kExpMin, kExpMax] so 2^n is always a normal float
+// (the relative error in this range is < 2e-7)
+//
+// The SIMD min/max instructions return the second operand if either operand is NaN,
+// so x is passed as the second operand: NaN inputs propagate through the clamping,
+// matching the scalar activation functions
+//
+constexpr float kExpMin = -87.0f;
+constexpr float kExpMax = 88.0f;
+constexpr float kLog2e = 1.44269504088896341f;
+constexpr float kLn2Hi = 0.693359375f;
+constexpr float kLn2Lo = -2.12194440e-4f;
+constexpr float kExpP0 = 1.9875691500e-4f;
+constexpr float kExpP1 = 1.3981999507e-3f;
+constexpr float kExpP2 = 8.3334519073e-3f;
+constexpr float kExpP3 = 4.1665795894e-2f;
+constexpr float kExpP4 = 1.6666665459e-1f;
+constexpr float kExpP5 = 5.0000001201e-1f;
+
+constexpr float kNeatSlope = 4.924273f;
+
+// the exact array kernels: the scalar activation function inlined into the loop
+struct ExactKernels {
+  template <ActivationFunction AFN>
+  static float activate(float x) {
+    if constexpr (AFN == ActivationFunction::Identity)
+      return afnIdentity(x);
+    else if constexpr (AFN == ActivationFunction::Logistic)
+      return afnLogistic(x);
+    else if constexpr (AFN == ActivationFunction::Tanh)
+      return afnTanh(x);
+    else if constexpr (AFN == ActivationFunction::ReLU)
+      return afnReLU(x);
+    else if constexpr (AFN == ActivationFunction::Neat)
+      return afnNeat(x);
+    else if constexpr (AFN == ActivationFunction::ReExp)
+      return afnReExp(x);
+    else
+      return afnLogisticEx(x);
+  }
+
+  template <ActivationFunction AFN>
+  static void apply(float* values, size_t count) {
+    for (size_t i = 0; i < count; ++i)
+      values[i] = activate<AFN>(values[i]);
+  }
+};
+
+// AVX2 polynomial approximations, 8 values at a time
+struct Avx2Kernels {
+  static __m256 exp(__m256 x) {
+    x = _mm256_max_ps(_mm256_set1_ps(kExpMin), x);
+    x = _mm256_min_ps(_mm256_set1_ps(kExpMax), x);
+
+    const __m256 n = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(kLog2e)),
+                                     _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256 r = _mm256_fnmadd_ps(n, _mm256_set1_ps(kLn2Hi), x);
+    r = _mm256_fnmadd_ps(n, _mm256_set1_ps(kLn2Lo), r);
+
+    __m256 p = _mm256_set1_ps(kExpP0);
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(kExpP1));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(kExpP2));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(kExpP3));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(kExpP4));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(kExpP5));
+
+    // exp(r) ~ 1 + r + r^2 * p
+    p = _mm256_fmadd_ps(p, _mm256_mul_ps(r, r), _mm256_add_ps(r, _mm256_set1_ps(1)));
+
+    // 2^n, built directly from the exponent bits
+    __m256i e = _mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127));
+    e = _mm256_slli_epi32(e, 23);
+    return _mm256_mul_ps(p, _mm256_castsi256_ps(e));
+  }
+
+  // 1 / (1 + exp(-x))
+  static __m256 logistic(__m256 x) {
+    const __m256 one = _mm256_set1_ps(1);
+    const __m256 e = exp(_mm256_sub_ps(_mm256_setzero_ps(), x));
+    return _mm256_div_ps(one, _mm256_add_ps(one, e));
+  }
+
+  template <ActivationFunction AFN>
+  static __m256 activate(__m256 x) {
+    if constexpr (AFN == ActivationFunction::Identity) {
+      return x;
+    } else if constexpr (AFN == ActivationFunction::Logistic) {
+      return logistic(x);
+    } else if constexpr (AFN == ActivationFunction::Tanh) {
+      // tanh(x) = 2 * logistic(2x) - 1
+      const __m256 l = logistic(_mm256_add_ps(x, x));
+      return _mm256_sub_ps(_mm256_add_ps(l, l), _mm256_set1_ps(1));
+    } else if constexpr (AFN == ActivationFunction::ReLU) {
+      // (NaN -> 0, same as the scalar version)
+      return _mm256_max_ps(x, _mm256_setzero_ps());
+    } else if constexpr (AFN == ActivationFunction::Neat) {
+      return logistic(_mm256_mul_ps(x, _mm256_set1_ps(kNeatSlope)));
+    } else if constexpr (AFN == ActivationFunction::ReExp) {
+      // 1 - exp(-max(x, 0)) is 0 for all the non-positive inputs (and NaN)
+      const __m256 e = exp(_mm256_sub_ps(_mm256_setzero_ps(),
+                                         _mm256_max_ps(x, _mm256_setzero_ps())));
+      return _mm256_sub_ps(_mm256_set1_ps(1), e);
+    } else {
+      const __m256 y = _mm256_sub_ps(x, _mm256_set1_ps(2));
+      return logistic(_mm256_add_ps(y, y));
+    }
+  }
+
+  template <ActivationFunction AFN>
+  static void apply(float* values, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+      _mm256_storeu_ps(values + i, activate<AFN>(_mm256_loadu_ps(values + i)));
+
+    // the last, partial strip
+    if (i < count) {
+      alignas(32) float tail[8] = {};
+      std::copy(values + i, values + count, tail);
+      _mm256_store_ps(tail, activate<AFN>(_mm256_load_ps(tail)));
+      std::copy(tail, tail + (count - i), values + i);
+    }
+  }
+};
+
+// AVX-512 polynomial approximations, 16 values at a time
+// (the same approximations as the AVX2 kernels)
+struct Avx512Kernels {
+  // GCC implements the unmasked forms of a few AVX-512 intrinsics (min, max,
+  // roundscale, conversions, shifts) as merge-masking over an undefined source,
+  // which triggers bogus -Wmaybe-uninitialized warnings, so we use the
+  // zero-masking forms, with all the lanes enabled
+  static constexpr __mmask16 kAllLanes = 0xffff;
+
+  DARWIN_TARGET_AVX512
+  static __m512 exp(__m512 x) {
+    x = _mm512_maskz_max_ps(kAllLanes, _mm512_set1_ps(kExpMin), x);
+    x = _mm512_maskz_min_ps(kAllLanes, _mm512_set1_ps(kExpMax), x);
+
+    const __m512 n =
+        _mm512_maskz_roundscale_ps(kAllLanes,
+                                   _mm512_mul_ps(x, _mm512_set1_ps(kLog2e)),
+                                   _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m512 r = _mm512_fnmadd_ps(n, _mm512_set1_ps(kLn2Hi), x);
+    r = _mm512_fnmadd_ps(n, _mm512_set1_ps(kLn2Lo), r);
+
+    __m512 p = _mm512_set1_ps(kExpP0);
+    p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(kExpP1));
+    p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(kExpP2));
+    p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(kExpP3));
+    p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(kExpP4));
+    p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(kExpP5));
+    p = _mm512_fmadd_ps(p, _mm512_mul_ps(r, r), _mm512_add_ps(r, _mm512_set1_ps(1)));
+
+    __m512i e = _mm512_add_epi32(_mm512_maskz_cvtps_epi32(kAllLanes, n),
+                                 _mm512_set1_epi32(127));
+    e = _mm512_maskz_slli_epi32(kAllLanes, e, 23);
+    return _mm512_mul_ps(p, _mm512_castsi512_ps(e));
+  }
+
+  DARWIN_TARGET_AVX512
+  static __m512 logistic(__m512 x) {
+    const __m512 one = _mm512_set1_ps(1);
+    const __m512 e = exp(_mm512_sub_ps(_mm512_setzero_ps(), x));
+    return _mm512_div_ps(one, _mm512_add_ps(one, e));
+  }
+
+  template <ActivationFunction AFN>
+  DARWIN_TARGET_AVX512 static __m512 activate(__m512 x) {
+    if constexpr (AFN == ActivationFunction::Identity) {
+      return x;
+    } else if constexpr (AFN == ActivationFunction::Logistic) {
+      return logistic(x);
+    } else if constexpr (AFN == ActivationFunction::Tanh) {
+      const __m512 l = logistic(_mm512_add_ps(x, x));
+      return _mm512_sub_ps(_mm512_add_ps(l, l), _mm512_set1_ps(1));
+    } else if constexpr (AFN == ActivationFunction::ReLU) {
+      return _mm512_maskz_max_ps(kAllLanes, x, _mm512_setzero_ps());
+    } else if constexpr (AFN == ActivationFunction::Neat) {
+      return logistic(_mm512_mul_ps(x, _mm512_set1_ps(kNeatSlope)));
+    } else if constexpr (AFN == ActivationFunction::ReExp) {
+      const __m512 e = exp(_mm512_sub_ps(
+          _mm512_setzero_ps(), _mm512_maskz_max_ps(kAllLanes, x, _mm512_setzero_ps())));
+      return _mm512_sub_ps(_mm512_set1_ps(1), e);
+    } else {
+      const __m512 y = _mm512_sub_ps(x, _mm512_set1_ps(2));
+      return logistic(_mm512_add_ps(y, y));
+    }
+  }
+
+  template <ActivationFunction AFN>
+  DARWIN_TARGET_AVX512 static void apply(float* values, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+      _mm512_storeu_ps(values + i, activate<AFN>(_mm512_loadu_ps(values + i)));
+
+    // the last, partial strip
+    if (i < count) {
+      const __mmask16 mask = __mmask16((1u << (count - i)) - 1);
+      const __m512 x = _mm512_maskz_loadu_ps(mask, values + i);
+      _mm512_mask_storeu_ps(values + i, mask, activate<AFN>(x));
+    }
+  }
+};
+
+template <class KERNELS>
+static ActivationArrayPfn kernelsArrayPfn(ActivationFunction afn) {
+  switch (afn) {
+    case ActivationFunction::Identity:
+      return &KERNELS::template apply<ActivationFunction::Identity>;
+    case ActivationFunction::Logistic:
+      return &KERNELS::template apply<ActivationFunction::Logistic>;
+    case ActivationFunction::Tanh:
+      return &KERNELS::template apply<ActivationFunction::Tanh>;
+    case ActivationFunction::ReLU:
+      return &KERNELS::template apply<ActivationFunction::ReLU>;
+    case ActivationFunction::Neat:
+      return &KERNELS::template apply<ActivationFunction::Neat>;
+    case ActivationFunction::ReExp:
+      return &KERNELS::template apply<ActivationFunction::ReExp>;
+    case ActivationFunction::LogisticEx:
+      return &KERNELS::template apply<ActivationFunction::LogisticEx>;
+    default:
+      FATAL("Unexpected activation function");
+  }
+}
+
+ActivationArrayPfn activationArrayPfn(ActivationFunction afn,
+                                      ActivationPrecision precision) {
+  if (precision == ActivationPrecision::Fast && pal::detectAvx2()) {
+    return pal::detectAvx512() ? kernelsArrayPfn<Avx512Kernels>(afn)
+                               : kernelsArrayPfn<Avx2Kernels>(afn);
+  }
+  return kernelsArrayPfn<ExactKernels>(afn);
+}
+
 static ActivationFunctionPfn activationFunctionPfn(ActivationFunction afn) {
   switch (afn) {
     case ActivationFunction::Identity:
@@ -40,12 +287,14 @@ static ActivationFunctionPfn activationFunctionPfn(ActivationFunction afn) {
   }
 }
 
-void setActivationFunction(ActivationFunction afn) {
+void setActivationFunction(ActivationFunction afn, ActivationPrecision precision) {
   g_activation_function = activationFunctionPfn(afn);
+  g_activation_array = activationArrayPfn(afn, precision);
 }
 
-void setGateActivationFunction(ActivationFunction afn) {
+void setGateActivationFunction(ActivationFunction afn, ActivationPrecision precision) {
   g_gate_activation_function = activationFunctionPfn(afn);
+  g_gate_activation_array = activationArrayPfn(afn, precision);
 }
 
 }  // namespace ann
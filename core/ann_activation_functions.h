@@ -17,6 +17,8 @@
 #include <core/stringify.h>
 
 #include <cmath>
+#include <stddef.h>
+#include <vector>
 using namespace std;
 
 namespace ann {
@@ -48,17 +50,48 @@ inline auto customStringify(core::TypeTag<ActivationFunction>) {
   return stringify;
 }
 
+//! The precision of the whole-array activation functions
+enum class ActivationPrecision {
+  Exact,  //!< Same results as the scalar activation functions
+  Fast,   //!< SIMD polynomial approximations (absolute error < 1e-6, same NaN results)
+};
+
+inline auto customStringify(core::TypeTag<ActivationPrecision>) {
+  static auto stringify = new core::StringifyKnownValues<ActivationPrecision>{
+    { ActivationPrecision::Exact, "exact" },
+    { ActivationPrecision::Fast, "fast" },
+  };
+  return stringify;
+}
+
 using ActivationFunctionPfn = float (*)(float);
 
+//! Applies an activation function, in place, over an array of values
+using ActivationArrayPfn = void (*)(float* values, size_t count);
+
 extern ActivationFunctionPfn g_activation_function;
 extern ActivationFunctionPfn g_gate_activation_function;
 
+extern ActivationArrayPfn g_activation_array;
+extern ActivationArrayPfn g_gate_activation_array;
+
 //! Selects the activation function
-void setActivationFunction(ActivationFunction afn);
+void setActivationFunction(ActivationFunction afn,
+                           ActivationPrecision precision = ActivationPrecision::Exact);
 
 //! Selects the gate activation function
 //! (used with ANNs which include gates, for example LSTM)
-void setGateActivationFunction(ActivationFunction afn);
+void setGateActivationFunction(
+    ActivationFunction afn,
+    ActivationPrecision precision = ActivationPrecision::Exact);
+
+//! Returns the whole-array implementation of an activation function
+//!
+//! The fast variants use AVX-512 or AVX2 if available. If neither is supported,
+//! the exact implementation is returned.
+//!
+ActivationArrayPfn activationArrayPfn(ActivationFunction afn,
+                                      ActivationPrecision precision);
 
 //! Applies the selected activation function
 //! \sa setActivationFunction
@@ -72,6 +105,23 @@ inline float activateGate(float x) {
   return (*g_gate_activation_function)(x);
 }
 
+//! Applies the selected activation function over an array of values
+//! \sa setActivationFunction
+inline void activate(float* values, size_t count) {
+  (*g_activation_array)(values, count);
+}
+
+//! Applies the selected activation function over a vector of values
+inline void activate(vector<float>& values) {
+  (*g_activation_array)(values.data(), values.size());
+}
+
+//! Applies the selected gate activation function over an array of values
+//! \sa setGateActivationFunction
+inline void activateGate(float* values, size_t count) {
+  (*g_gate_activation_array)(values, count);
+}
+
 //! Identity function
 inline float afnIdentity(float x) {
   return x;
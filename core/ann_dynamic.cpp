@@ -22,30 +22,43 @@
 namespace ann {
 
 EvaluateLayer evaluateLayer = nullptr;
+EvaluateLayerBatch evaluateLayerBatch = nullptr;
+EvaluateLstmCells evaluateLstmCells = nullptr;
+EvaluateLstmLiteCells evaluateLstmLiteCells = nullptr;
 
-// AVX2 optimized fully connected layer evaluation
-static void evaluateLayer_avx(const vector<float>& in,
-                              vector<float>& out,
-                              const Matrix& w) {
-  assert(in.size() + 1 == w.rows);
-  assert(out.size() == w.cols);
+// the minimum number of columns for using the register blocked kernels
+// (the narrow layers are evaluated one column strip at a time)
+constexpr size_t kAvx2BlockedMinCols = 32;
+constexpr size_t kAvx512MinCols = 16;
+constexpr size_t kAvx512BlockedMinCols = 64;
 
+// the LSTM cells are evaluated in blocks of this size
+// (so the gate values stay in L1 between the kernel passes)
+constexpr size_t kLstmBlockCells = 64;
+
+// AVX2 optimized evaluation of the columns [first_col, cols)
+// (8 columns strips, plus a masked tail strip)
+static void evaluateStrips_avx(const vector<float>& in,
+                               vector<float>& out,
+                               ConstMatrixView w,
+                               size_t first_col) {
   const size_t cols = w.cols;
   const size_t bias_index = w.rows - 1;
 
-  for (size_t j = 0; j < cols / 8; ++j) {
-    __m256 r = _mm256_loadu_ps(&w[bias_index][j * 8]);
+  size_t j = first_col;
+  for (; j + 8 <= cols; j += 8) {
+    __m256 r = _mm256_loadu_ps(&w[bias_index][j]);
 
     for (size_t i = 0; i < bias_index; ++i) {
       __m256 a = _mm256_broadcast_ss(&in[i]);
-      __m256 b = _mm256_loadu_ps(&w[i][j * 8]);
+      __m256 b = _mm256_loadu_ps(&w[i][j]);
       r = _mm256_fmadd_ps(a, b, r);
     }
 
-    _mm256_storeu_ps(&out[j * 8], r);
+    _mm256_storeu_ps(&out[j], r);
   }
 
-  const size_t mod = cols % 8;
+  const size_t mod = cols - j;
   if (mod != 0) {
     __m256i mask = _mm256_set_epi32((mod > 7) ? -1 : 0,
                                     (mod > 6) ? -1 : 0,
@@ -56,7 +69,6 @@ static void evaluateLayer_avx(const vector<float>& in,
                                     (mod > 1) ? -1 : 0,
                                     (mod > 0) ? -1 : 0);
 
-    size_t j = cols & ~7;
     __m256 r = _mm256_maskload_ps(&w[bias_index][j], mask);
 
     for (size_t i = 0; i < bias_index; ++i) {
@@ -69,9 +81,169 @@ static void evaluateLayer_avx(const vector<float>& in,
   }
 }
 
+// AVX2 optimized fully connected layer evaluation
+static void evaluateLayer_avx(const vector<float>& in,
+                              vector<float>& out,
+                              ConstMatrixView w) {
+  assert(in.size() + 1 == w.rows);
+  assert(out.size() == w.cols);
+
+  evaluateStrips_avx(in, out, w, 0);
+}
+
+// AVX2, register blocked: 4 column strips (32 columns) for each input broadcast
+//
+// The independent accumulators hide the FMA latency, and each broadcast
+// is reused for 4 loads instead of 1.
+//
+static void evaluateLayer_avx_blocked(const vector<float>& in,
+                                      vector<float>& out,
+                                      ConstMatrixView w) {
+  assert(in.size() + 1 == w.rows);
+  assert(out.size() == w.cols);
+
+  const size_t cols = w.cols;
+  const size_t bias_index = w.rows - 1;
+
+  size_t j = 0;
+  for (; j + 32 <= cols; j += 32) {
+    const float* bias = &w[bias_index][j];
+    __m256 r0 = _mm256_loadu_ps(bias);
+    __m256 r1 = _mm256_loadu_ps(bias + 8);
+    __m256 r2 = _mm256_loadu_ps(bias + 16);
+    __m256 r3 = _mm256_loadu_ps(bias + 24);
+
+    for (size_t i = 0; i < bias_index; ++i) {
+      const float* row = &w[i][j];
+      __m256 a = _mm256_broadcast_ss(&in[i]);
+      r0 = _mm256_fmadd_ps(a, _mm256_loadu_ps(row), r0);
+      r1 = _mm256_fmadd_ps(a, _mm256_loadu_ps(row + 8), r1);
+      r2 = _mm256_fmadd_ps(a, _mm256_loadu_ps(row + 16), r2);
+      r3 = _mm256_fmadd_ps(a, _mm256_loadu_ps(row + 24), r3);
+    }
+
+    _mm256_storeu_ps(&out[j], r0);
+    _mm256_storeu_ps(&out[j + 8], r1);
+    _mm256_storeu_ps(&out[j + 16], r2);
+    _mm256_storeu_ps(&out[j + 24], r3);
+  }
+
+  evaluateStrips_avx(in, out, w, j);
+}
+
+// AVX-512 optimized evaluation of the columns [first_col, cols)
+// (16 columns strips, plus a masked tail strip)
+DARWIN_TARGET_AVX512
+static void evaluateStrips_avx512(const vector<float>& in,
+                                  vector<float>& out,
+                                  ConstMatrixView w,
+                                  size_t first_col) {
+  const size_t cols = w.cols;
+  const size_t bias_index = w.rows - 1;
+
+  size_t j = first_col;
+  for (; j + 16 <= cols; j += 16) {
+    __m512 r = _mm512_loadu_ps(&w[bias_index][j]);
+
+    for (size_t i = 0; i < bias_index; ++i) {
+      __m512 a = _mm512_set1_ps(in[i]);
+      __m512 b = _mm512_loadu_ps(&w[i][j]);
+      r = _mm512_fmadd_ps(a, b, r);
+    }
+
+    _mm512_storeu_ps(&out[j], r);
+  }
+
+  const size_t mod = cols - j;
+  if (mod != 0) {
+    const __mmask16 mask = __mmask16((1u << mod) - 1);
+
+    __m512 r = _mm512_maskz_loadu_ps(mask, &w[bias_index][j]);
+
+    for (size_t i = 0; i < bias_index; ++i) {
+      __m512 a = _mm512_set1_ps(in[i]);
+      __m512 b = _mm512_maskz_loadu_ps(mask, &w[i][j]);
+      r = _mm512_fmadd_ps(a, b, r);
+    }
+
+    _mm512_mask_storeu_ps(&out[j], mask, r);
+  }
+}
+
+// AVX-512 optimized fully connected layer evaluation
+DARWIN_TARGET_AVX512
+static void evaluateLayer_avx512(const vector<float>& in,
+                                 vector<float>& out,
+                                 ConstMatrixView w) {
+  assert(in.size() + 1 == w.rows);
+  assert(out.size() == w.cols);
+
+  evaluateStrips_avx512(in, out, w, 0);
+}
+
+// AVX-512, register blocked: 4 column strips (64 columns) for each input broadcast
+DARWIN_TARGET_AVX512
+static void evaluateLayer_avx512_blocked(const vector<float>& in,
+                                         vector<float>& out,
+                                         ConstMatrixView w) {
+  assert(in.size() + 1 == w.rows);
+  assert(out.size() == w.cols);
+
+  const size_t cols = w.cols;
+  const size_t bias_index = w.rows - 1;
+
+  size_t j = 0;
+  for (; j + 64 <= cols; j += 64) {
+    const float* bias = &w[bias_index][j];
+    __m512 r0 = _mm512_loadu_ps(bias);
+    __m512 r1 = _mm512_loadu_ps(bias + 16);
+    __m512 r2 = _mm512_loadu_ps(bias + 32);
+    __m512 r3 = _mm512_loadu_ps(bias + 48);
+
+    for (size_t i = 0; i < bias_index; ++i) {
+      const float* row = &w[i][j];
+      __m512 a = _mm512_set1_ps(in[i]);
+      r0 = _mm512_fmadd_ps(a, _mm512_loadu_ps(row), r0);
+      r1 = _mm512_fmadd_ps(a, _mm512_loadu_ps(row + 16), r1);
+      r2 = _mm512_fmadd_ps(a, _mm512_loadu_ps(row + 32), r2);
+      r3 = _mm512_fmadd_ps(a, _mm512_loadu_ps(row + 48), r3);
+    }
+
+    _mm512_storeu_ps(&out[j], r0);
+    _mm512_storeu_ps(&out[j + 16], r1);
+    _mm512_storeu_ps(&out[j + 32], r2);
+    _mm512_storeu_ps(&out[j + 48], r3);
+  }
+
+  evaluateStrips_avx512(in, out, w, j);
+}
+
+// selects the AVX2 kernel based on the layer shape
+static void evaluateLayer_avx_dispatch(const vector<float>& in,
+                                       vector<float>& out,
+                                       ConstMatrixView w) {
+  if (w.cols >= kAvx2BlockedMinCols)
+    evaluateLayer_avx_blocked(in, out, w);
+  else
+    evaluateLayer_avx(in, out, w);
+}
+
+// selects the AVX-512 kernel based on the layer shape
+// (the narrow layers use the AVX2 kernels, since most of the 16 lanes would be masked)
+static void evaluateLayer_avx512_dispatch(const vector<float>& in,
+                                          vector<float>& out,
+                                          ConstMatrixView w) {
+  if (w.cols >= kAvx512BlockedMinCols)
+    evaluateLayer_avx512_blocked(in, out, w);
+  else if (w.cols >= kAvx512MinCols)
+    evaluateLayer_avx512(in, out, w);
+  else
+    evaluateLayer_avx(in, out, w);
+}
+
 static void evaluateLayer_cpu(const vector<float>& in,
                               vector<float>& out,
-                              const Matrix& w) {
+                              ConstMatrixView w) {
   assert(in.size() + 1 == w.rows);
   assert(out.size() == w.cols);
 
@@ -84,13 +256,261 @@ static void evaluateLayer_cpu(const vector<float>& in,
   }
 }
 
-void initAnnLibrary() {
+// AVX2 optimized batch evaluation (one network per SIMD lane)
+static void evaluateLayerBatch_avx(const float* in,
+                                   float* out,
+                                   const float* w,
+                                   size_t inputs,
+                                   size_t outputs) {
+  static_assert(kBatchLanes == 8, "kBatchLanes must match the AVX vector width");
+
+  const float* bias_row = w + inputs * outputs * kBatchLanes;
+  for (size_t j = 0; j < outputs; ++j) {
+    __m256 r = _mm256_loadu_ps(bias_row + j * kBatchLanes);
+
+    for (size_t i = 0; i < inputs; ++i) {
+      __m256 a = _mm256_loadu_ps(in + i * kBatchLanes);
+      __m256 b = _mm256_loadu_ps(w + (i * outputs + j) * kBatchLanes);
+      r = _mm256_fmadd_ps(a, b, r);
+    }
+
+    _mm256_storeu_ps(out + j * kBatchLanes, r);
+  }
+}
+
+static void evaluateLayerBatch_cpu(const float* in,
+                                   float* out,
+                                   const float* w,
+                                   size_t inputs,
+                                   size_t outputs) {
+  const float* bias_row = w + inputs * outputs * kBatchLanes;
+  for (size_t j = 0; j < outputs; ++j) {
+    float values[kBatchLanes];
+    for (size_t lane = 0; lane < kBatchLanes; ++lane)
+      values[lane] = bias_row[j * kBatchLanes + lane];
+
+    for (size_t i = 0; i < inputs; ++i) {
+      const float* w_row = w + (i * outputs + j) * kBatchLanes;
+      for (size_t lane = 0; lane < kBatchLanes; ++lane)
+        values[lane] += in[i * kBatchLanes + lane] * w_row[lane];
+    }
+
+    for (size_t lane = 0; lane < kBatchLanes; ++lane)
+      out[j * kBatchLanes + lane] = values[lane];
+  }
+}
+
+// AVX2 optimized LSTM cells, 8 cells at a time
+static void evaluateLstmCells_avx(const float* in,
+                                  float* values,
+                                  float* cells,
+                                  const LstmCellWeights& lw,
+                                  size_t count) {
+  // gates = [i_gate][f_gate][o_gate], so all the gates are activated with one call
+  alignas(32) float gates[kLstmBlockCells * 3];
+  alignas(32) float cand_C[kLstmBlockCells];
+
+  for (size_t first = 0; first < count; first += kLstmBlockCells) {
+    const size_t n = min(kLstmBlockCells, count - first);
+    float* i_gate = gates;
+    float* f_gate = gates + n;
+    float* o_gate = gates + n * 2;
+
+    size_t j = 0;
+    for (; j + 8 <= n; j += 8) {
+      const size_t k = first + j;
+      const __m256 x = _mm256_loadu_ps(in + k);
+      const __m256 h = _mm256_loadu_ps(values + k);
+      auto gate = [&](const float* w, const float* u, const float* b) {
+        const __m256 r =
+            _mm256_fmadd_ps(_mm256_loadu_ps(u + k), h, _mm256_loadu_ps(b + k));
+        return _mm256_fmadd_ps(_mm256_loadu_ps(w + k), x, r);
+      };
+      _mm256_storeu_ps(i_gate + j, gate(lw.wi, lw.ui, lw.bi));
+      _mm256_storeu_ps(f_gate + j, gate(lw.wf, lw.uf, lw.bf));
+      _mm256_storeu_ps(o_gate + j, gate(lw.wo, lw.uo, lw.bo));
+      _mm256_store_ps(cand_C + j, gate(lw.wc, lw.uc, lw.bc));
+    }
+    for (; j < n; ++j) {
+      const size_t k = first + j;
+      i_gate[j] = lw.wi[k] * in[k] + lw.ui[k] * values[k] + lw.bi[k];
+      f_gate[j] = lw.wf[k] * in[k] + lw.uf[k] * values[k] + lw.bf[k];
+      o_gate[j] = lw.wo[k] * in[k] + lw.uo[k] * values[k] + lw.bo[k];
+      cand_C[j] = lw.wc[k] * in[k] + lw.uc[k] * values[k] + lw.bc[k];
+    }
+
+    ann::activateGate(gates, n * 3);
+    ann::activate(cand_C, n);
+
+    // the new cell states (cand_C is reused for the cell outputs)
+    j = 0;
+    for (; j + 8 <= n; j += 8) {
+      const size_t k = first + j;
+      const __m256 i = _mm256_loadu_ps(i_gate + j);
+      const __m256 f = _mm256_loadu_ps(f_gate + j);
+      const __m256 ic = _mm256_mul_ps(i, _mm256_load_ps(cand_C + j));
+      const __m256 c = _mm256_fmadd_ps(f, _mm256_loadu_ps(cells + k), ic);
+      _mm256_storeu_ps(cells + k, c);
+      _mm256_store_ps(cand_C + j, c);
+    }
+    for (; j < n; ++j) {
+      const size_t k = first + j;
+      cells[k] = f_gate[j] * cells[k] + i_gate[j] * cand_C[j];
+      cand_C[j] = cells[k];
+    }
+
+    ann::activate(cand_C, n);
+
+    j = 0;
+    for (; j + 8 <= n; j += 8) {
+      const __m256 o = _mm256_loadu_ps(o_gate + j);
+      _mm256_storeu_ps(values + first + j, _mm256_mul_ps(o, _mm256_load_ps(cand_C + j)));
+    }
+    for (; j < n; ++j)
+      values[first + j] = o_gate[j] * cand_C[j];
+  }
+}
+
+static void evaluateLstmCells_cpu(const float* in,
+                                  float* values,
+                                  float* cells,
+                                  const LstmCellWeights& lw,
+                                  size_t count) {
+  float gates[kLstmBlockCells * 3];
+  float cand_C[kLstmBlockCells];
+
+  for (size_t first = 0; first < count; first += kLstmBlockCells) {
+    const size_t n = min(kLstmBlockCells, count - first);
+    float* i_gate = gates;
+    float* f_gate = gates + n;
+    float* o_gate = gates + n * 2;
+
+    for (size_t j = 0; j < n; ++j) {
+      const size_t k = first + j;
+      i_gate[j] = lw.wi[k] * in[k] + lw.ui[k] * values[k] + lw.bi[k];
+      f_gate[j] = lw.wf[k] * in[k] + lw.uf[k] * values[k] + lw.bf[k];
+      o_gate[j] = lw.wo[k] * in[k] + lw.uo[k] * values[k] + lw.bo[k];
+      cand_C[j] = lw.wc[k] * in[k] + lw.uc[k] * values[k] + lw.bc[k];
+    }
+
+    ann::activateGate(gates, n * 3);
+    ann::activate(cand_C, n);
+
+    for (size_t j = 0; j < n; ++j) {
+      const size_t k = first + j;
+      cells[k] = f_gate[j] * cells[k] + i_gate[j] * cand_C[j];
+      cand_C[j] = cells[k];
+    }
+
+    ann::activate(cand_C, n);
+
+    for (size_t j = 0; j < n; ++j)
+      values[first + j] = o_gate[j] * cand_C[j];
+  }
+}
+
+// AVX2 optimized LSTM-lite cells, 8 cells at a time
+static void evaluateLstmLiteCells_avx(const float* in,
+                                      float* values,
+                                      float* cells,
+                                      const LstmLiteCellWeights& lw,
+                                      size_t count) {
+  alignas(32) float gate[kLstmBlockCells];
+
+  for (size_t first = 0; first < count; first += kLstmBlockCells) {
+    const size_t n = min(kLstmBlockCells, count - first);
+
+    // the gate inputs, and the cell inputs (stored directly into values)
+    size_t j = 0;
+    for (; j + 8 <= n; j += 8) {
+      const size_t k = first + j;
+      const __m256 x = _mm256_loadu_ps(in + k);
+      const __m256 c = _mm256_loadu_ps(cells + k);
+      const __m256 g =
+          _mm256_fmadd_ps(_mm256_loadu_ps(lw.ug + k), c, _mm256_loadu_ps(lw.bg + k));
+      _mm256_store_ps(gate + j, _mm256_fmadd_ps(_mm256_loadu_ps(lw.wg + k), x, g));
+      _mm256_storeu_ps(values + k, _mm256_fmadd_ps(_mm256_loadu_ps(lw.wc + k), c, x));
+    }
+    for (; j < n; ++j) {
+      const size_t k = first + j;
+      gate[j] = lw.wg[k] * in[k] + lw.ug[k] * cells[k] + lw.bg[k];
+      values[k] = in[k] + lw.wc[k] * cells[k];
+    }
+
+    ann::activateGate(gate, n);
+
+    j = 0;
+    for (; j + 8 <= n; j += 8) {
+      const size_t k = first + j;
+      const __m256 v = _mm256_loadu_ps(values + k);
+      _mm256_storeu_ps(cells + k, _mm256_mul_ps(v, _mm256_load_ps(gate + j)));
+    }
+    for (; j < n; ++j)
+      cells[first + j] = values[first + j] * gate[j];
+
+    ann::activate(values + first, n);
+  }
+}
+
+static void evaluateLstmLiteCells_cpu(const float* in,
+                                      float* values,
+                                      float* cells,
+                                      const LstmLiteCellWeights& lw,
+                                      size_t count) {
+  float gate[kLstmBlockCells];
+
+  for (size_t first = 0; first < count; first += kLstmBlockCells) {
+    const size_t n = min(kLstmBlockCells, count - first);
+
+    for (size_t j = 0; j < n; ++j) {
+      const size_t k = first + j;
+      gate[j] = lw.wg[k] * in[k] + lw.ug[k] * cells[k] + lw.bg[k];
+      values[k] = in[k] + lw.wc[k] * cells[k];
+    }
+
+    ann::activateGate(gate, n);
+
+    for (size_t j = 0; j < n; ++j)
+      cells[first + j] = values[first + j] * gate[j];
+
+    ann::activate(values + first, n);
+  }
+}
+
+vector<LayerKernel> availableLayerKernels() {
+  vector<LayerKernel> kernels = { { "cpu", &evaluateLayer_cpu } };
   if (pal::detectAvx2()) {
+    kernels.push_back({ "avx2", &evaluateLayer_avx });
+    kernels.push_back({ "avx2_blocked", &evaluateLayer_avx_blocked });
+    kernels.push_back({ "avx2_dispatch", &evaluateLayer_avx_dispatch });
+  }
+  if (pal::detectAvx2() && pal::detectAvx512()) {
+    kernels.push_back({ "avx512", &evaluateLayer_avx512 });
+    kernels.push_back({ "avx512_blocked", &evaluateLayer_avx512_blocked });
+    kernels.push_back({ "avx512_dispatch", &evaluateLayer_avx512_dispatch });
+  }
+  return kernels;
+}
+
+void initAnnLibrary() {
+  if (pal::detectAvx2() && pal::detectAvx512()) {
+    core::log("ANN library: Using AVX-512 optimized code\n");
+    evaluateLayer = &evaluateLayer_avx512_dispatch;
+    evaluateLayerBatch = &evaluateLayerBatch_avx;
+    evaluateLstmCells = &evaluateLstmCells_avx;
+    evaluateLstmLiteCells = &evaluateLstmLiteCells_avx;
+  } else if (pal::detectAvx2()) {
     core::log("ANN library: Using AVX2 optimized code\n");
-    evaluateLayer = &evaluateLayer_avx;
+    evaluateLayer = &evaluateLayer_avx_dispatch;
+    evaluateLayerBatch = &evaluateLayerBatch_avx;
+    evaluateLstmCells = &evaluateLstmCells_avx;
+    evaluateLstmLiteCells = &evaluateLstmLiteCells_avx;
   } else {
     core::log("ANN library: AVX2 not detected\n");
     evaluateLayer = &evaluateLayer_cpu;
+    evaluateLayerBatch = &evaluateLayerBatch_cpu;
+    evaluateLstmCells = &evaluateLstmCells_cpu;
+    evaluateLstmLiteCells = &evaluateLstmLiteCells_cpu;
   }
 }
 
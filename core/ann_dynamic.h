@@ -17,10 +17,13 @@
 #include "ann_utils.h"
 #include "utils.h"
 #include "darwin.h"
+#include "rng.h"
 
 #include <algorithm>
 #include <cmath>
 #include <random>
+#include <string>
+#include <vector>
 using namespace std;
 
 namespace ann {
@@ -40,16 +43,113 @@ inline void reset(Matrix& matrix) {
 
 typedef void (*EvaluateLayer)(const vector<float>& in,
                               vector<float>& out,
-                              const Matrix& w);
+                              ConstMatrixView w);
 
 //! Evaluate a fully connected layer
+//!
+//! The implementation is selected by initAnnLibrary(), based on the CPU features
+//! (AVX-512, AVX2 or generic code). The optimized implementations also pick a kernel
+//! based on the layer shape (the wide layers use register blocked kernels).
+//!
 extern EvaluateLayer evaluateLayer;
 
+//! A named evaluateLayer() implementation
+struct LayerKernel {
+  string name;
+  EvaluateLayer evaluate = nullptr;
+};
+
+//! Returns the evaluateLayer() implementations supported by the current CPU
+//! (the first one is always the generic implementation)
+//! \note This is intended for testing and benchmarking
+vector<LayerKernel> availableLayerKernels();
+
+//! The number of networks evaluated in lock-step by evaluateLayerBatch()
+constexpr size_t kBatchLanes = 8;
+
+typedef void (*EvaluateLayerBatch)(const float* in,
+                                   float* out,
+                                   const float* w,
+                                   size_t inputs,
+                                   size_t outputs);
+
+//! Evaluate a fully connected layer for kBatchLanes networks at once
+//!
+//! The values are interleaved by network (lane):
+//! - in[inputs][kBatchLanes]
+//! - w[inputs + 1][outputs][kBatchLanes] (the last row contains the bias weights)
+//! - out[outputs][kBatchLanes]
+//!
+extern EvaluateLayerBatch evaluateLayerBatch;
+
+//! Gate-major (structure of arrays) LSTM cell weights
+//!
+//! Each pointer references an array with one weight for each cell
+//! (ex. wi[cell] is the input gate weight for the feedforward input of the cell)
+//!
+struct LstmCellWeights {
+  const float* wi;  //!< Input gate: feedforward input weights
+  const float* ui;  //!< Input gate: recurrent (previous output) weights
+  const float* bi;  //!< Input gate: bias
+  const float* wf;  //!< Forget gate: feedforward input weights
+  const float* uf;  //!< Forget gate: recurrent weights
+  const float* bf;  //!< Forget gate: bias
+  const float* wo;  //!< Output gate: feedforward input weights
+  const float* uo;  //!< Output gate: recurrent weights
+  const float* bo;  //!< Output gate: bias
+  const float* wc;  //!< Cell candidate: feedforward input weights
+  const float* uc;  //!< Cell candidate: recurrent weights
+  const float* bc;  //!< Cell candidate: bias
+};
+
+typedef void (*EvaluateLstmCells)(const float* in,
+                                  float* values,
+                                  float* cells,
+                                  const LstmCellWeights& lw,
+                                  size_t count);
+
+//! Evaluate a set of LSTM cells (the part after the feedforward input projection)
+//!
+//! - in[count] : the feedforward input of each cell
+//! - values[count] : the previous cell outputs, updated with the new outputs
+//! - cells[count] : the cell states, updated in place
+//!
+//! All 4 gates are evaluated for a block of cells at a time, using the selected
+//! (whole-array) activation and gate activation functions.
+//!
+extern EvaluateLstmCells evaluateLstmCells;
+
+//! Gate-major LSTM-lite cell weights (see cne::lstm_lite)
+struct LstmLiteCellWeights {
+  const float* wg;  //!< Gate: feedforward input weights
+  const float* ug;  //!< Gate: cell state weights
+  const float* bg;  //!< Gate: bias
+  const float* wc;  //!< Cell state weights (added to the feedforward input)
+};
+
+typedef void (*EvaluateLstmLiteCells)(const float* in,
+                                      float* values,
+                                      float* cells,
+                                      const LstmLiteCellWeights& lw,
+                                      size_t count);
+
+//! Evaluate a set of LSTM-lite cells (same conventions as evaluateLstmCells())
+extern EvaluateLstmLiteCells evaluateLstmLiteCells;
+
+//! Returns the transposed matrix
+//! (ex. used to convert per-cell weights into the gate-major layout)
+inline Matrix transpose(ConstMatrixView m) {
+  Matrix transposed(m.cols, m.rows);
+  for (size_t i = 0; i < m.rows; ++i)
+    for (size_t j = 0; j < m.cols; ++j)
+      transposed[j][i] = m[i][j];
+  return transposed;
+}
+
 //! Apply the activation function over a set of values
 //! \sa ann::activate()
 inline void activateLayer(vector<float>& out) {
-  for (float& value : out)
-    value = ann::activate(value);
+  ann::activate(out);
 }
 
 //! Randomize the values in a Matrix
@@ -59,19 +159,18 @@ inline void activateLayer(vector<float>& out) {
 //! - If Config::sparse_weights is true, only a subset of values are non-zero (subject to
 //!   the Config::weights_density value)
 //! 
-inline void randomize(Matrix& w) {
+inline void randomize(MatrixView w) {
   const float range = g_config.connection_range;
 
-  std::random_device rd;
-  std::default_random_engine rnd(rd());
+  auto& rnd = rng::threadGenerator();
   std::uniform_real_distribution<float> dist(-range, range);
 
   if (g_config.sparse_weights) {
     std::bernoulli_distribution density(g_config.weights_density);
-    for (float& value : w.values)
+    for (float& value : w)
       value = density(rnd) ? ann::roundWeight(dist(rnd)) : 0;
   } else {
-    for (float& value : w.values)
+    for (float& value : w)
       value = ann::roundWeight(dist(rnd));
   }
 }
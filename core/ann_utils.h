@@ -83,5 +83,7 @@ void mutateValue(T& value, RND& rnd, T std_dev) {
 
 // CONSIDER: do we really need this alias?
 using Matrix = core::Matrix<float>;
+using MatrixView = core::MatrixView<float>;
+using ConstMatrixView = core::MatrixView<const float>;
 
 }  // namespace ann
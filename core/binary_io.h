@@ -0,0 +1,236 @@
+// Copyright 2018 The Darwin Neuroevolution Framework Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include "exception.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+using namespace std;
+
+namespace core {
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+constexpr bool kBigEndianHost = true;
+#else
+constexpr bool kBigEndianHost = false;
+#endif
+
+//! Encodes values into a compact binary format
+//!
+//! - Arithmetic and enum values are stored in little-endian byte order
+//! - Sizes (including the strings and vectors lengths) are stored as
+//!   LEB128 variable length integers
+//! - Fixed size arrays are stored without a length prefix
+//! - Other types are encoded by a to_binary(BinaryWriter&, const T&) function,
+//!   found through ADL (similar to the nlohmann::json to_json() convention)
+//!
+//! \sa BinaryReader
+//!
+class BinaryWriter {
+ public:
+  //! Encodes a value
+  template <class T>
+  void write(const T& value) {
+    if constexpr (is_arithmetic_v<T> || is_enum_v<T>) {
+      writeValues(&value, 1);
+    } else {
+      to_binary(*this, value);
+    }
+  }
+
+  void write(bool value) { write(uint8_t(value ? 1 : 0)); }
+
+  void write(const string& value) {
+    writeSize(value.size());
+    writeBytes(value.data(), value.size());
+  }
+
+  template <class T>
+  void write(const vector<T>& values) {
+    writeSize(values.size());
+    if constexpr (is_arithmetic_v<T> && !is_same_v<T, bool>) {
+      writeValues(values.data(), values.size());
+    } else {
+      for (const auto& value : values)
+        write(value);
+    }
+  }
+
+  template <class T, size_t N>
+  void write(const array<T, N>& values) {
+    for (const auto& value : values)
+      write(value);
+  }
+
+  //! Encodes a size value (as a LEB128 variable length integer)
+  void writeSize(uint64_t size) {
+    while (size >= 0x80) {
+      buffer_.push_back(uint8_t(size | 0x80));
+      size >>= 7;
+    }
+    buffer_.push_back(uint8_t(size));
+  }
+
+  //! Appends raw bytes
+  void writeBytes(const void* data, size_t size) {
+    const auto bytes = static_cast<const uint8_t*>(data);
+    buffer_.insert(buffer_.end(), bytes, bytes + size);
+  }
+
+  //! Encodes an array of arithmetic values (without a length prefix)
+  template <class T>
+  void writeValues(const T* values, size_t count) {
+    static_assert(is_arithmetic_v<T> || is_enum_v<T>);
+    const size_t offset = buffer_.size();
+    buffer_.resize(offset + count * sizeof(T));
+    uint8_t* dst = buffer_.data() + offset;
+    ::memcpy(dst, values, count * sizeof(T));
+    if constexpr (kBigEndianHost && sizeof(T) > 1) {
+      for (size_t i = 0; i < count; ++i, dst += sizeof(T))
+        reverse(dst, dst + sizeof(T));
+    }
+  }
+
+  //! The encoded data
+  const vector<uint8_t>& data() const { return buffer_; }
+
+ private:
+  vector<uint8_t> buffer_;
+};
+
+//! Decodes the values encoded by a BinaryWriter
+//!
+//! \note All the reads are bounds checked: a truncated or corrupted input
+//!   results in a core::Exception
+//!
+class BinaryReader {
+ public:
+  BinaryReader(const uint8_t* data, size_t size) : data_(data), end_(data + size) {}
+
+  explicit BinaryReader(const vector<uint8_t>& data)
+      : BinaryReader(data.data(), data.size()) {}
+
+  //! Decodes a value
+  template <class T>
+  void read(T& value) {
+    if constexpr (is_arithmetic_v<T> || is_enum_v<T>) {
+      readValues(&value, 1);
+    } else {
+      from_binary(*this, value);
+    }
+  }
+
+  void read(bool& value) {
+    const auto byte = read<uint8_t>();
+    if (byte > 1)
+      throw core::Exception("Invalid binary data (bool value)");
+    value = byte != 0;
+  }
+
+  void read(string& value) {
+    const size_t size = readSize();
+    const auto bytes = readBytes(size);
+    value.assign(reinterpret_cast<const char*>(bytes), size);
+  }
+
+  template <class T>
+  void read(vector<T>& values) {
+    const size_t size = readSize();
+    if constexpr (is_arithmetic_v<T> && !is_same_v<T, bool>) {
+      if (size > remaining() / sizeof(T))
+        throw core::Exception("Invalid binary data (truncated)");
+      values.resize(size);
+      readValues(values.data(), size);
+    } else {
+      // each value is encoded using at least one byte
+      if (size > remaining())
+        throw core::Exception("Invalid binary data (truncated)");
+      values.resize(size);
+      for (auto& value : values)
+        read(value);
+    }
+  }
+
+  template <class T, size_t N>
+  void read(array<T, N>& values) {
+    for (auto& value : values)
+      read(value);
+  }
+
+  //! Decodes a value
+  template <class T>
+  T read() {
+    T value = {};
+    read(value);
+    return value;
+  }
+
+  //! Decodes a size value (a LEB128 variable length integer)
+  size_t readSize() {
+    uint64_t size = 0;
+    for (int shift = 0;; shift += 7) {
+      if (shift > 63)
+        throw core::Exception("Invalid binary data (size value)");
+      const auto byte = read<uint8_t>();
+      size |= uint64_t(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0)
+        break;
+    }
+    return size_t(size);
+  }
+
+  //! Returns a pointer to the next `size` raw bytes (and skips over them)
+  const uint8_t* readBytes(size_t size) {
+    if (size > remaining())
+      throw core::Exception("Invalid binary data (truncated)");
+    const uint8_t* bytes = data_;
+    data_ += size;
+    return bytes;
+  }
+
+  //! The number of bytes left to decode
+  size_t remaining() const { return size_t(end_ - data_); }
+
+  //! Returns true if all the input was decoded
+  bool atEnd() const { return data_ == end_; }
+
+  //! Decodes an array of arithmetic values (encoded by BinaryWriter::writeValues())
+  template <class T>
+  void readValues(T* values, size_t count) {
+    static_assert(is_arithmetic_v<T> || is_enum_v<T>);
+    if (count > remaining() / sizeof(T))
+      throw core::Exception("Invalid binary data (truncated)");
+    const auto bytes = readBytes(count * sizeof(T));
+    auto dst = reinterpret_cast<uint8_t*>(values);
+    ::memcpy(dst, bytes, count * sizeof(T));
+    if constexpr (kBigEndianHost && sizeof(T) > 1) {
+      for (size_t i = 0; i < count; ++i, dst += sizeof(T))
+        reverse(dst, dst + sizeof(T));
+    }
+  }
+
+ private:
+  const uint8_t* data_ = nullptr;
+  const uint8_t* end_ = nullptr;
+};
+
+}  // namespace core
@@ -0,0 +1,41 @@
+// Copyright 2018 The Darwin Neuroevolution Framework Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <third_party/box2d/box2d.h>
+
+namespace box2d {
+
+//! Restores a dynamic body to the state of a newly created body
+//!
+//! Deactivating the body destroys its contacts (along with their cached impulses)
+//! and its broad-phase proxies. The proxies are re-created when the body is
+//! re-activated, in the fixture list order (the fixtures themselves are preserved).
+//!
+//! \note The joints attached to the body must be re-created as well, in order to
+//!   discard the cached joint impulses (used for warm starting)
+//!
+inline void resetBody(b2Body* body, const b2Vec2& position, float angle) {
+  body->SetActive(false);
+  body->SetTransform(position, angle);
+
+  // putting the body to sleep clears the velocities and the accumulated forces
+  body->SetAwake(false);
+
+  body->SetActive(true);
+  body->SetAwake(true);
+}
+
+}  // namespace box2d
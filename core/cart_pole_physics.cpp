@@ -0,0 +1,510 @@
+// Copyright 2018 The Darwin Neuroevolution Framework Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "cart_pole_physics.h"
+#include "platform_abstraction_layer.h"
+
+#include <immintrin.h>
+#include <algorithm>
+#include <cmath>
+
+namespace physics {
+
+// sin() / cos() approximation constants (the Cephes sinf and cosf polynomials)
+//
+// x = n * pi/2 + r, where n = round(x * 2/pi), with pi/2 split in three parts
+// to keep r accurate. The polynomials approximate sin(r) and cos(r) for
+// r in [-pi/4, pi/4], and the quadrant (n mod 4) selects and negates the results.
+//
+constexpr float k2OverPi = 0.636619772367581343f;
+constexpr float kPiOver2Hi = 1.5703125f;
+constexpr float kPiOver2Mid = 4.837512969970703125e-4f;
+constexpr float kPiOver2Lo = 7.54978995489188216e-8f;
+constexpr float kSinP0 = -1.9515295891e-4f;
+constexpr float kSinP1 = 8.3321608736e-3f;
+constexpr float kSinP2 = -1.6666654611e-1f;
+constexpr float kCosP0 = 2.443315711809948e-5f;
+constexpr float kCosP1 = -1.388731625493765e-3f;
+constexpr float kCosP2 = 4.166664568298827e-2f;
+
+// the constant terms of the equations of motion
+//
+// For each pole (with mass m, distance l from the hinge to the center of mass,
+// and moment of inertia I about the center of mass):
+//
+//  a = m * l
+//  k = m * l / (I + m * l^2)
+//
+// With the Box2D angle conventions (counter-clockwise from the vertical):
+//
+//  x'' = (F + sum(a * sin(theta) * (g * k * cos(theta) - theta'^2))) /
+//        (total_mass - sum(a * k * cos(theta)^2))
+//
+//  theta'' = k * (g * sin(theta) + cos(theta) * x'')
+//
+struct Coefficients {
+  float gravity = 0;
+  float total_mass = 0;
+  float a[kMaxPoles] = {};
+  float k[kMaxPoles] = {};
+
+  explicit Coefficients(const CartPoleModel& model) {
+    CHECK(model.poles >= 1 && model.poles <= kMaxPoles);
+    gravity = model.gravity;
+    total_mass = model.cart_mass;
+    for (int pole = 0; pole < model.poles; ++pole) {
+      const float m = model.pole_mass[pole];
+      const float l = model.pole_half_length[pole];
+      total_mass += m;
+      a[pole] = m * l;
+      k[pole] = m * l / (model.pole_inertia[pole] + m * l * l);
+    }
+  }
+};
+
+// the state variables, in the CartPoleBatch field order
+// (the unused pole variables are always 0)
+constexpr int kStateSize = CartPoleBatch::kForce;
+
+// the portable implementation (also used for the single episode step())
+struct ScalarKernel {
+  static void derivatives(const Coefficients& c,
+                          int poles,
+                          const float* y,
+                          float force,
+                          float* dy) {
+    float sin_theta[kMaxPoles];
+    float cos_theta[kMaxPoles];
+    float numerator = force;
+    float denominator = c.total_mass;
+    for (int pole = 0; pole < poles; ++pole) {
+      const float theta = y[CartPoleBatch::kPoleAngle + pole];
+      const float omega = y[CartPoleBatch::kPoleAngularVelocity + pole];
+      sin_theta[pole] = sin(theta);
+      cos_theta[pole] = cos(theta);
+      numerator += c.a[pole] * sin_theta[pole] *
+                   (c.gravity * c.k[pole] * cos_theta[pole] - omega * omega);
+      denominator -= c.a[pole] * c.k[pole] * cos_theta[pole] * cos_theta[pole];
+    }
+
+    const float acceleration = numerator / denominator;
+    dy[CartPoleBatch::kCartDistance] = y[CartPoleBatch::kCartVelocity];
+    dy[CartPoleBatch::kCartVelocity] = acceleration;
+    for (int pole = 0; pole < poles; ++pole) {
+      dy[CartPoleBatch::kPoleAngle + pole] = y[CartPoleBatch::kPoleAngularVelocity + pole];
+      dy[CartPoleBatch::kPoleAngularVelocity + pole] =
+          c.k[pole] * (c.gravity * sin_theta[pole] + cos_theta[pole] * acceleration);
+    }
+  }
+
+  static void step(const Coefficients& c, int poles, float* y, float force, float dt) {
+    float k1[kStateSize] = {};
+    float k2[kStateSize] = {};
+    float k3[kStateSize] = {};
+    float k4[kStateSize] = {};
+    float tmp[kStateSize] = {};
+
+    derivatives(c, poles, y, force, k1);
+    for (int i = 0; i < kStateSize; ++i)
+      tmp[i] = y[i] + dt / 2 * k1[i];
+    derivatives(c, poles, tmp, force, k2);
+    for (int i = 0; i < kStateSize; ++i)
+      tmp[i] = y[i] + dt / 2 * k2[i];
+    derivatives(c, poles, tmp, force, k3);
+    for (int i = 0; i < kStateSize; ++i)
+      tmp[i] = y[i] + dt * k3[i];
+    derivatives(c, poles, tmp, force, k4);
+    for (int i = 0; i < kStateSize; ++i)
+      y[i] += dt / 6 * (k1[i] + 2 * k2[i] + 2 * k3[i] + k4[i]);
+  }
+
+  static void run(CartPoleBatch* batch, float dt) {
+    const Coefficients c(batch->model_);
+    const int poles = batch->model_.poles;
+    const float* forces = batch->field(CartPoleBatch::kForce);
+    for (size_t lane = 0; lane < batch->size_; ++lane) {
+      float y[kStateSize];
+      for (int i = 0; i < kStateSize; ++i)
+        y[i] = batch->field(i)[lane];
+      step(c, poles, y, forces[lane], dt);
+      for (int i = 0; i < kStateSize; ++i)
+        batch->field(i)[lane] = y[i];
+    }
+  }
+};
+
+// AVX2 implementation, 8 episodes at a time
+struct Avx2Kernel {
+  static void sincos(__m256 x, __m256& sin_x, __m256& cos_x) {
+    const __m256 n = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(k2OverPi)),
+                                     _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256 r = _mm256_fnmadd_ps(n, _mm256_set1_ps(kPiOver2Hi), x);
+    r = _mm256_fnmadd_ps(n, _mm256_set1_ps(kPiOver2Mid), r);
+    r = _mm256_fnmadd_ps(n, _mm256_set1_ps(kPiOver2Lo), r);
+    const __m256 z = _mm256_mul_ps(r, r);
+
+    // sin(r) ~ r + r^3 * P(z)
+    __m256 ps = _mm256_set1_ps(kSinP0);
+    ps = _mm256_fmadd_ps(ps, z, _mm256_set1_ps(kSinP1));
+    ps = _mm256_fmadd_ps(ps, z, _mm256_set1_ps(kSinP2));
+    const __m256 sin_r = _mm256_fmadd_ps(ps, _mm256_mul_ps(z, r), r);
+
+    // cos(r) ~ 1 - z / 2 + z^2 * Q(z)
+    __m256 pc = _mm256_set1_ps(kCosP0);
+    pc = _mm256_fmadd_ps(pc, z, _mm256_set1_ps(kCosP1));
+    pc = _mm256_fmadd_ps(pc, z, _mm256_set1_ps(kCosP2));
+    const __m256 cos_r = _mm256_fmadd_ps(
+        pc, _mm256_mul_ps(z, z), _mm256_fnmadd_ps(_mm256_set1_ps(0.5f), z, _mm256_set1_ps(1)));
+
+    // the odd quadrants swap sin and cos (blendv selects on the sign bit)
+    const __m256i q = _mm256_cvtps_epi32(n);
+    const __m256 swap = _mm256_castsi256_ps(_mm256_slli_epi32(q, 31));
+    const __m256 s = _mm256_blendv_ps(sin_r, cos_r, swap);
+    const __m256 c = _mm256_blendv_ps(cos_r, sin_r, swap);
+
+    // sin is negated in the quadrants 2 and 3, cos in the quadrants 1 and 2
+    const __m256i two = _mm256_set1_epi32(2);
+    const __m256i sin_sign = _mm256_slli_epi32(_mm256_and_si256(q, two), 30);
+    const __m256i cos_sign = _mm256_slli_epi32(
+        _mm256_and_si256(_mm256_add_epi32(q, _mm256_set1_epi32(1)), two), 30);
+    sin_x = _mm256_xor_ps(s, _mm256_castsi256_ps(sin_sign));
+    cos_x = _mm256_xor_ps(c, _mm256_castsi256_ps(cos_sign));
+  }
+
+  template <int POLES>
+  static void derivatives(const Coefficients& c, const __m256* y, __m256 force, __m256* dy) {
+    const __m256 gravity = _mm256_set1_ps(c.gravity);
+    __m256 sin_theta[POLES];
+    __m256 cos_theta[POLES];
+    __m256 numerator = force;
+    __m256 denominator = _mm256_set1_ps(c.total_mass);
+    for (int pole = 0; pole < POLES; ++pole) {
+      const __m256 a = _mm256_set1_ps(c.a[pole]);
+      const __m256 gk = _mm256_set1_ps(c.gravity * c.k[pole]);
+      const __m256 ak = _mm256_set1_ps(c.a[pole] * c.k[pole]);
+      const __m256 omega = y[CartPoleBatch::kPoleAngularVelocity + pole];
+      sincos(y[CartPoleBatch::kPoleAngle + pole], sin_theta[pole], cos_theta[pole]);
+      const __m256 t = _mm256_fnmadd_ps(omega, omega, _mm256_mul_ps(gk, cos_theta[pole]));
+      numerator = _mm256_fmadd_ps(_mm256_mul_ps(a, sin_theta[pole]), t, numerator);
+      denominator = _mm256_fnmadd_ps(_mm256_mul_ps(ak, cos_theta[pole]), cos_theta[pole],
+                                     denominator);
+    }
+
+    const __m256 acceleration = _mm256_div_ps(numerator, denominator);
+    dy[CartPoleBatch::kCartDistance] = y[CartPoleBatch::kCartVelocity];
+    dy[CartPoleBatch::kCartVelocity] = acceleration;
+    for (int pole = 0; pole < POLES; ++pole) {
+      const __m256 k = _mm256_set1_ps(c.k[pole]);
+      dy[CartPoleBatch::kPoleAngle + pole] = y[CartPoleBatch::kPoleAngularVelocity + pole];
+      dy[CartPoleBatch::kPoleAngularVelocity + pole] = _mm256_mul_ps(
+          k, _mm256_fmadd_ps(cos_theta[pole], acceleration, _mm256_mul_ps(gravity, sin_theta[pole])));
+    }
+  }
+
+  template <int POLES>
+  static void step(const Coefficients& c, CartPoleBatch* batch, float dt) {
+    const __m256 half_dt = _mm256_set1_ps(dt / 2);
+    const __m256 full_dt = _mm256_set1_ps(dt);
+    const __m256 sixth_dt = _mm256_set1_ps(dt / 6);
+    const __m256 two = _mm256_set1_ps(2);
+
+    for (size_t lane = 0; lane < batch->padded_size_; lane += 8) {
+      __m256 y[kStateSize] = {};
+      __m256 k1[kStateSize] = {};
+      __m256 k2[kStateSize] = {};
+      __m256 k3[kStateSize] = {};
+      __m256 k4[kStateSize] = {};
+      __m256 tmp[kStateSize] = {};
+
+      for (int i = 0; i < kStateSize; ++i)
+        y[i] = _mm256_loadu_ps(batch->field(i) + lane);
+      const __m256 force = _mm256_loadu_ps(batch->field(CartPoleBatch::kForce) + lane);
+
+      derivatives<POLES>(c, y, force, k1);
+      for (int i = 0; i < kStateSize; ++i)
+        tmp[i] = _mm256_fmadd_ps(half_dt, k1[i], y[i]);
+      derivatives<POLES>(c, tmp, force, k2);
+      for (int i = 0; i < kStateSize; ++i)
+        tmp[i] = _mm256_fmadd_ps(half_dt, k2[i], y[i]);
+      derivatives<POLES>(c, tmp, force, k3);
+      for (int i = 0; i < kStateSize; ++i)
+        tmp[i] = _mm256_fmadd_ps(full_dt, k3[i], y[i]);
+      derivatives<POLES>(c, tmp, force, k4);
+
+      for (int i = 0; i < kStateSize; ++i) {
+        __m256 sum = _mm256_add_ps(k1[i], k4[i]);
+        sum = _mm256_fmadd_ps(two, _mm256_add_ps(k2[i], k3[i]), sum);
+        _mm256_storeu_ps(batch->field(i) + lane, _mm256_fmadd_ps(sixth_dt, sum, y[i]));
+      }
+    }
+  }
+
+  static void run(CartPoleBatch* batch, float dt) {
+    const Coefficients c(batch->model_);
+    if (batch->model_.poles == 1)
+      step<1>(c, batch, dt);
+    else
+      step<2>(c, batch, dt);
+  }
+};
+
+// AVX-512 implementation, 16 episodes at a time
+// (the same approximations as the AVX2 kernel)
+struct Avx512Kernel {
+  // (the zero-masking forms of roundscale, cvtps_epi32 and slli_epi32 are used
+  // to avoid GCC's bogus uninitialized warnings for the unmasked forms)
+  static constexpr __mmask16 kAllLanes = 0xffff;
+
+  DARWIN_TARGET_AVX512
+  static __m512 negate(__m512 x, __m512i sign) {
+    return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(x), sign));
+  }
+
+  DARWIN_TARGET_AVX512
+  static void sincos(__m512 x, __m512& sin_x, __m512& cos_x) {
+    const __m512 n =
+        _mm512_maskz_roundscale_ps(kAllLanes,
+                                   _mm512_mul_ps(x, _mm512_set1_ps(k2OverPi)),
+                                   _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m512 r = _mm512_fnmadd_ps(n, _mm512_set1_ps(kPiOver2Hi), x);
+    r = _mm512_fnmadd_ps(n, _mm512_set1_ps(kPiOver2Mid), r);
+    r = _mm512_fnmadd_ps(n, _mm512_set1_ps(kPiOver2Lo), r);
+    const __m512 z = _mm512_mul_ps(r, r);
+
+    __m512 ps = _mm512_set1_ps(kSinP0);
+    ps = _mm512_fmadd_ps(ps, z, _mm512_set1_ps(kSinP1));
+    ps = _mm512_fmadd_ps(ps, z, _mm512_set1_ps(kSinP2));
+    const __m512 sin_r = _mm512_fmadd_ps(ps, _mm512_mul_ps(z, r), r);
+
+    __m512 pc = _mm512_set1_ps(kCosP0);
+    pc = _mm512_fmadd_ps(pc, z, _mm512_set1_ps(kCosP1));
+    pc = _mm512_fmadd_ps(pc, z, _mm512_set1_ps(kCosP2));
+    const __m512 cos_r = _mm512_fmadd_ps(
+        pc, _mm512_mul_ps(z, z), _mm512_fnmadd_ps(_mm512_set1_ps(0.5f), z, _mm512_set1_ps(1)));
+
+    const __m512i q = _mm512_maskz_cvtps_epi32(kAllLanes, n);
+    const __mmask16 swap = _mm512_test_epi32_mask(q, _mm512_set1_epi32(1));
+    const __m512 s = _mm512_mask_blend_ps(swap, sin_r, cos_r);
+    const __m512 c = _mm512_mask_blend_ps(swap, cos_r, sin_r);
+
+    const __m512i two = _mm512_set1_epi32(2);
+    const __m512i sin_sign =
+        _mm512_maskz_slli_epi32(kAllLanes, _mm512_and_si512(q, two), 30);
+    const __m512i cos_sign = _mm512_maskz_slli_epi32(
+        kAllLanes, _mm512_and_si512(_mm512_add_epi32(q, _mm512_set1_epi32(1)), two), 30);
+    sin_x = negate(s, sin_sign);
+    cos_x = negate(c, cos_sign);
+  }
+
+  template <int POLES>
+  DARWIN_TARGET_AVX512 static void derivatives(const Coefficients& c,
+                                               const __m512* y,
+                                               __m512 force,
+                                               __m512* dy) {
+    const __m512 gravity = _mm512_set1_ps(c.gravity);
+    __m512 sin_theta[POLES];
+    __m512 cos_theta[POLES];
+    __m512 numerator = force;
+    __m512 denominator = _mm512_set1_ps(c.total_mass);
+    for (int pole = 0; pole < POLES; ++pole) {
+      const __m512 a = _mm512_set1_ps(c.a[pole]);
+      const __m512 gk = _mm512_set1_ps(c.gravity * c.k[pole]);
+      const __m512 ak = _mm512_set1_ps(c.a[pole] * c.k[pole]);
+      const __m512 omega = y[CartPoleBatch::kPoleAngularVelocity + pole];
+      sincos(y[CartPoleBatch::kPoleAngle + pole], sin_theta[pole], cos_theta[pole]);
+      const __m512 t = _mm512_fnmadd_ps(omega, omega, _mm512_mul_ps(gk, cos_theta[pole]));
+      numerator = _mm512_fmadd_ps(_mm512_mul_ps(a, sin_theta[pole]), t, numerator);
+      denominator = _mm512_fnmadd_ps(_mm512_mul_ps(ak, cos_theta[pole]), cos_theta[pole],
+                                     denominator);
+    }
+
+    const __m512 acceleration = _mm512_div_ps(numerator, denominator);
+    dy[CartPoleBatch::kCartDistance] = y[CartPoleBatch::kCartVelocity];
+    dy[CartPoleBatch::kCartVelocity] = acceleration;
+    for (int pole = 0; pole < POLES; ++pole) {
+      const __m512 k = _mm512_set1_ps(c.k[pole]);
+      dy[CartPoleBatch::kPoleAngle + pole] = y[CartPoleBatch::kPoleAngularVelocity + pole];
+      dy[CartPoleBatch::kPoleAngularVelocity + pole] = _mm512_mul_ps(
+          k, _mm512_fmadd_ps(cos_theta[pole], acceleration, _mm512_mul_ps(gravity, sin_theta[pole])));
+    }
+  }
+
+  template <int POLES>
+  DARWIN_TARGET_AVX512 static void step(const Coefficients& c, CartPoleBatch* batch, float dt) {
+    const __m512 half_dt = _mm512_set1_ps(dt / 2);
+    const __m512 full_dt = _mm512_set1_ps(dt);
+    const __m512 sixth_dt = _mm512_set1_ps(dt / 6);
+    const __m512 two = _mm512_set1_ps(2);
+
+    for (size_t lane = 0; lane < batch->padded_size_; lane += 16) {
+      __m512 y[kStateSize];
+      __m512 k1[kStateSize];
+      __m512 k2[kStateSize];
+      __m512 k3[kStateSize];
+      __m512 k4[kStateSize];
+      __m512 tmp[kStateSize];
+      for (int i = 0; i < kStateSize; ++i) {
+        k1[i] = k2[i] = k3[i] = k4[i] = _mm512_setzero_ps();
+        y[i] = _mm512_loadu_ps(batch->field(i) + lane);
+      }
+      const __m512 force = _mm512_loadu_ps(batch->field(CartPoleBatch::kForce) + lane);
+
+      derivatives<POLES>(c, y, force, k1);
+      for (int i = 0; i < kStateSize; ++i)
+        tmp[i] = _mm512_fmadd_ps(half_dt, k1[i], y[i]);
+      derivatives<POLES>(c, tmp, force, k2);
+      for (int i = 0; i < kStateSize; ++i)
+        tmp[i] = _mm512_fmadd_ps(half_dt, k2[i], y[i]);
+      derivatives<POLES>(c, tmp, force, k3);
+      for (int i = 0; i < kStateSize; ++i)
+        tmp[i] = _mm512_fmadd_ps(full_dt, k3[i], y[i]);
+      derivatives<POLES>(c, tmp, force, k4);
+
+      for (int i = 0; i < kStateSize; ++i) {
+        __m512 sum = _mm512_add_ps(k1[i], k4[i]);
+        sum = _mm512_fmadd_ps(two, _mm512_add_ps(k2[i], k3[i]), sum);
+        _mm512_storeu_ps(batch->field(i) + lane, _mm512_fmadd_ps(sixth_dt, sum, y[i]));
+      }
+    }
+  }
+
+  DARWIN_TARGET_AVX512
+  static void run(CartPoleBatch* batch, float dt) {
+    const Coefficients c(batch->model_);
+    if (batch->model_.poles == 1)
+      step<1>(c, batch, dt);
+    else
+      step<2>(c, batch, dt);
+  }
+};
+
+static void packState(const CartPoleState& state, float* y) {
+  std::fill(y, y + kStateSize, 0.0f);
+  y[CartPoleBatch::kCartDistance] = state.cart_distance;
+  y[CartPoleBatch::kCartVelocity] = state.cart_velocity;
+  for (int pole = 0; pole < kMaxPoles; ++pole) {
+    y[CartPoleBatch::kPoleAngle + pole] = state.pole_angle[pole];
+    y[CartPoleBatch::kPoleAngularVelocity + pole] = state.pole_angular_velocity[pole];
+  }
+}
+
+static void unpackState(const float* y, CartPoleState& state) {
+  state.cart_distance = y[CartPoleBatch::kCartDistance];
+  state.cart_velocity = y[CartPoleBatch::kCartVelocity];
+  for (int pole = 0; pole < kMaxPoles; ++pole) {
+    state.pole_angle[pole] = y[CartPoleBatch::kPoleAngle + pole];
+    state.pole_angular_velocity[pole] = y[CartPoleBatch::kPoleAngularVelocity + pole];
+  }
+}
+
+void step(const CartPoleModel& model, CartPoleState& state, float force, float dt) {
+  float y[kStateSize];
+  packState(state, y);
+  ScalarKernel::step(Coefficients(model), model.poles, y, force, dt);
+  unpackState(y, state);
+}
+
+static CartPoleBatch::Kernel bestKernel() {
+  if (pal::detectAvx2() && pal::detectAvx512())
+    return &Avx512Kernel::run;
+  else if (pal::detectAvx2())
+    return &Avx2Kernel::run;
+  else
+    return &ScalarKernel::run;
+}
+
+CartPoleBatch::CartPoleBatch(const CartPoleModel& model, size_t size, Kernel kernel)
+    : model_(model),
+      size_(size),
+      padded_size_((size + kLanes - 1) / kLanes * kLanes),
+      kernel_(kernel != nullptr ? kernel : bestKernel()) {
+  CHECK(model_.poles >= 1 && model_.poles <= kMaxPoles);
+  values_.resize(kFieldsCount * padded_size_);
+}
+
+CartPoleState CartPoleBatch::state(size_t index) const {
+  CHECK(index < size_);
+  float y[kStateSize];
+  for (int i = 0; i < kStateSize; ++i)
+    y[i] = field(i)[index];
+  CartPoleState state;
+  unpackState(y, state);
+  return state;
+}
+
+void CartPoleBatch::setState(size_t index, const CartPoleState& state) {
+  CHECK(index < size_);
+  float y[kStateSize];
+  packState(state, y);
+  for (int pole = model_.poles; pole < kMaxPoles; ++pole) {
+    y[kPoleAngle + pole] = 0;
+    y[kPoleAngularVelocity + pole] = 0;
+  }
+  for (int i = 0; i < kStateSize; ++i)
+    field(i)[index] = y[i];
+}
+
+void CartPoleBatch::setForce(size_t index, float force) {
+  CHECK(index < size_);
+  field(kForce)[index] = force;
+}
+
+void CartPoleBatch::step(float dt) {
+  kernel_(this, dt);
+
+  // the forces only apply to one step
+  float* forces = field(kForce);
+  std::fill(forces, forces + padded_size_, 0.0f);
+}
+
+vector<CartPoleBatch::NamedKernel> CartPoleBatch::availableKernels() {
+  vector<NamedKernel> kernels = { { "scalar", &ScalarKernel::run } };
+  if (pal::detectAvx2())
+    kernels.push_back({ "avx2", &Avx2Kernel::run });
+  if (pal::detectAvx2() && pal::detectAvx512())
+    kernels.push_back({ "avx512", &Avx512Kernel::run });
+  return kernels;
+}
+
+void Validation::check(const CartPoleModel& model,
+                       const CartPoleState& before,
+                       float force,
+                       float dt,
+                       const CartPoleState& after) {
+  CartPoleState expected = before;
+  physics::step(model, expected, force, dt);
+
+  float deviation = max(fabs(expected.cart_distance - after.cart_distance),
+                        fabs(expected.cart_velocity - after.cart_velocity));
+  for (int pole = 0; pole < model.poles; ++pole) {
+    deviation = max(deviation, fabs(expected.pole_angle[pole] - after.pole_angle[pole]));
+    deviation = max(deviation,
+                    fabs(expected.pole_angular_velocity[pole] -
+                         after.pole_angular_velocity[pole]));
+  }
+
+  float max_deviation = max_deviation_;
+  while (deviation > max_deviation &&
+         !max_deviation_.compare_exchange_weak(max_deviation, deviation)) {
+  }
+  ++steps_;
+}
+
+void Validation::reset() {
+  max_deviation_ = 0;
+  steps_ = 0;
+}
+
+}  // namespace physics
@@ -0,0 +1,198 @@
+// Copyright 2018 The Darwin Neuroevolution Framework Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include "stringify.h"
+#include "utils.h"
+
+#include <atomic>
+#include <string>
+#include <vector>
+using namespace std;
+
+namespace physics {
+
+//! The physics engines for the cart-pole domains
+enum class Engine {
+  Box2D,     //!< General purpose rigid body simulation (Box2D)
+  Analytic,  //!< Runge-Kutta integration of the cart-pole equations of motion
+  Validate,  //!< Box2D simulation, with each step checked against the analytic engine
+};
+
+inline auto customStringify(core::TypeTag<Engine>) {
+  static auto stringify = new core::StringifyKnownValues<Engine>{
+    { Engine::Box2D, "box2d" },
+    { Engine::Analytic, "analytic" },
+    { Engine::Validate, "validate" },
+  };
+  return stringify;
+}
+
+//! The max number of poles supported by the analytic engine
+constexpr int kMaxPoles = 2;
+
+//! The physical parameters of a cart with one or more poles
+//!
+//! Each pole is a rigid body hinged at the center of the cart, and the cart
+//! moves horizontally, without friction.
+//!
+struct CartPoleModel {
+  float gravity = 9.8f;    //!< Gravitational acceleration
+  float cart_mass = 1.0f;  //!< The mass of the cart
+  int poles = 1;           //!< Number of poles (at most kMaxPoles)
+
+  float pole_mass[kMaxPoles] = {};       //!< The mass of each pole
+  float pole_half_length[kMaxPoles] = {};  //!< Distance from the hinge to the center of mass
+  float pole_inertia[kMaxPoles] = {};    //!< Moment of inertia about the center of mass
+};
+
+//! The state of a cart-pole system
+//!
+//! The pole angles follow the Box2D conventions: radians, counter-clockwise
+//! from the vertical.
+//!
+struct CartPoleState {
+  float cart_distance = 0;
+  float cart_velocity = 0;
+  float pole_angle[kMaxPoles] = {};
+  float pole_angular_velocity[kMaxPoles] = {};
+};
+
+//! Advances the state by one time step (fourth order Runge-Kutta)
+//! \param model The physical parameters
+//! \param state The state to be updated
+//! \param force The horizontal force applied to the cart during the time step
+//! \param dt The time step, in seconds
+void step(const CartPoleModel& model, CartPoleState& state, float force, float dt);
+
+//! A set of independent cart-pole episodes, simulated in lock-step
+//!
+//! The state is stored as a structure of arrays, padded to a multiple of kLanes,
+//! so each step() updates 8 episodes per AVX2 register (or 16 per AVX-512 register).
+//!
+//! The forces set by setForce() apply to the next step() only, like the
+//! Box2D forces, which are cleared after each step.
+//!
+//! \note The results of the AVX2 and AVX-512 kernels are not bit-identical
+//!   to the scalar step(): they use polynomial sin/cos approximations
+//!
+class CartPoleBatch : public core::NonCopyable {
+ public:
+  //! The episodes are processed in blocks of kLanes
+  static constexpr size_t kLanes = 16;
+
+  //! Advances all the episodes in a batch by one time step (see availableKernels())
+  using Kernel = void (*)(CartPoleBatch* batch, float dt);
+
+  //! The batch values layout: each field is an array with one value per episode
+  //! (the state variables come first, followed by the force applied to the cart)
+  enum Field {
+    kCartDistance,
+    kCartVelocity,
+    kPoleAngle,
+    kPoleAngularVelocity = kPoleAngle + kMaxPoles,
+    kForce = kPoleAngularVelocity + kMaxPoles,
+    kFieldsCount
+  };
+
+  //! A named step kernel implementation
+  struct NamedKernel {
+    string name;
+    Kernel kernel = nullptr;
+  };
+
+ public:
+  //! Creates a batch of episodes, all starting from the default (zero) state
+  //! \param model The physical parameters, shared by all the episodes
+  //! \param size The number of episodes
+  //! \param kernel The step kernel (the default is the best kernel for the current CPU)
+  CartPoleBatch(const CartPoleModel& model, size_t size, Kernel kernel = nullptr);
+
+  //! The number of episodes
+  size_t size() const { return size_; }
+
+  //! Returns the current state of an episode
+  CartPoleState state(size_t index) const;
+
+  //! Sets the current state of an episode
+  void setState(size_t index, const CartPoleState& state);
+
+  //! Sets the horizontal force applied to the cart during the next step
+  void setForce(size_t index, float force);
+
+  //! Advances all the episodes by one time step
+  void step(float dt);
+
+  //! Returns the step kernels supported by the current CPU
+  //! (the first one is always the scalar implementation)
+  //! \note This is intended for testing and benchmarking
+  static vector<NamedKernel> availableKernels();
+
+ private:
+  friend struct ScalarKernel;
+  friend struct Avx2Kernel;
+  friend struct Avx512Kernel;
+
+  float* field(int field) { return values_.data() + field * padded_size_; }
+  const float* field(int field) const { return values_.data() + field * padded_size_; }
+
+ private:
+  const CartPoleModel model_;
+  const size_t size_;
+  const size_t padded_size_;
+  const Kernel kernel_;
+
+  vector<float> values_;
+};
+
+//! Tracks the divergence between the analytic engine and a reference simulation
+//!
+//! Each check() starts from the reference state before a step, advances it using
+//! the analytic engine, and compares the result with the reference state after the
+//! step. (the episodes are chaotic, so the full trajectories can't be compared
+//! directly, instead this measures the error of each individual step)
+//!
+//! \note check() is thread-safe
+//!
+class Validation : public core::NonCopyable {
+ public:
+  //! Checks one reference simulation step
+  //! \param model The physical parameters
+  //! \param before The reference state before the step
+  //! \param force The force applied to the cart during the step
+  //! \param dt The time step
+  //! \param after The reference state after the step
+  void check(const CartPoleModel& model,
+             const CartPoleState& before,
+             float force,
+             float dt,
+             const CartPoleState& after);
+
+  //! The max absolute difference of any state variable, across all the checked steps
+  float maxDeviation() const { return max_deviation_; }
+
+  //! The number of checked steps
+  size_t steps() const { return steps_; }
+
+  //! Resets the tracked divergence
+  void reset();
+
+ private:
+  atomic<float> max_deviation_ = 0;
+  atomic<size_t> steps_ = 0;
+};
+
+}  // namespace physics
@@ -14,16 +14,22 @@ SOURCES += \
     logging.cpp \
     platform_abstraction_layer.cpp \
     database.cpp \
+    lz4.cpp \
+    population_trace.cpp \
     universe.cpp \
     evolution.cpp \
+    progress_counter.cpp \
     ann_activation_functions.cpp \
     parallel_for_each.cpp \
+    rng.cpp \
     thread_pool.cpp \
     ann_dynamic.cpp \
+    cart_pole_physics.cpp \
     utils.cpp \
     roulette_selection.cpp \
     cgp_islands_selection.cpp \
     truncation_selection.cpp \
+    tournament.cpp \
     simple_tournament.cpp \
     swiss_tournament.cpp
 
@@ -36,20 +42,29 @@ HEADERS += \
     scope_guard.h \
     matrix.h \
     math_2d.h \
+    box2d_utils.h \
+    cart_pole_physics.h \
     exception.h \
     properties.h \
     io_utils.h \
+    binary_io.h \
+    lz4.h \
+    population_trace.h \
     stringify.h \
     platform_abstraction_layer.h \
     database.h \
     format.h \
     universe.h \
     evolution.h \
+    progress_counter.h \
     ann_activation_functions.h \
     parallel_for_each.h \
+    rng.h \
     thread_pool.h \
+    work_stealing_deque.h \
     utils.h \
     pp_utils.h \
+    object_pool.h \
     modules.h \
     tournament.h \
     selection_algorithm.h \
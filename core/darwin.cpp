@@ -14,6 +14,7 @@
 
 #include "darwin.h"
 #include "logging.h"
+#include "lz4.h"
 #include "platform_abstraction_layer.h"
 #include "ann_dynamic.h"
 
@@ -44,6 +45,109 @@ void init(int, char*[], const char* home_path) {
 
 void shutdown() {}
 
+// the binary genotype header:
+//
+//  u32     magic ("DGEN")
+//  u8      format version
+//  u8      GenotypeCompression
+//  size    the payload size (uncompressed)
+//  ...     the payload (LZ4 block if compressed)
+//
+constexpr uint32_t kGenotypeMagic = 0x4e454744;
+constexpr uint8_t kGenotypeFormatVersion = 1;
+
+vector<uint8_t> Genotype::saveBinary(GenotypeCompression compression) const {
+  core::BinaryWriter payload;
+  saveBinaryPayload(payload);
+  const auto& payload_data = payload.data();
+
+  vector<uint8_t> compressed_payload;
+  if (compression == GenotypeCompression::Lz4) {
+    compressed_payload = lz4::compress(payload_data.data(), payload_data.size());
+    if (compressed_payload.size() >= payload_data.size())
+      compression = GenotypeCompression::None;
+  }
+
+  core::BinaryWriter writer;
+  writer.write(kGenotypeMagic);
+  writer.write(kGenotypeFormatVersion);
+  writer.write(uint8_t(compression));
+  writer.writeSize(payload_data.size());
+
+  switch (compression) {
+    case GenotypeCompression::None:
+      writer.writeBytes(payload_data.data(), payload_data.size());
+      break;
+
+    case GenotypeCompression::Lz4:
+      writer.writeBytes(compressed_payload.data(), compressed_payload.size());
+      break;
+
+    default:
+      FATAL("Unexpected genotype compression");
+  }
+
+  return writer.data();
+}
+
+void Genotype::loadBinary(const uint8_t* data, size_t size) {
+  core::BinaryReader reader(data, size);
+  if (reader.read<uint32_t>() != kGenotypeMagic)
+    throw core::Exception("Can't load genotype, not a binary genotype");
+  if (reader.read<uint8_t>() != kGenotypeFormatVersion)
+    throw core::Exception("Can't load genotype, unsupported binary format version");
+
+  const auto compression = GenotypeCompression(reader.read<uint8_t>());
+  const size_t payload_size = reader.readSize();
+
+  vector<uint8_t> payload;
+  switch (compression) {
+    case GenotypeCompression::None: {
+      const uint8_t* bytes = reader.readBytes(payload_size);
+      payload.assign(bytes, bytes + payload_size);
+    } break;
+
+    case GenotypeCompression::Lz4: {
+      const size_t compressed_size = reader.remaining();
+      payload = lz4::decompress(
+          reader.readBytes(compressed_size), compressed_size, payload_size);
+    } break;
+
+    default:
+      throw core::Exception("Can't load genotype, unknown compression");
+  }
+
+  if (!reader.atEnd())
+    throw core::Exception("Can't load genotype, unexpected trailing data");
+
+  core::BinaryReader payload_reader(payload);
+  loadBinaryPayload(payload_reader);
+  if (!payload_reader.atEnd())
+    throw core::Exception("Can't load genotype, unexpected trailing data");
+}
+
+void Genotype::saveBinaryPayload(core::BinaryWriter& writer) const {
+  writer.write(json::to_cbor(save()));
+}
+
+void Genotype::loadBinaryPayload(core::BinaryReader& reader) {
+  load(json::from_cbor(reader.read<vector<uint8_t>>()));
+}
+
+// FNV-1a hashing
+uint64_t Genotype::contentHash() const {
+  core::BinaryWriter payload;
+  saveBinaryPayload(payload);
+
+  constexpr uint64_t kFnvPrime = 1099511628211ull;
+  uint64_t hash = 14695981039346656037ull;
+  for (uint8_t value : payload.data()) {
+    hash ^= value;
+    hash *= kFnvPrime;
+  }
+  return hash;
+}
+
 Experiment::Experiment(const optional<string>& name,
                        const ExperimentSetup& setup,
                        const optional<db::RowId>& base_variation_id,
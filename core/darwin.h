@@ -15,6 +15,7 @@
 #pragma once
 
 #include "ann_utils.h"
+#include "binary_io.h"
 #include "utils.h"
 #include "modules.h"
 #include "properties.h"
@@ -90,6 +91,82 @@ class Brain {
   virtual void resetState() = 0;
 };
 
+//! A batch of brains evaluated in lock-step
+//!
+//! A batch brain evaluates a set of genotypes, each with its own input values, with a
+//! single thinkBatch() call. This allows kernels which vectorize across the genotypes
+//! in the batch (population-level SIMD inference).
+//!
+//! \sa Population::growBatch()
+//!
+class BatchBrain {
+ public:
+  virtual ~BatchBrain() = default;
+
+  //! The number of brains in the batch
+  virtual size_t size() const = 0;
+
+  //! Sets all the input values for one of the brains in the batch
+  virtual void setInputs(int batch_index, const float* values) = 0;
+
+  //! Returns the value of one of the outputs, for one of the brains in the batch
+  //! \note Outputs can be any floating-point value except for NaNs.
+  virtual float output(int batch_index, int index) const = 0;
+
+  //! Evaluates the outputs from the input values, for all the brains in the batch
+  virtual void thinkBatch() = 0;
+
+  //! Resets the internal state of all the brains in the batch
+  virtual void resetState() = 0;
+};
+
+//! A BatchBrain made of independent Brain instances
+//!
+//! This allows lock-step simulations with brains which don't support batched
+//! evaluation (ex. brains grown from several different genotypes).
+//!
+//! \note thinkBatch() only evaluates the brains with new inputs (set since the
+//!   previous thinkBatch() call), so masked out brains are not evaluated
+//!
+class BrainArray : public BatchBrain {
+ public:
+  //! Creates a batch from a set of brains, each with the specified number of inputs
+  BrainArray(vector<unique_ptr<Brain>> brains, size_t inputs)
+      : brains_(std::move(brains)), inputs_(inputs), pending_(brains_.size(), false) {}
+
+  size_t size() const override { return brains_.size(); }
+
+  void setInputs(int batch_index, const float* values) override {
+    auto& brain = brains_[batch_index];
+    for (size_t i = 0; i < inputs_; ++i)
+      brain->setInput(int(i), values[i]);
+    pending_[batch_index] = true;
+  }
+
+  float output(int batch_index, int index) const override {
+    return brains_[batch_index]->output(index);
+  }
+
+  void thinkBatch() override {
+    for (size_t i = 0; i < brains_.size(); ++i) {
+      if (pending_[i]) {
+        brains_[i]->think();
+        pending_[i] = false;
+      }
+    }
+  }
+
+  void resetState() override {
+    for (auto& brain : brains_)
+      brain->resetState();
+  }
+
+ private:
+  vector<unique_ptr<Brain>> brains_;
+  size_t inputs_ = 0;
+  vector<bool> pending_;
+};
+
 //! Models the genealogy information of a genotype
 //! 
 //! \sa Genotype
@@ -113,6 +190,21 @@ struct Genealogy {
   }
 };
 
+//! Compression options for the binary genotype encoding
+//! \sa Genotype::saveBinary()
+enum class GenotypeCompression {
+  None,  //!< No compression
+  Lz4,   //!< LZ4 block compression (only used if it actually reduces the size)
+};
+
+inline auto customStringify(core::TypeTag<GenotypeCompression>) {
+  static auto stringify = new core::StringifyKnownValues<GenotypeCompression>{
+    { GenotypeCompression::None, "none" },
+    { GenotypeCompression::Lz4, "lz4" },
+  };
+  return stringify;
+}
+
 //! The interface to the population-specific "genetic material", the
 //! [Genotype](https://en.wikipedia.org/wiki/Genotype)
 //! 
@@ -142,6 +234,19 @@ class Genotype {
   //! "Grow" a Brain using the genetic "recipe" encoded in this genotype
   virtual unique_ptr<Brain> grow() const = 0;
   
+  //! Grows a BatchBrain with `size` independent instances of this genotype's Brain
+  //! (for example, to simulate multiple episodes in lock-step)
+  //!
+  //! \returns The batch brain, or nullptr if the genotype doesn't support batched
+  //!   evaluation (the domains must fall back to grow() in this case)
+  //!
+  //! \sa supportsBatch()
+  //!
+  virtual unique_ptr<BatchBrain> growBatch(size_t /*size*/) const { return nullptr; }
+
+  //! Returns true if growBatch() is supported (without growing a batch brain)
+  virtual bool supportsBatch() const { return false; }
+
   //! Returns a clone of this genotype
   virtual unique_ptr<Genotype> clone() const = 0;
 
@@ -151,6 +256,28 @@ class Genotype {
   //! Loads a JSON representation
   virtual void load(const json& json_obj) = 0;
 
+  //! Creates a compact, versioned binary representation
+  //! (JSON is still the preferred format for exporting genotypes)
+  vector<uint8_t> saveBinary(GenotypeCompression compression) const;
+
+  //! Loads a binary representation (created by saveBinary())
+  //! \throws core::Exception if the data is invalid or not compatible
+  void loadBinary(const uint8_t* data, size_t size);
+
+  //! Encodes the population-specific binary payload
+  //! \note The default implementation encodes the JSON representation (as CBOR)
+  virtual void saveBinaryPayload(core::BinaryWriter& writer) const;
+
+  //! Decodes the population-specific binary payload
+  virtual void loadBinaryPayload(core::BinaryReader& reader);
+
+  //! A 64bit hash of the genotype content (the binary payload)
+  //!
+  //! Genotypes with the same content hash are considered identical (the hash
+  //! doesn't cover the fitness or the genealogy information).
+  //!
+  uint64_t contentHash() const;
+
   virtual void reset() {
     fitness = 0;
     genealogy.reset();
@@ -200,6 +327,34 @@ class Population : public core::NonCopyable {
   //!
   virtual void createNextGeneration() = 0;
 
+  //! Creates a BatchBrain for the genotypes [first_index, first_index + count)
+  //!
+  //! \returns The batch brain, or nullptr if the population doesn't support batched
+  //!   evaluation (the domains must fall back to Genotype::grow() in this case)
+  //!
+  //! \sa supportsBatch()
+  //!
+  virtual unique_ptr<BatchBrain> growBatch(size_t /*first_index*/,
+                                           size_t /*count*/) const {
+    return nullptr;
+  }
+
+  //! Returns true if growBatch() is supported (without growing a batch brain)
+  virtual bool supportsBatch() const { return false; }
+
+  //! Returns true if the fitness value of a genotype is already known
+  //!
+  //! This is the case when the population detects that the genotype has the same
+  //! phenotype as one of its parents, and the parent's fitness value was inherited.
+  //! Domains with deterministic evaluation may skip these genotypes.
+  //!
+  //! \sa Domain::skipsInheritedFitness()
+  //!
+  virtual bool isFitnessInherited(size_t /*index*/) const { return false; }
+
+  //! Optional population specific counters, recorded in the generation profile
+  virtual json profileCounters() const { return json(); }
+
   //! Array subscript operator (required for pp::for_each)
   Genotype* operator[](size_t index) { return genotype(index); }
   const Genotype* operator[](size_t index) const { return genotype(index); }
@@ -256,6 +411,16 @@ class Domain : public core::NonCopyable {
   //! 
   virtual bool evaluatePopulation(Population* population) const = 0;
 
+  //! Returns true if evaluatePopulation() skips the genotypes which inherited
+  //! their fitness value (only valid for deterministic evaluations)
+  //!
+  //! Populations may use this to avoid the cost of detecting these genotypes
+  //! when the domain would evaluate them anyway.
+  //!
+  //! \sa Population::isFitnessInherited()
+  //!
+  virtual bool skipsInheritedFitness() const { return false; }
+
   //! Optional: additional fitness metrics
   //! (normally not used in the population evaluation, _ie_ a _test set_)
   virtual unique_ptr<core::PropertySet> calibrateGenotype([
@@ -18,7 +18,7 @@
 
 namespace db {
 
-Statement::Statement(::sqlite3* db, const string& sql_statement) {
+Statement::Statement(::sqlite3* db, const string& sql_statement) : sql_(sql_statement) {
   int rc = sqlite3_prepare_v2(
       db, sql_statement.c_str(), int(sql_statement.size() + 1), &stmt_, nullptr);
 
@@ -32,6 +32,13 @@ Statement::~Statement() {
   sqlite3_finalize(stmt_);
 }
 
+void Statement::reset() {
+  // NOTE: sqlite3_reset() returns the error from the last step(), if any,
+  //  which was already reported by step()
+  sqlite3_reset(stmt_);
+  sqlite3_clear_bindings(stmt_);
+}
+
 void Statement::bindValue(int index, std::nullopt_t) {
   if (sqlite3_bind_null(stmt_, index) != SQLITE_OK)
     throw core::Exception("Failed to bind SQL parameter");
@@ -68,6 +75,16 @@ void Statement::bindValue(int index, double value) {
     throw core::Exception("Failed to bind SQL parameter");
 }
 
+void Statement::bindValue(int index, const Blob& value) {
+  // (binding a nullptr blob would result in a NULL value)
+  const int rc = value.empty()
+                     ? sqlite3_bind_zeroblob(stmt_, index, 0)
+                     : sqlite3_bind_blob64(
+                           stmt_, index, value.data(), value.size(), SQLITE_TRANSIENT);
+  if (rc != SQLITE_OK)
+    throw core::Exception("Failed to bind SQL parameter");
+}
+
 bool Statement::step() {
   int rc = sqlite3_step(stmt_);
   switch (rc) {
@@ -159,6 +176,51 @@ void Statement::columnValue(int column, optional<double>& value) const {
   }
 }
 
+void Statement::columnValue(int column, optional<Blob>& value) const {
+  if (column >= columnCount())
+    throw core::Exception("Invalid column index");
+
+  switch (sqlite3_column_type(stmt_, column)) {
+    case SQLITE_BLOB: {
+      // sqlite3_column_bytes() must be called after sqlite3_column_blob()
+      auto blob = static_cast<const uint8_t*>(sqlite3_column_blob(stmt_, column));
+      value = Blob(blob, blob + sqlite3_column_bytes(stmt_, column));
+    } break;
+
+    case SQLITE_NULL:
+      value.reset();
+      break;
+
+    default:
+      throw core::Exception("Unexpected column data type");
+  }
+}
+
+void Statement::columnValue(int column, optional<string_view>& value) const {
+  if (column >= columnCount())
+    throw core::Exception("Invalid column index");
+
+  switch (sqlite3_column_type(stmt_, column)) {
+    case SQLITE_TEXT: {
+      // sqlite3_column_bytes() must be called after sqlite3_column_text()
+      auto text = reinterpret_cast<const char*>(sqlite3_column_text(stmt_, column));
+      value = string_view(text, sqlite3_column_bytes(stmt_, column));
+    } break;
+
+    case SQLITE_BLOB: {
+      auto blob = reinterpret_cast<const char*>(sqlite3_column_blob(stmt_, column));
+      value = string_view(blob, sqlite3_column_bytes(stmt_, column));
+    } break;
+
+    case SQLITE_NULL:
+      value.reset();
+      break;
+
+    default:
+      throw core::Exception("Unexpected column data type");
+  }
+}
+
 static int schemaVersionCheck(void* data, int argc, char* argv[], char*[]) {
   CHECK(data == nullptr);
   return (argc == 1 && string(argv[0]) == "0") ? 0 : SQLITE_ERROR;
@@ -205,9 +267,43 @@ Connection::Connection(const string& filename, OpenMode open_mode, int busy_wait
 }
 
 Connection::~Connection() {
+  // all the statements must be finalized before closing the connection
+  statements_cache_.clear();
   CHECK(sqlite3_close(db_) == SQLITE_OK);
 }
 
+Connection::StatementPtr Connection::prepare(const string& sql_statement) {
+  {
+    unique_lock<mutex> guard(statements_cache_lock_);
+    auto it = statements_cache_.find(sql_statement);
+    if (it != statements_cache_.end()) {
+      auto statement = std::move(it->second);
+      statements_cache_.erase(it);
+      return StatementPtr(statement.release(), StatementRecycler{ this });
+    }
+  }
+
+  return StatementPtr(new Statement(db_, sql_statement), StatementRecycler{ this });
+}
+
+void Connection::StatementRecycler::operator()(Statement* statement) const {
+  connection->recycleStatement(statement);
+}
+
+// the statement is reset before returning it to the cache, so it doesn't keep
+// an active read transaction. if the same SQL statement is already cached
+// (nested uses of the same statement) or the cache is full, it's discarded
+void Connection::recycleStatement(Statement* statement) {
+  unique_ptr<Statement> recycled_statement(statement);
+  recycled_statement->reset();
+
+  unique_lock<mutex> guard(statements_cache_lock_);
+  if (statements_cache_.size() < kMaxCachedStatements) {
+    const auto& sql_statement = recycled_statement->sql();
+    statements_cache_.try_emplace(sql_statement, std::move(recycled_statement));
+  }
+}
+
 void Connection::beginTransaction(TransactionOption option) {
   switch (option) {
     case TransactionOption::Deferred:
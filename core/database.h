@@ -18,15 +18,20 @@
 #include "exception.h"
 
 #include <cstddef>
+#include <iterator>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <tuple>
+#include <type_traits>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 using namespace std;
 
 // CONSIDER:
-// - lazy rezultset / cursor (call step on demand)
 // - aggregate type mapping (for params/results, ex. exec<MyStruct>(...))
 
 struct sqlite3;
@@ -43,6 +48,9 @@ enum class OpenMode {
 //! Represents the ID of a row in the database
 using RowId = int64_t;
 
+//! A BLOB value
+using Blob = vector<uint8_t>;
+
 //! A prepared Sqlite statement
 class Statement {
  public:
@@ -53,6 +61,13 @@ class Statement {
   Statement(const Statement&) = delete;
   Statement& operator=(const Statement&) = delete;
 
+  //! The SQL text used to prepare the statement
+  const string& sql() const { return sql_; }
+
+  //! Resets the statement, so it can be executed again
+  //! (it also clears all the parameter bindings)
+  void reset();
+
   template <class... PARAMS>
   void bind(PARAMS&&... params) {
     bindHelper(1, std::forward<PARAMS>(params)...);
@@ -66,6 +81,7 @@ class Statement {
   void bindValue(int index, const string& value);
   void bindValue(int index, const char* value);
   void bindValue(int index, double value);
+  void bindValue(int index, const Blob& value);
 
   // use std::nullopt for NULL values
   void bindValue(int index, nullptr_t) = delete;
@@ -90,6 +106,11 @@ class Statement {
   void columnValue(int column, optional<int64_t>& value) const;
   void columnValue(int column, optional<string>& value) const;
   void columnValue(int column, optional<double>& value) const;
+  void columnValue(int column, optional<Blob>& value) const;
+
+  // zero-copy access to TEXT/BLOB columns
+  // (the value is only valid until the next step() or reset())
+  void columnValue(int column, optional<string_view>& value) const;
 
  private:
   template <class T, class... PARAMS>
@@ -102,12 +123,16 @@ class Statement {
 
  private:
   ::sqlite3_stmt* stmt_ = nullptr;
+  const string sql_;
 };
 
 //! Represents the results of executing a query
 //! \sa db::Connection::exec()
 template <class... TYPES>
 class ResultSet {
+  static_assert(!(is_same_v<TYPES, string_view> || ...),
+                "string_view results are only supported by db::Connection::query()");
+
  public:
   //! A results row
   using Row = tuple<optional<TYPES>...>;
@@ -174,8 +199,21 @@ enum class TransactionOption {
   Exclusive   //!< Maps to _BEGIN EXCLUSIVE TRANSACTION_
 };
 
+template <class... TYPES>
+class Query;
+
 //! A very simple relational database abstraction on top of Sqlite
 class Connection : public core::NonCopyable {
+  // returns the statements to the connection's cache
+  struct StatementRecycler {
+    Connection* connection = nullptr;
+    void operator()(Statement* statement) const;
+  };
+
+ public:
+  //! A prepared statement, returned to the statements cache when released
+  using StatementPtr = unique_ptr<Statement, StatementRecycler>;
+
  public:
   //! Opens a Sqlite connection
   explicit Connection(const string& filename, OpenMode open_mode, int busy_wait_ms = 500);
@@ -194,7 +232,12 @@ class Connection : public core::NonCopyable {
   //! Returns the ID of the last inserted row with this connection
   RowId lastInsertRowId() const;
 
-  // TODO: consider stm = prepare() / exec(stm)
+  //! Returns a prepared statement
+  //!
+  //! The prepared statements are cached (keyed by the SQL text), so repeated
+  //! statements are only compiled once
+  //!
+  StatementPtr prepare(const string& sql_statement);
 
   //! Executes the specified Sqlite statement and returns the results as a ResultSet
   //! 
@@ -207,19 +250,140 @@ class Connection : public core::NonCopyable {
   //! 
   template <class... RESULTS, class... PARAMS>
   ResultSet<RESULTS...> exec(const string& sql_statement, PARAMS&&... params) {
-    Statement prepared_statement(db_, sql_statement);
-    prepared_statement.bind(std::forward<PARAMS>(params)...);
+    auto prepared_statement = prepare(sql_statement);
+    prepared_statement->bind(std::forward<PARAMS>(params)...);
 
     ResultSet<RESULTS...> results;
-    while (prepared_statement.step())
-      results.extractRow(prepared_statement);
+    while (prepared_statement->step())
+      results.extractRow(*prepared_statement);
     return results;
   }
 
+  //! Executes the specified Sqlite statement and returns a streaming cursor
+  //!
+  //! Unlike exec(), the rows are extracted one at a time, as the results are
+  //! iterated. The result types may include `string_view`, for zero-copy access
+  //! to TEXT/BLOB columns (valid only until the cursor advances):
+  //!
+  //! ```cpp
+  //! for (const auto& [id, name] : query<RowId, string_view>("select id, name from t"))
+  //!   ...
+  //! ```
+  //!
+  //! \note The Query object keeps the underlying statement active, so it should
+  //!   not outlive the iteration
+  //!
+  template <class... RESULTS, class... PARAMS>
+  Query<RESULTS...> query(const string& sql_statement, PARAMS&&... params);
+
+ private:
+  void recycleStatement(Statement* statement);
+
+ private:
+  // max number of statements in the cache
+  static constexpr size_t kMaxCachedStatements = 128;
+
  private:
   ::sqlite3* db_ = nullptr;
+
+  // the idle prepared statements, keyed by SQL text
+  // (the statements in use are removed from the cache while they are active)
+  unordered_map<string, unique_ptr<Statement>> statements_cache_;
+  mutex statements_cache_lock_;
+};
+
+//! A streaming cursor over the results of a query
+//! \sa db::Connection::query()
+template <class... TYPES>
+class Query : public core::NonCopyable {
+ public:
+  //! A results row
+  using Row = tuple<optional<TYPES>...>;
+
+  //! Input iterator over the query results
+  class Iterator {
+   public:
+    using iterator_category = input_iterator_tag;
+    using value_type = Row;
+    using difference_type = ptrdiff_t;
+    using pointer = const Row*;
+    using reference = const Row&;
+
+    explicit Iterator(Query* query) : query_(query) {}
+
+    const Row& operator*() const { return query_->row(); }
+    const Row* operator->() const { return &query_->row(); }
+
+    Iterator& operator++() {
+      if (!query_->next())
+        query_ = nullptr;
+      return *this;
+    }
+
+    bool operator==(const Iterator& other) const { return query_ == other.query_; }
+    bool operator!=(const Iterator& other) const { return query_ != other.query_; }
+
+   private:
+    Query* query_ = nullptr;
+  };
+
+ public:
+  explicit Query(Connection::StatementPtr statement) : statement_(std::move(statement)) {
+    if (columnCount() > 0 && statement_->columnCount() != columnCount()) {
+      throw core::Exception(
+          "Query column count does not match the statement column count");
+    }
+  }
+
+  //! Count of columns in the results
+  int columnCount() const { return tuple_size<Row>::value; }
+
+  //! Advances to the next row (returns false if there are no more rows)
+  bool next() {
+    if (done_)
+      return false;
+    if (!statement_->step()) {
+      done_ = true;
+      statement_.reset();
+      return false;
+    }
+    extractColumns(index_sequence_for<TYPES...>{});
+    return true;
+  }
+
+  //! The current row
+  const Row& row() const { return row_; }
+
+  //! Starts the iteration (a Query can only be iterated once)
+  Iterator begin() {
+    CHECK(!started_, "a query can only be iterated once");
+    started_ = true;
+    return Iterator(next() ? this : nullptr);
+  }
+
+  //! The end iterator
+  Iterator end() { return Iterator(nullptr); }
+
+ private:
+  template <size_t... COLUMNS>
+  void extractColumns(index_sequence<COLUMNS...>) {
+    (statement_->columnValue(COLUMNS, std::get<COLUMNS>(row_)), ...);
+  }
+
+ private:
+  Connection::StatementPtr statement_;
+  Row row_;
+  bool started_ = false;
+  bool done_ = false;
 };
 
+template <class... RESULTS, class... PARAMS>
+Query<RESULTS...> Connection::query(const string& sql_statement, PARAMS&&... params) {
+  auto prepared_statement = prepare(sql_statement);
+  prepared_statement->bind(std::forward<PARAMS>(params)...);
+  return Query<RESULTS...>(std::move(prepared_statement));
+}
+
 //! A scope-based transaction guard
 class TransactionScope {
  public:
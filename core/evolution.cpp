@@ -14,6 +14,7 @@
 
 #include "evolution.h"
 #include "logging.h"
+#include "rng.h"
 #include "scope_guard.h"
 
 #include <assert.h>
@@ -22,6 +23,7 @@
 #include <fstream>
 #include <limits>
 #include <memory>
+#include <optional>
 #include <sstream>
 #include <system_error>
 #include <thread>
@@ -32,8 +34,12 @@ namespace darwin {
 
 ProgressMonitor* ProgressManager::progress_monitor_ = nullptr;
 
+// the random stream used while setting up a new experiment (reproducible mode)
+constexpr uint64_t kSetupStream = 1;
+
 GenerationSummary::GenerationSummary(const Population* population,
-                                     shared_ptr<core::PropertySet> calibration_fitness)
+                                     shared_ptr<core::PropertySet> calibration_fitness,
+                                     const GenerationSummary* previous)
     : calibration_fitness(calibration_fitness) {
   const size_t size = population->size();
   CHECK(size > 0);
@@ -43,7 +49,18 @@ GenerationSummary::GenerationSummary(const Population* population,
   best_fitness = population->genotype(ranking_index[0])->fitness;
   median_fitness = population->genotype(ranking_index[size / 2])->fitness;
   worst_fitness = population->genotype(ranking_index[size - 1])->fitness;
-  champion = population->genotype(ranking_index[0])->clone();
+
+  // share the champion with the previous generation if it's unchanged
+  // (ex. the same genotype surviving through elitism, with the same fitness)
+  const auto best_genotype = population->genotype(ranking_index[0]);
+  champion_hash = best_genotype->contentHash();
+  if (previous != nullptr && previous->champion &&
+      previous->champion_hash == champion_hash &&
+      previous->champion->fitness == best_genotype->fitness) {
+    champion = previous->champion;
+  } else {
+    champion = best_genotype->clone();
+  }
 }
 
 EvolutionTrace::EvolutionTrace(const Evolution* evolution) : evolution_(evolution) {
@@ -51,6 +68,12 @@ EvolutionTrace::EvolutionTrace(const Evolution* evolution) : evolution_(evolutio
   auto universe = experiment.universe();
   auto evolution_config = evolution_->config().toJson().dump(2);
   db_trace_ = universe->newTrace(experiment.dbVariationId(), evolution_config);
+
+  GenerationWriterConfig writer_config;
+  writer_config.max_rows = evolution_->config().db_commit_max_generations;
+  writer_config.max_latency_ms = evolution_->config().db_commit_max_latency;
+  writer_config.queue_capacity = max(writer_config.queue_capacity, writer_config.max_rows);
+  universe->setGenerationWriterConfig(writer_config);
 }
 
 int EvolutionTrace::size() const {
@@ -121,7 +144,15 @@ GenerationSummary EvolutionTrace::addGeneration(
     const Population* population,
     shared_ptr<core::PropertySet> calibration_fitness,
     const EvolutionStage& top_stage) {
-  GenerationSummary summary(population, calibration_fitness);
+  optional<GenerationSummary> previous;
+  {
+    unique_lock<mutex> guard(lock_);
+    if (!generations_.empty())
+      previous = generations_.back();
+  }
+
+  GenerationSummary summary(
+      population, calibration_fitness, previous.has_value() ? &*previous : nullptr);
 
   // record the generation summary
   {
@@ -140,6 +171,9 @@ GenerationSummary EvolutionTrace::addGeneration(
   json json_summary;
   json json_details;
 
+  PopulationTrace population_trace;
+  population_trace.fitness_encoding = config.fitness_trace_encoding;
+
   json_summary["best_fitness"] = summary.best_fitness;
   json_summary["median_fitness"] = summary.median_fitness;
   json_summary["worst_fitness"] = summary.worst_fitness;
@@ -169,11 +203,12 @@ GenerationSummary EvolutionTrace::addGeneration(
 
     case FitnessInfoKind::FullRaw: {
       // capture all fitness values (ranked)
-      json json_full_fitness;
-      for (auto genotype_index : population->rankingIndex()) {
-        json_full_fitness.push_back(population->genotype(genotype_index)->fitness);
+      const auto& ranking_index = population->rankingIndex();
+      population_trace.ranked_fitness.reserve(ranking_index.size());
+      for (auto genotype_index : ranking_index) {
+        population_trace.ranked_fitness.push_back(
+            population->genotype(genotype_index)->fitness);
       }
-      json_details["full_fitness"] = json_full_fitness;
     } break;
 
     default:
@@ -182,22 +217,31 @@ GenerationSummary EvolutionTrace::addGeneration(
 
   // capture genealogy information
   if (config.save_genealogy) {
-    json json_full_genealogy;
     for (size_t i = 0; i < population->size(); ++i) {
       const auto& genealogy = population->genotype(i)->genealogy;
-      json json_genealogy_entry;
-      if (!genealogy.genetic_operator.empty())
-        json_genealogy_entry[genealogy.genetic_operator] = genealogy.parents;
-      json_full_genealogy.push_back(json_genealogy_entry);
+      population_trace.addGenealogy(genealogy.genetic_operator, genealogy.parents);
     }
-    json_details["genealogy"] = json_full_genealogy;
   }
 
-  // champion genotype
+  // the full fitness and genealogy traces use a compact binary encoding
+  if (!population_trace.empty()) {
+    core::BinaryWriter writer;
+    writer.write(population_trace);
+    db_generation.population_trace = writer.data();
+  }
+
+  // champion genotype (saved only once per trace, see DbGeneration::champion_genotype)
+  // (the genotype blob is always included, in case the generation which introduced
+  // this champion fails to commit, but it's shared by all the generations with the
+  // same champion)
   if (config.save_champion_genotype) {
-    json json_genotypes;
-    json_genotypes["champion"] = summary.champion->save();
-    db_generation.genotypes = json_genotypes.dump();
+    if (summary.champion != last_champion_) {
+      last_champion_ = summary.champion;
+      last_champion_genotype_ = make_shared<const db::Blob>(
+          summary.champion->saveBinary(config.genotype_compression));
+    }
+    db_generation.champion_hash = summary.champion_hash;
+    db_generation.champion_genotype = last_champion_genotype_;
   }
 
   // generation runtime profile
@@ -214,6 +258,9 @@ GenerationSummary EvolutionTrace::addGeneration(
     default:
       FATAL("unexpected profile kind");
   }
+  auto json_counters = population->profileCounters();
+  if (!json_counters.empty())
+    json_profile["counters"] = json_counters;
   db_generation.profile = json_profile.dump();
 
   // summary
@@ -226,8 +273,9 @@ GenerationSummary EvolutionTrace::addGeneration(
   }
 
   // save the new generation to the universe database
+  // (queued, the generations are committed in batches)
   auto universe = evolution_->experiment().universe();
-  universe->newGeneration(db_generation);
+  universe->newGeneration(std::move(db_generation));
 
   return summary;
 }
@@ -242,7 +290,9 @@ bool Evolution::newExperiment(shared_ptr<Experiment> experiment,
             experiment->setup()->population_size);
 
   CHECK(config.max_generations >= 0);
-  
+  CHECK(config.db_commit_max_generations > 0);
+  CHECK(config.db_commit_max_latency >= 0);
+
   {
     unique_lock<mutex> guard(lock_);
 
@@ -258,6 +308,11 @@ bool Evolution::newExperiment(shared_ptr<Experiment> experiment,
     ann::g_config.copyFrom(*experiment->coreConfig());
 
     try {
+      // the domain and population constructors may use random values too
+      // (seeded from a separate stream, derived from the same master seed)
+      rng::ReproducibleScope reproducible_scope(
+          config.reproducible, rng::mixSeed(uint64_t(config.random_seed), kSetupStream));
+
       // setup the domain
       auto domain_factory = experiment->domainFactory();
       auto domain = domain_factory->create(*experiment->domainConfig());
@@ -309,6 +364,9 @@ void Evolution::mainThread() {
       core::log("\nRestarting the evolution lifecycle...\n\n");
       canceled = true;
     }
+
+    // make sure all the generations are saved before reporting the stop
+    experiment_->universe()->flush();
     
     // stop the evolution
     {
@@ -341,6 +399,10 @@ void Evolution::evolutionCycle() {
 
   SCOPE_EXIT { top_stages.unsubscribe(stages_subscription); };
 
+  // reproducible mode? (scoped to the evolution main thread and its parallel loops)
+  rng::ReproducibleScope reproducible_scope(config_.reproducible,
+                                            uint64_t(config_.random_seed));
+
   core::log("\nEvolution started:\n\n");
 
   // main evolution loop
@@ -388,6 +450,15 @@ void Evolution::checkpoint() {
   while (state_ != State::Running) {
     // handle pause requests (Pausing -> Paused)
     if (state_ == State::Pausing) {
+      // make sure all the generations are saved before reporting the pause
+      auto universe = experiment_->universe();
+      guard.unlock();
+      universe->flush();
+      guard.lock();
+
+      if (state_ != State::Pausing)
+        continue;
+
       state_ = State::Paused;
       state_cv_.notify_all();
 
@@ -418,11 +489,12 @@ void Evolution::beginStage(const string& name, size_t size, uint32_t annotations
 
   {
     unique_lock<mutex> guard(lock_);
+    foldPendingProgress();
     stage_stack_.emplace_back(name, size, annotations);
     stage_stack_.back().start();
   }
 
-  events.publish(EventFlag::StateChanged);
+  events.publish(EventFlag::StateChanged | EventFlag::ProgressUpdate);
 }
 
 void Evolution::finishStage(const string& name) {
@@ -436,6 +508,7 @@ void Evolution::finishStage(const string& name) {
     unique_lock<mutex> guard(lock_);
 
     CHECK(!stage_stack_.empty());
+    foldPendingProgress();
     stage = stage_stack_.back();
     CHECK(stage.name() == name);
     stage.finish();
@@ -455,25 +528,25 @@ void Evolution::finishStage(const string& name) {
     top_stages.publish(stage);
   }
 
-  events.publish(EventFlag::StateChanged);
+  events.publish(EventFlag::StateChanged | EventFlag::ProgressUpdate);
 }
 
+// NOTE: this is called from the worker threads for every evaluated
+//  genotype, so it must not take the evolution lock
 void Evolution::reportProgress(size_t increment) {
-  bool progress_notification = false;
-
-  {
-    unique_lock<mutex> guard(lock_);
+  // the progress notifications are throttled
+  // (beginStage() and finishStage() always publish the final progress)
+  if (progress_.add(increment))
+    events.publish(EventFlag::ProgressUpdate);
+}
 
+// folds the pending progress into the current stage (must be called with lock_ held)
+void Evolution::foldPendingProgress() {
+  const size_t progress = progress_.fold();
+  if (progress > 0) {
     CHECK(!stage_stack_.empty());
-
-    auto& current_stage = stage_stack_.back();
-    int prev_progress_percent = current_stage.progressPercent();
-    current_stage.advanceProgress(increment);
-    progress_notification = current_stage.progressPercent() != prev_progress_percent;
+    stage_stack_.back().advanceProgress(progress);
   }
-
-  if (progress_notification)
-    events.publish(EventFlag::ProgressUpdate);
 }
 
 Evolution::Snapshot Evolution::snapshot() const {
@@ -483,6 +556,13 @@ Evolution::Snapshot Evolution::snapshot() const {
   s.trace = trace_;
   s.generation = population_ ? population_->generation() : 0;
   s.stage = stage_stack_.empty() ? EvolutionStage() : stage_stack_.back();
+  if (!stage_stack_.empty()) {
+    // include the progress reported since the last stage transition
+    // (a lower bound since the worker threads may be still reporting progress)
+    const size_t pending_progress = progress_.pending();
+    if (pending_progress > 0)
+      s.stage.advanceProgress(pending_progress);
+  }
   s.state = state_;
   s.population = population_.get();
   s.domain = domain_.get();
@@ -557,6 +637,7 @@ bool Evolution::reset() {
 
     // reset the evolution state
     stage_stack_.clear();
+    progress_.reset();
     experiment_.reset();
     trace_.reset();
     population_.reset();
@@ -15,6 +15,7 @@
 #pragma once
 
 #include "darwin.h"
+#include "progress_counter.h"
 #include "pubsub.h"
 #include "thread_pool.h"
 
@@ -51,12 +52,19 @@ struct GenerationSummary {
   shared_ptr<core::PropertySet> calibration_fitness;
 
   //! Best genotype in the generation
+  //! \note Consecutive generations with the same champion share the same instance
   shared_ptr<Genotype> champion;
 
+  //! Content hash of the champion genotype (see Genotype::contentHash())
+  uint64_t champion_hash = 0;
+
   GenerationSummary() = default;
 
+  //! Captures the summary of the current population generation
+  //! (the champion is shared with the previous generation summary, if unchanged)
   GenerationSummary(const Population* population,
-                    shared_ptr<core::PropertySet> calibration_fitness);
+                    shared_ptr<core::PropertySet> calibration_fitness,
+                    const GenerationSummary* previous = nullptr);
 };
 
 //! One fitness data point
@@ -74,7 +82,7 @@ struct CompressedFitnessValue {
 enum class FitnessInfoKind {
   SamplesOnly,      //!< Just the best/median/worst/calibration fitness values
   FullCompressed,   //!< All the fitness values, compressed
-  FullRaw,          //!< All the fitness values, raw
+  FullRaw,          //!< All the fitness values, raw (see PopulationTrace)
 };
 
 inline auto customStringify(core::TypeTag<FitnessInfoKind>) {
@@ -117,15 +125,43 @@ struct EvolutionConfig : public core::PropertySet {
            FitnessInfoKind::FullCompressed,
            "What kind of fitness information to save");
 
+  PROPERTY(genotype_compression,
+           GenotypeCompression,
+           GenotypeCompression::Lz4,
+           "Compression used for the saved genotypes");
+
+  PROPERTY(fitness_trace_encoding,
+           FitnessTraceEncoding,
+           FitnessTraceEncoding::Delta,
+           "Encoding of the full fitness values (with full_raw fitness information)");
+
   PROPERTY(save_genealogy,
            bool,
            false,
-           "Save the genealogy information (can be very large!)");
+           "Save the genealogy information (one entry for each genotype)");
 
   PROPERTY(profile_information,
            ProfileInfoKind,
            ProfileInfoKind::GenerationOnly,
            "Performance trace (counters/timings)");
+
+  PROPERTY(reproducible,
+           bool,
+           false,
+           "Reproducible runs (identical results for the same random seed, "
+           "regardless of the number of threads)");
+
+  PROPERTY(random_seed, int, 1, "The master random seed (used if reproducible is true)");
+
+  PROPERTY(db_commit_max_generations,
+           int,
+           64,
+           "Max number of generations saved in a single database transaction");
+
+  PROPERTY(db_commit_max_latency,
+           int,
+           1000,
+           "Max time (milliseconds) before a generation is saved to the database");
 };
 
 vector<CompressedFitnessValue> compressFitness(const Population* population);
@@ -206,6 +242,11 @@ class EvolutionTrace : public core::NonCopyable {
 
   const Evolution* evolution_ = nullptr;
   unique_ptr<DbEvolutionTrace> db_trace_;
+
+  // the last champion and its binary genotype (reused while the champion is unchanged)
+  // (only accessed from addGeneration(), so it's not guarded by lock_)
+  shared_ptr<Genotype> last_champion_;
+  shared_ptr<const db::Blob> last_champion_genotype_;
 };
 
 //! Interface for monitoring evolution progress
@@ -411,6 +452,8 @@ class Evolution : public core::NonCopyable,
   void finishStage(const string& name) override;
   void reportProgress(size_t increment = 1) override;
 
+  void foldPendingProgress();
+
  private:
   std::thread::id main_thread_id_;
 
@@ -420,6 +463,12 @@ class Evolution : public core::NonCopyable,
   State state_ = State::Initializing;
   vector<EvolutionStage> stage_stack_;
 
+  // progress reported for the current (innermost) stage, not yet folded into
+  // stage_stack_. the progress reporting from the worker threads doesn't need to
+  // take the lock (the pending progress is folded into the stage on stage
+  // transitions and added to the snapshots)
+  ProgressCounter progress_;
+
   EvolutionConfig config_;
 
   // population & domain
@@ -0,0 +1,194 @@
+// Copyright 2018 The Darwin Neuroevolution Framework Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "lz4.h"
+#include "exception.h"
+
+#include <string.h>
+#include <algorithm>
+#include <memory>
+using namespace std;
+
+namespace lz4 {
+
+constexpr size_t kMinMatch = 4;
+
+// the last match must start at least 12 bytes before the end of the block,
+// and the last 5 bytes are always literals
+constexpr size_t kMatchStartLimit = 12;
+constexpr size_t kLastLiterals = 5;
+
+constexpr size_t kMaxOffset = 65535;
+
+constexpr int kHashBits = 12;
+
+static uint32_t load32(const uint8_t* p) {
+  uint32_t value = 0;
+  ::memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+static uint32_t hash(uint32_t sequence) {
+  return (sequence * 2654435761u) >> (32 - kHashBits);
+}
+
+static void writeLength(vector<uint8_t>& dst, size_t length) {
+  for (; length >= 255; length -= 255)
+    dst.push_back(255);
+  dst.push_back(uint8_t(length));
+}
+
+static void writeSequence(vector<uint8_t>& dst,
+                          const uint8_t* literals,
+                          size_t literals_length,
+                          size_t offset,
+                          size_t match_length) {
+  const bool last_sequence = match_length == 0;
+  const size_t match_code = last_sequence ? 0 : match_length - kMinMatch;
+
+  const uint8_t literals_token = uint8_t(min<size_t>(literals_length, 15));
+  const uint8_t match_token = uint8_t(min<size_t>(match_code, 15));
+  dst.push_back(uint8_t(literals_token << 4 | match_token));
+
+  if (literals_length >= 15)
+    writeLength(dst, literals_length - 15);
+  dst.insert(dst.end(), literals, literals + literals_length);
+
+  if (!last_sequence) {
+    dst.push_back(uint8_t(offset));
+    dst.push_back(uint8_t(offset >> 8));
+    if (match_code >= 15)
+      writeLength(dst, match_code - 15);
+  }
+}
+
+vector<uint8_t> compress(const uint8_t* data, size_t size) {
+  vector<uint8_t> dst;
+  dst.reserve(size + size / 255 + 16);
+
+  size_t anchor = 0;
+
+  if (size > kMatchStartLimit) {
+    // the positions of the last sequences seen for each hash value (+1, 0 = empty)
+    auto hash_table = make_unique<uint32_t[]>(size_t(1) << kHashBits);
+
+    const size_t match_start_limit = size - kMatchStartLimit;
+    const size_t match_end_limit = size - kLastLiterals;
+
+    size_t pos = 0;
+    while (pos < match_start_limit) {
+      const uint32_t sequence = load32(data + pos);
+      uint32_t& slot = hash_table[hash(sequence)];
+      const size_t candidate = slot;
+      slot = uint32_t(pos + 1);
+
+      if (candidate == 0 || pos - (candidate - 1) > kMaxOffset ||
+          load32(data + candidate - 1) != sequence) {
+        ++pos;
+        continue;
+      }
+
+      const size_t match = candidate - 1;
+      size_t match_length = kMinMatch;
+      while (pos + match_length < match_end_limit &&
+             data[match + match_length] == data[pos + match_length]) {
+        ++match_length;
+      }
+
+      writeSequence(dst, data + anchor, pos - anchor, pos - match, match_length);
+      pos += match_length;
+      anchor = pos;
+    }
+  }
+
+  // the last literals
+  writeSequence(dst, data + anchor, size - anchor, 0, 0);
+  return dst;
+}
+
+vector<uint8_t> decompress(const uint8_t* data, size_t size, size_t decompressed_size) {
+  // each input byte decompresses to at most 255 bytes (a match length extension),
+  // so reject impossible sizes before allocating the output buffer
+  constexpr size_t kMaxExpansion = 255;
+  if (decompressed_size / kMaxExpansion > size)
+    throw core::Exception("Invalid LZ4 block");
+
+  vector<uint8_t> dst(decompressed_size);
+
+  const uint8_t* src = data;
+  const uint8_t* src_end = data + size;
+  size_t dst_pos = 0;
+
+  auto invalidBlock = [] { return core::Exception("Invalid LZ4 block"); };
+
+  auto readLength = [&](size_t length) {
+    if (length == 15) {
+      uint8_t byte = 0;
+      do {
+        if (src == src_end)
+          throw invalidBlock();
+        byte = *src++;
+        length += byte;
+      } while (byte == 255);
+    }
+    return length;
+  };
+
+  for (;;) {
+    if (src == src_end)
+      throw invalidBlock();
+    const uint8_t token = *src++;
+
+    // literals
+    const size_t literals_length = readLength(token >> 4);
+    if (literals_length > size_t(src_end - src) ||
+        literals_length > decompressed_size - dst_pos) {
+      throw invalidBlock();
+    }
+    ::memcpy(dst.data() + dst_pos, src, literals_length);
+    src += literals_length;
+    dst_pos += literals_length;
+
+    // the last sequence has no match
+    if (src == src_end)
+      break;
+
+    // match
+    if (src_end - src < 2)
+      throw invalidBlock();
+    const size_t offset = size_t(src[0]) | size_t(src[1]) << 8;
+    src += 2;
+    if (offset == 0 || offset > dst_pos)
+      throw invalidBlock();
+
+    const size_t match_length = readLength(token & 0x0f) + kMinMatch;
+    if (match_length > decompressed_size - dst_pos)
+      throw invalidBlock();
+
+    // the match may overlap the output, so it must be copied one byte at a time
+    const uint8_t* match = dst.data() + dst_pos - offset;
+    uint8_t* out = dst.data() + dst_pos;
+    for (size_t i = 0; i < match_length; ++i)
+      out[i] = match[i];
+    dst_pos += match_length;
+  }
+
+  if (dst_pos != decompressed_size)
+    throw invalidBlock();
+
+  return dst;
+}
+
+}  // namespace lz4
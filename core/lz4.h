@@ -0,0 +1,38 @@
+// Copyright 2018 The Darwin Neuroevolution Framework Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+using namespace std;
+
+// a self-contained implementation of the LZ4 block format
+// (https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md)
+//
+// the compressor is a simple greedy one (a single hash table probe per position),
+// trading some compression ratio for speed and simplicity
+//
+namespace lz4 {
+
+//! Compresses a block of data
+vector<uint8_t> compress(const uint8_t* data, size_t size);
+
+//! Decompresses a LZ4 block (the decompressed size must be known)
+//! \throws core::Exception if the compressed block is invalid
+vector<uint8_t> decompress(const uint8_t* data, size_t size, size_t decompressed_size);
+
+}  // namespace lz4
@@ -14,12 +14,14 @@
 
 #pragma once
 
+#include "binary_io.h"
 #include "exception.h"
 
 #include <third_party/json/json.h>
 using nlohmann::json;
 
 #include <assert.h>
+#include <type_traits>
 #include <vector>
 using namespace std;
 
@@ -100,9 +102,76 @@ struct Matrix {
       throw core::Exception("Failed to deserialize matrix");
   }
 
+  //! Binary encoding
+  friend void to_binary(core::BinaryWriter& writer, const Matrix& m) {
+    writer.writeSize(m.rows);
+    writer.writeSize(m.cols);
+    writer.writeValues(m.values.data(), m.values.size());
+  }
+
+  //! Binary decoding
+  friend void from_binary(core::BinaryReader& reader, Matrix& m) {
+    const size_t rows = reader.readSize();
+    const size_t cols = reader.readSize();
+    if ((rows == 0) != (cols == 0))
+      throw core::Exception("Failed to deserialize matrix");
+    if (cols > 0 && rows > reader.remaining() / sizeof(T) / cols)
+      throw core::Exception("Failed to deserialize matrix");
+    m.rows = rows;
+    m.cols = cols;
+    m.values.resize(rows * cols);
+    reader.readValues(m.values.data(), m.values.size());
+  }
+
   size_t rows = 0;
   size_t cols = 0;
   vector<T> values;
 };
 
+//! A non-owning view of a 2D matrix (row-major, contiguous values)
+//!
+//! The values may belong to a Matrix or to an external memory block
+//! (ex. a slice of a larger arena)
+//!
+//! \note Use MatrixView<const T> for read-only views
+//!
+template <class T>
+struct MatrixView {
+  using Value = remove_const_t<T>;
+
+  //! Constructs a view of an external memory block (rows * cols values)
+  MatrixView(T* data, size_t rows, size_t cols) : data(data), rows(rows), cols(cols) {}
+
+  //! Constructs a view of a Matrix
+  MatrixView(Matrix<Value>& matrix)
+      : MatrixView(matrix.values.data(), matrix.rows, matrix.cols) {}
+
+  //! Constructs a read-only view of a Matrix
+  MatrixView(const Matrix<Value>& matrix)
+      : MatrixView(matrix.values.data(), matrix.rows, matrix.cols) {}
+
+  //! Copy constructor, also the conversion from a mutable to a read-only view
+  MatrixView(const MatrixView<Value>& other)
+      : MatrixView(other.data, other.rows, other.cols) {}
+
+  MatrixView& operator=(const MatrixView&) = default;
+
+  //! Indexed access to a row in the matrix
+  ArrayView<T> operator[](size_t row) const {
+    assert(row < rows);
+    return { data + row * cols, cols };
+  }
+
+  //! The total number of values (rows * cols)
+  size_t size() const { return rows * cols; }
+
+  //! Iteration over all the values (row-major order)
+  T* begin() const { return data; }
+  T* end() const { return data + rows * cols; }
+
+  T* data = nullptr;
+  size_t rows = 0;
+  size_t cols = 0;
+};
+
 }  // namespace core
@@ -0,0 +1,90 @@
+// Copyright 2018 The Darwin Neuroevolution Framework Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <core/utils.h>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+using namespace std;
+
+namespace pp {
+
+//! A thread-safe pool of reusable objects
+//!
+//! For objects which are expensive to construct relative to their use (ex. physics
+//! worlds used for short simulation episodes), recycling the objects avoids the
+//! construction cost and the allocator churn.
+//!
+//! ```cpp
+//! auto world = pool.acquire();
+//! if (world)
+//!   world->reset(...);
+//! else
+//!   world = pool.adopt(make_unique<World>(...));
+//! ```
+//!
+//! The objects are returned to the pool when the handles go out of scope. The most
+//! recently returned objects are reused first, so the worker threads tend to get
+//! back the same objects (which are likely still in the cache).
+//!
+//! \note The pool must outlive the handles
+//!
+template <class T>
+class ObjectPool : public core::NonCopyable {
+  // returns the objects to the pool, instead of deleting them
+  struct Recycler {
+    ObjectPool* pool = nullptr;
+    void operator()(T* obj) const { pool->recycle(obj); }
+  };
+
+ public:
+  //! A pooled object handle
+  using Handle = unique_ptr<T, Recycler>;
+
+  ObjectPool() = default;
+
+  ~ObjectPool() {
+    for (T* obj : free_objects_)
+      delete obj;
+  }
+
+  //! Returns a recycled object, or an empty handle if there are no available objects
+  //! (the caller is responsible for resetting the recycled object state)
+  Handle acquire() {
+    unique_lock<mutex> guard(lock_);
+    if (free_objects_.empty())
+      return Handle(nullptr, Recycler{ this });
+    T* obj = free_objects_.back();
+    free_objects_.pop_back();
+    return Handle(obj, Recycler{ this });
+  }
+
+  //! Takes ownership of a new object, which will be returned to this pool
+  Handle adopt(unique_ptr<T> obj) { return Handle(obj.release(), Recycler{ this }); }
+
+ private:
+  void recycle(T* obj) {
+    unique_lock<mutex> guard(lock_);
+    free_objects_.push_back(obj);
+  }
+
+ private:
+  mutex lock_;
+  vector<T*> free_objects_;
+};
+
+}  // namespace pp
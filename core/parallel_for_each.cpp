@@ -12,8 +12,54 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include "parallel_for_each.h"
+
+#include <algorithm>
+using namespace std;
+
 namespace pp {
 
 thread_local bool g_inside_parallel_for = false;
 
+vector<int> partition(int size, int threads_count, Partitioner partitioner) {
+  // this is roughly the number of shards per worker thread (Partitioner::Static)
+  constexpr int kShardsGranularity = 100;
+
+  // a guided shard covers 1/(kGuidedDivisor * threads) of the remaining indexes
+  constexpr int kGuidedDivisor = 2;
+
+  CHECK(size > 0);
+  CHECK(threads_count > 0);
+
+  vector<int> bounds = { 0 };
+
+  switch (partitioner) {
+    case Partitioner::Static: {
+      const int shards_count = min(size, threads_count * kShardsGranularity);
+      const int shard_size = size / shards_count;
+      const int remainder = size % shards_count;
+      int index = 0;
+      for (int i = 0; i < shards_count; ++i) {
+        index += i < remainder ? (shard_size + 1) : shard_size;
+        bounds.push_back(index);
+      }
+    } break;
+
+    case Partitioner::Guided: {
+      int index = 0;
+      while (index < size) {
+        const int remaining = size - index;
+        index += max(1, remaining / (threads_count * kGuidedDivisor));
+        bounds.push_back(index);
+      }
+    } break;
+
+    default:
+      FATAL("Unexpected partitioner type");
+  }
+
+  CHECK(bounds.back() == size);
+  return bounds;
+}
+
 }  // namespace pp
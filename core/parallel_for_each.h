@@ -15,14 +15,52 @@
 #pragma once
 
 #include "utils.h"
+#include "rng.h"
 #include "scope_guard.h"
 #include "thread_pool.h"
 
+#include <atomic>
+#include <vector>
+using namespace std;
+
 namespace pp {
 
 // per-thread state used to catch accidental nesting of parallel-for-loops
 extern thread_local bool g_inside_parallel_for;
 
+//! The strategy used by pp::for_each() to split the index range into shards
+//!
+//! Here, a shard is a set of consecutive array indexes, processed as one
+//! thread pool work item.
+//!
+enum class Partitioner {
+  //! Equal size shards (roughly kShardsGranularity shards per worker thread)
+  //!
+  //! Higher granularity means smaller individual shards and results in better
+  //! load balancing, but also higher work queue synchronization overhead.
+  //!
+  Static,
+
+  //! Guided self-scheduling: large initial shards, shrinking as the range drains
+  //!
+  //! The size of each shard is proportional to the number of remaining indexes,
+  //! so the bulk of the range is processed in a few large shards while the small
+  //! shards towards the end balance the load. A good fit for iterations with
+  //! highly variable costs (ex. evaluation episodes which may end early)
+  //!
+  Guided,
+};
+
+//! Splits the [0, size) index range into shards
+//! 
+//! \param size - the index range size
+//! \param threads_count - the number of worker threads
+//! \param partitioner - the partitioning strategy
+//! 
+//! \returns The shard boundaries: shard i is [bounds[i], bounds[i + 1])
+//! 
+vector<int> partition(int size, int threads_count, Partitioner partitioner);
+
 //! Iterates over an array, with support for parallel execution
 //! 
 //! pp::for_each() offers an easy way to parallelize the processing of the elements in an
@@ -37,6 +75,13 @@ extern thread_local bool g_inside_parallel_for;
 //! });
 //! ```
 //!
+//! The optional partitioner argument selects how the array is split into shards
+//! (the default is Partitioner::Static)
+//!
+//! If the calling thread is in the reproducible mode (rng::ReproducibleScope), the
+//! thread generator (rng::threadGenerator()) is reseeded before each iteration, so
+//! the iterations see the same random values regardless of the number of threads.
+//!
 //! \note pp::for_each() loops can't be nested
 //!
 //! \warning Iterations will likely happen on different threads,
@@ -52,7 +97,9 @@ extern thread_local bool g_inside_parallel_for;
 //!   ```
 //!
 template <class T, class Body>
-void for_each(T& array, const Body& loop_body) {
+void for_each(T& array,
+              const Body& loop_body,
+              Partitioner partitioner = Partitioner::Static) {
   CHECK(!g_inside_parallel_for);
 
   auto thread_pool = ParallelForSupport::threadPool();
@@ -61,42 +108,43 @@ void for_each(T& array, const Body& loop_body) {
   if (array.size() == 0)
     return;
 
-  // this is roughly the number of shards per worker thread
-  //
-  // here, a shard is a set of array indexes. higher granularity means
-  // smaller individual shards and results in better load balancing,
-  //  but also higher work queue synchronization overhead
-  //
-  // TODO: investigate auto-tuning solutions instead of the hardcoded value
-  //
-  constexpr int kShardsGranularity = 100;
-
   const int size = int(array.size());
-  const int shards_count = thread_pool->threadsCount() * kShardsGranularity;
-  const int shard_size = size / shards_count;
-  const int remainder = size % shards_count;
+  const auto shard_bounds = partition(size, thread_pool->threadsCount(), partitioner);
+  const int shards_count = int(shard_bounds.size()) - 1;
+  CHECK(shards_count > 0);
+
+  // reproducible mode: each iteration uses its own random stream
+  const bool reseed = rng::reproducibleMode();
+  const uint64_t loop_seed = reseed ? rng::nextSeed() : 0;
+
+  // the shards are handed out in order, as the work items are executed
+  // (so the large shards produced by Partitioner::Guided are processed first)
+  atomic<int> next_shard = 0;
 
   // create a batch for all the shards
   auto batch = make_unique<WorkBatch>();
 
-  int index = 0;
-  for (int i = 0; i < shards_count && index < size; ++i) {
-    int actual_shard_size = i < remainder ? (shard_size + 1) : shard_size;
-    CHECK(actual_shard_size > 0);
-    batch->pushWork([&, beginIndex = index, endIndex = index + actual_shard_size] {
+  for (int i = 0; i < shards_count; ++i) {
+    batch->pushWork([&] {
       g_inside_parallel_for = true;
       SCOPE_EXIT { g_inside_parallel_for = false; };
 
-      CHECK(beginIndex < endIndex);
+      // the loop body follows the calling thread's reproducible mode
+      rng::LoopScope rng_loop_scope(reseed);
+
+      const int shard_index = next_shard++;
+      CHECK(shard_index < shards_count);
+      const int begin_index = shard_bounds[shard_index];
+      const int end_index = shard_bounds[shard_index + 1];
+      CHECK(begin_index < end_index);
 
-      for (int i = beginIndex; i < endIndex; ++i) {
+      for (int i = begin_index; i < end_index; ++i) {
+        if (reseed)
+          rng::threadGenerator().seed(rng::mixSeed(loop_seed, i));
         loop_body(i, array[i]);
       }
     });
-
-    index += actual_shard_size;
   }
-  CHECK(index == size);
 
   // push work and wait for completition
   thread_pool->processBatch(std::move(batch));
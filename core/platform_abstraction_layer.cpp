@@ -73,4 +73,32 @@ bool detectAvx2() {
 #endif  // DARWIN_COMPILER_MSVC
 }
 
+bool detectAvx512() {
+#ifdef DARWIN_COMPILER_MSVC
+  int cpu_info[4] = {};
+  bool has_avx512 = false;
+
+  __cpuid(cpu_info, 0);
+  const int n_ids = cpu_info[0];
+
+  if (n_ids >= 7) {
+    __cpuidex(cpu_info, 7, 0);
+    const int ebx_reg = cpu_info[1];
+    has_avx512 = (ebx_reg & (1 << 16)) != 0;
+  }
+
+  // the OS must also save the opmask and the ZMM registers state (XCR0 bits 1-2, 5-7)
+  if (has_avx512) {
+    __cpuid(cpu_info, 1);
+    const int ecx_reg = cpu_info[2];
+    const bool os_xsave = (ecx_reg & (1 << 27)) != 0;
+    has_avx512 = os_xsave && (_xgetbv(0) & 0xe6) == 0xe6;
+  }
+
+  return has_avx512;
+#else
+  return __builtin_cpu_supports("avx512f");
+#endif  // DARWIN_COMPILER_MSVC
+}
+
 }  // namespace pal
@@ -16,9 +16,19 @@
 
 #pragma once
 
+#include "utils.h"
+
 #include <string>
 using namespace std;
 
+//! Marks a function as compiled for AVX-512, regardless of the global build flags
+//! (it must only be called if pal::detectAvx512() returns true)
+#ifdef DARWIN_COMPILER_MSVC
+#define DARWIN_TARGET_AVX512
+#else
+#define DARWIN_TARGET_AVX512 __attribute__((target("avx512f")))
+#endif
+
 namespace pal {
 
 //! Returns user home directory path
@@ -27,4 +37,8 @@ string userHomePath();
 //! Returns true if AVX2 is detected
 bool detectAvx2();
 
+//! Returns true if AVX-512 (the AVX512F foundation subset) is detected
+//! (and enabled by the OS)
+bool detectAvx512();
+
 }  // namespace pal
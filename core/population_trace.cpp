@@ -0,0 +1,226 @@
+// Copyright 2018 The Darwin Neuroevolution Framework Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "population_trace.h"
+#include "exception.h"
+#include "utils.h"
+
+#include <math.h>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+using namespace std;
+
+namespace darwin {
+
+// the population trace binary format:
+//
+//  u8      format version
+//  u8      FitnessTraceEncoding
+//  size    ranked fitness values count
+//  ...     the ranked fitness values (see below)
+//  ...     the genetic operator names (vector<string>)
+//  ...     the operator codes (vector<u8>)
+//  ...     the parents counts (vector<u8>)
+//  ...     the parent ranks (vector<i32>)
+//
+constexpr uint8_t kPopulationTraceVersion = 1;
+
+constexpr double kQuantizedMaxValue = numeric_limits<uint16_t>::max();
+
+static uint32_t floatBits(float value) {
+  uint32_t bits = 0;
+  ::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+static float bitsToFloat(uint32_t bits) {
+  float value = 0;
+  ::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+// the ranked fitness values are sorted, so the deltas between the bit patterns
+// of the consecutive values are small (at least for values with the same sign)
+// and they are encoded as zigzag LEB128 values
+static void writeDeltaFitness(core::BinaryWriter& writer, const vector<float>& values) {
+  int64_t last_bits = 0;
+  for (float value : values) {
+    const int64_t bits = floatBits(value);
+    const int64_t delta = bits - last_bits;
+    writer.writeSize((uint64_t(delta) << 1) ^ uint64_t(delta >> 63));
+    last_bits = bits;
+  }
+}
+
+static void readDeltaFitness(core::BinaryReader& reader, vector<float>& values) {
+  int64_t last_bits = 0;
+  for (float& value : values) {
+    const uint64_t zigzag = reader.readSize();
+    const int64_t bits = last_bits + (int64_t(zigzag >> 1) ^ -int64_t(zigzag & 1));
+    if (bits < 0 || bits > numeric_limits<uint32_t>::max())
+      throw core::Exception("Invalid population trace (fitness delta)");
+    value = bitsToFloat(uint32_t(bits));
+    last_bits = bits;
+  }
+}
+
+// the values are quantized to 16bit values, in the [min, max] range
+static void writeQuantizedFitness(core::BinaryWriter& writer,
+                                  const vector<float>& values) {
+  if (values.empty())
+    return;
+  const auto [min_it, max_it] = minmax_element(values.begin(), values.end());
+  const float min_value = *min_it;
+  const float max_value = *max_it;
+  writer.write(min_value);
+  writer.write(max_value);
+
+  const double range = double(max_value) - min_value;
+  const double scale = range > 0 ? kQuantizedMaxValue / range : 0;
+  vector<uint16_t> quantized_values(values.size());
+  for (size_t i = 0; i < values.size(); ++i)
+    quantized_values[i] = uint16_t(lround((values[i] - double(min_value)) * scale));
+  writer.writeValues(quantized_values.data(), quantized_values.size());
+}
+
+static void readQuantizedFitness(core::BinaryReader& reader, vector<float>& values) {
+  if (values.empty())
+    return;
+  const auto min_value = reader.read<float>();
+  const auto max_value = reader.read<float>();
+  if (!isfinite(min_value) || !isfinite(max_value) || min_value > max_value)
+    throw core::Exception("Invalid population trace (quantized fitness range)");
+
+  vector<uint16_t> quantized_values(values.size());
+  reader.readValues(quantized_values.data(), quantized_values.size());
+
+  const double step = (double(max_value) - min_value) / kQuantizedMaxValue;
+  for (size_t i = 0; i < values.size(); ++i)
+    values[i] = float(min_value + quantized_values[i] * step);
+}
+
+void PopulationTrace::addGenealogy(const string& genetic_operator,
+                                   const vector<int>& parents) {
+  uint8_t operator_code = kNoOperator;
+  if (!genetic_operator.empty()) {
+    auto it = find(genetic_operators.begin(), genetic_operators.end(), genetic_operator);
+    if (it == genetic_operators.end()) {
+      CHECK(genetic_operators.size() < kNoOperator, "Too many genetic operators");
+      genetic_operators.push_back(genetic_operator);
+      it = genetic_operators.end() - 1;
+    }
+    operator_code = uint8_t(it - genetic_operators.begin());
+  }
+
+  CHECK(parents.size() <= numeric_limits<uint8_t>::max());
+  operator_codes.push_back(operator_code);
+  parents_counts.push_back(uint8_t(parents.size()));
+  this->parents.insert(this->parents.end(), parents.begin(), parents.end());
+}
+
+void to_binary(core::BinaryWriter& writer, const PopulationTrace& trace) {
+  const auto& values = trace.ranked_fitness;
+
+  // the quantization needs a finite range
+  auto fitness_encoding = trace.fitness_encoding;
+  if (fitness_encoding == FitnessTraceEncoding::Quantized) {
+    for (float value : values) {
+      if (!isfinite(value)) {
+        fitness_encoding = FitnessTraceEncoding::Delta;
+        break;
+      }
+    }
+  }
+
+  writer.write(kPopulationTraceVersion);
+  writer.write(fitness_encoding);
+  writer.writeSize(values.size());
+
+  switch (fitness_encoding) {
+    case FitnessTraceEncoding::Float32:
+      writer.writeValues(values.data(), values.size());
+      break;
+
+    case FitnessTraceEncoding::Delta:
+      writeDeltaFitness(writer, values);
+      break;
+
+    case FitnessTraceEncoding::Quantized:
+      writeQuantizedFitness(writer, values);
+      break;
+
+    default:
+      FATAL("Unexpected fitness trace encoding");
+  }
+
+  CHECK(trace.operator_codes.size() == trace.parents_counts.size());
+  writer.write(trace.genetic_operators);
+  writer.write(trace.operator_codes);
+  writer.write(trace.parents_counts);
+  writer.write(trace.parents);
+}
+
+void from_binary(core::BinaryReader& reader, PopulationTrace& trace) {
+  if (reader.read<uint8_t>() != kPopulationTraceVersion)
+    throw core::Exception("Unsupported population trace format version");
+
+  trace.fitness_encoding = reader.read<FitnessTraceEncoding>();
+
+  // each value is encoded using at least one byte
+  const size_t values_count = reader.readSize();
+  if (values_count > reader.remaining())
+    throw core::Exception("Invalid binary data (truncated)");
+  trace.ranked_fitness.resize(values_count);
+
+  switch (trace.fitness_encoding) {
+    case FitnessTraceEncoding::Float32:
+      reader.readValues(trace.ranked_fitness.data(), values_count);
+      break;
+
+    case FitnessTraceEncoding::Delta:
+      readDeltaFitness(reader, trace.ranked_fitness);
+      break;
+
+    case FitnessTraceEncoding::Quantized:
+      readQuantizedFitness(reader, trace.ranked_fitness);
+      break;
+
+    default:
+      throw core::Exception("Invalid population trace (unknown fitness encoding)");
+  }
+
+  reader.read(trace.genetic_operators);
+  reader.read(trace.operator_codes);
+  reader.read(trace.parents_counts);
+  reader.read(trace.parents);
+
+  if (trace.operator_codes.size() != trace.parents_counts.size())
+    throw core::Exception("Invalid population trace (genealogy size)");
+
+  size_t total_parents = 0;
+  for (size_t i = 0; i < trace.operator_codes.size(); ++i) {
+    const auto operator_code = trace.operator_codes[i];
+    if (operator_code != PopulationTrace::kNoOperator &&
+        operator_code >= trace.genetic_operators.size()) {
+      throw core::Exception("Invalid population trace (genetic operator)");
+    }
+    total_parents += trace.parents_counts[i];
+  }
+  if (total_parents != trace.parents.size())
+    throw core::Exception("Invalid population trace (parents count)");
+}
+
+}  // namespace darwin
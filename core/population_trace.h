@@ -0,0 +1,86 @@
+// Copyright 2018 The Darwin Neuroevolution Framework Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include "binary_io.h"
+#include "stringify.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+using namespace std;
+
+namespace darwin {
+
+//! The encoding of the ranked fitness values
+//! \sa PopulationTrace
+enum class FitnessTraceEncoding : uint8_t {
+  Float32,    //!< Raw float32 values
+  Delta,      //!< Lossless, the deltas between the consecutive values (varint)
+  Quantized,  //!< Lossy, 16bit values quantized to the [worst, best] fitness range
+};
+
+inline auto customStringify(core::TypeTag<FitnessTraceEncoding>) {
+  static auto stringify = new core::StringifyKnownValues<FitnessTraceEncoding>{
+    { FitnessTraceEncoding::Float32, "float32" },
+    { FitnessTraceEncoding::Delta, "delta" },
+    { FitnessTraceEncoding::Quantized, "quantized" },
+  };
+  return stringify;
+}
+
+//! The per-genotype details of a generation (the full fitness and genealogy
+//! traces), stored in a compact, columnar binary format
+//!
+//! The genealogy entries (one for each genotype) are split into the genetic
+//! operator codes, the parents counts and the concatenated parent ranks.
+//!
+//! \sa DbGeneration::population_trace
+//!
+struct PopulationTrace {
+  //! Marks the genotypes without genealogy information (no genetic operator)
+  static constexpr uint8_t kNoOperator = 0xff;
+
+  //! How the fitness values are encoded
+  //! \note Quantized falls back to Delta if the fitness values are not finite
+  FitnessTraceEncoding fitness_encoding = FitnessTraceEncoding::Float32;
+
+  //! All the fitness values, ranked (empty if not captured)
+  vector<float> ranked_fitness;
+
+  //! The genetic operator names, indexed by the operator codes
+  vector<string> genetic_operators;
+
+  //! The genetic operator code for each genotype (or kNoOperator)
+  vector<uint8_t> operator_codes;
+
+  //! The number of parents for each genotype
+  vector<uint8_t> parents_counts;
+
+  //! The rank indexes of the parents (concatenated for all the genotypes)
+  vector<int32_t> parents;
+
+  //! Appends the genealogy entry for the next genotype
+  void addGenealogy(const string& genetic_operator, const vector<int>& parents);
+
+  //! True if there's nothing to save
+  bool empty() const { return ranked_fitness.empty() && operator_codes.empty(); }
+
+  friend void to_binary(core::BinaryWriter& writer, const PopulationTrace& trace);
+  friend void from_binary(core::BinaryReader& reader, PopulationTrace& trace);
+};
+
+}  // namespace darwin
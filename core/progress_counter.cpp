@@ -0,0 +1,60 @@
+// Copyright 2018 The Darwin Neuroevolution Framework Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "progress_counter.h"
+
+namespace darwin {
+
+// the stripe assigned to the current thread
+static size_t threadStripe() {
+  static atomic<size_t> next_stripe = 0;
+  static thread_local const size_t stripe =
+      next_stripe.fetch_add(1, memory_order_relaxed) % ProgressCounter::kStripes;
+  return stripe;
+}
+
+bool ProgressCounter::add(size_t increment) {
+  using Clock = chrono::steady_clock;
+
+  CHECK(increment > 0);
+  stripes_[threadStripe()].value.fetch_add(increment, memory_order_relaxed);
+
+  // throttle the notifications
+  const int64_t now = Clock::now().time_since_epoch().count();
+  const int64_t interval = Clock::duration(kNotificationInterval).count();
+  int64_t last_notification = last_notification_.load(memory_order_relaxed);
+  return now - last_notification >= interval &&
+         last_notification_.compare_exchange_strong(last_notification, now);
+}
+
+size_t ProgressCounter::pending() const {
+  size_t progress = 0;
+  for (const auto& stripe : stripes_)
+    progress += stripe.value.load(memory_order_relaxed);
+  return progress;
+}
+
+size_t ProgressCounter::fold() {
+  size_t progress = 0;
+  for (auto& stripe : stripes_)
+    progress += stripe.value.exchange(0, memory_order_relaxed);
+  return progress;
+}
+
+void ProgressCounter::reset() {
+  for (auto& stripe : stripes_)
+    stripe.value = 0;
+}
+
+}  // namespace darwin
@@ -0,0 +1,74 @@
+// Copyright 2018 The Darwin Neuroevolution Framework Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "utils.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+using namespace std;
+
+namespace darwin {
+
+//! Accumulates the progress reported concurrently by the worker threads
+//!
+//! The counter is split into stripes (one cache line each) and every thread is
+//! assigned its own stripe, round-robin, the first time it reports progress. So
+//! add() doesn't need a lock and the threads don't contend for the same cache line
+//! (unless there are more than kStripes reporting threads).
+//!
+//! add() also throttles the progress notifications: it returns true at most once
+//! every kNotificationInterval. The last increments may not trigger a notification,
+//! so the owner is expected to notify the final progress explicitly (ex. when the
+//! current stage is finished).
+//!
+class ProgressCounter : public core::NonCopyable {
+ public:
+  //! Number of counter stripes
+  static constexpr int kStripes = 32;
+
+  //! The min interval between two notifications
+  static constexpr auto kNotificationInterval = chrono::milliseconds(100);
+
+ public:
+  //! Adds to the pending progress
+  //! \returns true if a progress notification is due
+  bool add(size_t increment);
+
+  //! The pending progress (a lower bound if other threads are reporting progress)
+  size_t pending() const;
+
+  //! Returns the pending progress and resets it to zero
+  size_t fold();
+
+  //! Resets the pending progress (no other thread may be reporting progress)
+  void reset();
+
+ private:
+  // a counter stripe (padded to a cache line)
+  struct alignas(64) Stripe {
+    atomic<size_t> value = 0;
+  };
+
+  array<Stripe, kStripes> stripes_;
+
+  // timestamp of the last notification (steady clock ticks)
+  atomic<int64_t> last_notification_ = 0;
+};
+
+}  // namespace darwin
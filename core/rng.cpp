@@ -0,0 +1,80 @@
+// Copyright 2019 The Darwin Neuroevolution Framework Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rng.h"
+#include "utils.h"
+
+#include <random>
+using namespace std;
+
+namespace rng {
+
+// the reproducible mode state (per thread, see ReproducibleScope)
+static thread_local bool g_reproducible_mode = false;
+static thread_local uint64_t g_master_seed = 0;
+static thread_local uint64_t g_seed_counter = 0;
+
+// set while executing the iterations of a reproducible pp::for_each() loop
+static thread_local bool g_reproducible_loop = false;
+
+uint64_t randomSeed() {
+  random_device rd;
+  const uint64_t hi = rd();
+  const uint64_t lo = rd();
+  return (hi << 32) | lo;
+}
+
+void setReproducibleMode(bool enabled, uint64_t master_seed) {
+  g_master_seed = master_seed;
+  g_seed_counter = 0;
+  g_reproducible_mode = enabled;
+
+  if (enabled) {
+    threadGenerator().seed(nextSeed());
+  }
+}
+
+bool reproducibleMode() {
+  return g_reproducible_mode || g_reproducible_loop;
+}
+
+uint64_t nextSeed() {
+  CHECK(g_reproducible_mode);
+  return mixSeed(g_master_seed, g_seed_counter++);
+}
+
+ReproducibleScope::ReproducibleScope(bool enabled, uint64_t master_seed)
+    : saved_enabled_(g_reproducible_mode),
+      saved_master_seed_(g_master_seed),
+      saved_seed_counter_(g_seed_counter),
+      saved_generator_(threadGenerator()) {
+  setReproducibleMode(enabled, master_seed);
+}
+
+ReproducibleScope::~ReproducibleScope() {
+  g_reproducible_mode = saved_enabled_;
+  g_master_seed = saved_master_seed_;
+  g_seed_counter = saved_seed_counter_;
+  threadGenerator() = saved_generator_;
+}
+
+LoopScope::LoopScope(bool reproducible) : saved_reproducible_loop_(g_reproducible_loop) {
+  g_reproducible_loop = reproducible;
+}
+
+LoopScope::~LoopScope() {
+  g_reproducible_loop = saved_reproducible_loop_;
+}
+
+}  // namespace rng
@@ -0,0 +1,201 @@
+// Copyright 2019 The Darwin Neuroevolution Framework Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+using namespace std;
+
+//! Fast pseudo-random number generators
+//!
+//! The hot loops (selection, genetic operators, tournaments, ...) should use the
+//! thread-local generator instead of constructing (and seeding) a new generator
+//! for each item:
+//!
+//! ```cpp
+//! auto& rnd = rng::threadGenerator();
+//! uniform_int_distribution<int> dist(0, 10);
+//! int value = dist(rnd);
+//! ```
+//!
+//! Independent, reproducible streams can be derived from a seed and a stream id,
+//! using rng::streamGenerator()
+//!
+//! In the reproducible mode (see ReproducibleScope), pp::for_each() reseeds the
+//! thread generator before each iteration, from a seed derived from the master seed,
+//! the loop sequence number and the iteration index. So the generated values depend
+//! only on the master seed and the sequence of parallel loops, not on the number of
+//! threads or on the iterations scheduling.
+//!
+//! The reproducible mode is a per-thread setting: it applies to the thread which
+//! enabled it and to the bodies of the pp::for_each() loops started from that thread.
+//! The parallel loops started from other threads are not affected.
+//!
+namespace rng {
+
+//! SplitMix64 step (used to expand and mix seeds)
+//! \sa http://prng.di.unimi.it/splitmix64.c
+inline uint64_t splitMix64(uint64_t& state) {
+  uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+//! Derives a new seed from a base seed and a stream id
+//!
+//! This is a counter-based split: the result depends only on the input values,
+//! and the streams derived from the same seed are statistically independent.
+//!
+inline uint64_t mixSeed(uint64_t seed, uint64_t stream) {
+  uint64_t state = seed;
+  const uint64_t mixed_seed = splitMix64(state);
+  state = mixed_seed ^ stream;
+  return splitMix64(state);
+}
+
+//! xoshiro256** 1.0, a fast, high quality 64bit generator (Blackman & Vigna)
+//!
+//! It models the C++ UniformRandomBitGenerator concept, so it can be used with
+//! the standard distributions.
+//!
+//! \sa http://prng.di.unimi.it
+//!
+class Xoshiro256 {
+ public:
+  using result_type = uint64_t;
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() { return numeric_limits<result_type>::max(); }
+
+  explicit Xoshiro256(uint64_t seed_value = 0) { seed(seed_value); }
+
+  //! Reseeds the generator (the full state is expanded from the seed using SplitMix64)
+  void seed(uint64_t seed_value) {
+    uint64_t state = seed_value;
+    for (auto& s : s_)
+      s = splitMix64(state);
+  }
+
+  //! Generates the next value
+  result_type operator()() {
+    const uint64_t result = rotl(s_[1] * 5, 7) * 9;
+    const uint64_t t = s_[1] << 17;
+    s_[2] ^= s_[0];
+    s_[3] ^= s_[1];
+    s_[1] ^= s_[2];
+    s_[0] ^= s_[3];
+    s_[2] ^= t;
+    s_[3] = rotl(s_[3], 45);
+    return result;
+  }
+
+  friend bool operator==(const Xoshiro256& a, const Xoshiro256& b) {
+    return a.s_[0] == b.s_[0] && a.s_[1] == b.s_[1] && a.s_[2] == b.s_[2] &&
+           a.s_[3] == b.s_[3];
+  }
+
+  friend bool operator!=(const Xoshiro256& a, const Xoshiro256& b) { return !(a == b); }
+
+ private:
+  static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+ private:
+  uint64_t s_[4] = {};
+};
+
+//! The default generator type
+using Generator = Xoshiro256;
+
+//! Returns a new random seed (from std::random_device)
+//! \note This is relatively expensive, don't use it in hot loops
+uint64_t randomSeed();
+
+//! Creates a generator for the specified stream
+//!
+//! The generator state depends only on the seed and the stream id,
+//! (it doesn't matter which thread is calling this)
+//!
+inline Generator streamGenerator(uint64_t seed, uint64_t stream) {
+  return Generator(mixSeed(seed, stream));
+}
+
+//! Accessor to the calling thread's generator
+//!
+//! The thread-local generator is seeded once, using randomSeed(), so the
+//! generated values are not reproducible between runs (unless the reproducible
+//! mode is enabled, see setReproducibleMode())
+//!
+inline Generator& threadGenerator() {
+  static thread_local Generator generator(randomSeed());
+  return generator;
+}
+
+//! Enables or disables the reproducible mode for the calling thread
+//!
+//! Enabling the reproducible mode resets the loop sequence (see nextSeed())
+//! and reseeds the calling thread's generator from the master seed.
+//!
+//! \param enabled - enable or disable the reproducible mode
+//! \param master_seed - the master seed (used only if enabled is true)
+//!
+//! \sa ReproducibleScope
+//!
+void setReproducibleMode(bool enabled, uint64_t master_seed = 0);
+
+//! Returns true if the reproducible mode is enabled for the calling thread
+//! (including the pp::for_each() iterations started from a reproducible thread)
+bool reproducibleMode();
+
+//! Returns the next seed in the sequence derived from the master seed
+//! \note It must be called only in the reproducible mode, and not from
+//!   the pp::for_each() iterations
+uint64_t nextSeed();
+
+//! Sets the reproducible mode for the calling thread, for the lifetime of the scope
+//!
+//! The previous mode and the state of the thread's generator are restored
+//! when the scope is destroyed.
+//!
+class ReproducibleScope {
+ public:
+  ReproducibleScope(bool enabled, uint64_t master_seed);
+  ~ReproducibleScope();
+
+  ReproducibleScope(const ReproducibleScope&) = delete;
+  ReproducibleScope& operator=(const ReproducibleScope&) = delete;
+
+ private:
+  bool saved_enabled_ = false;
+  uint64_t saved_master_seed_ = 0;
+  uint64_t saved_seed_counter_ = 0;
+  Generator saved_generator_;
+};
+
+//! Propagates the reproducible mode to the iterations of a parallel loop
+//! (used by pp::for_each(), on the threads executing the loop body)
+class LoopScope {
+ public:
+  explicit LoopScope(bool reproducible);
+  ~LoopScope();
+
+  LoopScope(const LoopScope&) = delete;
+  LoopScope& operator=(const LoopScope&) = delete;
+
+ private:
+  bool saved_reproducible_loop_ = false;
+};
+
+}  // namespace rng
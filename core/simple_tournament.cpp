@@ -16,6 +16,7 @@
 
 #include <core/evolution.h>
 #include <core/parallel_for_each.h>
+#include <core/rng.h>
 
 namespace tournament {
 
@@ -25,10 +26,12 @@ SimpleTournament::SimpleTournament(const core::PropertySet& config) {
 
 void SimpleTournament::evaluatePopulation(darwin::Population* population,
                                           GameRules* game_rules) {
+  // the cached brains from the previous tournament are stale
+  BrainCache::newTournament();
+
   darwin::StageScope stage("Tournament", population->size());
   pp::for_each(*population, [&](int index, darwin::Genotype* genotype) {
-    random_device rd;
-    default_random_engine rnd(rd());
+    auto& rnd = rng::threadGenerator();
     uniform_int_distribution<size_t> dist_opponent(0, population->size() - 1);
 
     float score = 0;
@@ -18,6 +18,7 @@
 #include <core/evolution.h>
 #include <core/parallel_for_each.h>
 #include <core/logging.h>
+#include <core/rng.h>
 
 #include <algorithm>
 #include <random>
@@ -71,8 +72,7 @@ void SwissTournament::evaluatePopulation(darwin::Population* population,
   if (population->size() % 2 != 0)
     throw core::Exception("Swiss tournament requires an even population size");
 
-  random_device rd;
-  default_random_engine rnd(rd());
+  auto& rnd = rng::threadGenerator();
 
   // setup the index used to setup the pairings for each round
   vector<int> pairing_index(population->size());
@@ -87,6 +87,9 @@ void SwissTournament::evaluatePopulation(darwin::Population* population,
 
   PairingLog pairing_log(population->size());
 
+  // the cached brains from the previous tournament are stale
+  BrainCache::newTournament();
+
   darwin::StageScope stage("Tournament", config_.rounds);
   for (int round = 0; round < config_.rounds; ++round) {
     vector<Pairing> pairings;
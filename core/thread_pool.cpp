@@ -38,29 +38,49 @@ ThreadPool::ThreadPool(int threads_count, Controller* controller)
   }
 
   for (int i = 0; i < threads_count; ++i) {
-    worker_threads_.emplace_back(&ThreadPool::workerThread, this);
+    workers_.push_back(make_unique<Worker>());
+  }
+
+  for (int i = 0; i < threads_count; ++i) {
+    worker_threads_.emplace_back(&ThreadPool::workerThread, this, i);
   }
 }
 
-void ThreadPool::processBatch(unique_ptr<WorkBatch> batch) {
-  unique_lock<mutex> guard(lock_);
+ThreadPool::~ThreadPool() {
+  {
+    unique_lock<mutex> guard(lock_);
+    CHECK(pending_batches_.empty());
+    shutdown_ = true;
+    queue_cv_.notify_all();
+  }
+
+  for (auto& worker_thread : worker_threads_) {
+    worker_thread.join();
+  }
+}
 
+void ThreadPool::processBatch(unique_ptr<WorkBatch> batch) {
   CHECK(!worker_threads_.empty());
 
   CHECK(!batch->canceled);
   CHECK(batch->work_left == 0);
-  batch->work_left = batch->work_items.size();
-  CHECK(batch->work_left > 0);
+  const size_t size = batch->work_items.size();
+  CHECK(size > 0);
 
-  if (work_items_.empty())
-    queue_cv_.notify_all();
-
-  // push all work items from the batch
-  for (auto& work_item : batch->work_items) {
+  for (const auto& work_item : batch->work_items) {
     CHECK(work_item->batch() == batch.get());
-    work_items_.push_back(std::move(work_item));
   }
-  batch->work_items.clear();
+
+  // one slice per worker thread (the work items are still owned by the batch)
+  batch->work_left = size;
+  batch->slices_count = int(min(size, workers_.size()));
+  batch->next_slice = 0;
+
+  unique_lock<mutex> guard(lock_);
+
+  pending_batches_.push_back(batch.get());
+  pending_slices_ += batch->slices_count;
+  queue_cv_.notify_all();
 
   // wait for the completition of all work items in the batch
   while (batch->work_left > 0)
@@ -70,8 +90,8 @@ void ThreadPool::processBatch(unique_ptr<WorkBatch> batch) {
     throw CanceledException();
 }
 
-void ThreadPool::executeOneItem() {
-  auto work_item = acquireWork();
+void ThreadPool::executeOneItem(WorkItem* work_item) {
+  WorkBatch* batch = work_item->batch();
 
   try {
     if (controller_ != nullptr)
@@ -79,33 +99,112 @@ void ThreadPool::executeOneItem() {
 
     work_item->execute();
   } catch (const CanceledException&) {
-    work_item->batch()->canceled = true;
+    batch->canceled = true;
+  }
+
+  finishedWork(batch);
+}
+
+WorkItem* ThreadPool::acquireWork(int worker_index) {
+  // number of stealing rounds before an idle worker goes to sleep
+  constexpr int kStealAttempts = 64;
+
+  auto& deque = workers_[worker_index]->deque;
+
+  for (;;) {
+    // 1. local work
+    if (auto work_item = deque.pop())
+      return work_item;
+
+    // 2. new work (claim a slice from a pending batch)
+    if (pending_slices_ > 0 && claimSlice(worker_index))
+      continue;
+
+    // 3. steal work from the other workers
+    for (int i = 0; i < kStealAttempts && pending_slices_ == 0; ++i) {
+      if (auto work_item = stealWork(worker_index))
+        return work_item;
+      this_thread::yield();
+    }
+
+    // 4. nothing to do, wait for a new batch
+    if (pending_slices_ == 0 && !waitForWork())
+      return nullptr;
+  }
+}
+
+bool ThreadPool::claimSlice(int worker_index) {
+  WorkBatch* batch = nullptr;
+  size_t begin_index = 0;
+  size_t end_index = 0;
+
+  {
+    unique_lock<mutex> guard(lock_);
+    if (pending_batches_.empty())
+      return false;
+
+    batch = pending_batches_.front();
+    const int slice = batch->next_slice++;
+    CHECK(slice < batch->slices_count);
+    if (batch->next_slice == batch->slices_count)
+      pending_batches_.erase(pending_batches_.begin());
+    --pending_slices_;
+
+    const size_t size = batch->work_items.size();
+    begin_index = size * slice / batch->slices_count;
+    end_index = size * (slice + 1) / batch->slices_count;
   }
 
-  finishedWork(work_item->batch());
+  CHECK(begin_index < end_index);
+
+  // push in reverse order, so the owner pops the work items in the
+  // original order while thieves steal from the end of the slice
+  //
+  // NOTE: the batch must not be accessed after the last push, since the
+  //   work items may be completed (and the batch released) at any point after that
+  //
+  auto& deque = workers_[worker_index]->deque;
+  for (size_t i = end_index; i-- > begin_index;) {
+    deque.push(batch->work_items[i].get());
+  }
+
+  return true;
+}
+
+WorkItem* ThreadPool::stealWork(int worker_index) {
+  const int workers_count = int(workers_.size());
+  for (int i = 1; i < workers_count; ++i) {
+    const int victim_index = (worker_index + i) % workers_count;
+    if (auto work_item = workers_[victim_index]->deque.steal())
+      return work_item;
+  }
+  return nullptr;
 }
 
-unique_ptr<WorkItem> ThreadPool::acquireWork() {
+bool ThreadPool::waitForWork() {
   unique_lock<mutex> guard(lock_);
-  while (work_items_.empty())
+  while (pending_slices_ == 0 && !shutdown_)
     queue_cv_.wait(guard);
-  auto work_item = std::move(work_items_.back());
-  work_items_.pop_back();
-  return work_item;
+  return !shutdown_;
 }
 
 void ThreadPool::finishedWork(WorkBatch* batch) {
   CHECK(batch != nullptr);
 
-  unique_lock<mutex> guard(lock_);
-  CHECK(batch->work_left > 0);
-  if (--batch->work_left == 0)
+  const size_t prev_work_left = batch->work_left.fetch_sub(1);
+  CHECK(prev_work_left > 0);
+
+  // the last work item in the batch? (the lock is required to
+  // avoid a lost wakeup in processBatch())
+  if (prev_work_left == 1) {
+    unique_lock<mutex> guard(lock_);
     results_cv_.notify_all();
+  }
 }
 
-void ThreadPool::workerThread() {
-  for (;;) {
-    executeOneItem();
+void ThreadPool::workerThread(int worker_index) {
+  while (auto work_item = acquireWork(worker_index)) {
+    executeOneItem(work_item);
   }
 }
 
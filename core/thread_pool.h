@@ -15,6 +15,7 @@
 #pragma once
 
 #include "utils.h"
+#include "work_stealing_deque.h"
 
 #include <assert.h>
 #include <algorithm>
@@ -22,7 +23,6 @@
 #include <condition_variable>
 #include <cstdint>
 #include <cstdlib>
-#include <deque>
 #include <functional>
 #include <memory>
 #include <mutex>
@@ -82,8 +82,15 @@ struct WorkBatch {
   //! The set of work items to be processed
   vector<unique_ptr<WorkItem>> work_items;
 
-  //! Used by the work queue to track the progress
-  size_t work_left = 0;
+  //! Used by the thread pool to track the progress
+  atomic<size_t> work_left = 0;
+
+  //! Number of slices the work items are split into (set by the thread pool)
+  //! \sa ThreadPool
+  int slices_count = 0;
+
+  //! The next unclaimed slice (guarded by the thread pool lock)
+  int next_slice = 0;
 
   //! Cancellation support
   atomic<bool> canceled = false;
@@ -119,6 +126,13 @@ class Controller {
 };
 
 //! A basic thread pool (managing a fixed number of threads)
+//!
+//! Each worker thread owns a work-stealing deque (WorkStealingDeque). A new
+//! WorkBatch is split into contiguous slices (one per worker), and the slices
+//! are claimed by the worker threads, which push the work items to their own deque.
+//! Idle workers steal from the other deques, so the steady-state scheduling
+//! is lock-free: the pool lock is only taken to claim a slice, to put
+//! a worker to sleep and to signal the completion of a batch.
 //! 
 //! \sa WorkItem
 //! \sa WorkBatch
@@ -137,6 +151,10 @@ class ThreadPool : public core::NonCopyable {
   //! 
   ThreadPool(int threads_count, Controller* controller = nullptr);
 
+  //! Stops and joins the worker threads
+  //! \note There must be no pending batches
+  ~ThreadPool();
+
   //! Queues the work items in the specified batch and waits for completition
   //! \sa WorkBatch
   void processBatch(unique_ptr<WorkBatch> batch);
@@ -145,16 +163,32 @@ class ThreadPool : public core::NonCopyable {
   int threadsCount() const { return int(worker_threads_.size()); }
 
  private:
-  void executeOneItem();
-  unique_ptr<WorkItem> acquireWork();
+  struct Worker {
+    WorkStealingDeque<WorkItem> deque;
+  };
+
+ private:
+  void executeOneItem(WorkItem* work_item);
+  WorkItem* acquireWork(int worker_index);
+  bool claimSlice(int worker_index);
+  WorkItem* stealWork(int worker_index);
+  bool waitForWork();
   void finishedWork(WorkBatch* batch);
-  void workerThread();
+  void workerThread(int worker_index);
 
  private:
-  deque<unique_ptr<WorkItem>> work_items_;
+  vector<unique_ptr<Worker>> workers_;
   vector<thread> worker_threads_;
   Controller* controller_ = nullptr;
 
+  // the batches with unclaimed slices (guarded by lock_)
+  vector<WorkBatch*> pending_batches_;
+
+  // total number of unclaimed slices, used as a lock-free hint
+  atomic<int> pending_slices_ = 0;
+
+  bool shutdown_ = false;
+
   mutable mutex lock_;
   mutable condition_variable queue_cv_;
   mutable condition_variable results_cv_;
@@ -169,6 +203,12 @@ class ParallelForSupport {
 
   static ThreadPool* threadPool() { return thread_pool_; }
 
+  // replaces the thread pool, returning the previous one
+  // (intended for tests which compare runs using different numbers of threads)
+  static unique_ptr<ThreadPool> replaceThreadPool(unique_ptr<ThreadPool> thread_pool) {
+    return unique_ptr<ThreadPool>(thread_pool_.exchange(thread_pool.release()));
+  }
+
  private:
   static atomic<ThreadPool*> thread_pool_;
 };
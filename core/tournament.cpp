@@ -0,0 +1,98 @@
+// Copyright 2019 The Darwin Neuroevolution Framework Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tournament.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+using namespace std;
+
+namespace tournament {
+
+namespace {
+
+using BrainsMap = unordered_map<const darwin::Genotype*, unique_ptr<darwin::Brain>>;
+
+// the brain caches of all the live threads, so newTournament()
+// can release the brains right away (instead of waiting for each thread
+// to use its cache again)
+class CacheRegistry {
+ public:
+  static CacheRegistry* instance() {
+    static CacheRegistry registry;
+    return &registry;
+  }
+
+  void add(BrainsMap* brains) {
+    unique_lock<mutex> guard(lock_);
+    caches_.push_back(brains);
+  }
+
+  void remove(BrainsMap* brains) {
+    unique_lock<mutex> guard(lock_);
+    caches_.erase(std::remove(caches_.begin(), caches_.end(), brains), caches_.end());
+  }
+
+  void clearAll() {
+    unique_lock<mutex> guard(lock_);
+    for (auto brains : caches_)
+      brains->clear();
+  }
+
+ private:
+  mutex lock_;
+  vector<BrainsMap*> caches_;
+};
+
+struct ThreadCache {
+  // the registry is created first, so it outlives the thread caches
+  CacheRegistry* const registry = CacheRegistry::instance();
+  BrainsMap brains;
+
+  ThreadCache() { registry->add(&brains); }
+  ~ThreadCache() { registry->remove(&brains); }
+};
+
+}  // namespace
+
+void BrainCache::newTournament() {
+  CacheRegistry::instance()->clearAll();
+}
+
+darwin::Brain* BrainCache::brain(const darwin::Genotype* genotype) {
+  static thread_local ThreadCache cache;
+  static thread_local const darwin::Genotype* last_genotype = nullptr;
+
+  auto& brains = cache.brains;
+  auto it = brains.find(genotype);
+  if (it == brains.end()) {
+    // keep only the most recently returned brain (which may be in use by the
+    // other player in the current game)
+    if (brains.size() >= kMaxBrains) {
+      auto last = brains.extract(last_genotype);
+      brains.clear();
+      if (!last.empty())
+        brains.insert(std::move(last));
+    }
+    it = brains.emplace(genotype, genotype->grow()).first;
+  }
+
+  last_genotype = genotype;
+  return it->second.get();
+}
+
+}  // namespace tournament
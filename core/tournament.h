@@ -49,6 +49,36 @@ class GameRules : public core::NonCopyable {
   virtual Scores scores(GameOutcome outcome) const = 0;
 };
 
+//! A per-thread cache of the brains grown from the tournament genotypes
+//!
+//! Each genotype plays many games during a tournament, so instead of growing new
+//! brains for every game, the GameRules implementations can use the cached brains
+//! (the players are expected to call Brain::resetState() before each game)
+//!
+//! The brains are owned by the calling thread, so the two players in a game must be
+//! grown from different genotypes
+//!
+//! Each thread caches at most kMaxBrains brains. When the limit is reached, all
+//! the cached brains except the most recently returned one are released, so the
+//! brains for the two players in a game are always valid at the same time.
+//!
+//! \note The cached brains are only valid until the next newTournament() call
+//!   (which is done by the Tournament implementations)
+//!
+class BrainCache {
+ public:
+  //! The maximum number of cached brains per thread
+  static constexpr size_t kMaxBrains = 512;
+
+ public:
+  //! Releases the cached brains, for all the threads
+  //! \note Must not be called concurrently with brain()
+  static void newTournament();
+
+  //! Returns the calling thread's brain for the genotype (growing it if needed)
+  static darwin::Brain* brain(const darwin::Genotype* genotype);
+};
+
 //! Tournament interface
 class Tournament : public core::NonCopyable {
  public:
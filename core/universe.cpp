@@ -16,13 +16,18 @@
 #include "format.h"
 #include "logging.h"
 
+#include <algorithm>
 #include <optional>
+#include <utility>
 using namespace std;
 
 namespace darwin {
 
 constexpr int32_t kSqlApplicationId = 0x47414e4e;
-constexpr int32_t kSqlFormatVersion = 1;
+constexpr int32_t kSqlFormatVersion = 3;
+
+// the generation writer and the main connection may wait for each other's commits
+constexpr int kBusyWaitMs = 5000;
 
 unique_ptr<Universe> Universe::create(const string& path) {
   core::log("Creating new universe: '%s'...\n", path.c_str());
@@ -37,7 +42,9 @@ unique_ptr<Universe> Universe::open(const string& path) {
 
 // open an existing universe (or throws)
 Universe::Universe(const string& path)
-    : path_(path), db_(path, db::OpenMode::ExistingDatabase) {
+    : path_(path),
+      db_(path, db::OpenMode::ExistingDatabase, kBusyWaitMs),
+      writer_db_(path, db::OpenMode::ExistingDatabase, kBusyWaitMs) {
   if (db_.exec<int>("pragma application_id").singleValue() != kSqlApplicationId)
     throw core::Exception("Invalid universe database (application id)");
 
@@ -45,6 +52,33 @@ Universe::Universe(const string& path)
     throw core::Exception("Incompatible universe format");
 
   db_.exec("pragma quick_check");
+
+  setupConnection(db_);
+  setupConnection(writer_db_);
+
+  writer_thread_ = std::thread(&Universe::generationWriterThread, this);
+}
+
+Universe::~Universe() {
+  {
+    unique_lock<mutex> guard(writer_lock_);
+    writer_shutdown_ = true;
+    writer_cv_.notify_all();
+  }
+  writer_thread_.join();
+
+  if (writer_error_.has_value())
+    core::log("Failed to save the last generations: %s\n", writer_error_->c_str());
+}
+
+// WAL mode allows the readers to proceed while the generation writer is committing,
+// and with WAL a commit needs a single fsync (synchronous = normal defers it
+// to the checkpoints, while still protecting the database integrity)
+void Universe::setupConnection(db::Connection& db) {
+  if (db.exec<string>("pragma journal_mode = wal").singleValue() != "wal")
+    core::log("WAL journal mode is not available\n");
+  db.exec("pragma synchronous = normal");
+  db.exec("pragma temp_store = memory");
 }
 
 void Universe::initializeUniverse(const string& path) {
@@ -91,9 +125,19 @@ void Universe::initializeUniverse(const string& path) {
     generation int,
     summary text,
     details text,
-    genotypes text,
+    population_trace blob,
+    champion_id int,
     profile text))");
 
+  // the champion genotypes, deduplicated per trace (by content hash)
+  new_db.exec(R"(create table Champion(
+    id integer primary key,
+    trace_id int,
+    hash int,
+    genotype blob))");
+
+  new_db.exec("create index ChampionHash on Champion(trace_id, hash)");
+
   transaction.commit();
 }
 
@@ -219,9 +263,8 @@ bool Universe::findExperiment(const string& name) const {
   return !db_.exec("select null from Experiment where name = ?", name).empty();
 }
 
-// TODO: consider using an incremental iterator
 vector<DbExperiment> Universe::experimentsList() const {
-  auto results = db_.exec<db::RowId, string, int64_t, string, string, db::RowId, int64_t>(
+  auto query = db_.query<db::RowId, string, int64_t, string, string, db::RowId, int64_t>(
       R"(select
           id,
           comment,
@@ -234,7 +277,7 @@ vector<DbExperiment> Universe::experimentsList() const {
 
   vector<DbExperiment> experiments;
   for (const auto& [id, comment, timestamp, name, setup, last_variation_id,
-                    last_activity_timestamp] : results) {
+                    last_activity_timestamp] : query) {
     DbExperiment db_experiment;
     db_experiment.id = id.value();
     db_experiment.comment = comment;
@@ -354,26 +397,242 @@ unique_ptr<DbEvolutionTrace> Universe::newTrace(db::RowId variation_id,
   return new_trace;
 }
 
-void Universe::newGeneration(const DbGeneration& db_generation) {
-  unique_lock<mutex> guard(db_insert_lock_);
+void Universe::newGeneration(DbGeneration db_generation) {
+  db_generation.timestamp = time(nullptr);
 
-  db_.exec(
-      R"(insert into Generation(
-          timestamp,
-          trace_id,
-          generation,
-          summary,
-          details,
-          genotypes,
-          profile)
-        values(?, ?, ?, ?, ?, ?, ?))",
-      int64_t(time(nullptr)),
+  unique_lock<mutex> guard(writer_lock_);
+  checkWriterError();
+
+  // bounded queue: wait for the writer to catch up if needed
+  while (int(queued_generations_.size()) >= writer_config_.queue_capacity)
+    committed_cv_.wait(guard);
+
+  queued_generations_.push_back({ std::move(db_generation), Clock::now() });
+  ++queued_count_;
+
+  if (int(queued_generations_.size()) >= writer_config_.max_rows ||
+      queued_generations_.size() == 1) {
+    writer_cv_.notify_all();
+  }
+}
+
+void Universe::flush() {
+  unique_lock<mutex> guard(writer_lock_);
+
+  const auto target_count = queued_count_;
+  if (committed_count_ < target_count) {
+    ++flush_requests_;
+    writer_cv_.notify_all();
+    while (committed_count_ < target_count)
+      committed_cv_.wait(guard);
+    --flush_requests_;
+  }
+
+  checkWriterError();
+}
+
+void Universe::setGenerationWriterConfig(const GenerationWriterConfig& config) {
+  CHECK(config.max_rows > 0);
+  CHECK(config.max_latency_ms >= 0);
+  CHECK(config.queue_capacity >= config.max_rows);
+
+  unique_lock<mutex> guard(writer_lock_);
+  writer_config_ = config;
+  writer_cv_.notify_all();
+}
+
+// reports (and clears) the last generation writer error
+// (must be called with the writer_lock_ held)
+void Universe::checkWriterError() {
+  if (writer_error_.has_value()) {
+    const auto error = std::move(*writer_error_);
+    writer_error_.reset();
+    throw core::Exception("Failed to save generations: %s", error.c_str());
+  }
+}
+
+void Universe::generationWriterThread() {
+  vector<DbGeneration> batch;
+
+  for (;;) {
+    {
+      unique_lock<mutex> guard(writer_lock_);
+
+      // wait for a full batch, the oldest queued generation to reach the
+      // max latency, a flush request or the shutdown (which drains the queue)
+      for (;;) {
+        if (queued_generations_.empty()) {
+          if (writer_shutdown_)
+            return;
+          writer_cv_.wait(guard);
+          continue;
+        }
+
+        if (int(queued_generations_.size()) >= writer_config_.max_rows ||
+            flush_requests_ > 0 || writer_shutdown_) {
+          break;
+        }
+
+        const auto deadline = queued_generations_.front().timestamp +
+                              chrono::milliseconds(writer_config_.max_latency_ms);
+        if (Clock::now() >= deadline)
+          break;
+        writer_cv_.wait_until(guard, deadline);
+      }
+
+      const size_t batch_size =
+          min(queued_generations_.size(), size_t(writer_config_.max_rows));
+      for (size_t i = 0; i < batch_size; ++i) {
+        batch.push_back(std::move(queued_generations_.front().db_generation));
+        queued_generations_.pop_front();
+      }
+    }
+
+    optional<string> error;
+    try {
+      commitGenerations(batch);
+    } catch (const std::exception& e) {
+      core::log("Failed to save %d generations: %s\n", int(batch.size()), e.what());
+      error = e.what();
+      // the transaction was rolled back, including any new Champion records
+      last_champion_.reset();
+    }
+
+    {
+      unique_lock<mutex> guard(writer_lock_);
+      committed_count_ += batch.size();
+      if (error.has_value())
+        writer_error_ = std::move(error);
+      committed_cv_.notify_all();
+    }
+
+    batch.clear();
+  }
+}
+
+// runs on the generation writer thread
+void Universe::commitGenerations(const vector<DbGeneration>& db_generations) {
+  db::TransactionScope transaction(writer_db_, db::TransactionOption::Immediate);
+
+  for (const auto& db_generation : db_generations) {
+    optional<db::RowId> champion_id;
+    if (db_generation.champion_hash.has_value()) {
+      champion_id = commitChampion(db_generation);
+    } else {
+      CHECK(!db_generation.champion_genotype);
+    }
+
+    writer_db_.exec(
+        R"(insert into Generation(
+            timestamp,
+            trace_id,
+            generation,
+            summary,
+            details,
+            population_trace,
+            champion_id,
+            profile)
+          values(?, ?, ?, ?, ?, ?, ?, ?))",
+        int64_t(db_generation.timestamp),
+        db_generation.trace_id,
+        db_generation.generation,
+        db_generation.summary,
+        db_generation.details,
+        db_generation.population_trace,
+        champion_id,
+        db_generation.profile);
+  }
+
+  transaction.commit();
+}
+
+// returns the Champion record referenced by the generation, saving it if needed
+// (the champion genotype may have been part of a failed batch, so the writer
+// can't rely on it being already saved just because it was queued before)
+//
+// runs on the generation writer thread
+db::RowId Universe::commitChampion(const DbGeneration& db_generation) {
+  const auto& genotype = db_generation.champion_genotype;
+  if (genotype && last_champion_ && last_champion_->genotype == genotype &&
+      last_champion_->trace_id == db_generation.trace_id) {
+    return last_champion_->champion_id;
+  }
+
+  // the content hash only narrows down the candidates, the genotypes
+  // must match too (in case of hash collisions)
+  const auto candidates = writer_db_.exec<db::RowId, db::Blob>(
+      "select id, genotype from Champion where trace_id = ? and hash = ?",
       db_generation.trace_id,
-      db_generation.generation,
-      db_generation.summary,
-      db_generation.details,
-      db_generation.genotypes,
-      db_generation.profile);
+      int64_t(*db_generation.champion_hash));
+
+  optional<db::RowId> champion_id;
+  if (!genotype) {
+    if (candidates.empty())
+      throw core::Exception("Missing champion genotype (generation %d)",
+                            db_generation.generation);
+    if (candidates.size() > 1)
+      throw core::Exception("Ambiguous champion hash (generation %d)",
+                            db_generation.generation);
+    return get<0>(candidates[0]).value();
+  }
+
+  for (const auto& [id, stored_genotype] : candidates) {
+    if (stored_genotype == *genotype) {
+      champion_id = id;
+      break;
+    }
+  }
+
+  if (!champion_id.has_value()) {
+    writer_db_.exec(
+        R"(insert into Champion(
+            trace_id,
+            hash,
+            genotype)
+          values(?, ?, ?))",
+        db_generation.trace_id,
+        int64_t(*db_generation.champion_hash),
+        *genotype);
+    champion_id = writer_db_.lastInsertRowId();
+  }
+
+  last_champion_ = CommittedChampion{ db_generation.trace_id, genotype, *champion_id };
+  return *champion_id;
+}
+
+optional<db::Blob> Universe::loadChampion(db::RowId trace_id, int generation) const {
+  auto results = db_.exec<db::Blob>(
+      R"(select
+          champion.genotype
+        from generation
+          join champion on champion.id = generation.champion_id
+        where generation.trace_id = ? and generation.generation = ?)",
+      trace_id,
+      generation);
+
+  CHECK(results.size() <= 1);
+  return results.empty() ? nullopt : results.singleValue();
+}
+
+optional<PopulationTrace> Universe::loadPopulationTrace(db::RowId trace_id,
+                                                       int generation) const {
+  auto results = db_.exec<db::Blob>(
+      R"(select
+          population_trace
+        from generation
+        where trace_id = ? and generation = ?)",
+      trace_id,
+      generation);
+
+  CHECK(results.size() <= 1);
+  if (results.empty() || !results.singleValue().has_value())
+    return nullopt;
+
+  core::BinaryReader reader(*results.singleValue());
+  auto population_trace = reader.read<PopulationTrace>();
+  if (!reader.atEnd())
+    throw core::Exception("Invalid population trace (unexpected trailing data)");
+  return population_trace;
 }
 
 string Universe::strftime(time_t timestamp, const string& format) const {
@@ -16,16 +16,20 @@
 
 #include "utils.h"
 #include "database.h"
+#include "population_trace.h"
 #include "properties.h"
 #include "stringify.h"
 
 #include <time.h>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
 #include <mutex>
 #include <optional>
+#include <thread>
 using namespace std;
 
-// TODO: test cases
-
 namespace darwin {
 
 //! Base class for all the universe database objects
@@ -99,17 +103,47 @@ struct DbGeneration : public DbUniverseObject {
   
   //! Extra details (json)
   optional<string> details;
+
+  //! The full fitness and genealogy traces (binary, see PopulationTrace)
+  optional<db::Blob> population_trace;
   
-  //! Notable genotypes (json)
-  optional<string> genotypes;
+  //! Content hash of the champion genotype (see Genotype::contentHash())
+  optional<uint64_t> champion_hash;
+
+  //! The champion genotype (binary, see Genotype::saveBinary())
+  //!
+  //! \note The champions are saved only once per trace: if the trace already has
+  //!   a Champion record with the same champion_hash and the same genotype, the
+  //!   generation references it (the champion genotype is required only if there's
+  //!   no such record). The consecutive generations with the same champion are
+  //!   expected to share the genotype blob.
+  //!
+  shared_ptr<const db::Blob> champion_genotype;
   
   //! Runtime profile data (json)
   optional<string> profile;
 };
 
+//! Settings for the asynchronous generation writer
+//! \sa Universe::newGeneration()
+struct GenerationWriterConfig {
+  //! Max number of generations committed in a single transaction
+  int max_rows = 64;
+
+  //! Max time (in milliseconds) a queued generation waits to be committed
+  int max_latency_ms = 1000;
+
+  //! Max number of queued generations (Universe::newGeneration() blocks if the
+  //! queue is full)
+  int queue_capacity = 256;
+};
+
 //! The persistent storage for all the experiments and variations
 class Universe : public core::NonCopyable {
  public:
+  //! Drains the queued generations and stops the generation writer
+  ~Universe();
+
   //! Creates a new universe database
   static unique_ptr<Universe> create(const string& path);
   
@@ -144,8 +178,32 @@ class Universe : public core::NonCopyable {
   unique_ptr<DbEvolutionTrace> newTrace(db::RowId variation_id,
                                         const string& evolution_config);
 
-  //! Creates a new generation record
-  void newGeneration(const DbGeneration& db_generation);
+  //! Queues a new generation record
+  //!
+  //! The generations are written asynchronously, batching multiple rows into
+  //! one transaction (see GenerationWriterConfig)
+  //!
+  //! \throws core::Exception if a previous generation batch could not be saved
+  //!   (the error is reported only once, and the failed batch is discarded)
+  //! \sa flush()
+  //!
+  void newGeneration(DbGeneration db_generation);
+
+  //! Blocks until all the queued generations are committed
+  //! \throws core::Exception if the queued generations could not be saved
+  void flush();
+
+  //! Updates the generation writer settings
+  void setGenerationWriterConfig(const GenerationWriterConfig& config);
+
+  //! Loads the champion genotype (binary) of the specified generation
+  //! \note Only the committed generations are visible (see flush())
+  optional<db::Blob> loadChampion(db::RowId trace_id, int generation) const;
+
+  //! Loads the full fitness and genealogy traces of the specified generation
+  //! \note Only the committed generations are visible (see flush())
+  //! \throws core::Exception if the saved population trace is invalid
+  optional<PopulationTrace> loadPopulationTrace(db::RowId trace_id, int generation) const;
 
   // yeah, doesn't really belong here, but the standard C++ library
   // support for formatting date/time is still broken (not thread safe)
@@ -156,6 +214,13 @@ class Universe : public core::NonCopyable {
 
   static void initializeUniverse(const string& path);
 
+  static void setupConnection(db::Connection& db);
+
+  void generationWriterThread();
+  void commitGenerations(const vector<DbGeneration>& db_generations);
+  db::RowId commitChampion(const DbGeneration& db_generation);
+  void checkWriterError();
+
   db::RowId createVariationHelper(db::RowId experiment_id,
                                   const optional<db::RowId> prev_variation_id,
                                   const string& config);
@@ -169,6 +234,50 @@ class Universe : public core::NonCopyable {
 
   // guards all inserts in order to reliably get the last inserted RowId
   mutex db_insert_lock_;
+
+  using Clock = chrono::steady_clock;
+
+  struct QueuedGeneration {
+    DbGeneration db_generation;
+    Clock::time_point timestamp;
+  };
+
+  // the generations are committed in batches, on a dedicated
+  // thread and through a separate database connection
+  db::Connection writer_db_;
+  std::thread writer_thread_;
+
+  // guards the generation writer state (below)
+  mutex writer_lock_;
+
+  // wakes up the writer thread (new generations, flush or shutdown requests)
+  condition_variable writer_cv_;
+
+  // signals the progress of the writer thread (committed generations)
+  condition_variable committed_cv_;
+
+  GenerationWriterConfig writer_config_;
+  deque<QueuedGeneration> queued_generations_;
+
+  // total number of queued and committed (or failed) generations
+  uint64_t queued_count_ = 0;
+  uint64_t committed_count_ = 0;
+
+  int flush_requests_ = 0;
+  bool writer_shutdown_ = false;
+
+  // the last generation writer error, if any
+  optional<string> writer_error_;
+
+  // the last champion referenced by a committed generation
+  // (only accessed from the writer thread, it's used to avoid looking up and
+  // comparing the stored genotype blob for each generation with the same champion)
+  struct CommittedChampion {
+    db::RowId trace_id = 0;
+    shared_ptr<const db::Blob> genotype;
+    db::RowId champion_id = 0;
+  };
+  optional<CommittedChampion> last_champion_;
 };
 
 }  // namespace darwin
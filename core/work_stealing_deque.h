@@ -0,0 +1,158 @@
+// Copyright 2019 The Darwin Neuroevolution Framework Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "utils.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+using namespace std;
+
+namespace pp {
+
+//! A lock-free, Chase-Lev style work-stealing deque of pointers
+//!
+//! The owner thread pushes and pops items at the bottom end (LIFO), while any
+//! other thread may concurrently steal items from the top end (FIFO).
+//!
+//! The memory ordering follows "Correct and Efficient Work-Stealing for
+//! Weak Memory Models" (Lê, Pop, Cohen, Zappa Nardelli - PPoPP 2013)
+//!
+//! \note The deque doesn't own the items, it only stores raw pointers
+//!
+template <class T>
+class WorkStealingDeque : public core::NonCopyable {
+  struct Buffer {
+    const int64_t capacity;
+    const int64_t mask;
+    unique_ptr<atomic<T*>[]> items;
+
+    explicit Buffer(int64_t capacity)
+        : capacity(capacity), mask(capacity - 1), items(new atomic<T*>[capacity]) {
+      CHECK(capacity > 0 && (capacity & mask) == 0, "capacity must be a power of 2");
+    }
+
+    T* get(int64_t index) const { return items[index & mask].load(memory_order_relaxed); }
+
+    void put(int64_t index, T* item) {
+      items[index & mask].store(item, memory_order_relaxed);
+    }
+  };
+
+ public:
+  //! Creates an empty deque (the initial capacity must be a power of 2)
+  explicit WorkStealingDeque(int64_t initial_capacity = 256) {
+    buffers_.push_back(make_unique<Buffer>(initial_capacity));
+    buffer_ = buffers_.back().get();
+  }
+
+  //! Pushes a new item at the bottom end
+  //! \note Must be called only from the owner thread
+  void push(T* item) {
+    const int64_t bottom = bottom_.load(memory_order_relaxed);
+    const int64_t top = top_.load(memory_order_acquire);
+    Buffer* buffer = buffer_.load(memory_order_relaxed);
+    if (bottom - top > buffer->capacity - 1)
+      buffer = grow(buffer, bottom, top);
+    buffer->put(bottom, item);
+    atomic_thread_fence(memory_order_release);
+    bottom_.store(bottom + 1, memory_order_relaxed);
+  }
+
+  //! Pops an item from the bottom end
+  //! \returns The popped item, or nullptr if the deque is empty
+  //! \note Must be called only from the owner thread
+  T* pop() {
+    const int64_t bottom = bottom_.load(memory_order_relaxed) - 1;
+    Buffer* buffer = buffer_.load(memory_order_relaxed);
+    bottom_.store(bottom, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t top = top_.load(memory_order_relaxed);
+
+    T* item = nullptr;
+    if (top <= bottom) {
+      item = buffer->get(bottom);
+      if (top == bottom) {
+        // last item, race against the thieves
+        if (!top_.compare_exchange_strong(
+                top, top + 1, memory_order_seq_cst, memory_order_relaxed)) {
+          item = nullptr;
+        }
+        bottom_.store(bottom + 1, memory_order_relaxed);
+      }
+    } else {
+      bottom_.store(bottom + 1, memory_order_relaxed);
+    }
+    return item;
+  }
+
+  //! Attempts to steal an item from the top end
+  //! \returns The stolen item, or nullptr if the deque is empty
+  //!   (or another thread won the race for the top item)
+  //! \note Safe to call from any thread
+  T* steal() {
+    int64_t top = top_.load(memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    const int64_t bottom = bottom_.load(memory_order_acquire);
+
+    if (top < bottom) {
+      Buffer* buffer = buffer_.load(memory_order_acquire);
+      T* item = buffer->get(top);
+      if (!top_.compare_exchange_strong(
+              top, top + 1, memory_order_seq_cst, memory_order_relaxed)) {
+        return nullptr;
+      }
+      return item;
+    }
+    return nullptr;
+  }
+
+  //! A racy emptiness check (only a hint if called from a non-owner thread)
+  bool empty() const {
+    const int64_t bottom = bottom_.load(memory_order_relaxed);
+    const int64_t top = top_.load(memory_order_relaxed);
+    return bottom <= top;
+  }
+
+ private:
+  // doubles the buffer capacity (called only from the owner thread)
+  //
+  // the old buffers are retired, not released, since concurrent thieves
+  // may still read from them. they are freed with the deque
+  //
+  Buffer* grow(Buffer* old_buffer, int64_t bottom, int64_t top) {
+    auto new_buffer = make_unique<Buffer>(old_buffer->capacity * 2);
+    for (int64_t i = top; i < bottom; ++i)
+      new_buffer->put(i, old_buffer->get(i));
+    buffers_.push_back(std::move(new_buffer));
+    Buffer* buffer = buffers_.back().get();
+    buffer_.store(buffer, memory_order_release);
+    return buffer;
+  }
+
+ private:
+  // top and bottom are updated by different threads,
+  // so keep them on separate cache lines
+  alignas(64) atomic<int64_t> top_ = 0;
+  alignas(64) atomic<int64_t> bottom_ = 0;
+  alignas(64) atomic<Buffer*> buffer_ = nullptr;
+
+  // all the allocated buffers (owner thread only)
+  vector<unique_ptr<Buffer>> buffers_;
+};
+
+}  // namespace pp
@@ -21,18 +21,11 @@ Agent::Agent(const darwin::Genotype* genotype, World* world)
     : world_(world), brain_(genotype->grow()) {}
 
 void Agent::simStep() {
-  const auto& config = world_->domain()->config();
-  
   // setup inputs
-  int input_index = 0;
-  if (config.input_pole_angle)
-    brain_->setInput(input_index++, world_->poleAngle());
-  if (config.input_angular_velocity)
-    brain_->setInput(input_index++, world_->poleAngularVelocity());
-  if (config.input_cart_distance)
-    brain_->setInput(input_index++, world_->cartDistance());
-  if (config.input_cart_velocity)
-    brain_->setInput(input_index++, world_->cartVelocity());
+  float input_values[kMaxInputs];
+  const int inputs_count = readInputs(world_, input_values);
+  for (int i = 0; i < inputs_count; ++i)
+    brain_->setInput(i, input_values[i]);
 
   brain_->think();
   
@@ -40,6 +33,25 @@ void Agent::simStep() {
   world_->moveCart(brain_->output(0));
 }
 
+int Agent::readInputs(const World* world, float* values) {
+  return readInputs(world->domain()->config(), world->state(), values);
+}
+
+int Agent::readInputs(const Config& config,
+                      const physics::CartPoleState& state,
+                      float* values) {
+  int input_index = 0;
+  if (config.input_pole_angle)
+    values[input_index++] = state.pole_angle[0];
+  if (config.input_angular_velocity)
+    values[input_index++] = state.pole_angular_velocity[0];
+  if (config.input_cart_distance)
+    values[input_index++] = state.cart_distance;
+  if (config.input_cart_velocity)
+    values[input_index++] = state.cart_velocity;
+  return input_index;
+}
+
 int Agent::inputs(const Config& config) {
   int inputs_count = 0;
   if (config.input_pole_angle)
@@ -20,8 +20,12 @@
 #include <core/parallel_for_each.h>
 #include <core/logging.h>
 #include <core/exception.h>
+#include <core/rng.h>
 
+#include <algorithm>
+#include <memory>
 #include <random>
+#include <vector>
 using namespace std;
 
 namespace cart_pole {
@@ -29,8 +33,11 @@ namespace cart_pole {
 CartPole::CartPole(const core::PropertySet& config) {
   config_.copyFrom(config);
   validateConfiguration();
+  physics_model_ = World::physicsModel(config_);
 }
 
+CartPole::~CartPole() = default;
+
 size_t CartPole::inputs() const {
   return Agent::inputs(config_);
 }
@@ -45,26 +52,90 @@ bool CartPole::evaluatePopulation(darwin::Population* population) const {
   const int generation = population->generation();
   core::log("\n. generation %d\n", generation);
 
+  const EvaluationMode mode = evaluationMode(population);
+
+  vector<bool> skipped(population->size(), false);
+  if (skipsInheritedFitness()) {
+    CHECK(mode != EvaluationMode::Batched);
+    for (size_t index = 0; index < skipped.size(); ++index)
+      skipped[index] = population->isFitnessInherited(index);
+  }
+
   // reset the fitness values
-  pp::for_each(*population,
-               [&](int, darwin::Genotype* genotype) { genotype->fitness = 0; });
+  pp::for_each(*population, [&](int index, darwin::Genotype* genotype) {
+    if (!skipped[index])
+      genotype->fitness = 0;
+  });
+
+  physics_validation_.reset();
+
+  vector<float> initial_angles(config_.test_worlds);
+  for (float& initial_angle : initial_angles)
+    initial_angle = randomInitialAngle();
 
-  // evaluate each genotype (over N worlds)
-  for (int world_index = 0; world_index < config_.test_worlds; ++world_index) {
+  switch (mode) {
+    case EvaluationMode::PerWorld:
+      evaluatePerWorld(population, skipped, initial_angles);
+      break;
+    case EvaluationMode::Batched:
+      evaluateBatched(population, initial_angles);
+      break;
+    case EvaluationMode::LockStepTestWorlds:
+      evaluateTestWorlds(population, skipped, initial_angles);
+      break;
+    case EvaluationMode::AnalyticGroups:
+      evaluateAnalyticGroups(population, skipped, initial_angles);
+      break;
+  }
+
+  logPhysicsValidation();
+  core::log("\n");
+  return false;
+}
+
+// without a random initial angle the episodes are deterministic,
+// so the genotypes which inherited their fitness value can be skipped
+// (except for the batched evaluation, which simulates ranges of genotypes)
+bool CartPole::skipsInheritedFitness() const {
+  return config_.max_initial_angle == 0 && config_.batch_size == 0;
+}
+
+CartPole::EvaluationMode CartPole::evaluationMode(
+    const darwin::Population* population) const {
+  // the physics validation checks each Box2D step against the analytic engine,
+  // so it always uses the plain per-world evaluation
+  if (config_.physics == physics::Engine::Validate)
+    return EvaluationMode::PerWorld;
+  if (config_.batch_size > 0 && population->supportsBatch())
+    return EvaluationMode::Batched;
+  if (config_.lock_step_test_worlds && population->genotype(0)->supportsBatch())
+    return EvaluationMode::LockStepTestWorlds;
+  if (config_.physics == physics::Engine::Analytic)
+    return EvaluationMode::AnalyticGroups;
+  return EvaluationMode::PerWorld;
+}
+
+void CartPole::evaluatePerWorld(darwin::Population* population,
+                                const vector<bool>& skipped,
+                                const vector<float>& initial_angles) const {
+  for (size_t world_index = 0; world_index < initial_angles.size(); ++world_index) {
     darwin::StageScope stage("Evaluate one world", population->size());
-    core::log(" ... world %d\n", world_index);
+    core::log(" ... world %zu\n", world_index);
 
-    const float initial_angle = randomInitialAngle();
+    pp::for_each(*population, [&](int index, darwin::Genotype* genotype) {
+      if (skipped[index]) {
+        darwin::ProgressManager::reportProgress();
+        return;
+      }
 
-    pp::for_each(*population, [&](int, darwin::Genotype* genotype) {
-      World world(initial_angle, this);
-      Agent agent(genotype, &world);
+      auto world = newWorld(initial_angles[world_index]);
+      Agent agent(genotype, world.get());
 
       // simulation loop
       int step = 0;
       for (; step < config_.max_steps; ++step) {
         agent.simStep();
-        if (!world.simStep())
+        if (!world->simStep())
           break;
       }
       CHECK(step > 0);
@@ -75,14 +146,216 @@ bool CartPole::evaluatePopulation(darwin::Population* population) const {
       darwin::ProgressManager::reportProgress();
     });
   }
+}
 
-  core::log("\n");
-  return false;
+void CartPole::evaluateBatched(darwin::Population* population,
+                               const vector<float>& initial_angles) const {
+  const size_t batch_size = size_t(config_.batch_size);
+  vector<int> batches((population->size() + batch_size - 1) / batch_size);
+
+  for (size_t world_index = 0; world_index < initial_angles.size(); ++world_index) {
+    darwin::StageScope stage("Evaluate one world", population->size());
+    core::log(" ... world %zu (batched)\n", world_index);
+
+    pp::for_each(batches, [&](int batch_index, int) {
+      const size_t first_index = batch_index * batch_size;
+      const size_t count = min(batch_size, population->size() - first_index);
+
+      auto brain = population->growBatch(first_index, count);
+      CHECK(brain);
+      CHECK(brain->size() == count);
+
+      const vector<float> lanes_initial_angles(count, initial_angles[world_index]);
+      const auto steps = simulateLockStep(brain.get(), lanes_initial_angles);
+
+      // the fitness is the average number of steps over all test worlds
+      for (size_t i = 0; i < count; ++i) {
+        auto genotype = population->genotype(first_index + i);
+        genotype->fitness += float(steps[i]) / config_.test_worlds;
+      }
+
+      darwin::ProgressManager::reportProgress(count);
+    });
+  }
+}
+
+void CartPole::evaluateTestWorlds(darwin::Population* population,
+                                  const vector<bool>& skipped,
+                                  const vector<float>& initial_angles) const {
+  darwin::StageScope stage("Evaluate test worlds", population->size());
+  core::log(" ... %zu test worlds (in lock-step)\n", initial_angles.size());
+
+  pp::for_each(*population, [&](int index, darwin::Genotype* genotype) {
+    if (!skipped[index]) {
+      auto brain = genotype->growBatch(initial_angles.size());
+      CHECK(brain);
+      CHECK(brain->size() == initial_angles.size());
+
+      // the fitness is the average number of steps over all test worlds
+      for (int steps : simulateLockStep(brain.get(), initial_angles))
+        genotype->fitness += float(steps) / config_.test_worlds;
+    }
+    darwin::ProgressManager::reportProgress();
+  });
+}
+
+void CartPole::evaluateAnalyticGroups(darwin::Population* population,
+                                      const vector<bool>& skipped,
+                                      const vector<float>& initial_angles) const {
+  constexpr size_t kGroupSize = physics::CartPoleBatch::kLanes;
+  vector<int> groups((population->size() + kGroupSize - 1) / kGroupSize);
+
+  for (size_t world_index = 0; world_index < initial_angles.size(); ++world_index) {
+    darwin::StageScope stage("Evaluate one world", population->size());
+    core::log(" ... world %zu\n", world_index);
+
+    pp::for_each(groups, [&](int group_index, int) {
+      const size_t first_index = group_index * kGroupSize;
+      const size_t last_index = min(first_index + kGroupSize, population->size());
+
+      vector<size_t> indexes;
+      vector<unique_ptr<darwin::Brain>> brains;
+      for (size_t index = first_index; index < last_index; ++index) {
+        if (!skipped[index]) {
+          indexes.push_back(index);
+          brains.push_back(population->genotype(index)->grow());
+        }
+      }
+
+      if (!indexes.empty()) {
+        darwin::BrainArray brain(std::move(brains), inputs());
+        const vector<float> lanes_initial_angles(indexes.size(),
+                                                 initial_angles[world_index]);
+        const auto steps = simulateAnalytic(&brain, lanes_initial_angles);
+
+        // the fitness is the average number of steps over all test worlds
+        for (size_t i = 0; i < indexes.size(); ++i) {
+          auto genotype = population->genotype(indexes[i]);
+          genotype->fitness += float(steps[i]) / config_.test_worlds;
+        }
+      }
+
+      darwin::ProgressManager::reportProgress(last_index - first_index);
+    });
+  }
+}
+
+vector<int> CartPole::simulateLockStep(darwin::BatchBrain* brain,
+                                       const vector<float>& initial_angles) const {
+  // the batched modes use the analytic engine too, if selected
+  // (validate mode is excluded by evaluationMode())
+  if (config_.physics == physics::Engine::Analytic)
+    return simulateAnalytic(brain, initial_angles);
+  CHECK(config_.physics == physics::Engine::Box2D);
+
+  const size_t count = initial_angles.size();
+
+  vector<pp::ObjectPool<World>::Handle> worlds;
+  worlds.reserve(count);
+  for (size_t i = 0; i < count; ++i)
+    worlds.push_back(newWorld(initial_angles[i]));
+
+  // the number of steps for each world (or max_steps if the episode is successful)
+  vector<int> steps(count, config_.max_steps);
+  vector<bool> active(count, true);
+  size_t active_count = count;
+
+  // simulation loop (the worlds which are no longer active are masked out)
+  float input_values[Agent::kMaxInputs];
+  for (int step = 0; step < config_.max_steps && active_count > 0; ++step) {
+    for (size_t i = 0; i < count; ++i) {
+      if (active[i]) {
+        Agent::readInputs(worlds[i].get(), input_values);
+        brain->setInputs(int(i), input_values);
+      }
+    }
+
+    brain->thinkBatch();
+
+    for (size_t i = 0; i < count; ++i) {
+      if (active[i]) {
+        worlds[i]->moveCart(brain->output(int(i), 0));
+        if (!worlds[i]->simStep()) {
+          steps[i] = step;
+          active[i] = false;
+          --active_count;
+        }
+      }
+    }
+  }
+
+  for (int world_steps : steps)
+    CHECK(world_steps > 0);
+  return steps;
+}
+
+vector<int> CartPole::simulateAnalytic(darwin::BatchBrain* brain,
+                                       const vector<float>& initial_angles) const {
+  const size_t count = initial_angles.size();
+
+  physics::CartPoleBatch episodes(physics_model_, count);
+  for (size_t i = 0; i < count; ++i)
+    episodes.setState(i, World::initialState(initial_angles[i]));
+
+  vector<int> steps(count, config_.max_steps);
+  vector<bool> active(count, true);
+  size_t active_count = count;
+
+  // simulation loop (same as simulateLockStep(), except that all the
+  // episodes are stepped together, including the ones which are no longer active)
+  float input_values[Agent::kMaxInputs];
+  for (int step = 0; step < config_.max_steps && active_count > 0; ++step) {
+    for (size_t i = 0; i < count; ++i) {
+      if (active[i]) {
+        Agent::readInputs(config_, episodes.state(i), input_values);
+        brain->setInputs(int(i), input_values);
+      }
+    }
+
+    brain->thinkBatch();
+
+    for (size_t i = 0; i < count; ++i) {
+      if (active[i])
+        episodes.setForce(i, World::controlForce(config_, brain->output(int(i), 0)));
+    }
+
+    episodes.step(World::kTimeStep);
+
+    for (size_t i = 0; i < count; ++i) {
+      if (active[i] && !World::checkState(config_, episodes.state(i))) {
+        steps[i] = step;
+        active[i] = false;
+        --active_count;
+      }
+    }
+  }
+
+  for (int world_steps : steps)
+    CHECK(world_steps > 0);
+  return steps;
+}
+
+void CartPole::logPhysicsValidation() const {
+  if (config_.physics == physics::Engine::Validate) {
+    const float deviation = physics_validation_.maxDeviation();
+    core::log(" ... physics validation: %zu steps, max deviation %f (%s)\n",
+              physics_validation_.steps(),
+              deviation,
+              deviation <= config_.physics_tolerance ? "ok" : "FAILED");
+  }
+}
+
+pp::ObjectPool<World>::Handle CartPole::newWorld(float initial_angle) const {
+  auto world = world_pool_.acquire();
+  if (world)
+    world->reset(initial_angle);
+  else
+    world = world_pool_.adopt(make_unique<World>(initial_angle, this));
+  return world;
 }
 
 float CartPole::randomInitialAngle() const {
-  random_device rd;
-  default_random_engine rnd(rd());
+  auto& rnd = rng::threadGenerator();
   uniform_real_distribution<float> dist(-config_.max_initial_angle,
                                         config_.max_initial_angle);
   return dist(rnd);
@@ -105,6 +378,10 @@ void CartPole::validateConfiguration()
     throw core::Exception("Invalid configuration: pole_density must be positive");
   if (config_.cart_density < 0)
     throw core::Exception("Invalid configuration: cart_density must be positive or 0");
+  if (config_.physics != physics::Engine::Box2D && config_.cart_friction != 0)
+    throw core::Exception("Invalid configuration: analytic physics with cart_friction");
+  if (config_.physics_tolerance < 0)
+    throw core::Exception("Invalid configuration: physics_tolerance < 0");
 
   if (inputs() < 1)
     throw core::Exception("Invalid configuration: at least one input must be selected");
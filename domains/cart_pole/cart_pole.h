@@ -14,7 +14,9 @@
 
 #pragma once
 
+#include <core/cart_pole_physics.h>
 #include <core/darwin.h>
+#include <core/object_pool.h>
 #include <core/properties.h>
 
 namespace cart_pole {
@@ -30,6 +32,18 @@ struct Config : public core::PropertySet {
   PROPERTY(cart_density, float, 0.0f, "Cart density");
   PROPERTY(cart_friction, float, 0.0f, "Cart friction");
   PROPERTY(max_force, float, 5.0f, "Maximum force which can be applied to the cart");
+
+  PROPERTY(physics,
+           physics::Engine,
+           physics::Engine::Box2D,
+           "Physics engine: box2d, analytic (Runge-Kutta integration of the cart-pole "
+           "equations of motion) or validate (box2d, checking each step against the "
+           "analytic engine)");
+
+  PROPERTY(physics_tolerance,
+           float,
+           0.05f,
+           "The max deviation between the two physics engines (in validate mode)");
   
   PROPERTY(input_pole_angle, bool, true, "Use the pole angle as input");
   PROPERTY(input_angular_velocity, bool, false, "Use the angular velocity as input");
@@ -39,6 +53,18 @@ struct Config : public core::PropertySet {
   PROPERTY(test_worlds, int, 5, "Number of test worlds per generation");
   PROPERTY(max_steps, int, 1000, "Maximum number of steps per episode");
 
+  PROPERTY(batch_size,
+           int,
+           0,
+           "Number of genotypes evaluated in lock-step, if the population supports "
+           "batched evaluation (0 = disabled)");
+
+  PROPERTY(lock_step_test_worlds,
+           bool,
+           false,
+           "Evaluate the test worlds for each genotype in lock-step, if the genotypes "
+           "support batched evaluation");
+
   PROPERTY(discrete_controls,
            bool,
            true,
@@ -87,24 +113,80 @@ struct Config : public core::PropertySet {
 //! ------:|------
 //!      0 | force
 //!
+class World;
+
 class CartPole : public darwin::Domain {
  public:
   explicit CartPole(const core::PropertySet& config);
+  ~CartPole() override;
 
   size_t inputs() const override;
   size_t outputs() const override;
 
   bool evaluatePopulation(darwin::Population* population) const override;
+  bool skipsInheritedFitness() const override;
   
   const Config& config() const { return config_; }
+
+  // the physical parameters used by the analytic engine
+  const physics::CartPoleModel& physicsModel() const { return physics_model_; }
+
+  // tracks the differences between the physics engines (in validate mode)
+  physics::Validation* physicsValidation() const { return &physics_validation_; }
   
   float randomInitialAngle() const;
-  
+
+  // returns a recycled world (reset to the initial state), or a new world
+  pp::ObjectPool<World>::Handle newWorld(float initial_angle) const;
+
  private:
   void validateConfiguration();
+  void logPhysicsValidation() const;
+
+  // the population evaluation strategies (see evaluationMode())
+  enum class EvaluationMode {
+    PerWorld,            // one world per genotype and test world
+    Batched,             // batches of genotypes in lock-step (Population::growBatch())
+    LockStepTestWorlds,  // the test worlds of each genotype in lock-step
+    AnalyticGroups,      // groups of genotypes in lock-step, using the analytic engine
+  };
+
+  // selects the evaluation strategy, based on the configuration and
+  // the population / genotype capabilities
+  EvaluationMode evaluationMode(const darwin::Population* population) const;
+
+  void evaluatePerWorld(darwin::Population* population,
+                        const vector<bool>& skipped,
+                        const vector<float>& initial_angles) const;
+
+  void evaluateBatched(darwin::Population* population,
+                       const vector<float>& initial_angles) const;
+
+  void evaluateTestWorlds(darwin::Population* population,
+                          const vector<bool>& skipped,
+                          const vector<float>& initial_angles) const;
+
+  void evaluateAnalyticGroups(darwin::Population* population,
+                              const vector<bool>& skipped,
+                              const vector<float>& initial_angles) const;
+
+  // simulates a set of worlds in lock-step, one darwin::BatchBrain lane per world
+  // (returns the number of steps for each world)
+  vector<int> simulateLockStep(darwin::BatchBrain* brain,
+                               const vector<float>& initial_angles) const;
+
+  // the analytic engine version of simulateLockStep()
+  vector<int> simulateAnalytic(darwin::BatchBrain* brain,
+                               const vector<float>& initial_angles) const;
 
  private:
   Config config_;
+  physics::CartPoleModel physics_model_;
+  mutable physics::Validation physics_validation_;
+
+  // the pool of recycled worlds (see World::reset()), so the episodes don't pay
+  // for building the Box2D bodies, fixtures and joints each time
+  mutable pp::ObjectPool<World> world_pool_;
 };
 
 class Factory : public darwin::DomainFactory {
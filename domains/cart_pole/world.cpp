@@ -14,6 +14,7 @@
 
 #include "world.h"
 
+#include <core/box2d_utils.h>
 #include <core/math_2d.h>
 
 namespace cart_pole {
@@ -23,7 +24,6 @@ World::World(float initial_angle, const CartPole* domain)
   const auto& config = domain_->config();
 
   // ground
-  constexpr float kGroundY = 0.1f;
   b2EdgeShape ground_shape;
   ground_shape.Set(b2Vec2(-config.max_distance, 0), b2Vec2(config.max_distance, 0));
 
@@ -33,8 +33,6 @@ World::World(float initial_angle, const CartPole* domain)
   ground->CreateFixture(&ground_shape, 0.0f);
 
   // cart
-  constexpr float kCartHalfWidth = 0.2f;
-  constexpr float kCartHalfHeight = 0.05f;
   b2PolygonShape cart_shape;
   cart_shape.SetAsBox(kCartHalfWidth, kCartHalfHeight);
 
@@ -50,7 +48,6 @@ World::World(float initial_angle, const CartPole* domain)
   cart_->CreateFixture(&cart_fixture_def);
 
   // pole
-  constexpr float kPoleHalfWidth = 0.02f;
   const float kPoleHalfHeight = config.pole_length / 2;
   b2PolygonShape pole_shape;
   pole_shape.SetAsBox(kPoleHalfWidth, kPoleHalfHeight, b2Vec2(0, kPoleHalfHeight), 0.0f);
@@ -67,31 +64,100 @@ World::World(float initial_angle, const CartPole* domain)
   pole_->CreateFixture(&pole_fixture_def);
 
   // hinge
+  createHinge();
+}
+
+void World::createHinge() {
   b2RevoluteJointDef hinge_def;
   hinge_def.bodyA = cart_;
   hinge_def.bodyB = pole_;
   hinge_def.localAnchorA.Set(0.0f, 0.0f);
   hinge_def.localAnchorB.Set(0.0f, 0.0f);
-  b2_world_.CreateJoint(&hinge_def);
+  hinge_ = b2_world_.CreateJoint(&hinge_def);
+}
+
+void World::reset(float initial_angle) {
+  // the hinge is re-created in order to discard the cached joint impulses
+  b2_world_.DestroyJoint(hinge_);
+
+  const b2Vec2 position(0.0f, kCartHalfHeight + kGroundY);
+  box2d::resetBody(cart_, position, 0.0f);
+  box2d::resetBody(pole_, position, math::degreesToRadians(initial_angle));
+
+  createHinge();
+  force_ = 0;
 }
 
 bool World::simStep() {
-  constexpr float32 kTimeStep = 1.0f / 50.0f;
   constexpr int32 kVelocityIterations = 5;
   constexpr int32 kPositionIterations = 5;
 
   const auto& config = domain_->config();
+  const bool validate = config.physics == physics::Engine::Validate;
+  const auto initial_state = validate ? state() : physics::CartPoleState();
 
   // box2d: simulate one step
   b2_world_.Step(kTimeStep, kVelocityIterations, kPositionIterations);
 
+  const auto current_state = state();
+  if (validate) {
+    domain_->physicsValidation()->check(
+        domain_->physicsModel(), initial_state, force_, kTimeStep, current_state);
+  }
+  force_ = 0;
+
+  return checkState(config, current_state);
+}
+
+physics::CartPoleState World::state() const {
+  physics::CartPoleState state;
+  state.cart_distance = cartDistance();
+  state.cart_velocity = cartVelocity();
+  state.pole_angle[0] = poleAngle();
+  state.pole_angular_velocity[0] = poleAngularVelocity();
+  return state;
+}
+
+void World::moveCart(float force) {
+  force = controlForce(domain_->config(), force);
+  cart_->ApplyForceToCenter(b2Vec2(force, 0), true);
+  force_ += force;
+}
+
+physics::CartPoleModel World::physicsModel(const Config& config) {
+  physics::CartPoleModel model;
+  model.gravity = config.gravity;
+
+  // Box2D uses a unit mass for the dynamic bodies with zero density
+  const float cart_area = (2 * kCartHalfWidth) * (2 * kCartHalfHeight);
+  const float cart_mass = config.cart_density * cart_area;
+  model.cart_mass = cart_mass > 0 ? cart_mass : 1.0f;
+
+  // the pole is a box, rotating around one end
+  const float pole_half_length = config.pole_length / 2;
+  const float pole_mass = config.pole_density * (2 * kPoleHalfWidth) * config.pole_length;
+  model.poles = 1;
+  model.pole_mass[0] = pole_mass;
+  model.pole_half_length[0] = pole_half_length;
+  model.pole_inertia[0] =
+      pole_mass * (kPoleHalfWidth * kPoleHalfWidth + pole_half_length * pole_half_length) / 3;
+  return model;
+}
+
+physics::CartPoleState World::initialState(float initial_angle) {
+  physics::CartPoleState state;
+  state.pole_angle[0] = float(math::degreesToRadians(initial_angle));
+  return state;
+}
+
+bool World::checkState(const Config& config, const physics::CartPoleState& state) {
   // check cart distance
-  const auto distance = cartDistance();
+  const auto distance = state.cart_distance;
   if (distance < -config.max_distance || distance > config.max_distance)
     return false;
 
   // check pole angle
-  const auto pole_angle = poleAngle();
+  const auto pole_angle = state.pole_angle[0];
   const auto max_angle = math::degreesToRadians(config.max_angle);
   if (pole_angle < -max_angle || pole_angle > max_angle)
     return false;
@@ -99,10 +165,10 @@ bool World::simStep() {
   return true;
 }
 
-void World::moveCart(float force) {
-  CHECK(!isnan(force));
-  
-  const auto& config = domain_->config();
+float World::controlForce(const Config& config, float output) {
+  CHECK(!isnan(output));
+
+  float force = output;
 
   // discrete control forces?
   if (config.discrete_controls && force != 0) {
@@ -117,8 +183,8 @@ void World::moveCart(float force) {
   } else if (force > config.max_force) {
     force = config.max_force;
   }
-  
-  cart_->ApplyForceToCenter(b2Vec2(force, 0), true);
+
+  return force;
 }
 
 }  // namespace cart_pole
@@ -16,14 +16,28 @@
 
 #include "cart_pole.h"
 
+#include <core/cart_pole_physics.h>
 #include <third_party/box2d/box2d.h>
 
 namespace cart_pole {
 
 class World {
+  static constexpr float kGroundY = 0.1f;
+  static constexpr float kCartHalfWidth = 0.2f;
+  static constexpr float kCartHalfHeight = 0.05f;
+  static constexpr float kPoleHalfWidth = 0.02f;
+
+ public:
+  // the simulation time step, in seconds
+  static constexpr float kTimeStep = 1.0f / 50.0f;
+
  public:
   World(float initial_angle, const CartPole* domain);
-  
+
+  // restores the initial state (equivalent to constructing a new world,
+  // but without re-creating the Box2D world and bodies)
+  void reset(float initial_angle);
+
   // advances the physical simulation one step, returning false
   // if the state reaches one of the termination conditions
   bool simStep();
@@ -34,18 +48,39 @@ class World {
   float poleAngle() const { return pole_->GetAngle(); }
   float poleAngularVelocity() const { return pole_->GetAngularVelocity(); }
   
+  physics::CartPoleState state() const;
+
   // actuators
   void moveCart(float force);
+
+  // the physical parameters matching the Box2D world
+  // (cart and pole masses and the pole's moment of inertia)
+  static physics::CartPoleModel physicsModel(const Config& config);
+
+  static physics::CartPoleState initialState(float initial_angle);
+
+  // returns false if the state reaches one of the termination conditions
+  static bool checkState(const Config& config, const physics::CartPoleState& state);
+
+  // maps the brain output to the force applied to the cart
+  static float controlForce(const Config& config, float output);
   
   const CartPole* domain() const { return domain_; }
 
   b2World* box2dWorld() { return &b2_world_; }
   
+ private:
+  void createHinge();
+
  private:
   b2World b2_world_;
 
   b2Body* cart_ = nullptr;
   b2Body* pole_ = nullptr;
+  b2Joint* hinge_ = nullptr;
+
+  // the force applied during the current step (for physics validation)
+  float force_ = 0;
   
   const CartPole* domain_ = nullptr;
 };
@@ -72,7 +72,16 @@ string AnnPlayer::name() const {
 
 void AnnPlayer::grow(const darwin::Genotype* genotype) {
   assert(genotype != nullptr);
-  brain = genotype->grow();
+  owned_brain_ = genotype->grow();
+  brain = owned_brain_.get();
+  this->genotype = genotype;
+}
+
+void AnnPlayer::attachBrain(darwin::Brain* brain, const darwin::Genotype* genotype) {
+  assert(brain != nullptr);
+  assert(genotype != nullptr);
+  owned_brain_.reset();
+  this->brain = brain;
   this->genotype = genotype;
 }
 
@@ -23,7 +23,7 @@ namespace conquest {
 
 class AnnPlayer : public Player {
  public:
-  unique_ptr<darwin::Brain> brain;
+  darwin::Brain* brain = nullptr;
   const darwin::Genotype* genotype = nullptr;
   int generation = -1;
 
@@ -34,8 +34,14 @@ class AnnPlayer : public Player {
 
   void grow(const darwin::Genotype* genotype);
 
+  // uses a brain owned by the caller (ex. from tournament::BrainCache)
+  void attachBrain(darwin::Brain* brain, const darwin::Genotype* genotype);
+
   static size_t inputsCount(const Board* board);
   static size_t outputsCount(const Board* board);
+
+ private:
+  unique_ptr<darwin::Brain> owned_brain_;
 };
 
 }  // namespace conquest
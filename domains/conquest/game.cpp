@@ -262,12 +262,13 @@ tournament::GameOutcome ConquestRules::play(Player* player1, Player* player2) co
 
 tournament::GameOutcome ConquestRules::play(const darwin::Genotype* player1,
                                             const darwin::Genotype* player2) const {
+  // use the cached brains, instead of growing new ones for every game
   AnnPlayer blue_player;
-  blue_player.grow(player1);
+  blue_player.attachBrain(tournament::BrainCache::brain(player1), player1);
 
   AnnPlayer red_player;
-  red_player.grow(player2);
-  
+  red_player.attachBrain(tournament::BrainCache::brain(player2), player2);
+
   return play(&blue_player, &red_player);
 }
 
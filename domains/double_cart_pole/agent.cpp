@@ -21,27 +21,36 @@ Agent::Agent(const darwin::Genotype* genotype, World* world)
     : world_(world), brain_(genotype->grow()) {}
 
 void Agent::simStep() {
-  const auto& config = world_->domain()->config();
-
   // setup inputs
+  float input_values[kMaxInputs];
+  const int inputs_count =
+      readInputs(world_->domain()->config(), world_->state(), input_values);
+  for (int i = 0; i < inputs_count; ++i)
+    brain_->setInput(i, input_values[i]);
+
+  brain_->think();
+
+  // act based on the output values
+  world_->moveCart(brain_->output(0));
+}
+
+int Agent::readInputs(const Config& config,
+                      const physics::CartPoleState& state,
+                      float* values) {
   int input_index = 0;
   if (config.input_pole_angle) {
-    brain_->setInput(input_index++, world_->pole1Angle());
-    brain_->setInput(input_index++, world_->pole2Angle());
+    values[input_index++] = state.pole_angle[0];
+    values[input_index++] = state.pole_angle[1];
   }
   if (config.input_angular_velocity) {
-    brain_->setInput(input_index++, world_->pole1AngularVelocity());
-    brain_->setInput(input_index++, world_->pole2AngularVelocity());
+    values[input_index++] = state.pole_angular_velocity[0];
+    values[input_index++] = state.pole_angular_velocity[1];
   }
   if (config.input_cart_distance)
-    brain_->setInput(input_index++, world_->cartDistance());
+    values[input_index++] = state.cart_distance;
   if (config.input_cart_velocity)
-    brain_->setInput(input_index++, world_->cartVelocity());
-
-  brain_->think();
-
-  // act based on the output values
-  world_->moveCart(brain_->output(0));
+    values[input_index++] = state.cart_velocity;
+  return input_index;
 }
 
 int Agent::inputs(const Config& config) {
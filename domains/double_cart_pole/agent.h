@@ -16,6 +16,7 @@
 
 #include "double_cart_pole.h"
 
+#include <core/cart_pole_physics.h>
 #include <core/darwin.h>
 
 #include <memory>
@@ -26,6 +27,9 @@ namespace double_cart_pole {
 class World;
 
 class Agent {
+ public:
+  static constexpr int kMaxInputs = 6;
+
  public:
   Agent(const darwin::Genotype* genotype, World* world);
   void simStep();
@@ -33,6 +37,12 @@ class Agent {
   static int inputs(const Config& config);
   static int outputs(const Config& config);
 
+  // reads the current input values (sensors) from the world state,
+  // returning the number of inputs (at most kMaxInputs)
+  static int readInputs(const Config& config,
+                        const physics::CartPoleState& state,
+                        float* values);
+
  private:
   World* world_ = nullptr;
   unique_ptr<darwin::Brain> brain_;
@@ -20,8 +20,12 @@
 #include <core/exception.h>
 #include <core/logging.h>
 #include <core/parallel_for_each.h>
+#include <core/rng.h>
 
+#include <algorithm>
+#include <memory>
 #include <random>
+#include <vector>
 using namespace std;
 
 namespace double_cart_pole {
@@ -29,8 +33,11 @@ namespace double_cart_pole {
 DoubleCartPole::DoubleCartPole(const core::PropertySet& config) {
   config_.copyFrom(config);
   validateConfiguration();
+  physics_model_ = World::physicsModel(config_);
 }
 
+DoubleCartPole::~DoubleCartPole() = default;
+
 size_t DoubleCartPole::inputs() const {
   return Agent::inputs(config_);
 }
@@ -39,15 +46,37 @@ size_t DoubleCartPole::outputs() const {
   return Agent::outputs(config_);
 }
 
+// without a random initial angle the episodes are deterministic,
+// so the genotypes which inherited their fitness value can be skipped
+bool DoubleCartPole::skipsInheritedFitness() const {
+  return config_.max_initial_angle == 0;
+}
+
 bool DoubleCartPole::evaluatePopulation(darwin::Population* population) const {
   darwin::StageScope stage("Evaluate population");
 
   const int generation = population->generation();
   core::log("\n. generation %d\n", generation);
 
+  const bool skip_inherited = skipsInheritedFitness();
+  auto skipGenotype = [&](int index) {
+    return skip_inherited && population->isFitnessInherited(index);
+  };
+
   // reset the fitness values
-  pp::for_each(*population,
-               [&](int, darwin::Genotype* genotype) { genotype->fitness = 0; });
+  pp::for_each(*population, [&](int index, darwin::Genotype* genotype) {
+    if (!skipGenotype(index))
+      genotype->fitness = 0;
+  });
+
+  physics_validation_.reset();
+
+  // the analytic engine simulates groups of genotypes in lock-step
+  const bool analytic = config_.physics == physics::Engine::Analytic;
+  constexpr size_t kGroupSize = physics::CartPoleBatch::kLanes;
+  vector<int> groups;
+  if (analytic)
+    groups.resize((population->size() + kGroupSize - 1) / kGroupSize);
 
   // evaluate each genotype (over N worlds)
   for (int world_index = 0; world_index < config_.test_worlds; ++world_index) {
@@ -57,15 +86,34 @@ bool DoubleCartPole::evaluatePopulation(darwin::Population* population) const {
     const float initial_angle_1 = randomInitialAngle();
     const float initial_angle_2 = randomInitialAngle();
 
-    pp::for_each(*population, [&](int, darwin::Genotype* genotype) {
-      World world(initial_angle_1, initial_angle_2, this);
-      Agent agent(genotype, &world);
+    if (analytic) {
+      pp::for_each(groups, [&](int group_index, int) {
+        const size_t first_index = group_index * kGroupSize;
+        const size_t last_index = min(first_index + kGroupSize, population->size());
+        vector<size_t> indexes;
+        for (size_t index = first_index; index < last_index; ++index)
+          if (!skipGenotype(int(index)))
+            indexes.push_back(index);
+        evaluateGenotypes(population, indexes, initial_angle_1, initial_angle_2);
+        darwin::ProgressManager::reportProgress(last_index - first_index);
+      });
+      continue;
+    }
+
+    pp::for_each(*population, [&](int index, darwin::Genotype* genotype) {
+      if (skipGenotype(index)) {
+        darwin::ProgressManager::reportProgress();
+        return;
+      }
+
+      auto world = newWorld(initial_angle_1, initial_angle_2);
+      Agent agent(genotype, world.get());
 
       // simulation loop
       int step = 0;
       for (; step < config_.max_steps; ++step) {
         agent.simStep();
-        if (!world.simStep())
+        if (!world->simStep())
           break;
       }
       CHECK(step > 0);
@@ -77,13 +125,91 @@ bool DoubleCartPole::evaluatePopulation(darwin::Population* population) const {
     });
   }
 
+  logPhysicsValidation();
   core::log("\n");
   return false;
 }
 
+void DoubleCartPole::evaluateGenotypes(darwin::Population* population,
+                                       const vector<size_t>& indexes,
+                                       float initial_angle_1,
+                                       float initial_angle_2) const {
+  if (indexes.empty())
+    return;
+
+  const size_t count = indexes.size();
+
+  vector<unique_ptr<darwin::Brain>> brains;
+  for (size_t index : indexes)
+    brains.push_back(population->genotype(index)->grow());
+  darwin::BrainArray brain(std::move(brains), inputs());
+
+  physics::CartPoleBatch episodes(physics_model_, count);
+  for (size_t i = 0; i < count; ++i)
+    episodes.setState(i, World::initialState(initial_angle_1, initial_angle_2));
+
+  vector<int> steps(count, config_.max_steps);
+  vector<bool> active(count, true);
+  size_t active_count = count;
+
+  // simulation loop (the episodes which are no longer active are masked out)
+  float input_values[Agent::kMaxInputs];
+  for (int step = 0; step < config_.max_steps && active_count > 0; ++step) {
+    for (size_t i = 0; i < count; ++i) {
+      if (active[i]) {
+        Agent::readInputs(config_, episodes.state(i), input_values);
+        brain.setInputs(int(i), input_values);
+      }
+    }
+
+    brain.thinkBatch();
+
+    for (size_t i = 0; i < count; ++i) {
+      if (active[i])
+        episodes.setForce(i, World::controlForce(config_, brain.output(int(i), 0)));
+    }
+
+    episodes.step(World::kTimeStep);
+
+    for (size_t i = 0; i < count; ++i) {
+      if (active[i] && !World::checkState(config_, episodes.state(i))) {
+        steps[i] = step;
+        active[i] = false;
+        --active_count;
+      }
+    }
+  }
+
+  // the fitness is the average number of steps over all test worlds
+  for (size_t i = 0; i < count; ++i) {
+    CHECK(steps[i] > 0);
+    auto genotype = population->genotype(indexes[i]);
+    genotype->fitness += float(steps[i]) / config_.test_worlds;
+  }
+}
+
+void DoubleCartPole::logPhysicsValidation() const {
+  if (config_.physics == physics::Engine::Validate) {
+    const float deviation = physics_validation_.maxDeviation();
+    core::log(" ... physics validation: %zu steps, max deviation %f (%s)\n",
+              physics_validation_.steps(),
+              deviation,
+              deviation <= config_.physics_tolerance ? "ok" : "FAILED");
+  }
+}
+
+pp::ObjectPool<World>::Handle DoubleCartPole::newWorld(float initial_angle_1,
+                                                       float initial_angle_2) const {
+  auto world = world_pool_.acquire();
+  if (world)
+    world->reset(initial_angle_1, initial_angle_2);
+  else
+    world = world_pool_.adopt(make_unique<World>(initial_angle_1, initial_angle_2, this));
+  return world;
+}
+
 float DoubleCartPole::randomInitialAngle() const {
-  random_device rd;
-  default_random_engine rnd(rd());
+  auto& rnd = rng::threadGenerator();
   uniform_real_distribution<float> dist(-config_.max_initial_angle,
                                         config_.max_initial_angle);
   return dist(rnd);
@@ -109,6 +235,10 @@ void DoubleCartPole::validateConfiguration() {
     throw core::Exception("Invalid configuration: pole_2_density must be positive");
   if (config_.cart_density < 0)
     throw core::Exception("Invalid configuration: cart_density must be positive or 0");
+  if (config_.physics != physics::Engine::Box2D && config_.cart_friction != 0)
+    throw core::Exception("Invalid configuration: analytic physics with cart_friction");
+  if (config_.physics_tolerance < 0)
+    throw core::Exception("Invalid configuration: physics_tolerance < 0");
 
   if (inputs() < 1)
     throw core::Exception("Invalid configuration: at least one input must be selected");
@@ -14,7 +14,9 @@
 
 #pragma once
 
+#include <core/cart_pole_physics.h>
 #include <core/darwin.h>
+#include <core/object_pool.h>
 #include <core/properties.h>
 
 namespace double_cart_pole {
@@ -32,6 +34,18 @@ struct Config : public core::PropertySet {
   PROPERTY(cart_density, float, 0.0f, "Cart density");
   PROPERTY(cart_friction, float, 0.0f, "Cart friction");
   PROPERTY(max_force, float, 10.0f, "Maximum force which can be applied to the cart");
+
+  PROPERTY(physics,
+           physics::Engine,
+           physics::Engine::Box2D,
+           "Physics engine: box2d, analytic (Runge-Kutta integration of the cart-pole "
+           "equations of motion) or validate (box2d, checking each step against the "
+           "analytic engine)");
+
+  PROPERTY(physics_tolerance,
+           float,
+           0.05f,
+           "The max deviation between the two physics engines (in validate mode)");
   
   PROPERTY(input_pole_angle, bool, true, "Use the pole angle as input");
   PROPERTY(input_angular_velocity, bool, false, "Use the angular velocity as input");
@@ -89,24 +103,50 @@ struct Config : public core::PropertySet {
 //! ------:|------
 //!      0 | force
 //!
+class World;
+
 class DoubleCartPole : public darwin::Domain {
  public:
   explicit DoubleCartPole(const core::PropertySet& config);
+  ~DoubleCartPole() override;
 
   size_t inputs() const override;
   size_t outputs() const override;
 
   bool evaluatePopulation(darwin::Population* population) const override;
+  bool skipsInheritedFitness() const override;
   
   const Config& config() const { return config_; }
+
+  // the physical parameters used by the analytic engine
+  const physics::CartPoleModel& physicsModel() const { return physics_model_; }
+
+  // tracks the differences between the physics engines (in validate mode)
+  physics::Validation* physicsValidation() const { return &physics_validation_; }
   
   float randomInitialAngle() const;
-  
+
+  // returns a recycled world (reset to the initial state), or a new world
+  pp::ObjectPool<World>::Handle newWorld(float initial_angle_1,
+                                         float initial_angle_2) const;
+
  private:
   void validateConfiguration();
+  void logPhysicsValidation() const;
+
+  // simulates a set of genotypes in lock-step, using the analytic engine
+  void evaluateGenotypes(darwin::Population* population,
+                         const vector<size_t>& indexes,
+                         float initial_angle_1,
+                         float initial_angle_2) const;
 
  private:
   Config config_;
+  physics::CartPoleModel physics_model_;
+  mutable physics::Validation physics_validation_;
+
+  // reusable worlds (a cart, two poles and their hinges), reset between episodes
+  mutable pp::ObjectPool<World> world_pool_;
 };
 
 class Factory : public darwin::DomainFactory {
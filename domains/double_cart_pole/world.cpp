@@ -14,6 +14,7 @@
 
 #include "world.h"
 
+#include <core/box2d_utils.h>
 #include <core/math_2d.h>
 
 namespace double_cart_pole {
@@ -57,13 +58,13 @@ b2Body* World::createCart(float density, float friction) {
   return cart;
 }
 
-void World::createHinge(b2Body* cart, b2Body* pole) {
+b2Joint* World::createHinge(b2Body* cart, b2Body* pole) {
   b2RevoluteJointDef hinge_def;
   hinge_def.bodyA = cart;
   hinge_def.bodyB = pole;
   hinge_def.localAnchorA.Set(0.0f, 0.0f);
   hinge_def.localAnchorB.Set(0.0f, 0.0f);
-  b2_world_.CreateJoint(&hinge_def);
+  return b2_world_.CreateJoint(&hinge_def);
 }
 
 World::World(float initial_angle_1, float initial_angle_2, const DoubleCartPole* domain)
@@ -83,44 +84,119 @@ World::World(float initial_angle_1, float initial_angle_2, const DoubleCartPole*
   cart_ = createCart(config.cart_density, config.cart_friction);
   pole_1_ = createPole(config.pole_1_length, config.pole_1_density, initial_angle_1);
   pole_2_ = createPole(config.pole_2_length, config.pole_2_density, initial_angle_2);
-  createHinge(cart_, pole_1_);
-  createHinge(cart_, pole_2_);
+  hinge_1_ = createHinge(cart_, pole_1_);
+  hinge_2_ = createHinge(cart_, pole_2_);
+}
+
+void World::reset(float initial_angle_1, float initial_angle_2) {
+  // the hinges are re-created in order to discard the cached joint impulses
+  b2_world_.DestroyJoint(hinge_1_);
+  b2_world_.DestroyJoint(hinge_2_);
+
+  const b2Vec2 position(0.0f, kCartHalfHeight + kGroundY);
+  box2d::resetBody(cart_, position, 0.0f);
+  box2d::resetBody(pole_1_, position, math::degreesToRadians(initial_angle_1));
+  box2d::resetBody(pole_2_, position, math::degreesToRadians(initial_angle_2));
+
+  hinge_1_ = createHinge(cart_, pole_1_);
+  hinge_2_ = createHinge(cart_, pole_2_);
+  force_ = 0;
 }
 
 bool World::simStep() {
-  constexpr float32 kTimeStep = 1.0f / 50.0f;
   constexpr int32 kVelocityIterations = 5;
   constexpr int32 kPositionIterations = 5;
 
   const auto& config = domain_->config();
+  const bool validate = config.physics == physics::Engine::Validate;
+  const auto initial_state = validate ? state() : physics::CartPoleState();
 
   // box2d: simulate one step
   b2_world_.Step(kTimeStep, kVelocityIterations, kPositionIterations);
 
+  const auto current_state = state();
+  if (validate) {
+    domain_->physicsValidation()->check(
+        domain_->physicsModel(), initial_state, force_, kTimeStep, current_state);
+  }
+  force_ = 0;
+
+  return checkState(config, current_state);
+}
+
+physics::CartPoleState World::state() const {
+  physics::CartPoleState state;
+  state.cart_distance = cartDistance();
+  state.cart_velocity = cartVelocity();
+  state.pole_angle[0] = pole1Angle();
+  state.pole_angle[1] = pole2Angle();
+  state.pole_angular_velocity[0] = pole1AngularVelocity();
+  state.pole_angular_velocity[1] = pole2AngularVelocity();
+  return state;
+}
+
+void World::moveCart(float force) {
+  force = controlForce(domain_->config(), force);
+  cart_->ApplyForceToCenter(b2Vec2(force, 0), true);
+  force_ += force;
+}
+
+physics::CartPoleModel World::physicsModel(const Config& config) {
+  physics::CartPoleModel model;
+  model.gravity = config.gravity;
+
+  // Box2D uses a unit mass for the dynamic bodies with zero density
+  const float cart_area = (2 * kCartHalfWidth) * (2 * kCartHalfHeight);
+  const float cart_mass = config.cart_density * cart_area;
+  model.cart_mass = cart_mass > 0 ? cart_mass : 1.0f;
+
+  // the poles are boxes, rotating around one end
+  const float lengths[] = { config.pole_1_length, config.pole_2_length };
+  const float densities[] = { config.pole_1_density, config.pole_2_density };
+  model.poles = 2;
+  for (int pole = 0; pole < model.poles; ++pole) {
+    const float half_length = lengths[pole] / 2;
+    const float mass = densities[pole] * (2 * kPoleHalfWidth) * lengths[pole];
+    model.pole_mass[pole] = mass;
+    model.pole_half_length[pole] = half_length;
+    model.pole_inertia[pole] =
+        mass * (kPoleHalfWidth * kPoleHalfWidth + half_length * half_length) / 3;
+  }
+  return model;
+}
+
+physics::CartPoleState World::initialState(float initial_angle_1, float initial_angle_2) {
+  physics::CartPoleState state;
+  state.pole_angle[0] = float(math::degreesToRadians(initial_angle_1));
+  state.pole_angle[1] = float(math::degreesToRadians(initial_angle_2));
+  return state;
+}
+
+bool World::checkState(const Config& config, const physics::CartPoleState& state) {
   // check cart distance
-  const auto distance = cartDistance();
+  const auto distance = state.cart_distance;
   if (distance < -config.max_distance || distance > config.max_distance)
     return false;
 
   const auto max_angle = math::degreesToRadians(config.max_angle);
 
   // check pole 1 angle
-  const auto pole_1_angle = pole1Angle();
+  const auto pole_1_angle = state.pole_angle[0];
   if (pole_1_angle < -max_angle || pole_1_angle > max_angle)
     return false;
     
   // check pole 2 angle
-  const auto pole_2_angle = pole2Angle();
+  const auto pole_2_angle = state.pole_angle[1];
   if (pole_2_angle < -max_angle || pole_2_angle > max_angle)
     return false;
 
   return true;
 }
 
-void World::moveCart(float force) {
-  CHECK(!isnan(force));
+float World::controlForce(const Config& config, float output) {
+  CHECK(!isnan(output));
 
-  const auto& config = domain_->config();
+  float force = output;
 
   // discrete control forces?
   if (config.discrete_controls && force != 0) {
@@ -135,8 +211,8 @@ void World::moveCart(float force) {
   } else if (force > config.max_force) {
     force = config.max_force;
   }
-  
-  cart_->ApplyForceToCenter(b2Vec2(force, 0), true);
+
+  return force;
 }
 
 }  // namespace double_cart_pole
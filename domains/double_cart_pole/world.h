@@ -16,6 +16,7 @@
 
 #include "double_cart_pole.h"
 
+#include <core/cart_pole_physics.h>
 #include <third_party/box2d/box2d.h>
 
 namespace double_cart_pole {
@@ -26,9 +27,17 @@ class World {
   static constexpr float kPoleHalfWidth = 0.02f;
   static constexpr float kGroundY = 0.1f;
 
+ public:
+  // the simulation time step, in seconds
+  static constexpr float kTimeStep = 1.0f / 50.0f;
+
  public:
   World(float initial_angle_1, float initial_angle_2, const DoubleCartPole* domain);
-  
+
+  // restores the initial state (equivalent to constructing a new world,
+  // but without re-creating the Box2D world and bodies)
+  void reset(float initial_angle_1, float initial_angle_2);
+
   // advances the physical simulation one step, returning false
   // if the state reaches one of the termination conditions
   bool simStep();
@@ -41,8 +50,22 @@ class World {
   float pole2Angle() const { return pole_2_->GetAngle(); }
   float pole2AngularVelocity() const { return pole_2_->GetAngularVelocity(); }
   
+  physics::CartPoleState state() const;
+
   // actuators
   void moveCart(float force);
+
+  // the physical parameters matching the Box2D world
+  // (cart and pole masses and the poles' moments of inertia)
+  static physics::CartPoleModel physicsModel(const Config& config);
+
+  static physics::CartPoleState initialState(float initial_angle_1, float initial_angle_2);
+
+  // returns false if the state reaches one of the termination conditions
+  static bool checkState(const Config& config, const physics::CartPoleState& state);
+
+  // maps the brain output to the force applied to the cart
+  static float controlForce(const Config& config, float output);
   
   const DoubleCartPole* domain() const { return domain_; }
 
@@ -51,7 +74,7 @@ class World {
  private:
   b2Body* createPole(float length, float density, float initial_angle);
   b2Body* createCart(float density, float friction);
-  void createHinge(b2Body* cart, b2Body* pole);
+  b2Joint* createHinge(b2Body* cart, b2Body* pole);
   
  private:
   b2World b2_world_;
@@ -59,6 +82,11 @@ class World {
   b2Body* cart_ = nullptr;
   b2Body* pole_1_ = nullptr;
   b2Body* pole_2_ = nullptr;
+  b2Joint* hinge_1_ = nullptr;
+  b2Joint* hinge_2_ = nullptr;
+
+  // the force applied during the current step (for physics validation)
+  float force_ = 0;
   
   const DoubleCartPole* domain_ = nullptr;
 };
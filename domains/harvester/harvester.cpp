@@ -76,19 +76,23 @@ bool Harvester::evaluatePopulation(darwin::Population* population) const {
 
       {
         darwin::StageScope stage("Evaluate one map", robots.size());
-        pp::for_each(robots, [&](int robot_index, Robot& robot) {
-          World sandbox(template_map, &robot);
-
-          // TODO: revisit (a cleaner pattern?)
-          sandbox.simInit();
-          while (robot.alive())
-            sandbox.simStep();
-
-          population->genotype(robot_index)->fitness +=
-              robot.fitness() / test_world_maps.size();
-
-          darwin::ProgressManager::reportProgress();
-        });
+        // the episode lengths vary widely, hence the guided partitioner
+        pp::for_each(
+            robots,
+            [&](int robot_index, Robot& robot) {
+              World sandbox(template_map, &robot);
+
+              // TODO: revisit (a cleaner pattern?)
+              sandbox.simInit();
+              while (robot.alive())
+                sandbox.simStep();
+
+              population->genotype(robot_index)->fitness +=
+                  robot.fitness() / test_world_maps.size();
+
+              darwin::ProgressManager::reportProgress();
+            },
+            pp::Partitioner::Guided);
       }
 
       darwin::ProgressManager::reportProgress();
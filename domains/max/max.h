@@ -98,17 +98,22 @@ class FindMaxValue : public darwin::Domain {
 
         {
           darwin::StageScope stage("Evaluate one world", robots.size());
-          pp::for_each(robots, [&](int robot_index, Robot& robot) {
-            World sandbox;
-            sandbox.simInit(world_template, &robot);
-
-            while (robot.alive())
-              sandbox.simStep();
-
-            population->genotype(robot_index)->fitness += robot.fitness / worlds.size();
-
-            darwin::ProgressManager::reportProgress();
-          });
+          // the episode lengths vary widely, hence the guided partitioner
+          pp::for_each(
+              robots,
+              [&](int robot_index, Robot& robot) {
+                World sandbox;
+                sandbox.simInit(world_template, &robot);
+
+                while (robot.alive())
+                  sandbox.simStep();
+
+                population->genotype(robot_index)->fitness +=
+                    robot.fitness / worlds.size();
+
+                darwin::ProgressManager::reportProgress();
+              },
+              pp::Partitioner::Guided);
         }
 
         darwin::ProgressManager::reportProgress();
@@ -43,7 +43,7 @@ class AnnPlayer : public Player {
   static constexpr int kOutputMoveDown = 1;
 
  public:
-  unique_ptr<darwin::Brain> brain;
+  darwin::Brain* brain = nullptr;
   const darwin::Genotype* genotype = nullptr;
   Stats stats;
   int generation = -1;
@@ -54,6 +54,12 @@ class AnnPlayer : public Player {
   void newGame(const Game* game, Side side) override;
 
   void grow(const darwin::Genotype* genotype);
+
+  // uses a brain owned by the caller (ex. from tournament::BrainCache)
+  void attachBrain(darwin::Brain* brain, const darwin::Genotype* genotype);
+
+ private:
+  unique_ptr<darwin::Brain> owned_brain_;
 };
 
 }  // namespace pong
@@ -17,6 +17,7 @@
 #include "ann_player.h"
 
 #include <core/utils.h>
+#include <core/rng.h>
 
 #include <cmath>
 #include <random>
@@ -49,8 +50,7 @@ void Game::newSet() {
     ball_.vx = ball_speed_;
     ball_.vy = 0;
   } else {
-    random_device rd;
-    default_random_engine rnd(rd());
+    auto& rnd = rng::threadGenerator();
     uniform_real_distribution<float> dist(-kMaxAngle, kMaxAngle);
 
     float angle = dist(rnd);
@@ -260,11 +260,12 @@ tournament::GameOutcome PongRules::play(Player* player1, Player* player2) const
 
 tournament::GameOutcome PongRules::play(const darwin::Genotype* player1_genotype,
                                         const darwin::Genotype* player2_genotype) const {
+  // use the cached brains, instead of growing new ones for every game
   AnnPlayer player1;
-  player1.grow(player1_genotype);
+  player1.attachBrain(tournament::BrainCache::brain(player1_genotype), player1_genotype);
 
   AnnPlayer player2;
-  player2.grow(player2_genotype);
+  player2.attachBrain(tournament::BrainCache::brain(player2_genotype), player2_genotype);
 
   return play(&player1, &player2);
 }
@@ -51,7 +51,15 @@ int AnnPlayer::outputs() {
 
 void AnnPlayer::grow(const darwin::Genotype* genotype, int generation) {
   generation_ = generation;
-  brain_ = genotype->grow();
+  owned_brain_ = genotype->grow();
+  brain_ = owned_brain_.get();
+  genotype_ = genotype;
+}
+
+void AnnPlayer::attachBrain(darwin::Brain* brain, const darwin::Genotype* genotype) {
+  CHECK(brain != nullptr);
+  owned_brain_.reset();
+  brain_ = brain;
   genotype_ = genotype;
 }
 
@@ -31,6 +31,9 @@ class AnnPlayer : public Player {
 
   void grow(const darwin::Genotype* genotype, int generation = -1);
 
+  // uses a brain owned by the caller (ex. from tournament::BrainCache)
+  void attachBrain(darwin::Brain* brain, const darwin::Genotype* genotype);
+
   auto genotype() const { return genotype_; }
 
   // Player interface
@@ -44,7 +47,8 @@ class AnnPlayer : public Player {
   int valueBrainMove();
 
  private:
-  unique_ptr<darwin::Brain> brain_;
+  darwin::Brain* brain_ = nullptr;
+  unique_ptr<darwin::Brain> owned_brain_;
   const darwin::Genotype* genotype_ = nullptr;
   int generation_ = -1;
 };
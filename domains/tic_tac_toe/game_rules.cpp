@@ -65,11 +65,12 @@ tournament::GameOutcome TicTacToeRules::play(Player* x_player, Player* o_player)
 
 tournament::GameOutcome TicTacToeRules::play(const darwin::Genotype* x_genotype,
                                              const darwin::Genotype* o_genotype) const {
+  // use the cached brains, instead of growing new ones for every game
   AnnPlayer x_player;
-  x_player.grow(x_genotype);
+  x_player.attachBrain(tournament::BrainCache::brain(x_genotype), x_genotype);
 
   AnnPlayer o_player;
-  o_player.grow(o_genotype);
+  o_player.attachBrain(tournament::BrainCache::brain(o_genotype), o_genotype);
 
   return play(&x_player, &o_player);
 }
@@ -20,7 +20,9 @@
 #include <core/exception.h>
 #include <core/logging.h>
 #include <core/parallel_for_each.h>
+#include <core/rng.h>
 
+#include <memory>
 #include <random>
 using namespace std;
 
@@ -31,6 +33,8 @@ Unicycle::Unicycle(const core::PropertySet& config) {
   validateConfiguration();
 }
 
+Unicycle::~Unicycle() = default;
+
 size_t Unicycle::inputs() const {
   return Agent::inputs(config_);
 }
@@ -58,14 +62,14 @@ bool Unicycle::evaluatePopulation(darwin::Population* population) const {
     const float target_position = randomTargetPosition();
 
     pp::for_each(*population, [&](int, darwin::Genotype* genotype) {
-      World world(initial_angle, target_position, this);
-      Agent agent(genotype, &world);
+      auto world = newWorld(initial_angle, target_position);
+      Agent agent(genotype, world.get());
 
       // simulation loop
       int step = 0;
       for (; step < config_.max_steps; ++step) {
         agent.simStep();
-        if (!world.simStep())
+        if (!world->simStep())
           break;
       }
       CHECK(step > 0);
@@ -75,7 +79,7 @@ bool Unicycle::evaluatePopulation(darwin::Population* population) const {
       // 2. iff the pole was balanced for the whole episode, add the fitness bonus
       float episode_fitness = float(step) / config_.max_steps;
       if (step == config_.max_steps) {
-        episode_fitness += world.fitnessBonus() / config_.max_steps;
+        episode_fitness += world->fitnessBonus() / config_.max_steps;
       }
       genotype->fitness += episode_fitness / config_.test_worlds;
 
@@ -87,17 +91,25 @@ bool Unicycle::evaluatePopulation(darwin::Population* population) const {
   return false;
 }
 
+pp::ObjectPool<World>::Handle Unicycle::newWorld(float initial_angle,
+                                                 float target_position) const {
+  auto world = world_pool_.acquire();
+  if (world)
+    world->reset(initial_angle, target_position);
+  else
+    world = world_pool_.adopt(make_unique<World>(initial_angle, target_position, this));
+  return world;
+}
+
 float Unicycle::randomInitialAngle() const {
-  random_device rd;
-  default_random_engine rnd(rd());
+  auto& rnd = rng::threadGenerator();
   uniform_real_distribution<float> dist(-config_.max_initial_angle,
                                         config_.max_initial_angle);
   return dist(rnd);
 }
 
 float Unicycle::randomTargetPosition() const {
-  random_device rd;
-  default_random_engine rnd(rd());
+  auto& rnd = rng::threadGenerator();
   uniform_real_distribution<float> dist(-config_.max_distance, config_.max_distance);
   return dist(rnd);
 }
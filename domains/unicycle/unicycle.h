@@ -15,6 +15,7 @@
 #pragma once
 
 #include <core/darwin.h>
+#include <core/object_pool.h>
 #include <core/properties.h>
 
 namespace unicycle {
@@ -99,9 +100,12 @@ struct Config : public core::PropertySet {
 //! ------:|------
 //!      0 | torque
 //!
+class World;
+
 class Unicycle : public darwin::Domain {
  public:
   explicit Unicycle(const core::PropertySet& config);
+  ~Unicycle() override;
 
   size_t inputs() const override;
   size_t outputs() const override;
@@ -112,12 +116,18 @@ class Unicycle : public darwin::Domain {
   
   float randomInitialAngle() const;
   float randomTargetPosition() const;
-  
+
+  // returns a recycled world (reset to the initial state), or a new world
+  pp::ObjectPool<World>::Handle newWorld(float initial_angle, float target_position) const;
+
  private:
   void validateConfiguration();
 
  private:
   Config config_;
+
+  // the worlds are recycled, see World::reset()
+  mutable pp::ObjectPool<World> world_pool_;
 };
 
 class Factory : public darwin::DomainFactory {
@@ -14,6 +14,7 @@
 
 #include "world.h"
 
+#include <core/box2d_utils.h>
 #include <core/math_2d.h>
 
 #include <iterator>
@@ -84,13 +85,13 @@ b2Body* World::createWheel() {
   return wheel;
 }
 
-void World::createHinge(b2Body* wheel, b2Body* pole) {
+b2Joint* World::createHinge(b2Body* wheel, b2Body* pole) {
   b2RevoluteJointDef hinge_def;
   hinge_def.bodyA = wheel;
   hinge_def.bodyB = pole;
   hinge_def.localAnchorA.Set(0.0f, 0.0f);
   hinge_def.localAnchorB.Set(0.0f, 0.0f);
-  b2_world_.CreateJoint(&hinge_def);
+  return b2_world_.CreateJoint(&hinge_def);
 }
 
 World::World(float initial_angle, float target_position, const Unicycle* domain)
@@ -100,7 +101,23 @@ World::World(float initial_angle, float target_position, const Unicycle* domain)
   createGround();
   wheel_ = createWheel();
   pole_ = createPole(initial_angle);
-  createHinge(wheel_, pole_);
+  hinge_ = createHinge(wheel_, pole_);
+}
+
+void World::reset(float initial_angle, float target_position) {
+  const auto& config = domain_->config();
+
+  // the hinge is re-created in order to discard the cached joint impulses
+  b2_world_.DestroyJoint(hinge_);
+
+  const b2Vec2 wheel_axle_position(0.0f, config.wheel_radius + kGroundY);
+  box2d::resetBody(wheel_, wheel_axle_position, 0.0f);
+  box2d::resetBody(pole_, wheel_axle_position, math::degreesToRadians(initial_angle));
+
+  hinge_ = createHinge(wheel_, pole_);
+
+  fitness_bonus_ = 0;
+  target_position_ = target_position;
 }
 
 bool World::simStep() {
@@ -29,6 +29,10 @@ class World {
  public:
   World(float initial_angle, float target_position, const Unicycle* domain);
 
+  // restores the initial state (equivalent to constructing a new world,
+  // but without re-creating the Box2D world and bodies)
+  void reset(float initial_angle, float target_position);
+
   // advances the physical simulation one step, returning false
   // if the state reaches one of the termination conditions
   bool simStep();
@@ -56,13 +60,14 @@ class World {
   b2Body* createGround();
   b2Body* createPole(float initial_angle);
   b2Body* createWheel();
-  void createHinge(b2Body* wheel, b2Body* pole);
+  b2Joint* createHinge(b2Body* wheel, b2Body* pole);
   
  private:
   b2World b2_world_;
   b2Body* wheel_ = nullptr;
   b2Body* pole_ = nullptr;
-  
+  b2Joint* hinge_ = nullptr;
+
   float fitness_bonus_ = 0;
   float target_position_ = 0;
   const Unicycle* domain_ = nullptr;
@@ -15,6 +15,7 @@
 #include "brain.h"
 
 #include <core/ann_activation_functions.h>
+#include <core/ann_dynamic.h>
 
 #include <cmath>
 #include <assert.h>
@@ -40,8 +41,9 @@ Brain::Brain(const Genotype* genotype) : genotype_(genotype) {
     outputs_map_.push_back(register_index);
   }
   CHECK(registers_.size() == instructions_.size() + domain->inputs() + 1);
-  
-  memory_.resize(instructions_.size());
+
+  compileProgram();
+  memory_.resize(program_.size());
 }
 
 void Brain::setInput(int index, float value) {
@@ -101,201 +103,135 @@ IndexType Brain::dfsNodeEval(IndexType node_index, vector<IndexType>& nodes_map)
   return dst;
 }
 
-void Brain::think() {
+// the semantics of each function
+//
+// (first_arg and second_arg are the values of the instruction sources, and memory
+// is the per-instruction state used by the stateful functions)
+//
+template <FunctionId FN>
+float evaluate(float first_arg, float second_arg, float& memory);
+
+#define EVALUATE(id)                                                      \
+  template <>                                                             \
+  inline float evaluate<FunctionId::id>([[maybe_unused]] float first_arg,  \
+                                        [[maybe_unused]] float second_arg, \
+                                        [[maybe_unused]] float& memory)
+
+EVALUATE(ConstZero) { return 0.0f; }
+EVALUATE(ConstOne) { return 1.0f; }
+EVALUATE(ConstTwo) { return 2.0f; }
+EVALUATE(ConstPi) { return 3.141592653589f; }
+EVALUATE(ConstE) { return 2.718281828459f; }
+EVALUATE(Identity) { return first_arg; }
+EVALUATE(Add) { return first_arg + second_arg; }
+EVALUATE(Subtract) { return first_arg - second_arg; }
+EVALUATE(Multiply) { return first_arg * second_arg; }
+EVALUATE(Divide) { return first_arg / second_arg; }
+EVALUATE(Negate) { return -first_arg; }
+EVALUATE(Fmod) { return fmod(first_arg, second_arg); }
+EVALUATE(Reminder) { return remainder(first_arg, second_arg); }
+EVALUATE(Fdim) { return fdim(first_arg, second_arg); }
+EVALUATE(Ceil) { return ceil(first_arg); }
+EVALUATE(Floor) { return floor(first_arg); }
+EVALUATE(Abs) { return fabs(first_arg); }
+EVALUATE(Average) { return (first_arg + second_arg) / 2; }
+EVALUATE(Min) { return fmin(first_arg, second_arg); }
+EVALUATE(Max) { return fmax(first_arg, second_arg); }
+EVALUATE(Square) { return first_arg * first_arg; }
+EVALUATE(Log) { return log(first_arg); }
+EVALUATE(Log2) { return log2(first_arg); }
+EVALUATE(Sqrt) { return sqrt(first_arg); }
+EVALUATE(Power) { return pow(first_arg, second_arg); }
+EVALUATE(Exp) { return exp(first_arg); }
+EVALUATE(Exp2) { return exp2(first_arg); }
+EVALUATE(Sin) { return sin(first_arg); }
+EVALUATE(Cos) { return cos(first_arg); }
+EVALUATE(Tan) { return tan(first_arg); }
+EVALUATE(Asin) { return asin(first_arg); }
+EVALUATE(Acos) { return acos(first_arg); }
+EVALUATE(Atan) { return atan(first_arg); }
+EVALUATE(Sinh) { return sinh(first_arg); }
+EVALUATE(Cosh) { return cosh(first_arg); }
+EVALUATE(Tanh) { return tanh(first_arg); }
+EVALUATE(AfnIdentity) { return ann::afnIdentity(first_arg); }
+EVALUATE(AfnLogistic) { return ann::afnLogistic(first_arg); }
+EVALUATE(AfnTanh) { return ann::afnTanh(first_arg); }
+EVALUATE(AfnReLU) { return ann::afnReLU(first_arg); }
+EVALUATE(AfnNeat) { return ann::afnNeat(first_arg); }
+EVALUATE(CmpEq) { return first_arg == second_arg; }
+EVALUATE(CmpNe) { return first_arg != second_arg; }
+EVALUATE(CmpGt) { return first_arg > second_arg; }
+EVALUATE(CmpGe) { return first_arg >= second_arg; }
+EVALUATE(CmpLt) { return first_arg < second_arg; }
+EVALUATE(CmpLe) { return first_arg <= second_arg; }
+EVALUATE(And) { return bool(first_arg) && bool(second_arg); }
+EVALUATE(Or) { return bool(first_arg) || bool(second_arg); }
+EVALUATE(Not) { return !bool(first_arg); }
+EVALUATE(Xor) { return bool(first_arg) != bool(second_arg); }
+EVALUATE(IfOrZero) { return bool(first_arg) ? second_arg : 0; }
+
+EVALUATE(Velocity) {
+  const float result = first_arg - memory;
+  memory = first_arg;
+  return result;
+}
+
+EVALUATE(HighWatermark) {
+  memory = max(memory, first_arg);
+  return memory;
+}
+
+EVALUATE(LowWatermark) {
+  memory = min(memory, first_arg);
+  return memory;
+}
+
+EVALUATE(MemoryCell) {
+  if (second_arg >= 0) {
+    memory = first_arg;
+  }
+  return memory;
+}
+
+EVALUATE(SoftMemoryCell) {
+  const float gate = ann::afnLogistic(second_arg);
+  memory = first_arg * gate + memory * (1 - gate);
+  return memory;
+}
+
+EVALUATE(TimeDelay) {
+  const float result = memory;
+  memory = first_arg;
+  return result;
+}
+
+#undef EVALUATE
+
+// the constant instructions are evaluated only once, here
+void Brain::compileProgram() {
   auto domain = genotype_->population()->domain();
   const size_t instr_reg_base = domain->inputs() + 1;
+
+  float unused_memory = 0;
   for (size_t instr_index = 0; instr_index < instructions_.size(); ++instr_index) {
-    const size_t result_index = instr_reg_base + instr_index;
     const auto& instr = instructions_[instr_index];
-    assert(instr.sources[0] < result_index);
-    assert(instr.sources[1] < result_index);
-    float& result = registers_[result_index];
-    float& memory = memory_[instr_index];
-    const float& first_arg = registers_[instr.sources[0]];
-    const float& second_arg = registers_[instr.sources[1]];
+    const auto dst = IndexType(instr_reg_base + instr_index);
+    float& result = registers_[dst];
     switch (instr.function) {
       case FunctionId::ConstZero:
-        result = 0.0f;
+        result = evaluate<FunctionId::ConstZero>(0, 0, unused_memory);
         break;
       case FunctionId::ConstOne:
-        result = 1.0f;
+        result = evaluate<FunctionId::ConstOne>(0, 0, unused_memory);
         break;
       case FunctionId::ConstTwo:
-        result = 2.0f;
+        result = evaluate<FunctionId::ConstTwo>(0, 0, unused_memory);
         break;
       case FunctionId::ConstPi:
-        result = 3.141592653589f;
+        result = evaluate<FunctionId::ConstPi>(0, 0, unused_memory);
         break;
       case FunctionId::ConstE:
-        result = 2.718281828459f;
-        break;
-      case FunctionId::Identity:
-        result = first_arg;
-        break;
-      case FunctionId::Add:
-        result = first_arg + second_arg;
-        break;
-      case FunctionId::Subtract:
-        result = first_arg - second_arg;
-        break;
-      case FunctionId::Multiply:
-        result = first_arg * second_arg;
-        break;
-      case FunctionId::Divide:
-        result = first_arg / second_arg;
-        break;
-      case FunctionId::Negate:
-        result = -first_arg;
-        break;
-      case FunctionId::Fmod:
-        result = fmod(first_arg, second_arg);
-        break;
-      case FunctionId::Reminder:
-        result = remainder(first_arg, second_arg);
-        break;
-      case FunctionId::Fdim:
-        result = fdim(first_arg, second_arg);
-        break;
-      case FunctionId::Ceil:
-        result = ceil(first_arg);
-        break;
-      case FunctionId::Floor:
-        result = floor(first_arg);
-        break;
-      case FunctionId::Abs:
-        result = fabs(first_arg);
-        break;
-      case FunctionId::Average:
-        result = (first_arg + second_arg) / 2;
-        break;
-      case FunctionId::Min:
-        result = fmin(first_arg, second_arg);
-        break;
-      case FunctionId::Max:
-        result = fmax(first_arg, second_arg);
-        break;
-      case FunctionId::Square:
-        result = first_arg * first_arg;
-        break;
-      case FunctionId::Log:
-        result = log(first_arg);
-        break;
-      case FunctionId::Log2:
-        result = log2(first_arg);
-        break;
-      case FunctionId::Sqrt:
-        result = sqrt(first_arg);
-        break;
-      case FunctionId::Power:
-        result = pow(first_arg, second_arg);
-        break;
-      case FunctionId::Exp:
-        result = exp(first_arg);
-        break;
-      case FunctionId::Exp2:
-        result = exp2(first_arg);
-        break;
-      case FunctionId::Sin:
-        result = sin(first_arg);
-        break;
-      case FunctionId::Cos:
-        result = cos(first_arg);
-        break;
-      case FunctionId::Tan:
-        result = tan(first_arg);
-        break;
-      case FunctionId::Asin:
-        result = asin(first_arg);
-        break;
-      case FunctionId::Acos:
-        result = acos(first_arg);
-        break;
-      case FunctionId::Atan:
-        result = atan(first_arg);
-        break;
-      case FunctionId::Sinh:
-        result = sinh(first_arg);
-        break;
-      case FunctionId::Cosh:
-        result = cosh(first_arg);
-        break;
-      case FunctionId::Tanh:
-        result = tanh(first_arg);
-        break;
-      case FunctionId::AfnIdentity:
-        result = ann::afnIdentity(first_arg);
-        break;
-      case FunctionId::AfnLogistic:
-        result = ann::afnLogistic(first_arg);
-        break;
-      case FunctionId::AfnTanh:
-        result = ann::afnTanh(first_arg);
-        break;
-      case FunctionId::AfnReLU:
-        result = ann::afnReLU(first_arg);
-        break;
-      case FunctionId::AfnNeat:
-        result = ann::afnNeat(first_arg);
-        break;
-      case FunctionId::CmpEq:
-        result = first_arg == second_arg;
-        break;
-      case FunctionId::CmpNe:
-        result = first_arg != second_arg;
-        break;
-      case FunctionId::CmpGt:
-        result = first_arg > second_arg;
-        break;
-      case FunctionId::CmpGe:
-        result = first_arg >= second_arg;
-        break;
-      case FunctionId::CmpLt:
-        result = first_arg < second_arg;
-        break;
-      case FunctionId::CmpLe:
-        result = first_arg <= second_arg;
-        break;
-      case FunctionId::And:
-        result = bool(first_arg) && bool(second_arg);
-        break;
-      case FunctionId::Or:
-        result = bool(first_arg) || bool(second_arg);
-        break;
-      case FunctionId::Not:
-        result = !bool(first_arg);
-        break;
-      case FunctionId::Xor:
-        result = bool(first_arg) != bool(second_arg);
-        break;
-      case FunctionId::IfOrZero:
-        result = bool(first_arg) ? second_arg : 0;
-        break;
-      case FunctionId::Velocity:
-        result = first_arg - memory;
-        memory = first_arg;
-        break;
-      case FunctionId::HighWatermark:
-        memory = max(memory, first_arg);
-        result = memory;
-        break;
-      case FunctionId::LowWatermark:
-        memory = min(memory, first_arg);
-        result = memory;
-        break;
-      case FunctionId::MemoryCell:
-        if (second_arg >= 0) {
-          memory = first_arg;
-        }
-        result = memory;
-        break;
-      case FunctionId::SoftMemoryCell: {
-        const float gate = ann::afnLogistic(second_arg);
-        memory = first_arg * gate + memory * (1 - gate);
-        result = memory;
-      } break;
-      case FunctionId::TimeDelay:
-        result = memory;
-        memory = first_arg;
+        result = evaluate<FunctionId::ConstE>(0, 0, unused_memory);
         break;
       default:
         // evolvable constant?
@@ -303,13 +239,199 @@ void Brain::think() {
           result = genotype_->getEvolvableConstant(instr.function);
           break;
         }
+        CHECK(instr.function < FunctionId::LastEntry);
+        program_.push_back({ instr.function, dst, instr.sources });
+    }
+  }
+}
+
+// the GCC and Clang builds use a direct-threaded interpreter (based on the
+// "labels as values" extension), which replaces the single, hard to predict,
+// switch dispatch with a separate indirect jump at the end of each function
+#if defined(__GNUC__)
+#define DARWIN_CGP_THREADED_CODE 1
+#else
+#define DARWIN_CGP_THREADED_CODE 0
+#endif
+
+void Brain::think() {
+  float* const registers = registers_.data();
+  float* const memory = memory_.data();
+  const Operation* const program = program_.data();
+  const Operation* const program_end = program + program_.size();
+  const Operation* op = program;
+
+#define EXECUTE(id)                                                 \
+  assert(op->sources[0] < op->dst);                                 \
+  assert(op->sources[1] < op->dst);                                 \
+  registers[op->dst] = evaluate<FunctionId::id>(                    \
+      registers[op->sources[0]], registers[op->sources[1]], memory[op - program])
+
+#if DARWIN_CGP_THREADED_CODE
+  static void* const kDispatchTable[kFunctionCount] = {
+  #undef FN_DEF
+  #define FN_DEF(id, name, arity, category) &&execute_##id,
+  #include "functions_table.def"
+  };
+
+#define DISPATCH()                      \
+  if (op == program_end)                \
+    return;                             \
+  goto* kDispatchTable[op->function];
+
+  DISPATCH();
+
+  #undef FN_DEF
+  #define FN_DEF(id, name, arity, category) \
+    execute_##id:                           \
+      EXECUTE(id);                          \
+      ++op;                                 \
+      DISPATCH();
+  #include "functions_table.def"
+
+#undef DISPATCH
+#else
+  for (; op != program_end; ++op) {
+    switch (op->function) {
+      #undef FN_DEF
+      #define FN_DEF(id, name, arity, category) \
+        case FunctionId::id:                    \
+          EXECUTE(id);                          \
+          break;
+      #include "functions_table.def"
+      default:
         FATAL("Unexpected function id");
     }
   }
+#endif
+
+#undef EXECUTE
+}
+
+// FNV-1a hashing
+template <class T>
+static void hashValue(uint64_t& hash, const T& value) {
+  constexpr uint64_t kFnvPrime = 1099511628211ull;
+  const auto bytes = reinterpret_cast<const uint8_t*>(&value);
+  for (size_t i = 0; i < sizeof(value); ++i) {
+    hash ^= bytes[i];
+    hash *= kFnvPrime;
+  }
+}
+
+uint64_t Brain::fingerprint() const {
+  uint64_t hash = 14695981039346656037ull;
+  for (const auto& instr : instructions_) {
+    hashValue(hash, instr.function);
+    for (auto source : instr.sources) {
+      hashValue(hash, source);
+    }
+    if (instr.function < 0) {
+      hashValue(hash, genotype_->getEvolvableConstant(instr.function));
+    }
+  }
+  for (auto register_index : outputs_map_) {
+    hashValue(hash, register_index);
+  }
+  return hash;
+}
+
+bool Brain::samePhenotype(const Brain& other) const {
+  if (instructions_.size() != other.instructions_.size() ||
+      outputs_map_ != other.outputs_map_) {
+    return false;
+  }
+  for (size_t i = 0; i < instructions_.size(); ++i) {
+    const auto& instr = instructions_[i];
+    const auto& other_instr = other.instructions_[i];
+    if (instr.function != other_instr.function || instr.sources != other_instr.sources)
+      return false;
+    if (instr.function < 0 &&
+        genotype_->getEvolvableConstant(instr.function) !=
+            other.genotype_->getEvolvableConstant(other_instr.function)) {
+      return false;
+    }
+  }
+  return true;
 }
 
 void Brain::resetState() {
   std::fill(memory_.begin(), memory_.end(), 0.0f);
 }
 
+// applies one instruction to all the lanes
+// (the simple arithmetic functions are vectorized by the compiler)
+template <FunctionId FN>
+static void executeLanes(float* dst,
+                         const float* first_arg,
+                         const float* second_arg,
+                         float* memory,
+                         size_t lanes) {
+  for (size_t i = 0; i < lanes; ++i) {
+    dst[i] = evaluate<FN>(first_arg[i], second_arg[i], memory[i]);
+  }
+}
+
+BatchBrain::BatchBrain(const Genotype* genotype, size_t size)
+    : brain_(genotype), size_(size) {
+  CHECK(size_ > 0);
+  constexpr size_t kLanes = ann::kBatchLanes;
+  stride_ = (size_ + kLanes - 1) / kLanes * kLanes;
+
+  // broadcast the initial register values (including the constants)
+  const size_t registers_count = brain_.registers_.size();
+  registers_.resize(registers_count * stride_);
+  for (size_t i = 0; i < registers_count; ++i) {
+    const auto lanes = registers_.begin() + i * stride_;
+    std::fill(lanes, lanes + stride_, brain_.registers_[i]);
+  }
+
+  memory_.resize(brain_.program_.size() * stride_);
+}
+
+void BatchBrain::setInputs(int batch_index, const float* values) {
+  assert(batch_index >= 0 && batch_index < int(size_));
+  const size_t inputs_count = brain_.genotype_->population()->domain()->inputs();
+  for (size_t i = 0; i < inputs_count; ++i) {
+    registers_[(i + 1) * stride_ + batch_index] = values[i];
+  }
+}
+
+float BatchBrain::output(int batch_index, int index) const {
+  assert(batch_index >= 0 && batch_index < int(size_));
+  assert(index >= 0 && index < int(brain_.outputs_map_.size()));
+
+  // see Brain::output()
+  const float value = registers_[brain_.outputs_map_[index] * stride_ + batch_index];
+  return isnan(value) ? numeric_limits<float>::infinity() : value;
+}
+
+void BatchBrain::thinkBatch() {
+  float* const registers = registers_.data();
+  const auto& program = brain_.program_;
+  for (size_t op_index = 0; op_index < program.size(); ++op_index) {
+    const auto& op = program[op_index];
+    assert(op.sources[0] < op.dst);
+    assert(op.sources[1] < op.dst);
+    float* const dst = registers + op.dst * stride_;
+    const float* const first_arg = registers + op.sources[0] * stride_;
+    const float* const second_arg = registers + op.sources[1] * stride_;
+    float* const memory = memory_.data() + op_index * stride_;
+    switch (op.function) {
+      #undef FN_DEF
+      #define FN_DEF(id, name, arity, category)                                      \
+        case FunctionId::id:                                                         \
+          executeLanes<FunctionId::id>(dst, first_arg, second_arg, memory, stride_); \
+          break;
+      #include "functions_table.def"
+      default:
+        FATAL("Unexpected function id");
+    }
+  }
+}
+
+void BatchBrain::resetState() {
+  std::fill(memory_.begin(), memory_.end(), 0.0f);
+}
+
 }  // namespace cgp
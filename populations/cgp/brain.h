@@ -22,17 +22,31 @@
 #include <core/darwin.h>
 
 #include <array>
+#include <cstdint>
 #include <vector>
 using namespace std;
 
 namespace cgp {
 
 class Brain : public darwin::Brain {
+  friend class BatchBrain;
+
   struct Instruction {
     FunctionId function;
     array<IndexType, kMaxFunctionArity> sources;
   };
 
+  // a pre-decoded instruction, as executed by think()
+  //
+  // (the constant instructions are evaluated once, when the brain is created,
+  // so they are not part of the executed program)
+  //
+  struct Operation {
+    FunctionId function;
+    IndexType dst;
+    array<IndexType, kMaxFunctionArity> sources;
+  };
+
  public:
   explicit Brain(const Genotype* genotype);
 
@@ -41,16 +55,63 @@ class Brain : public darwin::Brain {
   void think() override;
   void resetState() override;
 
+  //! A hash of the active program (the instructions, outputs and the values of
+  //! the used evolvable constants)
+  //!
+  //! Genotypes with the same fingerprint have the same phenotype, even if they
+  //! differ in the inactive genes (neutral mutations).
+  //!
+  uint64_t fingerprint() const;
+
+  //! Returns true if the two brains run the same active program
+  //! (used to confirm a fingerprint match, since the fingerprints may collide)
+  bool samePhenotype(const Brain& other) const;
+
  private:
   IndexType dfsNodeEval(IndexType node_index, vector<IndexType>& nodes_map);
+  void compileProgram();
 
  private:
   const Genotype* genotype_ = nullptr;
 
+  // the active instructions, in evaluation order
   vector<Instruction> instructions_;
+
+  // the executed (non-constant) instructions
+  vector<Operation> program_;
+
   vector<float> registers_;
   vector<float> memory_;
   vector<int> outputs_map_;
 };
 
+// A batch of independent instances of the same CGP brain (lanes)
+//
+// Each register holds the values for all the lanes, registers_[register][lane],
+// so the instructions are dispatched once for the whole batch. The results are
+// bit-identical to evaluating each lane with a separate Brain.
+//
+class BatchBrain : public darwin::BatchBrain {
+ public:
+  BatchBrain(const Genotype* genotype, size_t size);
+
+  size_t size() const override { return size_; }
+  void setInputs(int batch_index, const float* values) override;
+  float output(int batch_index, int index) const override;
+  void thinkBatch() override;
+  void resetState() override;
+
+ private:
+  // the compiled program (the lanes share the instructions and constants)
+  Brain brain_;
+
+  size_t size_ = 0;
+
+  // the number of values per register (size_ padded to a multiple of kBatchLanes)
+  size_t stride_ = 0;
+
+  vector<float> registers_;
+  vector<float> memory_;
+};
+
 }  // namespace cgp
@@ -85,6 +85,12 @@ struct Config : public core::PropertySet {
            2.0f,
            "Mutation standard deviation, used for evolvable constants");
 
+  PROPERTY(inherit_neutral_fitness,
+           bool,
+           false,
+           "Inherit the parent fitness if the active program is unchanged "
+           "(only used if the domain skips the genotypes with inherited fitness)");
+
   VARIANT(mutation_strategy,
           MutationVariant,
           MutationStrategy::FixedCount,
@@ -18,6 +18,7 @@
 #include "population.h"
 
 #include <core/format.h>
+#include <core/rng.h>
 
 #include <string>
 #include <random>
@@ -33,6 +34,10 @@ unique_ptr<darwin::Brain> Genotype::grow() const {
   return make_unique<Brain>(this);
 }
 
+unique_ptr<darwin::BatchBrain> Genotype::growBatch(size_t size) const {
+  return make_unique<BatchBrain>(this, size);
+}
+
 unique_ptr<darwin::Genotype> Genotype::clone() const {
   return make_unique<Genotype>(*this);
 }
@@ -105,29 +110,101 @@ json Genotype::save() const {
 }
 
 void Genotype::load(const json& json_obj) {
+  checkShape(json_obj.at("inputs"),
+             json_obj.at("outputs"),
+             json_obj.at("rows"),
+             json_obj.at("columns"));
+
+  // load the genotype
+  Genotype tmp_genotype(population_);
+  tmp_genotype.function_genes_ =
+      json_obj.at("function_genes").get<vector<FunctionGene>>();
+  tmp_genotype.output_genes_ = json_obj.at("output_genes").get<vector<OutputGene>>();
+  tmp_genotype.constants_genes_ = json_obj.at("constants_genes").get<vector<float>>();
+  std::swap(*this, tmp_genotype);
+}
+
+void to_binary(core::BinaryWriter& writer, const OutputGene& gene) {
+  writer.write(gene.connection);
+}
+
+void from_binary(core::BinaryReader& reader, OutputGene& gene) {
+  reader.read(gene.connection);
+}
+
+// the function genes reference the functions by name (through a table of the
+// used function names), so the encoding doesn't depend on the FunctionId values
+// (negative function codes are evolvable constants, same as FunctionGene::function)
+void Genotype::saveBinaryPayload(core::BinaryWriter& writer) const {
+  writer.writeSize(population_->domain()->inputs());
+  writer.writeSize(population_->domain()->outputs());
+  writer.writeSize(population_->config().rows);
+  writer.writeSize(population_->config().columns);
+
+  vector<string> function_names;
+  array<int16_t, kFunctionCount> function_codes;
+  function_codes.fill(-1);
+  for (const auto& gene : function_genes_) {
+    if (gene.function >= 0 && function_codes[gene.function] < 0) {
+      function_codes[gene.function] = int16_t(function_names.size());
+      function_names.push_back(core::toString(gene.function));
+    }
+  }
+  writer.write(function_names);
+
+  writer.writeSize(function_genes_.size());
+  for (const auto& gene : function_genes_) {
+    writer.write(gene.function >= 0 ? function_codes[gene.function]
+                                    : int16_t(gene.function));
+    writer.write(gene.connections);
+  }
+
+  writer.write(output_genes_);
+  writer.write(constants_genes_);
+}
+
+void Genotype::loadBinaryPayload(core::BinaryReader& reader) {
+  const size_t inputs = reader.readSize();
+  const size_t outputs = reader.readSize();
+  const int rows = int(reader.readSize());
+  const int columns = int(reader.readSize());
+  checkShape(inputs, outputs, rows, columns);
+
+  vector<FunctionId> functions;
+  for (const auto& function_name : reader.read<vector<string>>())
+    functions.push_back(core::fromString<FunctionId>(function_name));
+
+  Genotype tmp_genotype(population_);
+  tmp_genotype.function_genes_.resize(reader.readSize());
+  for (auto& gene : tmp_genotype.function_genes_) {
+    const auto function_code = reader.read<int16_t>();
+    if (function_code >= 0) {
+      if (size_t(function_code) >= functions.size())
+        throw core::Exception("Can't load genotype, invalid function gene");
+      gene.function = functions[function_code];
+    } else {
+      gene.function = FunctionId(function_code);
+    }
+    reader.read(gene.connections);
+  }
+
+  reader.read(tmp_genotype.output_genes_);
+  reader.read(tmp_genotype.constants_genes_);
+  std::swap(*this, tmp_genotype);
+}
+
+void Genotype::checkShape(size_t inputs, size_t outputs, int rows, int columns) const {
   // check inputs & outputs count
-  const size_t inputs = json_obj.at("inputs");
-  const size_t outputs = json_obj.at("outputs");
   if (inputs != population_->domain()->inputs())
     throw core::Exception("Can't load genotype, mismatched inputs count");
   if (outputs != population_->domain()->outputs())
     throw core::Exception("Can't load genotype, mismatched outputs count");
 
   // check rows & columns count
-  const int rows = json_obj.at("rows");
-  const int columns = json_obj.at("columns");
   if (rows != population_->config().rows)
     throw core::Exception("Can't load genotype, mismatched rows count");
   if (columns != population_->config().columns)
     throw core::Exception("Can't load genotype, mismatched columns count");
-
-  // load the genotype
-  Genotype tmp_genotype(population_);
-  tmp_genotype.function_genes_ =
-      json_obj.at("function_genes").get<vector<FunctionGene>>();
-  tmp_genotype.output_genes_ = json_obj.at("output_genes").get<vector<OutputGene>>();
-  tmp_genotype.constants_genes_ = json_obj.at("constants_genes").get<vector<float>>();
-  std::swap(*this, tmp_genotype);
 }
 
 void Genotype::reset() {
@@ -203,7 +280,7 @@ void Genotype::createPrimordialSeed() {
   constants_genes_.resize(config.evolvable_constants_count);
 
   struct Predicates {
-    default_random_engine rnd{ random_device{}() };
+    rng::Generator& rnd = rng::threadGenerator();
     bool mutateConnection() { return true; }
     bool mutateFunction() { return true; }
     bool mutateOutput() { return true; }
@@ -224,7 +301,7 @@ void Genotype::createPrimordialSeed() {
 
 void Genotype::probabilisticMutation(const ProbabilisticMutation& config) {
   struct Predicates {
-    default_random_engine rnd{ random_device{}() };
+    rng::Generator& rnd = rng::threadGenerator();
     bernoulli_distribution dist_mutate_connection;
     bernoulli_distribution dist_mutate_function;
     bernoulli_distribution dist_mutate_output;
@@ -255,7 +332,7 @@ void Genotype::fixedCountMutation(const FixedCountMutation& config) {
                                    output_genes_count + constant_genes_count;
 
   struct Predicates {
-    default_random_engine rnd{ random_device{}() };
+    rng::Generator& rnd = rng::threadGenerator();
     double remaining_genes;
     double remaining_mutations;
 
@@ -313,8 +390,7 @@ static vector<T> singlePointCrossoverHelper(const vector<T>& a,
 void Genotype::inherit(const Genotype& parent1,
                        const Genotype& parent2,
                        float /*preference*/) {
-  random_device rd;
-  default_random_engine rnd(rd());
+  auto& rnd = rng::threadGenerator();
 
   function_genes_ =
       singlePointCrossoverHelper(parent1.function_genes_, parent2.function_genes_, rnd);
@@ -88,6 +88,8 @@ struct OutputGene {
 
   friend void to_json(json& json_obj, const OutputGene& gene);
   friend void from_json(const json& json_obj, OutputGene& gene);
+  friend void to_binary(core::BinaryWriter& writer, const OutputGene& gene);
+  friend void from_binary(core::BinaryReader& reader, OutputGene& gene);
   friend bool operator==(const OutputGene& a, const OutputGene& b);
 };
 
@@ -96,10 +98,14 @@ class Genotype : public darwin::Genotype {
   explicit Genotype(const Population* population);
 
   unique_ptr<darwin::Brain> grow() const override;
+  unique_ptr<darwin::BatchBrain> growBatch(size_t size) const override;
+  bool supportsBatch() const override { return true; }
   unique_ptr<darwin::Genotype> clone() const override;
 
   json save() const override;
   void load(const json& json_obj) override;
+  void saveBinaryPayload(core::BinaryWriter& writer) const override;
+  void loadBinaryPayload(core::BinaryReader& reader) override;
   void reset() override;
 
   void createPrimordialSeed();
@@ -121,6 +127,9 @@ class Genotype : public darwin::Genotype {
 
   pair<IndexType, IndexType> connectionRange(int layer, int levels_back) const;
 
+  // validates the shape of a loaded genotype against the population
+  void checkShape(size_t inputs, size_t outputs, int rows, int columns) const;
+
  private:
   const Population* population_ = nullptr;
 
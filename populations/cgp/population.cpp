@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "population.h"
+#include "brain.h"
 
 #include <core/evolution.h>
 #include <core/exception.h>
@@ -103,6 +104,9 @@ Population::Population(const core::PropertySet& config, const darwin::Domain& do
 
   setupAvailableFunctions();
 
+  inherit_neutral_fitness_ =
+      config_.inherit_neutral_fitness && domain.skipsInheritedFitness();
+
   switch (config_.selection_algorithm.tag()) {
     case SelectionAlgorithmType::RouletteWheel:
       selection_algorithm_ = make_unique<selection::RouletteSelection>(
@@ -135,6 +139,12 @@ void Population::createPrimordialGeneration(int population_size) {
                [](int, Genotype& genotype) { genotype.createPrimordialSeed(); });
 
   selection_algorithm_->newPopulation(this);
+
+  if (inherit_neutral_fitness_) {
+    fingerprints_.clear();
+    inheritNeutralFitness({});
+  }
+
   core::log("Ready.\n");
 }
 
@@ -158,6 +168,49 @@ void Population::createNextGeneration() {
   GenerationFactory generation_factory(this, next_generation);
   selection_algorithm_->createNextGeneration(&generation_factory);
   std::swap(genotypes_, next_generation);
+
+  if (inherit_neutral_fitness_)
+    inheritNeutralFitness(next_generation);
+}
+
+// in CGP, many mutations only touch the inactive genes, so the resulting
+// phenotype is identical to the parent's and there's no need to evaluate it again
+void Population::inheritNeutralFitness(const vector<Genotype>& prev_generation) {
+  darwin::StageScope stage("Inherit neutral fitness");
+
+  CHECK(fingerprints_.size() == prev_generation.size());
+
+  vector<uint64_t> fingerprints(genotypes_.size());
+  vector<uint8_t> inherited(genotypes_.size(), false);
+  pp::for_each(genotypes_, [&](int index, Genotype& genotype) {
+    const Brain brain(&genotype);
+    fingerprints[index] = brain.fingerprint();
+    for (int parent : genotype.genealogy.parents) {
+      // the fingerprints may collide, so a match is confirmed
+      // by comparing the active programs
+      if (fingerprints_[parent] == fingerprints[index] &&
+          brain.samePhenotype(Brain(&prev_generation[parent]))) {
+        genotype.fitness = prev_generation[parent].fitness;
+        inherited[index] = true;
+        break;
+      }
+    }
+  });
+
+  fitness_inherited_.assign(inherited.begin(), inherited.end());
+  inherited_fitness_count_ = std::count(inherited.begin(), inherited.end(), true);
+
+  std::swap(fingerprints_, fingerprints);
+}
+
+json Population::profileCounters() const {
+  json json_counters;
+  if (inherit_neutral_fitness_) {
+    json_counters["inherited_fitness"] = inherited_fitness_count_;
+    json_counters["inherited_fitness_rate"] =
+        double(inherited_fitness_count_) / genotypes_.size();
+  }
+  return json_counters;
 }
 
 void Population::setupAvailableFunctions() {
@@ -21,6 +21,7 @@
 #include <core/darwin.h>
 #include <core/properties.h>
 
+#include <cstdint>
 #include <memory>
 #include <vector>
 using namespace std;
@@ -44,6 +45,12 @@ class Population : public darwin::Population {
   void createPrimordialGeneration(int population_size) override;
   void createNextGeneration() override;
 
+  bool isFitnessInherited(size_t index) const override {
+    return !fitness_inherited_.empty() && fitness_inherited_[index];
+  }
+
+  json profileCounters() const override;
+
   const Config& config() const { return config_; }
   const darwin::Domain* domain() const { return domain_; }
 
@@ -51,6 +58,7 @@ class Population : public darwin::Population {
 
  private:
   void setupAvailableFunctions();
+  void inheritNeutralFitness(const vector<Genotype>& prev_generation);
 
  private:
   Config config_;
@@ -61,6 +69,16 @@ class Population : public darwin::Population {
   int generation_ = 0;
 
   vector<FunctionId> available_functions_;
+
+  // set if config_.inherit_neutral_fitness is set and the domain
+  // skips the genotypes which inherited their fitness value
+  bool inherit_neutral_fitness_ = false;
+
+  // phenotype fingerprints and inherited fitness flags for the current generation
+  // (only used if inherit_neutral_fitness_ is set)
+  vector<uint64_t> fingerprints_;
+  vector<bool> fitness_inherited_;
+  size_t inherited_fitness_count_ = 0;
 };
 
 }  // namespace cgp
@@ -0,0 +1,328 @@
+// Copyright 2019 The Darwin Neuroevolution Framework Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "arena.h"
+
+#include <core/ann_activation_functions.h>
+#include <core/ann_dynamic.h>
+#include <core/evolution.h>
+#include <core/exception.h>
+#include <core/logging.h>
+#include <core/parallel_for_each.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+using namespace std;
+
+namespace cne {
+namespace arena {
+
+// rounds up the number of floats to a multiple of the alignment
+static size_t alignedSize(size_t size) {
+  constexpr size_t kAlignedFloats = Layout::kAlignment / sizeof(float);
+  return (size + kAlignedFloats - 1) / kAlignedFloats * kAlignedFloats;
+}
+
+// updates the genealogy, reusing the existing string and vector storage
+static void setGenealogy(darwin::Genealogy& genealogy,
+                         const char* genetic_operator,
+                         initializer_list<int> parents) {
+  genealogy.genetic_operator = genetic_operator;
+  genealogy.parents.assign(parents);
+}
+
+Layout::Layout() {
+  CHECK(g_inputs > 0);
+  CHECK(g_outputs > 0);
+
+  auto addLayer = [&](size_t inputs, size_t outputs) {
+    LayerLayout layer;
+    layer.offset = stride_;
+    layer.rows = inputs + 1;
+    layer.cols = outputs;
+    layers_.push_back(layer);
+    stride_ += alignedSize(layer.rows * layer.cols);
+  };
+
+  size_t prev_size = g_inputs;
+  for (size_t size : g_config.hidden_layers) {
+    addLayer(prev_size, size);
+    prev_size = size;
+  }
+  addLayer(prev_size, g_outputs);
+}
+
+void WeightsArena::allocate(size_t slices_count, size_t stride) {
+  CHECK(stride > 0);
+  if (slices_count == slices_count_ && stride == stride_)
+    return;
+
+  const size_t size = slices_count * stride;
+  weights_.reset(static_cast<float*>(
+      ::operator new[](size * sizeof(float), align_val_t(Layout::kAlignment))));
+  std::fill(weights_.get(), weights_.get() + size, 0.0f);
+
+  slices_count_ = slices_count;
+  stride_ = stride;
+}
+
+void Genotype::bind(const Layout* layout, float* weights) {
+  CHECK(layout != nullptr);
+  CHECK(weights != nullptr);
+  layout_ = layout;
+  weights_ = weights;
+}
+
+ann::MatrixView Genotype::layer(size_t index) {
+  const auto& layer = layout_->layers()[index];
+  return { weights_ + layer.offset, layer.rows, layer.cols };
+}
+
+ann::ConstMatrixView Genotype::layer(size_t index) const {
+  const auto& layer = layout_->layers()[index];
+  return { weights_ + layer.offset, layer.rows, layer.cols };
+}
+
+unique_ptr<darwin::Brain> Genotype::grow() const {
+  return make_unique<Brain>(this);
+}
+
+unique_ptr<darwin::Genotype> Genotype::clone() const {
+  return make_unique<feedforward::Genotype>(toFeedforward());
+}
+
+json Genotype::save() const {
+  return toFeedforward().save();
+}
+
+void Genotype::load(const json& json_obj) {
+  // feedforward::Genotype::load() validates the topology
+  feedforward::Genotype tmp_genotype;
+  tmp_genotype.load(json_obj);
+  copyWeights(tmp_genotype);
+}
+
+void Genotype::saveBinaryPayload(core::BinaryWriter& writer) const {
+  toFeedforward().saveBinaryPayload(writer);
+}
+
+void Genotype::loadBinaryPayload(core::BinaryReader& reader) {
+  // feedforward::Genotype::loadBinaryPayload() validates the topology
+  feedforward::Genotype tmp_genotype;
+  tmp_genotype.loadBinaryPayload(reader);
+  copyWeights(tmp_genotype);
+}
+
+void Genotype::copyWeights(const feedforward::Genotype& genotype) {
+  // the loaded genotype may have been created with a different configuration
+  // (feedforward::Genotype only validates the layers against each other)
+  const size_t hidden_layers_count = genotype.hidden_layers.size();
+  if (hidden_layers_count + 1 != layersCount())
+    throw core::Exception("The genotype doesn't match the hidden layers configuration");
+  auto checkLayer = [&](const ann::Matrix& w, size_t index) {
+    const auto& layer = layout_->layers()[index];
+    if (w.rows != layer.rows || w.cols != layer.cols)
+      throw core::Exception("The genotype doesn't match the hidden layers configuration");
+  };
+  for (size_t i = 0; i < hidden_layers_count; ++i)
+    checkLayer(genotype.hidden_layers[i].w, i);
+  checkLayer(genotype.output_layer.w, hidden_layers_count);
+
+  for (size_t i = 0; i < hidden_layers_count; ++i) {
+    const auto& values = genotype.hidden_layers[i].w.values;
+    std::copy(values.begin(), values.end(), layer(i).begin());
+  }
+  const auto& values = genotype.output_layer.w.values;
+  std::copy(values.begin(), values.end(), layer(hidden_layers_count).begin());
+}
+
+feedforward::Genotype Genotype::toFeedforward() const {
+  feedforward::Genotype genotype;
+  genotype.fitness = fitness;
+  genotype.genealogy = genealogy;
+
+  const size_t hidden_layers_count = genotype.hidden_layers.size();
+  CHECK(hidden_layers_count + 1 == layersCount());
+  for (size_t i = 0; i < hidden_layers_count; ++i) {
+    const auto src = layer(i);
+    std::copy(src.begin(), src.end(), genotype.hidden_layers[i].w.values.begin());
+  }
+  const auto src = layer(hidden_layers_count);
+  std::copy(src.begin(), src.end(), genotype.output_layer.w.values.begin());
+
+  return genotype;
+}
+
+void Genotype::copyFrom(const Genotype& other) {
+  CHECK(layout_ == other.layout_);
+  std::copy(other.weights_, other.weights_ + layout_->stride(), weights_);
+}
+
+void Genotype::inherit(const Genotype& parent1,
+                       const Genotype& parent2,
+                       float preference) {
+  CHECK(layout_ == parent1.layout_);
+  CHECK(layout_ == parent2.layout_);
+  for (size_t i = 0; i < layersCount(); ++i) {
+    crossoverOperator(layer(i), parent1.layer(i), parent2.layer(i), preference);
+  }
+}
+
+void Genotype::mutate() {
+  for (size_t i = 0; i < layersCount(); ++i) {
+    mutationOperator(layer(i), ann::g_config.mutation_std_dev);
+  }
+}
+
+void Genotype::createPrimordialSeed() {
+  reset();
+  for (size_t i = 0; i < layersCount(); ++i) {
+    ann::randomize(layer(i));
+  }
+}
+
+Brain::Brain(const Genotype* genotype) {
+  CHECK(g_inputs > 0);
+  inputs_.resize(g_inputs);
+  const size_t layers_count = genotype->layersCount();
+  values_.resize(layers_count);
+  weights_.reserve(layers_count);
+  for (size_t i = 0; i < layers_count; ++i) {
+    weights_.push_back(genotype->layer(i));
+    values_[i].resize(weights_[i].cols);
+  }
+}
+
+void Brain::think() {
+  if (g_config.normalize_input)
+    ann::activateLayer(inputs_);
+
+  const vector<float>* prev_layer = &inputs_;
+
+  // hidden layers
+  const size_t hidden_layers_count = weights_.size() - 1;
+  for (size_t i = 0; i < hidden_layers_count; ++i) {
+    ann::evaluateLayer(*prev_layer, values_[i], weights_[i]);
+    ann::activateLayer(values_[i]);
+    prev_layer = &values_[i];
+  }
+
+  // output layer
+  auto& outputs = values_.back();
+  ann::evaluateLayer(*prev_layer, outputs, weights_.back());
+
+  if (g_config.normalize_output)
+    ann::activateLayer(outputs);
+
+  // finally, map any NaNs to +Inf
+  // (since NaNs are not valid output values)
+  for (float& output_value : outputs) {
+    if (isnan(output_value)) {
+      output_value = numeric_limits<float>::infinity();
+    }
+  }
+}
+
+void Brain::resetState() {
+  ann::reset(inputs_);
+  for (auto& values : values_)
+    ann::reset(values);
+}
+
+void Population::GenotypeFactory::createPrimordialSeed() {
+  genotype_->createPrimordialSeed();
+  setGenealogy(genotype_->genealogy, "p", {});
+}
+
+void Population::GenotypeFactory::replicate(int parent_index) {
+  genotype_->copyFrom(population_->genotypes_[parent_index]);
+  setGenealogy(genotype_->genealogy, "r", { parent_index });
+}
+
+void Population::GenotypeFactory::crossover(int parent1, int parent2, float preference) {
+  genotype_->inherit(
+      population_->genotypes_[parent1], population_->genotypes_[parent2], preference);
+  setGenealogy(genotype_->genealogy, "c", { parent1, parent2 });
+}
+
+void Population::GenotypeFactory::mutate() {
+  genotype_->mutate();
+  genotype_->genealogy.genetic_operator += "m";
+}
+
+void Population::GenerationFactory::init(Population* population,
+                                         vector<Genotype>& next_generation) {
+  factories_.resize(next_generation.size());
+  for (size_t i = 0; i < factories_.size(); ++i) {
+    factories_[i].init(population, &next_generation[i]);
+  }
+}
+
+Population::Population() : selection_algorithm_(createSelectionAlgorithm()) {}
+
+vector<size_t> Population::rankingIndex() const {
+  vector<size_t> ranking_index(genotypes_.size());
+  for (size_t i = 0; i < ranking_index.size(); ++i) {
+    ranking_index[i] = i;
+  }
+  // sort results by fitness (descending order)
+  std::sort(ranking_index.begin(), ranking_index.end(), [&](size_t a, size_t b) {
+    return genotypes_[a].fitness > genotypes_[b].fitness;
+  });
+  return ranking_index;
+}
+
+void Population::createPrimordialGeneration(int population_size) {
+  core::log("Resetting evolution ...\n");
+
+  darwin::StageScope stage("Create primordial generation");
+
+  generation_ = 0;
+
+  // allocate the arenas and bind the genotypes
+  // (this is the only place where the population allocates memory)
+  genotypes_.resize(population_size);
+  next_generation_.resize(population_size);
+  arenas_[0].allocate(population_size, layout_.stride());
+  arenas_[1].allocate(population_size, layout_.stride());
+  for (int i = 0; i < population_size; ++i) {
+    genotypes_[i].bind(&layout_, arenas_[0].slice(i));
+    next_generation_[i].bind(&layout_, arenas_[1].slice(i));
+  }
+
+  pp::for_each(genotypes_,
+               [](int, Genotype& genotype) { genotype.createPrimordialSeed(); });
+
+  selection_algorithm_->newPopulation(this);
+  core::log("Ready.\n");
+}
+
+void Population::createNextGeneration() {
+  darwin::StageScope stage("Create next generation");
+
+  ++generation_;
+
+  for (auto& genotype : next_generation_)
+    genotype.reset();
+
+  generation_factory_.init(this, next_generation_);
+  selection_algorithm_->createNextGeneration(&generation_factory_);
+
+  // swap the arenas (the genotypes stay bound to their slices)
+  std::swap(genotypes_, next_generation_);
+}
+
+}  // namespace arena
+}  // namespace cne
@@ -0,0 +1,215 @@
+// Copyright 2019 The Darwin Neuroevolution Framework Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "cne.h"
+#include "feedforward.h"
+
+#include <core/ann_utils.h>
+#include <core/utils.h>
+#include <core/darwin.h>
+#include <core/selection_algorithm.h>
+
+#include <memory>
+#include <new>
+#include <vector>
+using namespace std;
+
+// Feedforward CNE population backed by a contiguous weights arena
+//
+// All the weights of all the genotypes are stored in a single aligned
+// memory block (genotype i = fixed-stride slice). Two arenas are used,
+// for the current and the next generation, so no memory is allocated
+// after the primordial generation. The genotypes and the brains are views
+// over the arena slices.
+//
+// The genotypes are compatible with cne::feedforward::Genotype (same topology,
+// same JSON representation)
+//
+namespace cne {
+namespace arena {
+
+// the location and size of a layer's weights in a genotype slice
+// (the weights matrix is w[INPUTS+1][OUTPUTS], same as feedforward::Gene)
+struct LayerLayout {
+  size_t offset = 0;
+  size_t rows = 0;
+  size_t cols = 0;
+};
+
+// the layout of a genotype slice, based on the current configuration
+// (g_inputs, g_outputs and Config::hidden_layers)
+class Layout {
+ public:
+  // the slices and the layers are aligned to cache lines
+  static constexpr size_t kAlignment = 64;
+
+  Layout();
+
+  // the last layer is the output layer
+  const vector<LayerLayout>& layers() const { return layers_; }
+
+  // the size of a genotype slice (number of floats, including padding)
+  size_t stride() const { return stride_; }
+
+ private:
+  vector<LayerLayout> layers_;
+  size_t stride_ = 0;
+};
+
+// a contiguous, aligned block of weights for a fixed number of genotypes
+class WeightsArena : public core::NonCopyable {
+  struct Deleter {
+    void operator()(float* weights) const {
+      ::operator delete[](weights, align_val_t(Layout::kAlignment));
+    }
+  };
+
+ public:
+  void allocate(size_t slices_count, size_t stride);
+
+  size_t slicesCount() const { return slices_count_; }
+
+  float* slice(size_t index) const {
+    CHECK(index < slices_count_);
+    return weights_.get() + index * stride_;
+  }
+
+ private:
+  unique_ptr<float[], Deleter> weights_;
+  size_t slices_count_ = 0;
+  size_t stride_ = 0;
+};
+
+class Genotype : public darwin::Genotype {
+ public:
+  // binds the genotype to a weights slice
+  void bind(const Layout* layout, float* weights);
+
+  size_t layersCount() const { return layout_->layers().size(); }
+
+  ann::MatrixView layer(size_t index);
+  ann::ConstMatrixView layer(size_t index) const;
+
+  unique_ptr<darwin::Brain> grow() const override;
+
+  // the clone is a standalone feedforward::Genotype (not referencing the arena)
+  unique_ptr<darwin::Genotype> clone() const override;
+
+  json save() const override;
+  void load(const json& json_obj) override;
+
+  // same encoding as the equivalent feedforward::Genotype
+  void saveBinaryPayload(core::BinaryWriter& writer) const override;
+  void loadBinaryPayload(core::BinaryReader& reader) override;
+
+  // copies the weights from another genotype (the genotypes must share the layout)
+  void copyFrom(const Genotype& other);
+
+  void inherit(const Genotype& parent1, const Genotype& parent2, float preference);
+  void mutate();
+  void createPrimordialSeed();
+
+  feedforward::Genotype toFeedforward() const;
+
+ private:
+  void copyWeights(const feedforward::Genotype& genotype);
+
+ private:
+  const Layout* layout_ = nullptr;
+  float* weights_ = nullptr;
+};
+
+class Brain : public darwin::Brain {
+ public:
+  explicit Brain(const Genotype* genotype);
+
+  void setInput(int index, float value) override { inputs_[index] = value; }
+
+  float output(int index) const override { return values_.back()[index]; }
+
+  void think() override;
+  void resetState() override;
+
+ private:
+  vector<float> inputs_;
+
+  // one entry per layer (the last one is the output layer)
+  vector<vector<float>> values_;
+  vector<ann::ConstMatrixView> weights_;
+};
+
+class Population : public darwin::Population {
+  class GenotypeFactory : public selection::GenotypeFactory {
+   public:
+    void init(Population* population, Genotype* genotype) {
+      population_ = population;
+      genotype_ = genotype;
+    }
+
+    void createPrimordialSeed() override;
+    void replicate(int parent_index) override;
+    void crossover(int parent1, int parent2, float preference) override;
+    void mutate() override;
+
+   private:
+    Population* population_ = nullptr;
+    Genotype* genotype_ = nullptr;
+  };
+
+  class GenerationFactory : public selection::GenerationFactory {
+   public:
+    // binds the factories to the next generation genotypes
+    // (doesn't allocate memory, except for the first call)
+    void init(Population* population, vector<Genotype>& next_generation);
+
+    size_t size() const override { return factories_.size(); }
+    GenotypeFactory* operator[](size_t index) override { return &factories_[index]; }
+
+   private:
+    vector<GenotypeFactory> factories_;
+  };
+
+ public:
+  Population();
+
+  size_t size() const override { return genotypes_.size(); }
+
+  int generation() const override { return generation_; }
+
+  Genotype* genotype(size_t index) override { return &genotypes_[index]; }
+  const Genotype* genotype(size_t index) const override { return &genotypes_[index]; }
+
+  vector<size_t> rankingIndex() const override;
+  void createPrimordialGeneration(int population_size) override;
+  void createNextGeneration() override;
+
+ private:
+  const Layout layout_;
+
+  // the genotypes in the current and the next generation
+  // (each set is bound to one of the arenas)
+  vector<Genotype> genotypes_;
+  vector<Genotype> next_generation_;
+  WeightsArena arenas_[2];
+
+  GenerationFactory generation_factory_;
+  int generation_ = 0;
+
+  unique_ptr<selection::SelectionAlgorithm> selection_algorithm_;
+};
+
+}  // namespace arena
+}  // namespace cne
@@ -0,0 +1,39 @@
+// Copyright 2019 The Darwin Neuroevolution Framework Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "batch_brain.h"
+
+namespace cne {
+
+vector<float> packBatch(const vector<ann::ConstMatrixView>& matrices) {
+  CHECK(!matrices.empty());
+  const size_t rows = matrices[0].rows;
+  const size_t cols = matrices[0].cols;
+  const size_t group_size = rows * cols * kBatchLanes;
+
+  vector<float> packed(batchGroups(matrices.size()) * group_size);
+  for (size_t index = 0; index < matrices.size(); ++index) {
+    const auto& matrix = matrices[index];
+    CHECK(matrix.rows == rows && matrix.cols == cols);
+
+    float* group_values = packed.data() + (index / kBatchLanes) * group_size;
+    const size_t lane = index % kBatchLanes;
+    for (size_t i = 0; i < rows; ++i)
+      for (size_t j = 0; j < cols; ++j)
+        group_values[(i * cols + j) * kBatchLanes + lane] = matrix[i][j];
+  }
+  return packed;
+}
+
+}  // namespace cne
@@ -0,0 +1,179 @@
+// Copyright 2019 The Darwin Neuroevolution Framework Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "cne.h"
+
+#include <core/ann_dynamic.h>
+#include <core/darwin.h>
+#include <core/utils.h>
+
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
+using namespace std;
+
+namespace cne {
+
+constexpr size_t kBatchLanes = ann::kBatchLanes;
+
+// the number of lane groups needed for a batch
+inline size_t batchGroups(size_t batch_size) {
+  return (batch_size + kBatchLanes - 1) / kBatchLanes;
+}
+
+// packs a set of matrices (one per genotype, same dimensions) into the
+// lane-interleaved layout used by the batched kernels:
+// packed[group][row][col][lane], the unused lanes are zero padded
+vector<float> packBatch(const vector<ann::ConstMatrixView>& matrices);
+
+// packs one of the weight matrices from a set of genes (ex. packBatch(genes, &Gene::w))
+template <class GENE, class BASE>
+vector<float> packBatch(const vector<const GENE*>& genes,
+                        const ann::Matrix BASE::*matrix) {
+  vector<ann::ConstMatrixView> matrices;
+  matrices.reserve(genes.size());
+  for (const GENE* gene : genes)
+    matrices.push_back(gene->*matrix);
+  return packBatch(matrices);
+}
+
+// base class for batched, fully connected ANN layers
+//
+// the values for all the genotypes in the batch are interleaved,
+// values[group][neuron][lane]
+// (genotype i => group = i / kBatchLanes, lane = i % kBatchLanes)
+//
+struct BatchAnnLayer {
+  size_t size = 0;
+  size_t groups = 0;
+  vector<float> values;
+
+  BatchAnnLayer(size_t size, size_t groups)
+      : size(size), groups(groups), values(groups * size * kBatchLanes) {}
+
+  virtual ~BatchAnnLayer() = default;
+
+  virtual void evaluate(const vector<float>& inputs) = 0;
+  virtual void resetState() = 0;
+};
+
+// the batched counterpart of cne::Brain
+template <class TRAITS>
+class BatchBrain : public darwin::BatchBrain {
+  using Genotype = typename TRAITS::Genotype;
+  using HiddenLayerGene = typename decltype(Genotype::hidden_layers)::value_type;
+  using OutputLayerGene = decltype(Genotype::output_layer);
+  using HiddenLayer = typename TRAITS::HiddenBatchLayer;
+  using OutputLayer = typename TRAITS::OutputBatchLayer;
+
+ public:
+  BatchBrain(const Genotype* genotypes, size_t count)
+      : size_(count), output_layer_(outputGenes(genotypes, count)) {
+    CHECK(g_inputs > 0);
+    CHECK(count > 0);
+    inputs_.resize(batchGroups(count) * g_inputs * kBatchLanes);
+
+    const size_t hidden_layers_count = genotypes[0].hidden_layers.size();
+    hidden_layers_.reserve(hidden_layers_count);
+    for (size_t layer = 0; layer < hidden_layers_count; ++layer) {
+      vector<const HiddenLayerGene*> genes(count);
+      for (size_t i = 0; i < count; ++i)
+        genes[i] = &genotypes[i].hidden_layers[layer];
+      hidden_layers_.emplace_back(genes);
+    }
+  }
+
+  size_t size() const override { return size_; }
+
+  void setInputs(int batch_index, const float* values) override {
+    const size_t group = batch_index / kBatchLanes;
+    const size_t lane = batch_index % kBatchLanes;
+    float* group_inputs = inputs_.data() + group * g_inputs * kBatchLanes;
+    for (size_t i = 0; i < g_inputs; ++i)
+      group_inputs[i * kBatchLanes + lane] = values[i];
+  }
+
+  float output(int batch_index, int index) const override {
+    const size_t group = batch_index / kBatchLanes;
+    const size_t lane = batch_index % kBatchLanes;
+    const size_t outputs = output_layer_.size;
+    return output_layer_.values[(group * outputs + index) * kBatchLanes + lane];
+  }
+
+  void thinkBatch() override {
+    if (g_config.normalize_input)
+      ann::activateLayer(inputs_);
+
+    vector<float>* prev_layer = &inputs_;
+
+    for (auto& layer : hidden_layers_) {
+      layer.evaluate(*prev_layer);
+
+      if (TRAITS::kNormalizeHiddenLayers)
+        ann::activateLayer(layer.values);
+
+      prev_layer = &layer.values;
+    }
+
+    output_layer_.evaluate(*prev_layer);
+
+    if (g_config.normalize_output)
+      ann::activateLayer(output_layer_.values);
+
+    // finally, map any NaNs to +Inf
+    // (since NaNs are not valid output values)
+    for (float& output_value : output_layer_.values) {
+      if (isnan(output_value)) {
+        output_value = numeric_limits<float>::infinity();
+      }
+    }
+  }
+
+  void resetState() override {
+    ann::reset(inputs_);
+    for (auto& layer : hidden_layers_)
+      layer.resetState();
+    output_layer_.resetState();
+  }
+
+ private:
+  static auto outputGenes(const Genotype* genotypes, size_t count) {
+    vector<const OutputLayerGene*> genes(count);
+    for (size_t i = 0; i < count; ++i)
+      genes[i] = &genotypes[i].output_layer;
+    return genes;
+  }
+
+ private:
+  size_t size_ = 0;
+  vector<float> inputs_;
+  vector<HiddenLayer> hidden_layers_;
+  OutputLayer output_layer_;
+};
+
+// batched evaluation is not supported by default
+template <class GENOTYPE>
+unique_ptr<darwin::BatchBrain> growBatchBrain(const GENOTYPE*, size_t) {
+  return nullptr;
+}
+
+template <class GENOTYPE>
+constexpr bool supportsBatchBrain(const GENOTYPE*) {
+  return false;
+}
+
+}  // namespace cne
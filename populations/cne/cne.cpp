@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "cne.h"
+#include "arena.h"
 #include "feedforward.h"
 #include "full_rnn.h"
 #include "lstm.h"
@@ -27,7 +28,23 @@ Config g_config;
 size_t g_inputs = 0;
 size_t g_outputs = 0;
 
-template <class GENOTYPE>
+unique_ptr<selection::SelectionAlgorithm> createSelectionAlgorithm() {
+  switch (g_config.selection_algorithm.tag()) {
+    case SelectionAlgorithmType::RouletteWheel:
+      return make_unique<selection::RouletteSelection>(
+          g_config.selection_algorithm.roulette_wheel);
+    case SelectionAlgorithmType::CgpIslands:
+      return make_unique<selection::CgpIslandsSelection>(
+          g_config.selection_algorithm.cgp_islands);
+    case SelectionAlgorithmType::Truncation:
+      return make_unique<selection::TruncationSelection>(
+          g_config.selection_algorithm.truncation);
+    default:
+      FATAL("Unexpected selection algorithm type");
+  }
+}
+
+template <class POPULATION>
 class Factory : public darwin::PopulationFactory {
   unique_ptr<darwin::Population> create(const core::PropertySet& config,
                                         const darwin::Domain& domain) override {
@@ -36,9 +53,11 @@ class Factory : public darwin::PopulationFactory {
     g_outputs = domain.outputs();
     CHECK(g_inputs > 0);
     CHECK(g_outputs > 0);
-    ann::setActivationFunction(g_config.activation_function);
-    ann::setGateActivationFunction(g_config.gate_activation_function);
-    return make_unique<Population<GENOTYPE>>();
+    ann::setActivationFunction(g_config.activation_function,
+                               g_config.activation_precision);
+    ann::setGateActivationFunction(g_config.gate_activation_function,
+                                   g_config.activation_precision);
+    return make_unique<POPULATION>();
   }
 
   unique_ptr<core::PropertySet> defaultConfig(
@@ -63,11 +82,13 @@ class Factory : public darwin::PopulationFactory {
 
 void init() {
   auto registry = darwin::registry();
-  registry->populations.add<Factory<feedforward::Genotype>>("cne.feedforward");
-  registry->populations.add<Factory<full_rnn::Genotype>>("cne.full_rnn");
-  registry->populations.add<Factory<lstm::Genotype>>("cne.lstm");
-  registry->populations.add<Factory<lstm_lite::Genotype>>("cne.lstm_lite");
-  registry->populations.add<Factory<rnn::Genotype>>("cne.rnn");
+  registry->populations.add<Factory<Population<feedforward::Genotype>>>(
+      "cne.feedforward");
+  registry->populations.add<Factory<Population<full_rnn::Genotype>>>("cne.full_rnn");
+  registry->populations.add<Factory<Population<lstm::Genotype>>>("cne.lstm");
+  registry->populations.add<Factory<Population<lstm_lite::Genotype>>>("cne.lstm_lite");
+  registry->populations.add<Factory<Population<rnn::Genotype>>>("cne.rnn");
+  registry->populations.add<Factory<arena::Population>>("cne.feedforward_arena");
 }
 
 }  // namespace cne
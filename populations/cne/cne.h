@@ -128,6 +128,11 @@ struct Config : public core::PropertySet {
            ann::ActivationFunction::Logistic,
            "Activation function used for cell gates (ex. LSTM)");
 
+  PROPERTY(activation_precision,
+           ann::ActivationPrecision,
+           ann::ActivationPrecision::Exact,
+           "Exact activation functions, or faster SIMD approximations");
+
   // mutation parameters
   PROPERTY(mutation_chance, float, 0.01f, "Mutation chance");
 
@@ -157,12 +162,16 @@ extern size_t g_inputs;
 extern size_t g_outputs;
 
 // genetic operators
-void crossoverOperator(ann::Matrix& child,
-                       const ann::Matrix& parent1,
-                       const ann::Matrix& parent2,
+// (the operands can be ann::Matrix instances or views into a weights arena)
+void crossoverOperator(ann::MatrixView child,
+                       ann::ConstMatrixView parent1,
+                       ann::ConstMatrixView parent2,
                        float preference);
 
-void mutationOperator(ann::Matrix& w, float mutation_std_dev);
+void mutationOperator(ann::MatrixView w, float mutation_std_dev);
+
+// creates the selection algorithm instance, based on g_config.selection_algorithm
+unique_ptr<selection::SelectionAlgorithm> createSelectionAlgorithm();
 
 // base class for fully connected ANN layers
 struct AnnLayer {
@@ -14,7 +14,9 @@ SOURCES += \
     lstm.cpp \
     rnn.cpp \
     full_rnn.cpp \
-    lstm_lite.cpp
+    lstm_lite.cpp \
+    arena.cpp \
+    batch_brain.cpp
 
 HEADERS += \
     cne.h \
@@ -25,6 +27,8 @@ HEADERS += \
     full_rnn.h \
     brain.h \
     lstm_lite.h \
-    genotype.h
+    genotype.h \
+    arena.h \
+    batch_brain.h
 
 addLibrary(../../core)    
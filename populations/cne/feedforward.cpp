@@ -25,6 +25,11 @@ unique_ptr<darwin::Brain> feedforward::Genotype::grow() const {
   return make_unique<feedforward::Brain>(this);
 }
 
+unique_ptr<darwin::BatchBrain> growBatchBrain(const feedforward::Genotype* genotypes,
+                                              size_t count) {
+  return make_unique<feedforward::BatchBrain>(genotypes, count);
+}
+
 namespace feedforward {
 
 Gene::Gene(size_t inputs, size_t outputs) : w(inputs + 1, outputs) {}
@@ -49,6 +54,14 @@ void from_json(const json& json_obj, Gene& gene) {
   gene.w = json_obj.at("w");
 }
 
+void to_binary(core::BinaryWriter& writer, const Gene& gene) {
+  writer.write(gene.w);
+}
+
+void from_binary(core::BinaryReader& reader, Gene& gene) {
+  reader.read(gene.w);
+}
+
 Layer::Layer(const Gene& gene) : cne::AnnLayer(gene.w.cols), w(gene.w) {}
 
 void Layer::evaluate(const vector<float>& inputs) {
@@ -59,5 +72,26 @@ void Layer::resetState() {
   ann::reset(values);
 }
 
+BatchLayer::BatchLayer(const vector<const Gene*>& genes)
+    : cne::BatchAnnLayer(genes[0]->w.cols, batchGroups(genes.size())),
+      w(packBatch(genes, &Gene::w)),
+      inputs_count(genes[0]->w.rows - 1) {}
+
+void BatchLayer::evaluate(const vector<float>& inputs) {
+  assert(inputs.size() == groups * inputs_count * kBatchLanes);
+  const size_t group_weights = (inputs_count + 1) * size * kBatchLanes;
+  for (size_t group = 0; group < groups; ++group) {
+    ann::evaluateLayerBatch(inputs.data() + group * inputs_count * kBatchLanes,
+                            values.data() + group * size * kBatchLanes,
+                            w.data() + group * group_weights,
+                            inputs_count,
+                            size);
+  }
+}
+
+void BatchLayer::resetState() {
+  ann::reset(values);
+}
+
 }  // namespace feedforward
 }  // namespace cne
@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include "batch_brain.h"
 #include "brain.h"
 #include "cne.h"
 #include "genotype.h"
@@ -43,6 +44,9 @@ struct Gene {
 
   friend void to_json(json& json_obj, const Gene& gene);
   friend void from_json(const json& json_obj, Gene& gene);
+
+  friend void to_binary(core::BinaryWriter& writer, const Gene& gene);
+  friend void from_binary(core::BinaryReader& reader, Gene& gene);
 };
 
 struct Layer : public cne::AnnLayer {
@@ -55,6 +59,17 @@ struct Layer : public cne::AnnLayer {
   void resetState() override;
 };
 
+struct BatchLayer : public cne::BatchAnnLayer {
+  explicit BatchLayer(const vector<const Gene*>& genes);
+
+  // the packed weights, w[group][INPUTS+1][OUTPUTS][lane]
+  vector<float> w;
+  size_t inputs_count = 0;
+
+  void evaluate(const vector<float>& inputs) override;
+  void resetState() override;
+};
+
 struct GenotypeTraits {
   using HiddenLayerGene = feedforward::Gene;
   using OutputLayerGene = feedforward::Gene;
@@ -66,11 +81,22 @@ struct BrainTraits {
   using Genotype = feedforward::Genotype;
   using HiddenLayer = feedforward::Layer;
   using OutputLayer = feedforward::Layer;
+  using HiddenBatchLayer = feedforward::BatchLayer;
+  using OutputBatchLayer = feedforward::BatchLayer;
 
   static constexpr bool kNormalizeHiddenLayers = true;
 };
 
 using Brain = cne::Brain<BrainTraits>;
+using BatchBrain = cne::BatchBrain<BrainTraits>;
 
 }  // namespace feedforward
+
+unique_ptr<darwin::BatchBrain> growBatchBrain(const feedforward::Genotype* genotypes,
+                                              size_t count);
+
+constexpr bool supportsBatchBrain(const feedforward::Genotype*) {
+  return true;
+}
+
 }  // namespace cne
@@ -47,11 +47,26 @@ void to_json(nlohmann::json& json_obj, const Gene& gene) {
   json_obj["rw"] = gene.rw;
 }
 
+static void checkWeights(const Gene& gene) {
+  if (gene.rw.cols != gene.w.cols || gene.rw.rows != gene.w.cols)
+    throw core::Exception("Can't load gene, inconsistent RNN weights");
+}
+
 void from_json(const json& json_obj, Gene& gene) {
   from_json(json_obj, static_cast<feedforward::Gene&>(gene));
   gene.rw = json_obj.at("rw");
-  if (gene.rw.cols != gene.w.cols || gene.rw.rows != gene.w.cols)
-    throw core::Exception("Can't load gene, inconsistent RNN weights");
+  checkWeights(gene);
+}
+
+void to_binary(core::BinaryWriter& writer, const Gene& gene) {
+  to_binary(writer, static_cast<const feedforward::Gene&>(gene));
+  writer.write(gene.rw);
+}
+
+void from_binary(core::BinaryReader& reader, Gene& gene) {
+  from_binary(reader, static_cast<feedforward::Gene&>(gene));
+  reader.read(gene.rw);
+  checkWeights(gene);
 }
 
 Layer::Layer(const Gene& gene)
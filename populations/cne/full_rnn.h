@@ -47,6 +47,9 @@ struct Gene : public feedforward::Gene {
 
   friend void to_json(json& json_obj, const Gene& gene);
   friend void from_json(const json& json_obj, Gene& gene);
+
+  friend void to_binary(core::BinaryWriter& writer, const Gene& gene);
+  friend void from_binary(core::BinaryReader& reader, Gene& gene);
 };
 
 struct Layer : public cne::AnnLayer {
@@ -15,12 +15,16 @@
 #include "cne.h"
 
 #include <core/ann_dynamic.h>
+#include <core/rng.h>
+
+#include <algorithm>
+using namespace std;
 
 namespace cne {
 
-void crossoverOperator(ann::Matrix& child,
-                       const ann::Matrix& parent1,
-                       const ann::Matrix& parent2,
+void crossoverOperator(ann::MatrixView child,
+                       ann::ConstMatrixView parent1,
+                       ann::ConstMatrixView parent2,
                        float preference) {
   const size_t rows = child.rows;
   const size_t cols = child.cols;
@@ -29,8 +33,7 @@ void crossoverOperator(ann::Matrix& child,
   CHECK(cols == parent1.cols && cols == parent2.cols);
   CHECK(rows == parent1.rows && rows == parent2.rows);
 
-  std::random_device rd;
-  std::default_random_engine rnd(rd());
+  auto& rnd = rng::threadGenerator();
   std::bernoulli_distribution dist_parent(preference);
   std::bernoulli_distribution dist_coin;
 
@@ -184,7 +187,8 @@ void crossoverOperator(ann::Matrix& child,
     } break;
 
     case CrossoverOp::BestParent: {
-      child = (preference > 0.5f) ? parent1 : parent2;
+      const auto& parent = (preference > 0.5f) ? parent1 : parent2;
+      std::copy(parent.begin(), parent.end(), child.begin());
     } break;
 
     case CrossoverOp::Randomize:
@@ -193,12 +197,11 @@ void crossoverOperator(ann::Matrix& child,
   }
 }
 
-void mutationOperator(ann::Matrix& w, float mutation_std_dev) {
+void mutationOperator(ann::MatrixView w, float mutation_std_dev) {
   const size_t rows = w.rows;
   const size_t cols = w.cols;
 
-  std::random_device rd;
-  std::default_random_engine rnd(rd());
+  auto& rnd = rng::threadGenerator();
   std::bernoulli_distribution dist_mutate(g_config.mutation_chance);
 
   switch (g_config.mutation_operator) {
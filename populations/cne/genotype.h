@@ -62,25 +62,25 @@ class Genotype : public darwin::Genotype {
     tmp_genotype.hidden_layers =
         json_obj.at("hidden_layers").get<vector<HiddenLayerGene>>();
     tmp_genotype.output_layer = json_obj.at("output_layer");
-
-    // validate the genotype topology
-    size_t prev_size = g_inputs;
-    for (const auto& layer : tmp_genotype.hidden_layers) {
-      if (prev_size + 1 != layer.w.rows)
-        throw core::Exception("Can't load genotype, invalid topology");
-      prev_size = layer.w.cols;
-      if (prev_size == 0)
-        throw core::Exception("Can't load genotype, invalid topology");
-    }
-    if (prev_size + 1 != tmp_genotype.output_layer.w.rows)
-      throw core::Exception("Can't load genotype, invalid topology");
-    if (tmp_genotype.output_layer.w.cols != g_outputs)
-      throw core::Exception("Can't load genotype, invalid topology");
+    tmp_genotype.checkTopology();
 
     // if everything went well, replace the genotype with the loaded one
     std::swap(*this, tmp_genotype);
   }
 
+  void saveBinaryPayload(core::BinaryWriter& writer) const override {
+    writer.write(hidden_layers);
+    writer.write(output_layer);
+  }
+
+  void loadBinaryPayload(core::BinaryReader& reader) override {
+    Genotype tmp_genotype;
+    reader.read(tmp_genotype.hidden_layers);
+    reader.read(tmp_genotype.output_layer);
+    tmp_genotype.checkTopology();
+    std::swap(*this, tmp_genotype);
+  }
+
   unique_ptr<darwin::Brain> grow() const override;
 
   void inherit(const Genotype& parent1, const Genotype& parent2, float preference) {
@@ -111,6 +111,23 @@ class Genotype : public darwin::Genotype {
     }
     output_layer.randomize();
   }
+
+ private:
+  // validates the topology of a loaded genotype
+  void checkTopology() const {
+    size_t prev_size = g_inputs;
+    for (const auto& layer : hidden_layers) {
+      if (prev_size + 1 != layer.w.rows)
+        throw core::Exception("Can't load genotype, invalid topology");
+      prev_size = layer.w.cols;
+      if (prev_size == 0)
+        throw core::Exception("Can't load genotype, invalid topology");
+    }
+    if (prev_size + 1 != output_layer.w.rows)
+      throw core::Exception("Can't load genotype, invalid topology");
+    if (output_layer.w.cols != g_outputs)
+      throw core::Exception("Can't load genotype, invalid topology");
+  }
 };
 
 }  // namespace cne
@@ -26,24 +26,38 @@ unique_ptr<darwin::Brain> lstm::Genotype::grow() const {
   return make_unique<lstm::Brain>(this);
 }
 
+unique_ptr<darwin::BatchBrain> growBatchBrain(const lstm::Genotype* genotypes,
+                                              size_t count) {
+  return make_unique<lstm::BatchBrain>(genotypes, count);
+}
+
 namespace lstm {
 
 Gene::Gene(size_t inputs, size_t outputs)
-    : feedforward::Gene(inputs, outputs), lw(outputs, Nweights) {}
+    : feedforward::Gene(inputs, outputs),
+      lw(outputs, Nweights),
+      gate_major_lw(Nweights, outputs) {}
 
 void Gene::crossover(const Gene& parent1, const Gene& parent2, float preference) {
   feedforward::Gene::crossover(parent1, parent2, preference);
   crossoverOperator(lw, parent1.lw, parent2.lw, preference);
+  updateGateMajorWeights();
 }
 
 void Gene::mutate(float mutation_std_dev) {
   feedforward::Gene::mutate(mutation_std_dev);
   mutationOperator(lw, mutation_std_dev);
+  updateGateMajorWeights();
 }
 
 void Gene::randomize() {
   feedforward::Gene::randomize();
   ann::randomize(lw);
+  updateGateMajorWeights();
+}
+
+void Gene::updateGateMajorWeights() {
+  gate_major_lw = ann::transpose(lw);
 }
 
 void to_json(nlohmann::json& json_obj, const Gene& gene) {
@@ -51,37 +65,68 @@ void to_json(nlohmann::json& json_obj, const Gene& gene) {
   json_obj["lw"] = gene.lw;
 }
 
+static void checkWeights(const Gene& gene) {
+  if (gene.lw.cols != Nweights || gene.lw.rows != gene.w.cols)
+    throw core::Exception("Can't load gene, inconsistent LSTM weights");
+}
+
 void from_json(const json& json_obj, Gene& gene) {
   from_json(json_obj, static_cast<feedforward::Gene&>(gene));
   gene.lw = json_obj.at("lw");
-  if (gene.lw.cols != Nweights || gene.lw.rows != gene.w.cols)
-    throw core::Exception("Can't load gene, inconsistent LSTM weights");
+  checkWeights(gene);
+  gene.updateGateMajorWeights();
+}
+
+void to_binary(core::BinaryWriter& writer, const Gene& gene) {
+  to_binary(writer, static_cast<const feedforward::Gene&>(gene));
+  writer.write(gene.lw);
+}
+
+void from_binary(core::BinaryReader& reader, Gene& gene) {
+  from_binary(reader, static_cast<feedforward::Gene&>(gene));
+  reader.read(gene.lw);
+  checkWeights(gene);
+  gene.updateGateMajorWeights();
+}
+
+// the gate-major LSTM weights, Nweights rows of count values each
+static ann::LstmCellWeights cellWeights(const float* lw, size_t count) {
+  ann::LstmCellWeights cell_weights = {};
+  cell_weights.wi = lw + Wi * count;
+  cell_weights.ui = lw + Ui * count;
+  cell_weights.bi = lw + Bi * count;
+  cell_weights.wf = lw + Wf * count;
+  cell_weights.uf = lw + Uf * count;
+  cell_weights.bf = lw + Bf * count;
+  cell_weights.wo = lw + Wo * count;
+  cell_weights.uo = lw + Uo * count;
+  cell_weights.bo = lw + Bo * count;
+  cell_weights.wc = lw + Wc * count;
+  cell_weights.uc = lw + Uc * count;
+  cell_weights.bc = lw + Bc * count;
+  return cell_weights;
 }
 
 Layer::Layer(const Gene& gene)
-    : cne::AnnLayer(gene.w.cols), cells(gene.w.cols), w(gene.w), lw(gene.lw) {
-  CHECK(lw.cols == Nweights);
+    : cne::AnnLayer(gene.w.cols),
+      cells(gene.w.cols),
+      feedforward_values(gene.w.cols),
+      w(gene.w),
+      lw(gene.gate_major_lw) {
+  CHECK(lw.rows == Nweights && lw.cols == w.cols);
 }
 
 void Layer::evaluate(const vector<float>& inputs) {
   assert(inputs.size() == w.rows - 1);
-  assert(values.size() == lw.rows);
+  assert(values.size() == lw.cols);
   assert(values.size() == w.cols);
 
-  const size_t bias_index = w.rows - 1;
-  for (size_t i = 0; i < w.cols; ++i) {
-    float v = w[bias_index][i];
-    for (size_t j = 0; j < bias_index; ++j)
-      v += inputs[j] * w[j][i];
-
-    const float prev = values[i];
-    float cand_C = ann::activate(lw[i][Wc] * v + lw[i][Uc] * prev + lw[i][Bc]);
-    float i_gate = ann::activateGate(lw[i][Wi] * v + lw[i][Ui] * prev + lw[i][Bi]);
-    float f_gate = ann::activateGate(lw[i][Wf] * v + lw[i][Uf] * prev + lw[i][Bf]);
-    float o_gate = ann::activateGate(lw[i][Wo] * v + lw[i][Uo] * prev + lw[i][Bo]);
-    cells[i] = f_gate * cells[i] + i_gate * cand_C;
-    values[i] = o_gate * ann::activate(cells[i]);
-  }
+  ann::evaluateLayer(inputs, feedforward_values, w);
+  ann::evaluateLstmCells(feedforward_values.data(),
+                         values.data(),
+                         cells.data(),
+                         cellWeights(lw.values.data(), lw.cols),
+                         values.size());
 }
 
 void Layer::resetState() {
@@ -89,5 +134,44 @@ void Layer::resetState() {
   ann::reset(cells);
 }
 
+BatchLayer::BatchLayer(const vector<const Gene*>& genes)
+    : cne::BatchAnnLayer(genes[0]->w.cols, batchGroups(genes.size())),
+      w(packBatch(genes, &Gene::w)),
+      lw(packBatch(genes, &Gene::gate_major_lw)),
+      inputs_count(genes[0]->w.rows - 1),
+      cells(values.size()),
+      feedforward_values(values.size()) {
+  CHECK(lw.size() == values.size() * Nweights);
+}
+
+void BatchLayer::evaluate(const vector<float>& inputs) {
+  assert(inputs.size() == groups * inputs_count * kBatchLanes);
+  const size_t group_weights = (inputs_count + 1) * size * kBatchLanes;
+  for (size_t group = 0; group < groups; ++group) {
+    ann::evaluateLayerBatch(inputs.data() + group * inputs_count * kBatchLanes,
+                            feedforward_values.data() + group * size * kBatchLanes,
+                            w.data() + group * group_weights,
+                            inputs_count,
+                            size);
+  }
+
+  // the lane-interleaved values of a group are [OUTPUTS][lane], and each gate-major
+  // weights row is [OUTPUTS][lane] as well, so the lanes are just more cells
+  const size_t group_cells = size * kBatchLanes;
+  for (size_t group = 0; group < groups; ++group) {
+    const size_t offset = group * group_cells;
+    ann::evaluateLstmCells(feedforward_values.data() + offset,
+                           values.data() + offset,
+                           cells.data() + offset,
+                           cellWeights(lw.data() + offset * Nweights, group_cells),
+                           group_cells);
+  }
+}
+
+void BatchLayer::resetState() {
+  ann::reset(values);
+  ann::reset(cells);
+}
+
 }  // namespace lstm
 }  // namespace cne
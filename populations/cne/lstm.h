@@ -36,6 +36,10 @@ struct Gene : public feedforward::Gene {
   //  lw[i][j]    : i = output neuron
   ann::Matrix lw;
 
+  // the LSTM weights, transposed to the gate-major layout: lw[lstm::Nweights][OUTPUTS]
+  // (shared by all the brains grown from this gene)
+  ann::Matrix gate_major_lw;
+
   Gene() = default;
   Gene(size_t inputs, size_t outputs);
 
@@ -43,8 +47,14 @@ struct Gene : public feedforward::Gene {
   void mutate(float mutation_std_dev);
   void randomize();
 
+  // must be called after lw is modified directly
+  void updateGateMajorWeights();
+
   friend void to_json(json& json_obj, const Gene& gene);
   friend void from_json(const json& json_obj, Gene& gene);
+
+  friend void to_binary(core::BinaryWriter& writer, const Gene& gene);
+  friend void from_binary(core::BinaryReader& reader, Gene& gene);
 };
 
 struct Layer : public cne::AnnLayer {
@@ -52,14 +62,37 @@ struct Layer : public cne::AnnLayer {
 
   vector<float> cells;
 
+  // the feedforward part of the values (the input to the LSTM cells)
+  vector<float> feedforward_values;
+
   // points directly to the weights in the genotype
   const ann::Matrix& w;
+
+  // points directly to the gate-major LSTM weights in the genotype
   const ann::Matrix& lw;
 
   void evaluate(const vector<float>& inputs) override;
   void resetState() override;
 };
 
+struct BatchLayer : public cne::BatchAnnLayer {
+  explicit BatchLayer(const vector<const Gene*>& genes);
+
+  // the packed weights, w[group][INPUTS+1][OUTPUTS][lane] and
+  // lw[group][lstm::Nweights][OUTPUTS][lane] (gate-major)
+  vector<float> w;
+  vector<float> lw;
+  size_t inputs_count = 0;
+
+  vector<float> cells;
+
+  // the feedforward part of the values (the input to the LSTM cells)
+  vector<float> feedforward_values;
+
+  void evaluate(const vector<float>& inputs) override;
+  void resetState() override;
+};
+
 struct GenotypeTraits {
   using HiddenLayerGene = lstm::Gene;
   using OutputLayerGene = feedforward::Gene;
@@ -71,11 +104,22 @@ struct BrainTraits {
   using Genotype = lstm::Genotype;
   using HiddenLayer = lstm::Layer;
   using OutputLayer = feedforward::Layer;
+  using HiddenBatchLayer = lstm::BatchLayer;
+  using OutputBatchLayer = feedforward::BatchLayer;
 
   static constexpr bool kNormalizeHiddenLayers = false;
 };
 
 using Brain = cne::Brain<BrainTraits>;
+using BatchBrain = cne::BatchBrain<BrainTraits>;
 
 }  // namespace lstm
+
+unique_ptr<darwin::BatchBrain> growBatchBrain(const lstm::Genotype* genotypes,
+                                              size_t count);
+
+constexpr bool supportsBatchBrain(const lstm::Genotype*) {
+  return true;
+}
+
 }  // namespace cne
@@ -30,21 +30,30 @@ unique_ptr<darwin::Brain> lstm_lite::Genotype::grow() const {
 namespace lstm_lite {
 
 Gene::Gene(size_t inputs, size_t outputs)
-    : feedforward::Gene(inputs, outputs), lw(outputs, Nweights) {}
+    : feedforward::Gene(inputs, outputs),
+      lw(outputs, Nweights),
+      gate_major_lw(Nweights, outputs) {}
 
 void Gene::crossover(const Gene& parent1, const Gene& parent2, float preference) {
   feedforward::Gene::crossover(parent1, parent2, preference);
   crossoverOperator(lw, parent1.lw, parent2.lw, preference);
+  updateGateMajorWeights();
 }
 
 void Gene::mutate(float mutation_std_dev) {
   feedforward::Gene::mutate(mutation_std_dev);
   mutationOperator(lw, mutation_std_dev);
+  updateGateMajorWeights();
 }
 
 void Gene::randomize() {
   feedforward::Gene::randomize();
   ann::randomize(lw);
+  updateGateMajorWeights();
+}
+
+void Gene::updateGateMajorWeights() {
+  gate_major_lw = ann::transpose(lw);
 }
 
 void to_json(nlohmann::json& json_obj, const Gene& gene) {
@@ -52,34 +61,56 @@ void to_json(nlohmann::json& json_obj, const Gene& gene) {
   json_obj["lw"] = gene.lw;
 }
 
+static void checkWeights(const Gene& gene) {
+  if (gene.lw.cols != Nweights || gene.lw.rows != gene.w.cols)
+    throw core::Exception("Can't load gene, inconsistent LSTM weights");
+}
+
 void from_json(const json& json_obj, Gene& gene) {
   from_json(json_obj, static_cast<feedforward::Gene&>(gene));
   gene.lw = json_obj.at("lw");
-  if (gene.lw.cols != Nweights || gene.lw.rows != gene.w.cols)
-    throw core::Exception("Can't load gene, inconsistent LSTM weights");
+  checkWeights(gene);
+  gene.updateGateMajorWeights();
+}
+
+void to_binary(core::BinaryWriter& writer, const Gene& gene) {
+  to_binary(writer, static_cast<const feedforward::Gene&>(gene));
+  writer.write(gene.lw);
+}
+
+void from_binary(core::BinaryReader& reader, Gene& gene) {
+  from_binary(reader, static_cast<feedforward::Gene&>(gene));
+  reader.read(gene.lw);
+  checkWeights(gene);
+  gene.updateGateMajorWeights();
 }
 
 Layer::Layer(const Gene& gene)
-    : cne::AnnLayer(gene.w.cols), cells(gene.w.cols), w(gene.w), lw(gene.lw) {
-  CHECK(lw.cols == Nweights);
+    : cne::AnnLayer(gene.w.cols),
+      cells(gene.w.cols),
+      feedforward_values(gene.w.cols),
+      w(gene.w),
+      lw(gene.gate_major_lw) {
+  CHECK(lw.rows == Nweights && lw.cols == w.cols);
 }
 
 void Layer::evaluate(const vector<float>& inputs) {
   assert(inputs.size() == w.rows - 1);
-  assert(values.size() == lw.rows);
+  assert(values.size() == lw.cols);
   assert(values.size() == w.cols);
 
-  const size_t bias_index = w.rows - 1;
-  for (size_t i = 0; i < w.cols; ++i) {
-    float v = w[bias_index][i];
-    for (size_t j = 0; j < bias_index; ++j)
-      v += inputs[j] * w[j][i];
-
-    float gate = ann::activateGate(lw[i][Wg] * v + lw[i][Ug] * cells[i] + lw[i][Bg]);
-    v += lw[i][Wc] * cells[i];
-    cells[i] = v * gate;
-    values[i] = ann::activate(v);
-  }
+  const size_t count = values.size();
+  const float* weights = lw.values.data();
+
+  ann::LstmLiteCellWeights cell_weights = {};
+  cell_weights.wg = weights + Wg * count;
+  cell_weights.ug = weights + Ug * count;
+  cell_weights.bg = weights + Bg * count;
+  cell_weights.wc = weights + Wc * count;
+
+  ann::evaluateLayer(inputs, feedforward_values, w);
+  ann::evaluateLstmLiteCells(
+      feedforward_values.data(), values.data(), cells.data(), cell_weights, count);
 }
 
 void Layer::resetState() {
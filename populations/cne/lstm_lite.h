@@ -39,6 +39,10 @@ struct Gene : public feedforward::Gene {
   // LSTM_Lite weights: lw[OUTPUTS][Nweights]
   ann::Matrix lw;
 
+  // the LSTM-lite weights, transposed to the gate-major layout:
+  // lw[lstm_lite::Nweights][OUTPUTS] (shared by all the brains grown from this gene)
+  ann::Matrix gate_major_lw;
+
   Gene() = default;
   Gene(size_t inputs, size_t outputs);
 
@@ -46,8 +50,14 @@ struct Gene : public feedforward::Gene {
   void mutate(float mutation_std_dev);
   void randomize();
 
+  // must be called after lw is modified directly
+  void updateGateMajorWeights();
+
   friend void to_json(json& json_obj, const Gene& gene);
   friend void from_json(const json& json_obj, Gene& gene);
+
+  friend void to_binary(core::BinaryWriter& writer, const Gene& gene);
+  friend void from_binary(core::BinaryReader& reader, Gene& gene);
 };
 
 struct Layer : public cne::AnnLayer {
@@ -55,8 +65,13 @@ struct Layer : public cne::AnnLayer {
 
   vector<float> cells;
 
+  // the feedforward part of the values (the input to the LSTM-lite cells)
+  vector<float> feedforward_values;
+
   // points directly to the weights in the genotype
   const ann::Matrix& w;
+
+  // points directly to the gate-major LSTM-lite weights in the genotype
   const ann::Matrix& lw;
 
   void evaluate(const vector<float>& inputs) override;
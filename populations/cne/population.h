@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include "batch_brain.h"
 #include "cne.h"
 
 #include <core/ann_activation_functions.h>
@@ -84,24 +85,7 @@ class Population : public darwin::Population {
   };
 
  public:
-  Population() {
-    switch (g_config.selection_algorithm.tag()) {
-      case SelectionAlgorithmType::RouletteWheel:
-        selection_algorithm_ = make_unique<selection::RouletteSelection>(
-            g_config.selection_algorithm.roulette_wheel);
-        break;
-      case SelectionAlgorithmType::CgpIslands:
-        selection_algorithm_ = make_unique<selection::CgpIslandsSelection>(
-            g_config.selection_algorithm.cgp_islands);
-        break;
-      case SelectionAlgorithmType::Truncation:
-        selection_algorithm_ = make_unique<selection::TruncationSelection>(
-            g_config.selection_algorithm.truncation);
-        break;
-      default:
-        FATAL("Unexpected selection algorithm type");
-    }
-  }
+  Population() : selection_algorithm_(createSelectionAlgorithm()) {}
 
   size_t size() const override { return genotypes_.size(); }
 
@@ -136,6 +120,16 @@ class Population : public darwin::Population {
     std::swap(genotypes_, next_generation);
   }
 
+  unique_ptr<darwin::BatchBrain> growBatch(size_t first_index,
+                                           size_t count) const override {
+    CHECK(first_index + count <= genotypes_.size());
+    return growBatchBrain(genotypes_.data() + first_index, count);
+  }
+
+  bool supportsBatch() const override {
+    return supportsBatchBrain(static_cast<const GENOTYPE*>(nullptr));
+  }
+
   vector<size_t> rankingIndex() const {
     vector<size_t> ranking_index(genotypes_.size());
     for (size_t i = 0; i < ranking_index.size(); ++i) {
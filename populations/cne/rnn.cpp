@@ -27,6 +27,11 @@ unique_ptr<darwin::Brain> rnn::Genotype::grow() const {
   return make_unique<rnn::Brain>(this);
 }
 
+unique_ptr<darwin::BatchBrain> growBatchBrain(const rnn::Genotype* genotypes,
+                                              size_t count) {
+  return make_unique<rnn::BatchBrain>(genotypes, count);
+}
+
 namespace rnn {
 
 Gene::Gene(size_t inputs, size_t outputs)
@@ -52,11 +57,26 @@ void to_json(nlohmann::json& json_obj, const Gene& gene) {
   json_obj["rw"] = gene.rw;
 }
 
+static void checkWeights(const Gene& gene) {
+  if (gene.rw.cols != gene.w.cols || gene.rw.rows != 1)
+    throw core::Exception("Can't load gene, inconsistent RNN weights");
+}
+
 void from_json(const json& json_obj, Gene& gene) {
   from_json(json_obj, static_cast<feedforward::Gene&>(gene));
   gene.rw = json_obj.at("rw");
-  if (gene.rw.cols != gene.w.cols || gene.rw.rows != 1)
-    throw core::Exception("Can't load gene, inconsistent RNN weights");
+  checkWeights(gene);
+}
+
+void to_binary(core::BinaryWriter& writer, const Gene& gene) {
+  to_binary(writer, static_cast<const feedforward::Gene&>(gene));
+  writer.write(gene.rw);
+}
+
+void from_binary(core::BinaryReader& reader, Gene& gene) {
+  from_binary(reader, static_cast<feedforward::Gene&>(gene));
+  reader.read(gene.rw);
+  checkWeights(gene);
 }
 
 Layer::Layer(const Gene& gene) : cne::AnnLayer(gene.w.cols), w(gene.w), rw(gene.rw) {
@@ -81,5 +101,34 @@ void Layer::resetState() {
   ann::reset(values);
 }
 
+BatchLayer::BatchLayer(const vector<const Gene*>& genes)
+    : cne::BatchAnnLayer(genes[0]->w.cols, batchGroups(genes.size())),
+      w(packBatch(genes, &Gene::w)),
+      rw(packBatch(genes, &Gene::rw)),
+      inputs_count(genes[0]->w.rows - 1),
+      feedforward_values(values.size()) {
+  CHECK(rw.size() == values.size());
+}
+
+void BatchLayer::evaluate(const vector<float>& inputs) {
+  assert(inputs.size() == groups * inputs_count * kBatchLanes);
+  const size_t group_weights = (inputs_count + 1) * size * kBatchLanes;
+  for (size_t group = 0; group < groups; ++group) {
+    ann::evaluateLayerBatch(inputs.data() + group * inputs_count * kBatchLanes,
+                            feedforward_values.data() + group * size * kBatchLanes,
+                            w.data() + group * group_weights,
+                            inputs_count,
+                            size);
+  }
+
+  // the packed recurrent weights have the same layout as the values
+  for (size_t i = 0; i < values.size(); ++i)
+    values[i] = feedforward_values[i] + values[i] * rw[i];
+}
+
+void BatchLayer::resetState() {
+  ann::reset(values);
+}
+
 }  // namespace rnn
 }  // namespace cne
@@ -43,6 +43,9 @@ struct Gene : public feedforward::Gene {
 
   friend void to_json(json& json_obj, const Gene& gene);
   friend void from_json(const json& json_obj, Gene& gene);
+
+  friend void to_binary(core::BinaryWriter& writer, const Gene& gene);
+  friend void from_binary(core::BinaryReader& reader, Gene& gene);
 };
 
 struct Layer : public cne::AnnLayer {
@@ -56,6 +59,21 @@ struct Layer : public cne::AnnLayer {
   void resetState() override;
 };
 
+struct BatchLayer : public cne::BatchAnnLayer {
+  explicit BatchLayer(const vector<const Gene*>& genes);
+
+  // the packed weights, w[group][INPUTS+1][OUTPUTS][lane] and rw[group][1][OUTPUTS][lane]
+  vector<float> w;
+  vector<float> rw;
+  size_t inputs_count = 0;
+
+  // the feedforward part of the values (before adding the recurrent links)
+  vector<float> feedforward_values;
+
+  void evaluate(const vector<float>& inputs) override;
+  void resetState() override;
+};
+
 struct GenotypeTraits {
   using HiddenLayerGene = rnn::Gene;
   using OutputLayerGene = rnn::Gene;
@@ -67,11 +85,22 @@ struct BrainTraits {
   using Genotype = rnn::Genotype;
   using HiddenLayer = rnn::Layer;
   using OutputLayer = rnn::Layer;
+  using HiddenBatchLayer = rnn::BatchLayer;
+  using OutputBatchLayer = rnn::BatchLayer;
 
   static constexpr bool kNormalizeHiddenLayers = true;
 };
 
 using Brain = cne::Brain<BrainTraits>;
+using BatchBrain = cne::BatchBrain<BrainTraits>;
 
 }  // namespace rnn
+
+unique_ptr<darwin::BatchBrain> growBatchBrain(const rnn::Genotype* genotypes,
+                                              size_t count);
+
+constexpr bool supportsBatchBrain(const rnn::Genotype*) {
+  return true;
+}
+
 }  // namespace cne
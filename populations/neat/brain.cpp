@@ -14,111 +14,135 @@
 
 #include "brain.h"
 
-#include <queue>
-using namespace std;
-
 namespace neat {
 
-void LstmNode::resetState() {
-  value = 0;
-  cell = 0;
-}
-
-void LstmNode::activate(float input) {
-  float cand_C = ann::activate(lw[Wc] * input + lw[Uc] * value + lw[Bc]);
-  float i_gate = ann::activateGate(lw[Wi] * input + lw[Ui] * value + lw[Bi]);
-  float f_gate = ann::activateGate(lw[Wf] * input + lw[Uf] * value + lw[Bf]);
-  float o_gate = ann::activateGate(lw[Wo] * input + lw[Uo] * value + lw[Bo]);
-  cell = f_gate * cell + i_gate * cand_C;
-  value = o_gate * ann::activate(cell);
-}
-
 Brain::Brain(const Genotype* genotype) {
   const int kFirstOutput = kFirstInput + g_inputs;
+  const size_t nodes_count = genotype->nodes_count;
 
   CHECK(g_inputs > 0);
   CHECK(g_outputs > 0);
-  CHECK(genotype->nodes_count >= kFirstOutput + g_outputs);
+  CHECK(nodes_count >= kFirstOutput + g_outputs);
 
-  nodes_ = vector<unique_ptr<Node>>(genotype->nodes_count);
-  for (auto& node : nodes_) {
-    node = g_config.use_lstm_nodes ? make_unique<LstmNode>(genotype->lw)
-                                   : make_unique<Node>();
+  values_.resize(nodes_count);
+  if (g_config.use_lstm_nodes) {
+    cells_.resize(nodes_count);
+    lw_ = genotype->lw;
   }
 
-  for (const auto& gene : genotype->genes) {
+  // group the links by the destination node (counting sort, preserving the genes order)
+  vector<uint32_t> in_offsets(nodes_count + 1);
+  for (const auto& gene : genotype->genes()) {
     CHECK(gene.out != kBiasNodeId);
-    CHECK(gene.in < nodes_.size());
-    CHECK(gene.out < nodes_.size());
-    nodes_[gene.out]->inputs.emplace_back(gene.in, gene.weight, gene.recurrent);
+    CHECK(gene.in < nodes_count);
+    CHECK(gene.out < nodes_count);
+    ++in_offsets[gene.out + 1];
   }
-
-  // topological sort, for evaluation order
-  // (calculate the _reverse_ topological sort since we only track in arcs)
-  vector<int> outs_count(nodes_.size());
-  for (const auto& node : nodes_)
-    for (const auto& link : node->inputs) {
-      if (!link.recurrent)
-        ++outs_count[link.in];
+  for (size_t i = 0; i < nodes_count; ++i)
+    in_offsets[i + 1] += in_offsets[i];
+
+  const size_t links_count = genotype->genes().size();
+  vector<const Gene*> in_links(links_count);
+  vector<uint32_t> next_in_link(in_offsets.begin(), in_offsets.end() - 1);
+  for (const auto& gene : genotype->genes())
+    in_links[next_in_link[gene.out]++] = &gene;
+
+  // the evaluation order is the genotype's topological order (which only depends on
+  // the genes, see Genotype::topologicalOrder())
+  const vector<NodeId> eval_order = genotype->topologicalOrder();
+  CHECK(eval_order.size() == nodes_count);
+
+  // finally, build the plan (with the links laid out in evaluation order)
+  plan_.reserve(nodes_count - kFirstOutput);
+  link_sources_.reserve(links_count);
+  link_weights_.reserve(links_count);
+  for (auto node_id : eval_order) {
+    // bias & input nodes must NOT be be evaluated
+    if (node_id < kFirstOutput)
+      continue;
+
+    PlanStep step = {};
+    step.node_id = uint32_t(node_id);
+    step.first_link = uint32_t(link_sources_.size());
+    for (uint32_t i = in_offsets[node_id]; i < in_offsets[node_id + 1]; ++i) {
+      link_sources_.push_back(uint32_t(in_links[i]->in));
+      link_weights_.push_back(in_links[i]->weight);
     }
+    step.last_link = uint32_t(link_sources_.size());
+    plan_.push_back(step);
+  }
+}
 
-  eval_order_.clear();
+void Brain::activateLstmNode(NodeId node_id, float input) {
+  const auto& lw = lw_;
+  const float value = values_[node_id];
+  float& cell = cells_[node_id];
 
-  queue<NodeId> top_queue;
-  for (NodeId i = 0; i < outs_count.size(); ++i)
-    if (outs_count[i] == 0)
-      top_queue.push(i);
-  CHECK(!top_queue.empty(), "can't topsort the network");
+  float cand_C = ann::activate(lw[Wc] * input + lw[Uc] * value + lw[Bc]);
 
-  while (!top_queue.empty()) {
-    NodeId node_id = top_queue.front();
-    top_queue.pop();
+  // all the gates are activated with a single call
+  float gates[] = {
+    lw[Wi] * input + lw[Ui] * value + lw[Bi],
+    lw[Wf] * input + lw[Uf] * value + lw[Bf],
+    lw[Wo] * input + lw[Uo] * value + lw[Bo],
+  };
+  ann::activateGate(gates, 3);
+
+  const float i_gate = gates[0];
+  const float f_gate = gates[1];
+  const float o_gate = gates[2];
+  cell = f_gate * cell + i_gate * cand_C;
+  values_[node_id] = o_gate * ann::activate(cell);
+}
 
-    // bias & input nodes must NOT be be evaluated
-    if (node_id >= kFirstOutput)
-      eval_order_.push_back(node_id);
-
-    for (const auto& link : nodes_[node_id]->inputs)
-      if (!link.recurrent) {
-        CHECK(outs_count[link.in] > 0);
-        if (--outs_count[link.in] == 0)
-          top_queue.push(link.in);
-      }
-  }
+template <bool LSTM>
+void Brain::evaluateNodes() {
+  const NodeId kFirstHidden = kFirstInput + g_inputs + g_outputs;
+  const bool normalize_output = g_config.normalize_output;
 
-  CHECK(eval_order_.size() == nodes_.size() - kFirstOutput);
-  CHECK(std::count(outs_count.begin(), outs_count.end(), 0) == nodes_.size());
+  // (local pointers, since the stores to values[] may alias the member vectors)
+  float* values = values_.data();
+  const uint32_t* sources = link_sources_.data();
+  const float* weights = link_weights_.data();
 
-  // order inputs -> ... -> outputs
-  std::reverse(eval_order_.begin(), eval_order_.end());
+  for (const PlanStep& step : plan_) {
+    const NodeId node_id = step.node_id;
+
+    // a single, serial sum, in the genes order
+    // (no reassociation of the floating-point additions)
+    float value = 0;
+    for (uint32_t link = step.first_link; link < step.last_link; ++link)
+      value += values[sources[link]] * weights[link];
+
+    if (normalize_output || node_id >= kFirstHidden) {
+      if constexpr (LSTM)
+        activateLstmNode(node_id, value);
+      else
+        values[node_id] = ann::activate(value);
+    } else {
+      values[node_id] = value;
+    }
+  }
 }
 
 void Brain::think() {
-  const int kFirstOutput = kFirstInput + g_inputs;
-  const int kFirstHidden = kFirstOutput + g_outputs;
+  const bool use_lstm = !cells_.empty();
 
-  nodes_[kBiasNodeId]->value = 1.0f;
+  values_[kBiasNodeId] = 1.0f;
 
   if (g_config.normalize_input) {
-    for (NodeId i = 0; i < g_inputs; ++i) {
-      const auto& node = nodes_[kFirstInput + i];
-      node->activate(node->value);
+    if (use_lstm) {
+      for (NodeId i = 0; i < g_inputs; ++i)
+        activateLstmNode(kFirstInput + i, values_[kFirstInput + i]);
+    } else {
+      ann::activate(values_.data() + kFirstInput, g_inputs);
     }
   }
 
-  for (auto node_id : eval_order_) {
-    CHECK(node_id >= kFirstOutput);
-
-    const auto& node = nodes_[node_id];
-    float value = 0;
-    for (const auto& link : node->inputs)
-      value += nodes_[link.in]->value * link.weight;
-
-    if (g_config.normalize_output || node_id >= kFirstHidden)
-      node->activate(value);
-    else
-      node->value = value;
-  }
+  if (use_lstm)
+    evaluateNodes<true>();
+  else
+    evaluateNodes<false>();
 }
 
 }  // namespace neat
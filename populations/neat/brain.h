@@ -20,43 +20,26 @@
 #include <core/ann_activation_functions.h>
 #include <core/darwin.h>
 
-namespace neat {
-
-struct Link {
-  NodeId in;
-  float weight;
-  bool recurrent;
-
-  Link(NodeId in, float weight, bool recurrent)
-      : in(in), weight(weight), recurrent(recurrent) {}
-};
-
-struct Node {
-  virtual ~Node() = default;
-
-  float value = 0;
-  vector<Link> inputs;
-
-  virtual void resetState() { value = 0; }
-  virtual void activate(float input) { value = ann::activate(input); }
-};
-
-struct LstmNode : public Node {
-  explicit LstmNode(const array<float, Nlstm>& lw) : lw(lw) {}
-
-  // LSTM weights (points directly into the genotype)
-  const array<float, Nlstm>& lw;
-
-  // LSTM state
-  float cell = 0;
-
-  void resetState() override;
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+using namespace std;
 
-  void activate(float input) override;
-};
+namespace neat {
 
 // Phenotype
+//
+// The genotype is compiled into a flat execution plan: the nodes to be evaluated,
+// in topological order, with the input links of each node stored contiguously
+// (CSR layout, the links of a plan step are [first_link, last_link))
+//
 class Brain : public darwin::Brain {
+  struct PlanStep {
+    uint32_t node_id;
+    uint32_t first_link;
+    uint32_t last_link;
+  };
+
   // see the genotype comments regarding the node numbering
   static constexpr int kFirstInput = 1;
 
@@ -66,25 +49,44 @@ class Brain : public darwin::Brain {
   // index is the input index [0, INPUTS)
   void setInput(int index, float value) override {
     CHECK(index < g_inputs);
-    nodes_[kFirstInput + index]->value = value;
+    values_[kFirstInput + index] = value;
   }
 
   // index is the output index [0, OUTPUTS)
   float output(int index) const override {
     CHECK(index < g_outputs);
-    return nodes_[kFirstInput + g_inputs + index]->value;
+    return values_[kFirstInput + g_inputs + index];
   }
 
   void think() override;
 
   void resetState() override {
-    for (const auto& node : nodes_)
-      node->resetState();
+    std::fill(values_.begin(), values_.end(), 0.0f);
+    std::fill(cells_.begin(), cells_.end(), 0.0f);
   }
 
  private:
-  vector<unique_ptr<Node>> nodes_;
-  vector<NodeId> eval_order_;
+  template <bool LSTM>
+  void evaluateNodes();
+
+  void activateLstmNode(NodeId node_id, float input);
+
+ private:
+  // the node values, indexed by NodeId
+  vector<float> values_;
+
+  // the LSTM cell states, indexed by NodeId (empty if not using LSTM nodes)
+  vector<float> cells_;
+
+  // LSTM weights (shared by all the nodes)
+  LstmWeights lw_ = {};
+
+  // the evaluated nodes (outputs and hidden nodes), in topological order
+  vector<PlanStep> plan_;
+
+  // the input links, in evaluation order
+  vector<uint32_t> link_sources_;
+  vector<float> link_weights_;
 };
 
 }  // namespace neat
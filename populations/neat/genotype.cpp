@@ -16,8 +16,21 @@
 #include "brain.h"
 #include "neat.h"
 
+#include <core/rng.h>
+
+#include <algorithm>
+#include <limits>
+
 namespace neat {
 
+// the minimum links index size (the index is kept at most half full)
+constexpr size_t kMinLinksIndexSize = 16;
+
+static size_t linkHash(NodeId in, NodeId out) {
+  const uint64_t key = (uint64_t(in) << 32) | out;
+  return size_t((key * 0x9e3779b97f4a7c15ull) >> 32);
+}
+
 Genotype::Genotype() {
   reset();
 }
@@ -31,75 +44,343 @@ void Genotype::reset() {
 
   CHECK(g_inputs > 0);
   CHECK(g_outputs > 0);
-  genes.clear();
+  genes_.clear();
   nodes_count = g_inputs + g_outputs + 1;  // fixed node IDs
   age = 0;
   lw = {};
+
+  CHECK(indexGenes());
 }
 
 // DFS search for dst, starting at src
-bool Genotype::canReach(NodeId src, NodeId dst, unordered_set<NodeId>& visited) const {
+//
+// NOTE: the links always go from a lower to a higher topological rank, so the
+//   search is limited to the nodes ranked between src and dst
+//
+bool Genotype::canReach(NodeId src, NodeId dst) const {
+  CHECK(topology_indexed_);
   if (src == dst)
     return true;
 
-  // already visited src?
-  // (excluding recurrent links we have a DAG, so multiple paths are possible)
-  if (!visited.insert(src).second)
+  const uint32_t dst_rank = node_rank_[dst];
+  if (node_rank_[src] > dst_rank)
     return false;
 
-  for (const auto& gene : genes) {
-    if (!gene.recurrent && gene.in == src && canReach(gene.out, dst, visited))
-      return true;
+  vector<bool> visited(nodes_count);
+  vector<NodeId> stack = { src };
+  visited[src] = true;
+  while (!stack.empty()) {
+    const NodeId node = stack.back();
+    stack.pop_back();
+    for (uint32_t link = first_out_link_[node]; link != 0; link = next_out_link_[link - 1]) {
+      const NodeId next = genes_[link - 1].out;
+      if (next == dst)
+        return true;
+      if (node_rank_[next] < dst_rank && !visited[next]) {
+        visited[next] = true;
+        stack.push_back(next);
+      }
+    }
   }
 
   // can't reach dst from src
   return false;
 }
 
-// DFS helper used to detect cycles
-bool Genotype::detectCycles(NodeId node_id, vector<VisitedColor>& visited) const {
-  switch (visited[node_id]) {
-    case VisitedColor::Exploring:
-      return true;
+void Genotype::addGene(const Gene& gene) {
+  CHECK(gene.innovation <= kMaxInnovation);
+
+  // the genes may have been updated through mutableGenes()
+  if (!topology_indexed_)
+    CHECK(indexGenes());
+  indexLinks();
+
+  if (genes_.empty() || genes_.back().innovation <= gene.innovation) {
+    genes_.push_back(gene);
+    indexGene(uint32_t(genes_.size() - 1));
+  } else {
+    // keep the genes sorted by innovation number
+    auto it = std::upper_bound(
+        genes_.begin(), genes_.end(), gene, [](const Gene& a, const Gene& b) {
+          return a.innovation < b.innovation;
+        });
+    genes_.insert(it, gene);
+    CHECK(indexGenes());
+  }
+}
+
+void Genotype::shiftInnovations(Innovation base, Innovation offset) {
+  // the genes with the highest innovation numbers are at the end
+  for (auto it = genes_.rbegin(); it != genes_.rend() && it->innovation >= base; ++it)
+    it->innovation += offset;
+}
+
+Gene* Genotype::findLink(NodeId in, NodeId out) {
+  // the genes may have been updated through mutableGenes()
+  if (!topology_indexed_)
+    CHECK(indexGenes());
+  indexLinks();
+
+  const size_t mask = links_index_.size() - 1;
+  for (size_t slot = linkHash(in, out) & mask; links_index_[slot] != 0;
+       slot = (slot + 1) & mask) {
+    Gene& gene = genes_[links_index_[slot] - 1];
+    if (gene.in == in && gene.out == out)
+      return &gene;
+  }
+  return nullptr;
+}
+
+vector<NodeId> Genotype::topologicalOrder() const {
+  if (topology_indexed_ && topology_canonical_ &&
+      topological_order_.size() == nodes_count) {
+    return topological_order_;
+  }
+
+  // the genes (or the nodes count) were updated directly,
+  // or the order was updated incrementally
+  Genotype indexed_genotype(*this);
+  CHECK(indexed_genotype.indexGenes(), "can't topsort the network");
+  return std::move(indexed_genotype.topological_order_);
+}
+
+bool Genotype::indexGenes() {
+  releaseLinksIndex();
+  topology_indexed_ = sortTopologically();
+  topology_canonical_ = topology_indexed_;
+  return topology_indexed_;
+}
+
+void Genotype::indexLinks() {
+  if (links_indexed_)
+    return;
+  resizeLinksIndex(genes_.size());
+  for (size_t i = 0; i < genes_.size(); ++i)
+    insertLink(uint32_t(i));
+  links_indexed_ = true;
+}
+
+void Genotype::releaseLinksIndex() {
+  links_index_.clear();
+  links_index_.shrink_to_fit();
+  links_indexed_ = false;
+}
+
+void Genotype::indexGene(uint32_t gene_index) {
+  CHECK(links_indexed_ && topology_indexed_);
+  CHECK(gene_index + 1 == genes_.size());
+  if (links_index_.size() < (gene_index + 1) * 2) {
+    resizeLinksIndex(gene_index + 1);
+    for (uint32_t i = 0; i < gene_index; ++i)
+      insertLink(i);
+  }
+  insertLink(gene_index);
+  addTopologyNodes();
+  addTopologyLink(gene_index);
+  topology_canonical_ = false;
+}
+
+void Genotype::resizeLinksIndex(size_t genes_count) {
+  size_t index_size = kMinLinksIndexSize;
+  while (index_size < genes_count * 2)
+    index_size *= 2;
+  links_index_.assign(index_size, 0);
+}
+
+void Genotype::insertLink(uint32_t gene_index) {
+  const auto& gene = genes_[gene_index];
+  const size_t mask = links_index_.size() - 1;
+  size_t slot = linkHash(gene.in, gene.out) & mask;
+  for (; links_index_[slot] != 0; slot = (slot + 1) & mask) {
+    // only the first gene for each link is indexed
+    const auto& indexed_gene = genes_[links_index_[slot] - 1];
+    if (indexed_gene.in == gene.in && indexed_gene.out == gene.out)
+      return;
+  }
+  links_index_[slot] = gene_index + 1;
+}
+
+bool Genotype::sortTopologically() {
+  first_out_link_.assign(nodes_count, 0);
+  first_in_link_.assign(nodes_count, 0);
+  next_out_link_.assign(genes_.size(), 0);
+  next_in_link_.assign(genes_.size(), 0);
+
+  vector<uint32_t> ins_count(nodes_count);
+  for (uint32_t i = 0; i < genes_.size(); ++i) {
+    const auto& gene = genes_[i];
+    CHECK(gene.in < nodes_count);
+    CHECK(gene.out < nodes_count);
+    if (!gene.recurrent) {
+      next_out_link_[i] = first_out_link_[gene.in];
+      first_out_link_[gene.in] = i + 1;
+      next_in_link_[i] = first_in_link_[gene.out];
+      first_in_link_[gene.out] = i + 1;
+      ++ins_count[gene.out];
+    }
+  }
+
+  // (the topological order also doubles as the nodes queue)
+  topological_order_.clear();
+  topological_order_.reserve(nodes_count);
+  for (NodeId node_id = 0; node_id < nodes_count; ++node_id)
+    if (ins_count[node_id] == 0)
+      topological_order_.push_back(node_id);
+
+  for (size_t i = 0; i < topological_order_.size(); ++i) {
+    const NodeId node_id = topological_order_[i];
+    for (uint32_t link = first_out_link_[node_id]; link != 0;
+         link = next_out_link_[link - 1]) {
+      const NodeId out = genes_[link - 1].out;
+      if (--ins_count[out] == 0)
+        topological_order_.push_back(out);
+    }
+  }
+
+  node_rank_.resize(nodes_count);
+  for (uint32_t rank = 0; rank < topological_order_.size(); ++rank)
+    node_rank_[topological_order_[rank]] = rank;
 
-    case VisitedColor::Visited:
-      return false;
+  // any nodes left out are part of a cycle
+  return topological_order_.size() == nodes_count;
+}
+
+// new nodes are simply appended to the topological order
+void Genotype::addTopologyNodes() {
+  while (topological_order_.size() < nodes_count) {
+    const NodeId node_id = NodeId(topological_order_.size());
+    topological_order_.push_back(node_id);
+    node_rank_.push_back(node_id);
+    first_out_link_.push_back(0);
+    first_in_link_.push_back(0);
+  }
+}
 
-    case VisitedColor::NotYetVisited:
-      visited[node_id] = VisitedColor::Exploring;
-      for (const auto& gene : genes) {
-        if (!gene.recurrent && gene.in == node_id && detectCycles(gene.out, visited))
-          return true;
+// adds a new link to the adjacency lists, and if it goes against the current
+// topological order, reorders the affected region (the Pearce-Kelly algorithm)
+void Genotype::addTopologyLink(uint32_t gene_index) {
+  CHECK(next_out_link_.size() == gene_index);
+  next_out_link_.push_back(0);
+  next_in_link_.push_back(0);
+
+  const auto& gene = genes_[gene_index];
+  CHECK(gene.in < nodes_count);
+  CHECK(gene.out < nodes_count);
+  if (gene.recurrent)
+    return;
+
+  next_out_link_[gene_index] = first_out_link_[gene.in];
+  first_out_link_[gene.in] = gene_index + 1;
+  next_in_link_[gene_index] = first_in_link_[gene.out];
+  first_in_link_[gene.out] = gene_index + 1;
+
+  const uint32_t lower_rank = node_rank_[gene.out];
+  const uint32_t upper_rank = node_rank_[gene.in];
+  if (upper_rank < lower_rank)
+    return;
+  CHECK(upper_rank != lower_rank, "unexpected non-recurrent self link");
+
+  vector<bool> visited(nodes_count);
+
+  // the nodes reachable from gene.out, ranked below gene.in
+  vector<NodeId> forward_nodes = { gene.out };
+  visited[gene.out] = true;
+  for (size_t i = 0; i < forward_nodes.size(); ++i) {
+    const NodeId node_id = forward_nodes[i];
+    for (uint32_t link = first_out_link_[node_id]; link != 0;
+         link = next_out_link_[link - 1]) {
+      const NodeId next = genes_[link - 1].out;
+      CHECK(next != gene.in, "unexpected cycle");
+      if (node_rank_[next] < upper_rank && !visited[next]) {
+        visited[next] = true;
+        forward_nodes.push_back(next);
       }
-      visited[node_id] = VisitedColor::Visited;
-      return false;
+    }
+  }
 
-    default:
-      FATAL("Unexpected visited color");
+  // the nodes reaching gene.in, ranked above gene.out
+  vector<NodeId> backward_nodes = { gene.in };
+  visited[gene.in] = true;
+  for (size_t i = 0; i < backward_nodes.size(); ++i) {
+    const NodeId node_id = backward_nodes[i];
+    for (uint32_t link = first_in_link_[node_id]; link != 0;
+         link = next_in_link_[link - 1]) {
+      const NodeId prev = genes_[link - 1].in;
+      if (node_rank_[prev] > lower_rank && !visited[prev]) {
+        visited[prev] = true;
+        backward_nodes.push_back(prev);
+      }
+    }
   }
+
+  // reassign the ranks of the affected nodes: the backward nodes first,
+  // followed by the forward nodes (each group preserving its relative order)
+  const auto by_rank = [&](NodeId a, NodeId b) { return node_rank_[a] < node_rank_[b]; };
+  std::sort(forward_nodes.begin(), forward_nodes.end(), by_rank);
+  std::sort(backward_nodes.begin(), backward_nodes.end(), by_rank);
+
+  vector<uint32_t> ranks;
+  ranks.reserve(forward_nodes.size() + backward_nodes.size());
+  for (NodeId node_id : backward_nodes)
+    ranks.push_back(node_rank_[node_id]);
+  for (NodeId node_id : forward_nodes)
+    ranks.push_back(node_rank_[node_id]);
+  std::sort(ranks.begin(), ranks.end());
+
+  size_t next_rank = 0;
+  for (NodeId node_id : backward_nodes)
+    node_rank_[node_id] = ranks[next_rank++];
+  for (NodeId node_id : forward_nodes)
+    node_rank_[node_id] = ranks[next_rank++];
+  for (uint32_t rank : ranks)
+    topological_order_[rank] = NodeId(-1);
+  for (NodeId node_id : backward_nodes)
+    topological_order_[node_rank_[node_id]] = node_id;
+  for (NodeId node_id : forward_nodes)
+    topological_order_[node_rank_[node_id]] = node_id;
+}
+
+size_t Genotype::memoryUsage() const {
+  return sizeof(*this) + genes_.capacity() * sizeof(Gene) + indexMemoryUsage();
+}
+
+size_t Genotype::indexMemoryUsage() const {
+  return links_index_.capacity() * sizeof(uint32_t) +
+         (first_out_link_.capacity() + first_in_link_.capacity() +
+          next_out_link_.capacity() + next_in_link_.capacity()) *
+             sizeof(uint32_t) +
+         topological_order_.capacity() * sizeof(NodeId) +
+         node_rank_.capacity() * sizeof(uint32_t);
 }
 
 void to_json(nlohmann::json& json_obj, const Gene& gene) {
-  json_obj["innovation"] = gene.innovation;
-  json_obj["in"] = gene.in;
-  json_obj["out"] = gene.out;
+  json_obj["innovation"] = Innovation(gene.innovation);
+  json_obj["in"] = NodeId(gene.in);
+  json_obj["out"] = NodeId(gene.out);
   json_obj["weight"] = gene.weight;
-  json_obj["enabled"] = gene.enabled;
-  json_obj["recurrent"] = gene.recurrent;
+  json_obj["enabled"] = bool(gene.enabled);
+  json_obj["recurrent"] = bool(gene.recurrent);
 }
 
 void from_json(const json& json_obj, Gene& gene) {
-  gene.innovation = json_obj.at("innovation");
-  gene.in = json_obj.at("in");
-  gene.out = json_obj.at("out");
+  const Innovation innovation = json_obj.at("innovation");
+  if (innovation > kMaxInnovation)
+    throw core::Exception("Invalid innovation number");
+  const NodeId in = json_obj.at("in");
+  const NodeId out = json_obj.at("out");
+  if (in > kMaxNodeId || out > kMaxNodeId)
+    throw core::Exception("Invalid gene");
+  gene.innovation = innovation;
+  gene.in = in;
+  gene.out = out;
   gene.weight = json_obj.at("weight");
-  gene.enabled = json_obj.at("enabled");
-  gene.recurrent = json_obj.at("recurrent");
+  gene.enabled = json_obj.at("enabled").get<bool>();
+  gene.recurrent = json_obj.at("recurrent").get<bool>();
 }
 
 json Genotype::save() const {
   json json_obj;
-  json_obj["genes"] = genes;
+  json_obj["genes"] = genes_;
   json_obj["nodes_count"] = nodes_count;
   json_obj["lw"] = lw;
   json_obj["inputs"] = g_inputs;
@@ -111,37 +392,98 @@ json Genotype::save() const {
 void Genotype::load(const json& json_obj) {
   // load the genotype
   Genotype tmp_genotype;
-  tmp_genotype.genes = json_obj.at("genes").get<vector<Gene>>();
+  tmp_genotype.genes_ = json_obj.at("genes").get<vector<Gene>>();
   tmp_genotype.nodes_count = json_obj.at("nodes_count");
   tmp_genotype.lw = json_obj.at("lw");
+  tmp_genotype.checkLoadedGenotype(
+      json_obj.at("inputs"), json_obj.at("outputs"), json_obj.at("lstm"));
+  std::swap(*this, tmp_genotype);
+}
+
+// the genes are mostly small integers, so they use variable length encoding
+void to_binary(core::BinaryWriter& writer, const Gene& gene) {
+  writer.writeSize(gene.innovation);
+  writer.writeSize(gene.in);
+  writer.writeSize(gene.out);
+  writer.write(gene.weight);
+  writer.write(uint8_t(gene.enabled | gene.recurrent << 1));
+}
+
+void from_binary(core::BinaryReader& reader, Gene& gene) {
+  const size_t innovation = reader.readSize();
+  if (innovation > kMaxInnovation)
+    throw core::Exception("Invalid innovation number");
+  gene.innovation = Innovation(innovation);
+  const size_t in = reader.readSize();
+  const size_t out = reader.readSize();
+  if (in > kMaxNodeId || out > kMaxNodeId)
+    throw core::Exception("Invalid gene");
+  gene.in = NodeId(in);
+  gene.out = NodeId(out);
+  reader.read(gene.weight);
+  const auto flags = reader.read<uint8_t>();
+  if (flags > 3)
+    throw core::Exception("Invalid gene");
+  gene.enabled = flags & 1;
+  gene.recurrent = (flags >> 1) & 1;
+}
+
+void Genotype::saveBinaryPayload(core::BinaryWriter& writer) const {
+  writer.writeSize(g_inputs);
+  writer.writeSize(g_outputs);
+  writer.write(g_config.use_lstm_nodes);
+  writer.writeSize(nodes_count);
+  writer.write(genes_);
+  writer.write(lw);
+}
+
+void Genotype::loadBinaryPayload(core::BinaryReader& reader) {
+  const int inputs = int(reader.readSize());
+  const int outputs = int(reader.readSize());
+  const bool lstm = reader.read<bool>();
+
+  Genotype tmp_genotype;
+  tmp_genotype.nodes_count = reader.readSize();
+  reader.read(tmp_genotype.genes_);
+  reader.read(tmp_genotype.lw);
+  tmp_genotype.checkLoadedGenotype(inputs, outputs, lstm);
+  std::swap(*this, tmp_genotype);
+}
 
+void Genotype::checkLoadedGenotype(int inputs, int outputs, bool lstm) {
   // check inputs & outputs count
-  const int tmp_inputs = json_obj.at("inputs");
-  const int tmp_outputs = json_obj.at("outputs");
-  if (tmp_inputs != g_inputs || tmp_outputs != g_outputs)
+  if (inputs != g_inputs || outputs != g_outputs)
     throw core::Exception("Can't load genotype, mismatched inputs or outputs count");
-  if (tmp_genotype.nodes_count < kFirstInput + g_inputs + g_outputs)
+  if (nodes_count < kFirstInput + g_inputs + g_outputs)
+    throw core::Exception("Can't load genotype, invalid nodes count");
+  if (nodes_count > size_t(kMaxNodeId) + 1)
     throw core::Exception("Can't load genotype, invalid nodes count");
 
   // the genotype must be compatible with the current population configuration
-  if (json_obj.at("lstm") != g_config.use_lstm_nodes)
+  if (lstm != g_config.use_lstm_nodes)
     throw core::Exception("Can't load genotype, not matching the population config");
 
   // check all the node ids
-  for (const auto& gene : tmp_genotype.genes) {
-    if (gene.in >= tmp_genotype.nodes_count || gene.out >= tmp_genotype.nodes_count)
+  NodeId max_node_id = kFirstInput + g_inputs + g_outputs - 1;
+  for (const auto& gene : genes_) {
+    if (gene.in >= nodes_count || gene.out >= nodes_count)
       throw core::Exception("Can't load genotype, invalid gene");
+    max_node_id = max(max_node_id, NodeId(max(gene.in, gene.out)));
   }
 
-  // check genotype topology: no cycles (excluding the genes marked as recurrent)
-  vector<VisitedColor> visited(tmp_genotype.nodes_count, VisitedColor::NotYetVisited);
-  for (NodeId node_id = 0; node_id < tmp_genotype.nodes_count; ++node_id) {
-    CHECK(visited[node_id] != VisitedColor::Exploring);
-    if (tmp_genotype.detectCycles(node_id, visited))
-      throw core::Exception("Can't load genotype, cycle detected");
-  }
+  // every hidden node is created with a link to it, so the nodes count is bounded
+  // by the gene node ids (this also bounds the memory allocated for the indexes)
+  if (nodes_count > size_t(max_node_id) + 1)
+    throw core::Exception("Can't load genotype, invalid nodes count");
 
-  std::swap(*this, tmp_genotype);
+  // older genotypes may not have the genes sorted by innovation number
+  std::stable_sort(genes_.begin(), genes_.end(), [](const Gene& a, const Gene& b) {
+    return a.innovation < b.innovation;
+  });
+
+  // check genotype topology: no cycles (excluding the genes marked as recurrent)
+  if (!indexGenes())
+    throw core::Exception("Can't load genotype, cycle detected");
 }
 
 Innovation Genotype::createPrimordialSeed() {
@@ -151,22 +493,21 @@ Innovation Genotype::createPrimordialSeed() {
 
   const float range = ann::g_config.connection_range;
 
-  std::random_device rd;
-  std::default_random_engine rnd(rd());
+  auto& rnd = rng::threadGenerator();
   std::uniform_real_distribution<float> dist(-range, range);
 
   Innovation innovation = 1;
 
   for (int out = 0; out < g_outputs; ++out) {
     for (int in = 0; in < g_inputs; ++in)
-      genes.emplace_back(kFirstInput + in,
-                         kFirstOutput + out,
-                         ann::roundWeight(dist(rnd)),
-                         innovation++);
+      addGene(Gene(kFirstInput + in,
+                   kFirstOutput + out,
+                   ann::roundWeight(dist(rnd)),
+                   innovation++));
 
     if (g_config.implicit_bias_links)
-      genes.emplace_back(
-          kBiasNodeId, kFirstOutput + out, ann::roundWeight(dist(rnd)), innovation++);
+      addGene(Gene(
+          kBiasNodeId, kFirstOutput + out, ann::roundWeight(dist(rnd)), innovation++));
 
     if (g_config.recurrent_output_nodes) {
       Gene self_link(kFirstOutput + out,
@@ -174,7 +515,7 @@ Innovation Genotype::createPrimordialSeed() {
                      ann::roundWeight(dist(rnd)),
                      innovation++);
       self_link.recurrent = true;
-      genes.push_back(self_link);
+      addGene(self_link);
     }
   }
 
@@ -182,13 +523,18 @@ Innovation Genotype::createPrimordialSeed() {
     for (float& w : lw)
       w = ann::roundWeight(dist(rnd));
 
+  // the topological order is also the evaluation order, so it must not depend
+  // on the order the genes were added in
+  if (!topology_canonical_)
+    CHECK(indexGenes());
+  releaseLinksIndex();
+
   // return the next available innovation number
   return innovation;
 }
 
 void Genotype::mutate(atomic<Innovation>& next_innovation, bool weights_only) {
-  std::random_device rd;
-  std::default_random_engine rnd(rd());
+  auto& rnd = rng::threadGenerator();
 
   mutateWeights(rnd);
 
@@ -196,6 +542,12 @@ void Genotype::mutate(atomic<Innovation>& next_innovation, bool weights_only) {
     mutateNewNodes(rnd, next_innovation);
     mutateNewLinks(rnd, next_innovation);
   }
+
+  // re-sort from scratch, so the topological order (which is also the evaluation
+  // order) only depends on the resulting genes, not on the history of the mutations
+  if (!topology_canonical_)
+    CHECK(indexGenes());
+  releaseLinksIndex();
 }
 
 void Genotype::inherit(const Genotype& parent1,
@@ -205,13 +557,13 @@ void Genotype::inherit(const Genotype& parent1,
 
   const NodeId kHiddenFirst = 1 + g_inputs + g_outputs;
 
-  std::random_device rd;
-  std::default_random_engine rnd(rd());
+  auto& rnd = rng::threadGenerator();
   std::bernoulli_distribution dist_parent(preference);
   bool use_parent1 = preference >= 0.5f;
 
-  unordered_map<NodeId, NodeId> nodes_map1;
-  unordered_map<NodeId, NodeId> nodes_map2;
+  // parent node -> child node maps (0 = not yet mapped)
+  vector<NodeId> nodes_map1(parent1.nodes_count, 0);
+  vector<NodeId> nodes_map2(parent2.nodes_count, 0);
 
   // map matching nodes from both parents
   auto map_matching_nodes = [&](NodeId node1, NodeId node2) {
@@ -221,136 +573,119 @@ void Genotype::inherit(const Genotype& parent1,
       return node1;
     }
 
-    auto it1 = nodes_map1.find(node1);
-    auto it2 = nodes_map2.find(node2);
+    NodeId& mapped_node1 = nodes_map1[node1];
+    NodeId& mapped_node2 = nodes_map2[node2];
 
     // already mapped?
-    if (it1 != nodes_map1.end()) {
-      CHECK(it2 != nodes_map2.end());
-      CHECK(it1->second == it2->second);
-      return it1->second;
+    if (mapped_node1 != 0) {
+      CHECK(mapped_node1 == mapped_node2);
+      return mapped_node1;
     }
 
     // allocate a new hidden node and update the maps
-    NodeId new_node = nodes_count++;
-    nodes_map1[node1] = new_node;
-    nodes_map2[node2] = new_node;
-    return new_node;
+    mapped_node1 = mapped_node2 = NodeId(nodes_count++);
+    return mapped_node1;
   };
 
-  auto map_node = [&](NodeId node, unordered_map<NodeId, NodeId>& nodes_map) {
+  auto map_node = [&](NodeId node, vector<NodeId>& nodes_map) {
     if (node < kHiddenFirst)
       return node;
 
     NodeId& mapped_node = nodes_map[node];
     if (mapped_node == 0)
-      mapped_node = nodes_count++;
+      mapped_node = NodeId(nodes_count++);
     return mapped_node;
   };
 
+  auto inherit_gene = [&](const Gene& parent_gene, vector<NodeId>& nodes_map) {
+    Gene gene = parent_gene;
+    gene.in = map_node(gene.in, nodes_map);
+    gene.out = map_node(gene.out, nodes_map);
+    genes_.push_back(gene);
+  };
+
   if (g_config.use_lstm_nodes)
     lw = dist_parent(rnd) ? parent1.lw : parent2.lw;
 
-  // merge the genes from the parents
-  auto g1 = parent1.genes.begin();
-  auto g2 = parent2.genes.begin();
-  while (g1 != parent1.genes.end() || g2 != parent2.genes.end()) {
-    if (g1 != parent1.genes.end() && g2 != parent2.genes.end()) {
-      if (g1->innovation == g2->innovation) {
-        CHECK(g1->recurrent == g2->recurrent);
-        Gene gene = dist_parent(rnd) ? *g1 : *g2;
-
-        if (g_config.preserve_connectivity) {
-          // make sure we don't mix disabled genes from a parent
-          // w/o also carring the mutation which replaced it
-          if (!gene.enabled && g1->enabled != g2->enabled) {
-            if ((g1->enabled && use_parent1) || (g2->enabled && !use_parent1))
-              gene.enabled = true;
-          }
-        }
-
-        gene.in = map_matching_nodes(g1->in, g2->in);
-        gene.out = map_matching_nodes(g1->out, g2->out);
-        genes.push_back(gene);
-        ++g1;
-        ++g2;
-      } else if (g1->innovation < g2->innovation) {
-        if (use_parent1) {
-          Gene gene = *g1;
-          gene.in = map_node(gene.in, nodes_map1);
-          gene.out = map_node(gene.out, nodes_map1);
-          genes.push_back(gene);
+  genes_.reserve(use_parent1 ? parent1.genes_.size() : parent2.genes_.size());
+
+  // merge the genes from the parents (both sorted by innovation number)
+  auto g1 = parent1.genes_.begin();
+  auto g2 = parent2.genes_.begin();
+  const auto end1 = parent1.genes_.end();
+  const auto end2 = parent2.genes_.end();
+  while (g1 != end1 && g2 != end2) {
+    if (g1->innovation == g2->innovation) {
+      CHECK(g1->recurrent == g2->recurrent);
+      Gene gene = dist_parent(rnd) ? *g1 : *g2;
+
+      if (g_config.preserve_connectivity) {
+        // make sure we don't mix disabled genes from a parent
+        // w/o also carring the mutation which replaced it
+        if (!gene.enabled && g1->enabled != g2->enabled) {
+          if ((g1->enabled && use_parent1) || (g2->enabled && !use_parent1))
+            gene.enabled = true;
         }
-        ++g1;
-      } else {
-        if (!use_parent1) {
-          Gene gene = *g2;
-          gene.in = map_node(gene.in, nodes_map2);
-          gene.out = map_node(gene.out, nodes_map2);
-          genes.push_back(gene);
-        }
-        ++g2;
-      }
-    } else if (g1 != parent1.genes.end()) {
-      assert(g2 == parent2.genes.end());
-      if (use_parent1) {
-        Gene gene = *g1;
-        gene.in = map_node(gene.in, nodes_map1);
-        gene.out = map_node(gene.out, nodes_map1);
-        genes.push_back(gene);
       }
+
+      gene.in = map_matching_nodes(g1->in, g2->in);
+      gene.out = map_matching_nodes(g1->out, g2->out);
+      genes_.push_back(gene);
+      ++g1;
+      ++g2;
+    } else if (g1->innovation < g2->innovation) {
+      if (use_parent1)
+        inherit_gene(*g1, nodes_map1);
       ++g1;
     } else {
-      assert(g1 == parent1.genes.end());
-      assert(g2 != parent2.genes.end());
-      if (!use_parent1) {
-        Gene gene = *g2;
-        gene.in = map_node(gene.in, nodes_map2);
-        gene.out = map_node(gene.out, nodes_map2);
-        genes.push_back(gene);
-      }
+      if (!use_parent1)
+        inherit_gene(*g2, nodes_map2);
       ++g2;
     }
   }
+
+  // excess genes
+  if (use_parent1) {
+    for (; g1 != end1; ++g1)
+      inherit_gene(*g1, nodes_map1);
+  } else {
+    for (; g2 != end2; ++g2)
+      inherit_gene(*g2, nodes_map2);
+  }
+
+  CHECK(indexGenes(), "unexpected cycle in the inherited genes");
 }
 
 double Genotype::compatibility(const Genotype& ref) const {
-  const auto& genes1 = genes;
-  const auto& genes2 = ref.genes;
-
   double W = 0;
   size_t W_count = 0;
-  size_t E_count = 0;
   size_t D_count = 0;
 
-  auto g1 = genes1.begin();
-  auto g2 = genes2.begin();
-  while (g1 != genes1.end() || g2 != genes2.end()) {
-    if (g1 != genes1.end() && g2 != genes2.end()) {
-      if (g1->innovation == g2->innovation) {
-        W += fabs(g1->weight - g2->weight);
-        ++W_count;
-        ++g1;
-        ++g2;
-      } else if (g1->innovation < g2->innovation) {
-        ++D_count;
-        ++g1;
-      } else {
-        ++D_count;
-        ++g2;
-      }
-    } else if (g1 != genes1.end()) {
-      assert(g2 == genes2.end());
-      ++E_count;
+  // merge the two (sorted) gene lists
+  const Gene* g1 = genes_.data();
+  const Gene* g2 = ref.genes_.data();
+  const Gene* const end1 = g1 + genes_.size();
+  const Gene* const end2 = g2 + ref.genes_.size();
+  while (g1 != end1 && g2 != end2) {
+    const Innovation innovation1 = g1->innovation;
+    const Innovation innovation2 = g2->innovation;
+    if (innovation1 == innovation2) {
+      W += fabs(g1->weight - g2->weight);
+      ++W_count;
+      ++g1;
+      ++g2;
+    } else if (innovation1 < innovation2) {
+      ++D_count;
       ++g1;
     } else {
-      assert(g1 == genes1.end());
-      assert(g2 != genes2.end());
-      ++E_count;
+      ++D_count;
       ++g2;
     }
   }
 
+  // the remaining genes (from either list) are excess genes
+  const size_t E_count = size_t(end1 - g1) + size_t(end2 - g2);
+
   constexpr double N = 1;  // same as the official NEAT implementation
   return (g_config.c1 * E_count) / N + (g_config.c2 * D_count) / N +
          g_config.c3 * (W / W_count);
@@ -19,7 +19,7 @@
 #include <core/darwin.h>
 
 #include <array>
-#include <unordered_set>
+#include <limits>
 #include <vector>
 using namespace std;
 
@@ -35,40 +35,48 @@ using LstmWeights = array<float, Nlstm>;
 //  output nodes : [INPUTS + 1, INPUTS + OUTPUTS]
 //  hidden nodes : [INPUTS + OUTPUTS + 1, nodes_count)
 
-using NodeId = size_t;
-using Innovation = size_t;
+using NodeId = uint32_t;
+using Innovation = uint32_t;
 
 constexpr NodeId kBiasNodeId = 0;
 constexpr NodeId kFirstInput = 1;
 
+// the last valid innovation number (the value after it is reserved for
+// detecting the exhaustion of the innovation numbers, see newInnovation())
+constexpr Innovation kMaxInnovation = numeric_limits<Innovation>::max() - 1;
+
+// the node ids share a 32bit word with one of the gene flags
+constexpr NodeId kMaxNodeId = (NodeId(1) << 31) - 1;
+
 // a NEAT gene represents one link in the ANN
+// (packed into 16 bytes, since the genes make up most of the population's memory)
 struct Gene {
   Innovation innovation = 0;
-  NodeId in = 0;
-  NodeId out = 0;
+  NodeId in : 31;
+  NodeId enabled : 1;
+  NodeId out : 31;
+  NodeId recurrent : 1;
   float weight = 0;
-  bool enabled = true;
-  bool recurrent = false;
 
   Gene(NodeId in, NodeId out, float weight, Innovation innovation)
-      : innovation(innovation), in(in), out(out), weight(weight) {}
+      : innovation(innovation), in(in), enabled(true), out(out), recurrent(false),
+        weight(weight) {
+    CHECK(in <= kMaxNodeId && out <= kMaxNodeId);
+  }
 
-  Gene() = default;
+  Gene() : Gene(0, 0, 0, 0) {}
 
   friend void to_json(json& json_obj, const Gene& gene);
   friend void from_json(const json& json_obj, Gene& gene);
+
+  friend void to_binary(core::BinaryWriter& writer, const Gene& gene);
+  friend void from_binary(core::BinaryReader& reader, Gene& gene);
 };
 
-class Genotype : public darwin::Genotype {
-  // the "white/gray/black" DFS colors
-  enum class VisitedColor {
-    NotYetVisited,
-    Exploring,
-    Visited,
-  };
+static_assert(sizeof(Gene) == 16, "unexpected NEAT gene size");
 
+class Genotype : public darwin::Genotype {
  public:
-  vector<Gene> genes;
   size_t nodes_count = 0;  // total, including bias/in/out/hidden
 
   LstmWeights lw = {};
@@ -91,6 +99,14 @@ class Genotype : public darwin::Genotype {
 
   void mutate(atomic<Innovation>& next_innovation, bool weights_only = false);
 
+  // allocates the next innovation number from the shared counter
+  // (running out of innovation numbers is a fatal error, not a silent wrap around)
+  static Innovation newInnovation(atomic<Innovation>& next_innovation) {
+    const Innovation innovation = next_innovation++;
+    CHECK(innovation <= kMaxInnovation, "The NEAT innovation numbers were exhausted");
+    return innovation;
+  }
+
   // combine the genes from two parents, renumbering the hidden nodes
   void inherit(const Genotype& parent1, const Genotype& parent2, float preference);
 
@@ -104,13 +120,55 @@ class Genotype : public darwin::Genotype {
   json save() const override;
   void load(const json& json_obj) override;
 
+  void saveBinaryPayload(core::BinaryWriter& writer) const override;
+  void loadBinaryPayload(core::BinaryReader& reader) override;
+
+  // the genes, sorted by innovation number
+  const vector<Gene>& genes() const { return genes_; }
+
+  // direct access to the genes (invalidates the links index and the topological
+  // order, which are rebuilt from scratch the next time they are needed)
+  //
+  // NOTE: the genes must be kept sorted by innovation number, and new genes should
+  //   be added through addGene() in order to update the indexes incrementally
+  //
+  vector<Gene>& mutableGenes() {
+    links_indexed_ = false;
+    topology_indexed_ = false;
+    return genes_;
+  }
+
+  // appends a new gene (or inserts it, if it's not the highest innovation number)
+  void addGene(const Gene& gene);
+
+  // shifts the innovation numbers >= base by a common offset
+  // (this preserves the genes order, so the indexes are not affected)
+  void shiftInnovations(Innovation base, Innovation offset);
+
+  // returns the first gene linking in -> out, or nullptr if there's no such link
+  Gene* findLink(NodeId in, NodeId out);
+
+  // all the nodes, in topological order (considering only the non-recurrent links)
+  //
+  // This is also the brain evaluation order, which matters for the recurrent links,
+  // so it's always the order calculated from scratch (which only depends on the
+  // genes) and never the incrementally maintained order from the middle of a mutation
+  //
+  vector<NodeId> topologicalOrder() const;
+
+  // the approximate memory used by this genotype, in bytes
+  size_t memoryUsage() const;
+
+  // the part of memoryUsage() used by the links index and the topology index
+  size_t indexMemoryUsage() const;
+
  private:
   template <class RND>
   void mutateWeights(RND& rnd) {
     std::bernoulli_distribution dist_mutate(g_config.weight_mutation_chance);
 
     // CONSIDER: trimming (disabling?) links with weight < epsilon?
-    for (auto& gene : genes)
+    for (auto& gene : genes_)
       if (dist_mutate(rnd))
         ann::mutateValue(gene.weight, rnd, ann::g_config.mutation_std_dev);
 
@@ -123,10 +181,33 @@ class Genotype : public darwin::Genotype {
 
   // returns true if we can reach dst from src (or if dst == src)
   // using only non-recurrent links (so traversing a DAG, no cycles)
-  bool canReach(NodeId src, NodeId dst, unordered_set<NodeId>& visited) const;
+  bool canReach(NodeId src, NodeId dst) const;
+
+  // validates a loaded genotype and rebuilds the indexes
+  void checkLoadedGenotype(int inputs, int outputs, bool lstm);
+
+  // rebuilds the topological order from scratch, and drops the links index
+  // (returns false if the non-recurrent links form a cycle)
+  bool indexGenes();
+
+  // builds the links index, if it's not already up to date
+  void indexLinks();
+
+  // the links index is only needed for mutations, so it's released
+  // once the mutation is complete
+  void releaseLinksIndex();
+
+  // incrementally indexes a new gene (which must be the last one)
+  void indexGene(uint32_t gene_index);
+
+  void resizeLinksIndex(size_t genes_count);
+  void insertLink(uint32_t gene_index);
+
+  // Kahn's topological sort, also building the adjacency lists
+  bool sortTopologically();
 
-  // returns true if it detects any cycles (using node_id as search root)
-  bool detectCycles(NodeId node_id, vector<VisitedColor>& visited) const;
+  void addTopologyNodes();
+  void addTopologyLink(uint32_t gene_index);
 
   template <class RND>
   void mutateNewLinks(RND& rnd, atomic<Innovation>& next_innovation) {
@@ -145,21 +226,20 @@ class Genotype : public darwin::Genotype {
       std::uniform_real_distribution<float> dist_weight(-range, range);
 
       // check to see if the link already exists
-      for (Gene& gene : genes)
-        if (gene.in == in && gene.out == out) {
-          // re-enable and mutate disabled links
-          if (!gene.enabled) {
-            gene.enabled = true;
-            gene.weight = ann::roundWeight(dist_weight(rnd));
-          }
-          return;
+      if (Gene* gene = findLink(in, out)) {
+        // re-enable and mutate disabled links
+        if (!gene->enabled) {
+          gene->enabled = true;
+          gene->weight = ann::roundWeight(dist_weight(rnd));
         }
+        return;
+      }
 
       // create a new link
-      Gene new_gene(in, out, ann::roundWeight(dist_weight(rnd)), next_innovation++);
-      unordered_set<NodeId> visited;
-      new_gene.recurrent = canReach(out, in, visited);
-      genes.push_back(new_gene);
+      Gene new_gene(
+          in, out, ann::roundWeight(dist_weight(rnd)), newInnovation(next_innovation));
+      new_gene.recurrent = canReach(out, in);
+      addGene(new_gene);
     }
   }
 
@@ -168,39 +248,75 @@ class Genotype : public darwin::Genotype {
     std::bernoulli_distribution dist_mutate(g_config.new_node_chance);
     if (dist_mutate(rnd)) {
       // pick a random gene to split
-      std::uniform_int_distribution<size_t> dist_gene_index(0, genes.size() - 1);
-      auto& gene = genes[dist_gene_index(rnd)];
+      std::uniform_int_distribution<size_t> dist_gene_index(0, genes_.size() - 1);
+      auto& gene = genes_[dist_gene_index(rnd)];
 
       const float range = ann::g_config.connection_range;
       std::uniform_real_distribution<float> dist_weight(-range, range);
 
-      NodeId new_node_id = nodes_count++;
-      Gene pre_link(gene.in, new_node_id, 1.0f, next_innovation++);
+      NodeId new_node_id = NodeId(nodes_count++);
+      Gene pre_link(gene.in, new_node_id, 1.0f, newInnovation(next_innovation));
       pre_link.recurrent = false;
-      Gene post_link(new_node_id, gene.out, gene.weight, next_innovation++);
+      Gene post_link(new_node_id, gene.out, gene.weight, newInnovation(next_innovation));
       post_link.recurrent = gene.recurrent;
       gene.enabled = false;
-      genes.push_back(pre_link);
-      genes.push_back(post_link);
+      addGene(pre_link);
+      addGene(post_link);
 
       if (g_config.implicit_bias_links) {
         Gene bias(kBiasNodeId,
                   new_node_id,
                   ann::roundWeight(dist_weight(rnd)),
-                  next_innovation++);
-        genes.push_back(bias);
+                  newInnovation(next_innovation));
+        addGene(bias);
       }
 
       if (g_config.recurrent_hidden_nodes) {
         Gene self_link(new_node_id,
                        new_node_id,
                        ann::roundWeight(dist_weight(rnd)),
-                       next_innovation++);
+                       newInnovation(next_innovation));
         self_link.recurrent = true;
-        genes.push_back(self_link);
+        addGene(self_link);
       }
     }
   }
+
+ private:
+  vector<Gene> genes_;
+
+  // open addressing hash table indexing the genes by their (in, out) link
+  // (each slot is a gene index + 1, or 0 for empty slots)
+  //
+  // NOTE: at 2-4 slots per gene, this is the largest index (8-16 bytes per gene,
+  //   as much as the genes themselves), so it's only built for the duration of
+  //   a mutation (see indexLinks() and releaseLinksIndex())
+  //
+  vector<uint32_t> links_index_;
+  bool links_indexed_ = false;
+
+  // the non-recurrent links, as intrusive lists of gene indexes: the list heads
+  // are indexed by NodeId, the next entries are indexed by gene index
+  // (all the entries are a gene index + 1, or 0 for the end of the list)
+  //
+  // NOTE: these are kept for the lifetime of the genotype (8 bytes per gene and
+  //   8 bytes per node), since the topological order is needed for every grow()
+  //   and maintaining it incrementally requires the adjacency lists
+  //
+  vector<uint32_t> first_out_link_;
+  vector<uint32_t> first_in_link_;
+  vector<uint32_t> next_out_link_;
+  vector<uint32_t> next_in_link_;
+
+  // the nodes in topological order, and the position of each node in this order
+  // (maintained incrementally as new links are added, see addTopologyLink())
+  vector<NodeId> topological_order_;
+  vector<uint32_t> node_rank_;
+  bool topology_indexed_ = false;
+
+  // set if topological_order_ was calculated from scratch (see sortTopologically()),
+  // cleared when it's updated incrementally (the mutations re-sort it at the end)
+  bool topology_canonical_ = false;
 };
 
 }  // namespace neat
@@ -32,8 +32,10 @@ class Factory : public darwin::PopulationFactory {
     g_outputs = int(domain.outputs());
     CHECK(g_inputs > 0);
     CHECK(g_outputs > 0);
-    ann::setActivationFunction(g_config.activation_function);
-    ann::setGateActivationFunction(g_config.gate_activation_function);
+    ann::setActivationFunction(g_config.activation_function,
+                               g_config.activation_precision);
+    ann::setGateActivationFunction(g_config.gate_activation_function,
+                                   g_config.activation_precision);
     return make_unique<Population>();
   }
 
@@ -36,6 +36,11 @@ struct Config : public core::PropertySet {
            ann::ActivationFunction::Logistic,
            "Activation function used for cell gates (ex. LSTM)");
 
+  PROPERTY(activation_precision,
+           ann::ActivationPrecision,
+           ann::ActivationPrecision::Exact,
+           "Exact activation functions, or faster SIMD approximations");
+
   PROPERTY(implicit_bias_links,
            bool,
            true,
@@ -20,13 +20,22 @@
 #include <core/logging.h>
 #include <core/parallel_for_each.h>
 #include <core/pp_utils.h>
+#include <core/rng.h>
 
 #include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <limits>
 using namespace std;
 
 namespace neat {
 
+// speciation rounds with fewer unassigned genotypes are not worth parallelizing
+constexpr size_t kMinParallelSpeciateGenotypes = 256;
+
+// the number of genotypes resolved serially at the end of each speciation round
+constexpr size_t kSpeciateBatchSize = 64;
+
 void Population::createPrimordialGeneration(int population_size) {
   core::log("Resetting evolution ...\n");
 
@@ -60,27 +69,125 @@ vector<size_t> Population::rankingIndex() const {
   return rank_to_index;
 }
 
-void Population::assignSpecies(int index) {
-  const auto& genotype = genotypes_[index];
-  for (auto& species : species_) {
-    if (genotype.compatibility(species.origin) < g_config.compatibility_threshold) {
-      species.genotypes.push_back(index);
-      return;
-    }
+json Population::profileCounters() const {
+  size_t genes_count = 0;
+  size_t memory_usage = 0;
+  size_t index_memory_usage = 0;
+  for (const auto& genotype : genotypes_) {
+    genes_count += genotype.genes().size();
+    memory_usage += genotype.memoryUsage();
+    index_memory_usage += genotype.indexMemoryUsage();
   }
+  json json_counters;
+  json_counters["genes_per_genotype"] = double(genes_count) / genotypes_.size();
+  json_counters["bytes_per_genotype"] = double(memory_usage) / genotypes_.size();
+  json_counters["index_bytes_per_gene"] =
+      genes_count > 0 ? double(index_memory_usage) / genes_count : 0.0;
+  return json_counters;
+}
 
-  // create a new species
-  Species new_species;
-  new_species.genotypes.push_back(index);
-  new_species.origin = genotype;
-  species_.push_back(new_species);
+// a genotype is compatible with a species if its compatibility distance to the
+// species origin is below the threshold
+//
+// the gene count difference is a cheap lower bound for the number of excess and
+// disjoint genes, which can rule out most species without the full genes merge
+//
+bool Population::isCompatible(const Genotype& genotype,
+                              const Genotype& origin,
+                              size_t& skipped_merges) {
+  const double threshold = g_config.compatibility_threshold;
+  if (g_config.c1 >= 0 && g_config.c2 >= 0 && g_config.c3 >= 0) {
+    const auto genes_count = double(genotype.genes().size());
+    const auto origin_genes_count = double(origin.genes().size());
+    const double min_distance =
+        min(g_config.c1, g_config.c2) * fabs(genes_count - origin_genes_count);
+    if (min_distance >= threshold) {
+      ++skipped_merges;
+      return false;
+    }
+  }
+  return genotype.compatibility(origin) < threshold;
 }
 
+// each genotype is assigned to the first compatible species (in the species order),
+// or it creates a new species if there are no compatible species
+//
+// the results are identical to assigning the genotypes one at a time, but most of
+// the compatibility checks are done in parallel, in rounds: each round checks the
+// unassigned genotypes against the species created since the previous round, then
+// the first few unassigned genotypes are resolved serially (potentially creating
+// new species, which are checked in the next round)
+//
 void Population::speciate() {
   darwin::StageScope stage("Speciate");
+  const auto start_time = chrono::steady_clock::now();
+
+  constexpr int kUnassigned = -1;
+  vector<int> assignments(genotypes_.size(), kUnassigned);
+  vector<int> unassigned(genotypes_.size());
+  for (int i = 0; i < int(unassigned.size()); ++i)
+    unassigned[i] = i;
+
+  atomic<size_t> compatibility_checks = 0;
+  atomic<size_t> skipped_merges = 0;
+
+  auto checkSpecies = [&](int index, size_t first_species, size_t last_species) {
+    const auto& genotype = genotypes_[index];
+    size_t checks = 0;
+    size_t skipped = 0;
+    for (size_t i = first_species; i < last_species; ++i) {
+      ++checks;
+      if (isCompatible(genotype, species_[i].origin, skipped)) {
+        assignments[index] = int(i);
+        break;
+      }
+    }
+    compatibility_checks += checks;
+    skipped_merges += skipped;
+  };
+
+  auto createSpecies = [&](int index) {
+    Species new_species;
+    new_species.origin = genotypes_[index];
+    species_.push_back(new_species);
+    assignments[index] = int(species_.size() - 1);
+  };
+
+  size_t first_species = 0;
+  while (!unassigned.empty()) {
+    // check the unassigned genotypes against the species added since the last round
+    const size_t last_species = species_.size();
+    if (unassigned.size() >= kMinParallelSpeciateGenotypes) {
+      pp::for_each(unassigned, [&](int, int index) {
+        checkSpecies(index, first_species, last_species);
+      });
+    } else {
+      for (int index : unassigned)
+        checkSpecies(index, first_species, last_species);
+    }
+
+    auto assigned = std::remove_if(
+        unassigned.begin(), unassigned.end(), [&](int index) {
+          return assignments[index] != kUnassigned;
+        });
+    unassigned.erase(assigned, unassigned.end());
+
+    // the first few remaining genotypes are resolved serially, which can create
+    // multiple new species per round
+    const size_t batch_size = min(unassigned.size(), kSpeciateBatchSize);
+    for (size_t i = 0; i < batch_size; ++i) {
+      const int index = unassigned[i];
+      checkSpecies(index, last_species, species_.size());
+      if (assignments[index] == kUnassigned)
+        createSpecies(index);
+    }
+    unassigned.erase(unassigned.begin(), unassigned.begin() + batch_size);
+
+    first_species = last_species;
+  }
 
-  for (int i = 0; i < genotypes_.size(); ++i)
-    assignSpecies(i);
+  for (int i = 0; i < int(genotypes_.size()); ++i)
+    species_[assignments[i]].genotypes.push_back(i);
 
   // clean up extinct species
   auto removed =
@@ -89,6 +196,48 @@ void Population::speciate() {
       });
   species_.erase(removed, species_.end());
   CHECK(!species_.empty());
+
+  const chrono::duration<double, milli> elapsed =
+      chrono::steady_clock::now() - start_time;
+  const double skipped_percent =
+      compatibility_checks > 0 ? 100.0 * skipped_merges / compatibility_checks : 0.0;
+  core::log("Speciate: %zu species, %.2f ms (%.2f%% compatibility merges skipped)\n",
+            species_.size(),
+            elapsed.count(),
+            skipped_percent);
+}
+
+void Population::mutateChild(Genotype& child, int child_index, bool weights_only) {
+  if (rng::reproducibleMode()) {
+    // all the children number their new genes starting from the same base,
+    // the final numbers are assigned in child order by numberChildInnovations()
+    const Innovation base = next_innovation_;
+    atomic<Innovation> next_innovation = base;
+    child.mutate(next_innovation, weights_only);
+    child_innovations_[child_index] = next_innovation - base;
+  } else {
+    child.mutate(next_innovation_, weights_only);
+  }
+}
+
+void Population::numberChildInnovations() {
+  if (!rng::reproducibleMode())
+    return;
+
+  CHECK(child_innovations_.size() == genotypes_.size());
+  const Innovation base = next_innovation_;
+
+  // the new genes have the highest innovation numbers, so they are at the end
+  // of the (sorted) genes and shifting them by a common offset preserves the order
+  uint64_t offset = 0;
+  for (size_t i = 0; i < genotypes_.size(); ++i) {
+    genotypes_[i].shiftInnovations(base, Innovation(offset));
+    offset += child_innovations_[i];
+    CHECK(base + offset <= uint64_t(kMaxInnovation) + 1,
+          "The NEAT innovation numbers were exhausted");
+  }
+
+  next_innovation_ = Innovation(base + offset);
 }
 
 void Population::neatSelection() {
@@ -168,80 +317,95 @@ void Population::neatSelection() {
   // create the next generation
   vector<Genotype> next_generation(genotypes_.size());
 
-  atomic<int> next_child = 0;
-  atomic<int> extinct_species = 0;
+  // calculate the number of offspring for each species upfront, so each species
+  // gets a fixed range of child indexes (regardless of the scheduling order)
+  vector<int> species_offspring(species_.size());
+  vector<int> species_first_child(species_.size());
+  int next_child = 0;
+  int extinct_species = 0;
 
-  pp::for_each(species_, [&](int, Species& species) {
-    std::random_device rd;
-    std::default_random_engine rnd(rd());
+  // (if all the fitness values are zero, the whole next generation
+  // is made of interspecies offspring)
+  const bool valid_average_fitness = isfinite(average_fitness) && average_fitness > 0;
+
+  for (size_t species_index = 0; species_index < species_.size(); ++species_index) {
+    double expected_offspring = 0;
+    if (valid_average_fitness) {
+      for (int i : species_[species_index].genotypes)
+        expected_offspring += genotypes_[i].fitness / average_fitness;
+      expected_offspring = floor(expected_offspring);
+    }
+
+    if (expected_offspring < g_config.min_species_size) {
+      ++extinct_species;
+    } else {
+      species_offspring[species_index] = int(expected_offspring);
+      species_first_child[species_index] = next_child;
+      next_child += int(expected_offspring);
+    }
+  }
+  CHECK(next_child <= next_generation.size());
+
+  pp::for_each(species_, [&](int species_index, Species& species) {
+    auto& rnd = rng::threadGenerator();
 
     std::uniform_int_distribution<size_t> dist_parent_U(0, species.genotypes.size() - 1);
 
     std::discrete_distribution<size_t> dist_parent_D(
         species.genotypes.size(), 0, 1, [](double x) { return 1.1 - x; });
 
-    auto dist_parent = [&](std::default_random_engine& rnd) {
+    auto dist_parent = [&](rng::Generator& rnd) {
       return g_config.uniform_parents_distribution ? dist_parent_U(rnd)
                                                    : dist_parent_D(rnd);
     };
 
     std::bernoulli_distribution dist_mutate_elite(g_config.elite_mutation_chance);
 
-    double expected_offspring = 0;
-    for (int i : species.genotypes)
-      expected_offspring += genotypes_[i].fitness / average_fitness;
-    expected_offspring = floor(expected_offspring);
-
-    if (expected_offspring < g_config.min_species_size) {
-      ++extinct_species;
-    } else {
-      for (int i = 0; i < expected_offspring; ++i) {
-        int child_index = next_child++;
-        CHECK(child_index < next_generation.size());
-        auto& child = next_generation[child_index];
-
-        float percentage = float(i) / species.genotypes.size();
-
-        if (percentage < g_config.elite_percentage) {
-          int parent = species.genotypes[i];
-          child = genotypes_[parent];
-          if (dist_mutate_elite(rnd)) {
-            child.mutate(next_innovation_);
-            child.genealogy = darwin::Genealogy("em", { index_to_rank[parent] });
-          } else {
-            child.genealogy = darwin::Genealogy("e", { index_to_rank[parent] });
-          }
-          ++child.age;
-        } else {
-          // pick two parents and produce the offspring
-          int parent1 = species.genotypes[dist_parent(rnd)];
-          int parent2 = species.genotypes[dist_parent(rnd)];
-
-          const auto& g1 = genotypes_[parent1];
-          const auto& g2 = genotypes_[parent2];
+    for (int i = 0; i < species_offspring[species_index]; ++i) {
+      int child_index = species_first_child[species_index] + i;
+      CHECK(child_index < next_generation.size());
+      auto& child = next_generation[child_index];
 
-          float f1 = g1.fitness;
-          float f2 = g2.fitness;
+      float percentage = float(i) / species.genotypes.size();
 
-          float preference = f1 / (f1 + f2);
-          if (isnan(preference))
-            preference = 0.5f;
-
-          child.inherit(g1, g2, preference);
-          child.genealogy =
-              darwin::Genealogy("c", { index_to_rank[parent1], index_to_rank[parent2] });
-          child.mutate(next_innovation_);
+      if (percentage < g_config.elite_percentage) {
+        int parent = species.genotypes[i];
+        child = genotypes_[parent];
+        if (dist_mutate_elite(rnd)) {
+          mutateChild(child, child_index);
+          child.genealogy = darwin::Genealogy("em", { index_to_rank[parent] });
+        } else {
+          child.genealogy = darwin::Genealogy("e", { index_to_rank[parent] });
         }
+        ++child.age;
+      } else {
+        // pick two parents and produce the offspring
+        int parent1 = species.genotypes[dist_parent(rnd)];
+        int parent2 = species.genotypes[dist_parent(rnd)];
+
+        const auto& g1 = genotypes_[parent1];
+        const auto& g2 = genotypes_[parent2];
+
+        float f1 = g1.fitness;
+        float f2 = g2.fitness;
+
+        float preference = f1 / (f1 + f2);
+        if (isnan(preference))
+          preference = 0.5f;
+
+        child.inherit(g1, g2, preference);
+        child.genealogy =
+            darwin::Genealogy("c", { index_to_rank[parent1], index_to_rank[parent2] });
+        mutateChild(child, child_index);
       }
     }
   });
 
-  core::log("extinct species=%d\n", extinct_species.load());
+  core::log("extinct species=%d\n", extinct_species);
   core::log("bonus interspecies=%d\n", int(next_generation.size()) - next_child);
 
   // fill in the rest with interspecies offsprings
-  std::random_device rd;
-  std::default_random_engine rnd(rd());
+  auto& rnd = rng::threadGenerator();
   std::uniform_int_distribution<int> dist_any_genome(0, int(genotypes_.size()) - 1);
   while (next_child < next_generation.size()) {
     int child_index = next_child++;
@@ -264,10 +428,11 @@ void Population::neatSelection() {
     child.inherit(g1, g2, preference);
     child.genealogy =
         darwin::Genealogy("i", { index_to_rank[parent1], index_to_rank[parent2] });
-    child.mutate(next_innovation_);
+    mutateChild(child, child_index);
   }
 
   std::swap(genotypes_, next_generation);
+  numberChildInnovations();
 
   // recreate species
   if (g_config.contiguous_species) {
@@ -295,8 +460,7 @@ void Population::classicSelection() {
   const vector<size_t> rank_to_index = rankingIndex();
 
   pp::for_each(next_generation, [&](int index, Genotype& genotype) {
-    std::random_device rd;
-    std::default_random_engine rnd(rd());
+    auto& rnd = rng::threadGenerator();
     std::uniform_int_distribution<int> dist_parent;
     std::uniform_real_distribution<double> dist_survive(0, 1);
 
@@ -331,24 +495,25 @@ void Population::classicSelection() {
 
       genotype.inherit(g1, g2, preference);
       genotype.genealogy = darwin::Genealogy("c", { parent1, parent2 });
-      genotype.mutate(next_innovation_);
+      mutateChild(genotype, index);
       ++babies_count;
     } else {
       // last resort, mutate the old genotype
       genotype = old_genotype;
       genotype.genealogy = darwin::Genealogy("m", { index });
-      genotype.mutate(next_innovation_, true);
+      mutateChild(genotype, index, true);
       ++genotype.age;
       ++mutate_count;
     }
 
     total_nodes_count += genotype.nodes_count;
-    total_genes_count += genotype.genes.size();
+    total_genes_count += genotype.genes().size();
     pp::atomicMax(max_nodes_count, genotype.nodes_count);
-    pp::atomicMax(max_genes_count, genotype.genes.size());
+    pp::atomicMax(max_genes_count, genotype.genes().size());
   });
 
   std::swap(genotypes_, next_generation);
+  numberChildInnovations();
 
   const double population_size = genotypes_.size();
 
@@ -371,6 +536,9 @@ void Population::createNextGeneration() {
 
   ++generation_;
 
+  if (rng::reproducibleMode())
+    child_innovations_.assign(genotypes_.size(), 0);
+
   if (g_config.use_classic_selection) {
     classicSelection();
   } else {
@@ -39,22 +39,38 @@ class Population : public darwin::Population {
   Genotype* genotype(size_t index) override { return &genotypes_[index]; }
   const Genotype* genotype(size_t index) const override { return &genotypes_[index]; }
 
+  const vector<Species>& species() const { return species_; }
+
   vector<size_t> rankingIndex() const override;
   void createPrimordialGeneration(int population_size) override;
   void createNextGeneration() override;
 
+  json profileCounters() const override;
+
  private:
   void classicSelection();
   void neatSelection();
 
   // separate the genomes into species
   void speciate();
-  void assignSpecies(int index);
+
+  static bool isCompatible(const Genotype& genotype,
+                           const Genotype& origin,
+                           size_t& skipped_merges);
+
+  // mutates the child genotype at child_index in the next generation
+  // (in the reproducible mode, the new innovation numbers are assigned in child
+  // order after the selection, so they don't depend on the order of the mutations)
+  void mutateChild(Genotype& child, int child_index, bool weights_only = false);
+
+  // assigns the final innovation numbers to the new genes (reproducible mode only)
+  void numberChildInnovations();
 
  private:
   vector<Genotype> genotypes_;
   vector<Species> species_;
   atomic<Innovation> next_innovation_ = 0;
+  vector<Innovation> child_innovations_;  // new innovations, per child
   int generation_ = 0;
 };
 
@@ -16,6 +16,8 @@
 #include "brain.h"
 #include "test_population.h"
 
+#include <core/rng.h>
+
 namespace test_population {
 
 Genotype::Genotype(const Population* population) : population_(population) {
@@ -24,7 +26,8 @@ Genotype::Genotype(const Population* population) : population_(population) {
 
 void Genotype::reset() {
   darwin::Genotype::reset();
-  seed_ = random_device{}();
+  // (using the thread generator, so the seeds follow the reproducible mode)
+  seed_ = random_device::result_type(rng::threadGenerator()());
 }
 
 unique_ptr<darwin::Brain> Genotype::grow() const {
@@ -47,4 +50,14 @@ void Genotype::load(const json& json_obj) {
   std::swap(*this, tmp_genotype);
 }
 
+void Genotype::saveBinaryPayload(core::BinaryWriter& writer) const {
+  writer.write(seed_);
+}
+
+void Genotype::loadBinaryPayload(core::BinaryReader& reader) {
+  Genotype tmp_genotype(population_);
+  reader.read(tmp_genotype.seed_);
+  std::swap(*this, tmp_genotype);
+}
+
 }  // namespace test_population
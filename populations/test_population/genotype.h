@@ -34,6 +34,8 @@ class Genotype : public darwin::Genotype {
 
   json save() const override;
   void load(const json& json_obj) override;
+  void saveBinaryPayload(core::BinaryWriter& writer) const override;
+  void loadBinaryPayload(core::BinaryReader& reader) override;
   void reset() override;
 
   auto population() const { return population_; }
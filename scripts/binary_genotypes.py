@@ -0,0 +1,210 @@
+# Copyright 2019 The Darwin Neuroevolution Framework Authors.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# decoding of the binary genotypes stored in the champion table
+# (see darwin::Genotype::saveBinary())
+
+import json
+import os
+import re
+import struct
+
+kGenotypeMagic = 0x4e454744
+kGenotypeFormatVersion = 1
+
+kCompressionNone = 0
+kCompressionLz4 = 1
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def bytes(self, size):
+        if self.pos + size > len(self.data):
+            raise ValueError('Invalid binary data (unexpected end of data)')
+        value = self.data[self.pos:self.pos + size]
+        self.pos += size
+        return value
+
+    def unpack(self, fmt):
+        return struct.unpack('<' + fmt, self.bytes(struct.calcsize(fmt)))[0]
+
+    def size(self):
+        value = 0
+        shift = 0
+        while True:
+            byte = self.bytes(1)[0]
+            value |= (byte & 0x7f) << shift
+            shift += 7
+            if byte < 0x80:
+                return value
+
+    def string(self):
+        return self.bytes(self.size()).decode('utf-8')
+
+    def blob(self):
+        return self.bytes(self.size())
+
+    def values(self, fmt, count):
+        return [self.unpack(fmt) for _ in range(count)]
+
+    def at_end(self):
+        return self.pos == len(self.data)
+
+def lz4_decompress(data, decompressed_size):
+    reader = Reader(data)
+    output = bytearray()
+
+    def length(value):
+        if value == 15:
+            while True:
+                byte = reader.bytes(1)[0]
+                value += byte
+                if byte != 255:
+                    break
+        return value
+
+    while True:
+        token = reader.bytes(1)[0]
+        output += reader.bytes(length(token >> 4))
+        if reader.at_end():
+            break
+        offset = reader.unpack('H')
+        if offset == 0 or offset > len(output):
+            raise ValueError('Invalid LZ4 block')
+        match_length = length(token & 0x0f) + 4
+        for _ in range(match_length):
+            output.append(output[-offset])
+
+    if len(output) != decompressed_size:
+        raise ValueError('Invalid LZ4 block')
+    return bytes(output)
+
+# extracts the (decompressed) payload from a binary genotype
+def genotype_payload(data):
+    reader = Reader(data)
+    if reader.unpack('I') != kGenotypeMagic:
+        raise ValueError('Not a binary genotype')
+    if reader.unpack('B') != kGenotypeFormatVersion:
+        raise ValueError('Unsupported binary genotype format version')
+    compression = reader.unpack('B')
+    payload_size = reader.size()
+    if compression == kCompressionNone:
+        payload = reader.bytes(payload_size)
+    elif compression == kCompressionLz4:
+        payload = lz4_decompress(reader.bytes(len(data) - reader.pos), payload_size)
+    else:
+        raise ValueError('Unknown genotype compression')
+    if not reader.at_end():
+        raise ValueError('Unexpected trailing data')
+    return Reader(payload)
+
+# decodes a NEAT genotype, using the same layout as the JSON representation
+def neat_genotype(data):
+    reader = genotype_payload(data)
+    genotype = {}
+    genotype['inputs'] = reader.size()
+    genotype['outputs'] = reader.size()
+    genotype['lstm'] = reader.unpack('B') != 0
+    genotype['nodes_count'] = reader.size()
+    genes = []
+    for _ in range(reader.size()):
+        gene = {}
+        gene['innovation'] = reader.size()
+        gene['in'] = reader.size()
+        gene['out'] = reader.size()
+        gene['weight'] = reader.unpack('f')
+        flags = reader.unpack('B')
+        gene['enabled'] = (flags & 1) != 0
+        gene['recurrent'] = (flags & 2) != 0
+        genes.append(gene)
+    genotype['genes'] = genes
+    genotype['lw'] = reader.values('f', 12)
+    return genotype
+
+# the CGP function arities, from the functions table
+def cgp_function_arities():
+    table_path = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+        '..', 'populations', 'cgp', 'functions_table.def')
+    fn_def = re.compile(r'FN_DEF\(\s*\w+\s*,\s*([^,\s]+)\s*,\s*(\d+)')
+    arities = {}
+    with open(table_path) as table:
+        for match in fn_def.finditer(table.read()):
+            arities[match.group(1)] = int(match.group(2))
+    return arities
+
+kCgpMaxFunctionArity = 2
+
+# decodes a CGP genotype, using the same layout as the JSON representation
+def cgp_genotype(data):
+    reader = genotype_payload(data)
+    genotype = {}
+    genotype['inputs'] = reader.size()
+    genotype['outputs'] = reader.size()
+    genotype['rows'] = reader.size()
+    genotype['columns'] = reader.size()
+
+    function_names = [reader.string() for _ in range(reader.size())]
+    arities = cgp_function_arities()
+
+    function_genes = []
+    for _ in range(reader.size()):
+        function_code = reader.unpack('h')
+        connections = reader.values('H', kCgpMaxFunctionArity)
+        if function_code >= 0:
+            name = function_names[function_code]
+            arity = arities[name]
+        else:
+            name = 'const_%d' % -function_code
+            arity = 0
+        function_genes.append({ 'fn': name, 'c': connections, 'a': arity })
+    genotype['function_genes'] = function_genes
+
+    genotype['output_genes'] = [{ 'c': reader.unpack('H') } for _ in range(reader.size())]
+    genotype['constants_genes'] = reader.values('f', reader.size())
+    return genotype
+
+# decodes a list of named binary genotypes
+# (the generation.genotypes blob, used before the champion table was introduced)
+def named_genotypes(data):
+    reader = Reader(data)
+    genotypes = {}
+    for _ in range(reader.size()):
+        name = reader.string()
+        genotypes[name] = reader.blob()
+    if not reader.at_end():
+        raise ValueError('Invalid genotypes encoding')
+    return genotypes
+
+# loads the champion genotype from the specified generation
+#
+# older (version 1) universes store the champion in the generation.genotypes
+# column, either as JSON text or as a blob with a list of named binary genotypes
+#
+def load_champion(db, trace_id, generation, decoder):
+    if db.execute('pragma user_version').fetchone()[0] < 2:
+        row = db.execute(
+            """select genotypes
+                from generation where trace_id = ? and generation = ?""",
+                (trace_id, generation)).fetchone()
+        if isinstance(row[0], bytes):
+            return decoder(named_genotypes(row[0])['champion'])
+        return json.loads(row[0])['champion']
+    row = db.execute(
+        """select champion.genotype
+            from generation join champion on champion.id = generation.champion_id
+            where generation.trace_id = ? and generation.generation = ?""",
+            (trace_id, generation)).fetchone()
+    return decoder(row[0])
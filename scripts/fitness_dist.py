@@ -22,6 +22,8 @@ import sys
 import seaborn as sns
 import matplotlib.pyplot as plt
 
+import population_trace
+
 #------------------------------------------------------------------------------
 # command line parsing
 #------------------------------------------------------------------------------
@@ -72,7 +74,8 @@ cursor.execute(
 count = cursor.fetchone()[0]
 assert count > 0
 
-def fitnessValues(details):
+def fitnessValues(generation):
+    details = json.loads(generation['details'] or 'null') or {}
     if 'compressed_fitness' in details:
         fitness = details['compressed_fitness']
         x = [cfv[0] for cfv in fitness]
@@ -81,6 +84,10 @@ def fitnessValues(details):
     elif 'full_fitness' in details:
         y = details['full_fitness']
         return range(len(y)), y
+    elif generation['population_trace'] is not None:
+        y = population_trace.decode(generation['population_trace']).ranked_fitness
+        if y:
+            return range(len(y)), y
 
     # we don't have fitness values, aborting
     sys.exit('Fitness values not found')
@@ -102,8 +109,8 @@ def uncompressFitnessValues(cx, cy):
         uy.append(y)
     return ux, uy
     
-def plotGenerationFitness(details, a):
-    x, y = fitnessValues(details)
+def plotGenerationFitness(generation, a):
+    x, y = fitnessValues(generation)
     if args.sorted:
         plt.plot(x, y, color = [1 - a, 0.5, a, kAlpha], linewidth = 1)
     else:
@@ -117,22 +124,23 @@ current = 0
 
 print(f'Sampling {int(sample_count)} generations out of {count} ...')
 
+# the full fitness values are stored in the population_trace column
+# (older universes store them in the details json)
+has_population_trace = db.execute('pragma user_version').fetchone()[0] >= 3
+
 cursor.execute(
-    '''select details, generation
+    '''select details, %s, generation
         from generation
         where trace_id = ?
-        order by generation''',
+        order by generation''' %
+        ('population_trace' if has_population_trace else 'null as population_trace'),
     (trace_id, ))
 
 for generation in cursor:
     n = generation['generation']
     a = n / count
     if a >= current or n == count - 1:
-        details = json.loads(generation['details'])
-        if details is None:
-            # we don't have fitness values, aborting
-            sys.exit('Fitness values not found')
-        plotGenerationFitness(details, a)
+        plotGenerationFitness(generation, a)
         current += step
 
 if args.output != None:
@@ -19,6 +19,8 @@ import json
 import sys
 import argparse
 
+import binary_genotypes
+
 #------------------------------------------------------------------------------
 # command line parsing
 #------------------------------------------------------------------------------
@@ -48,15 +50,9 @@ generation = int(args.generation)
 db = sqlite3.connect(universe_db)
 db.row_factory = sqlite3.Row
 
-cursor = db.cursor()
-
 # read the champion genotype from the specified generation
-cursor.execute(
-    """select genotypes
-        from generation where trace_id = ? and generation = ?""",
-        (trace_id, generation))
-json_genotypes = json.loads(cursor.fetchone()['genotypes'])
-genotype = json_genotypes['champion']
+genotype = binary_genotypes.load_champion(
+    db, trace_id, generation, binary_genotypes.neat_genotype)
 
 #------------------------------------------------------------------------------
 # export the genotype as a graphviz dot specification
@@ -0,0 +1,83 @@
+# Copyright 2019 The Darwin Neuroevolution Framework Authors.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# decoding of the full fitness and genealogy traces stored in the
+# generation.population_trace column (see darwin::PopulationTrace)
+
+import struct
+
+from binary_genotypes import Reader
+
+kPopulationTraceVersion = 1
+
+kFitnessFloat32 = 0
+kFitnessDelta = 1
+kFitnessQuantized = 2
+
+kNoOperator = 0xff
+
+class PopulationTrace:
+    def __init__(self):
+        self.ranked_fitness = []
+        # one (genetic operator, parents) tuple for each genotype
+        # (the genetic operator is None if there's no genealogy information)
+        self.genealogy = []
+
+def _bits_to_float(bits):
+    return struct.unpack('<f', struct.pack('<I', bits))[0]
+
+def _decode_fitness(reader, encoding, count):
+    if encoding == kFitnessFloat32:
+        return reader.values('f', count)
+    elif encoding == kFitnessDelta:
+        values = []
+        last_bits = 0
+        for _ in range(count):
+            zigzag = reader.size()
+            last_bits += (zigzag >> 1) ^ -(zigzag & 1)
+            values.append(_bits_to_float(last_bits))
+        return values
+    elif encoding == kFitnessQuantized:
+        if count == 0:
+            return []
+        min_value = reader.unpack('f')
+        max_value = reader.unpack('f')
+        step = (max_value - min_value) / 65535
+        return [min_value + q * step for q in reader.values('H', count)]
+    raise ValueError('Unknown fitness encoding')
+
+def decode(data):
+    reader = Reader(data)
+    if reader.unpack('B') != kPopulationTraceVersion:
+        raise ValueError('Unsupported population trace format version')
+
+    trace = PopulationTrace()
+    encoding = reader.unpack('B')
+    trace.ranked_fitness = _decode_fitness(reader, encoding, reader.size())
+
+    genetic_operators = [reader.string() for _ in range(reader.size())]
+    operator_codes = reader.bytes(reader.size())
+    parents_counts = reader.bytes(reader.size())
+    parents = reader.values('i', reader.size())
+    if len(operator_codes) != len(parents_counts):
+        raise ValueError('Invalid population trace')
+
+    offset = 0
+    for code, count in zip(operator_codes, parents_counts):
+        genetic_operator = None if code == kNoOperator else genetic_operators[code]
+        trace.genealogy.append((genetic_operator, parents[offset:offset + count]))
+        offset += count
+    if offset != len(parents) or not reader.at_end():
+        raise ValueError('Invalid population trace')
+    return trace
@@ -0,0 +1,84 @@
+// Copyright 2019 The Darwin Neuroevolution Framework Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "benchmark.h"
+
+#include <core/ann_dynamic.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+using namespace std;
+
+namespace ann_benchmarks {
+
+// the number of multiply-adds for each measurement
+// (so the results for different layer sizes are comparable)
+constexpr size_t kWorkSize = size_t(1) << 26;
+
+// runs one layer shape with each of the available kernels
+static void compare(size_t inputs, size_t outputs) {
+  default_random_engine rnd(1);
+  uniform_real_distribution<float> dist(-1, 1);
+
+  ann::Matrix w(inputs + 1, outputs);
+  for (float& value : w.values)
+    value = dist(rnd);
+
+  vector<float> in(inputs);
+  for (float& value : in)
+    value = dist(rnd);
+
+  vector<float> out(outputs);
+  const size_t iterations = max(kWorkSize / ((inputs + 1) * outputs), size_t(1));
+
+  for (const auto& kernel : ann::availableLayerKernels()) {
+    const auto elapsed = benchmarks::measure([&] {
+      for (size_t i = 0; i < iterations; ++i) {
+        kernel.evaluate(in, out, w);
+        // feed the output back, so the evaluations can't be optimized away
+        in[i % inputs] = out[i % outputs] * 1e-3f;
+      }
+    });
+    const auto label = core::format("%zux%zu, %s", inputs, outputs, kernel.name);
+    benchmarks::report(label, elapsed);
+  }
+}
+
+// the typical neuroevolution layers (few inputs and outputs)
+BENCHMARK(EvaluateLayer_Small) {
+  compare(4, 2);
+  compare(8, 8);
+  compare(16, 16);
+  compare(32, 32);
+  compare(33, 7);
+}
+
+BENCHMARK(EvaluateLayer_Large) {
+  compare(64, 64);
+  compare(128, 128);
+  compare(256, 256);
+  compare(512, 512);
+  compare(1024, 1024);
+}
+
+// very narrow, very wide and odd shapes (partial column strips)
+BENCHMARK(EvaluateLayer_Skewed) {
+  compare(1024, 4);
+  compare(4, 1024);
+  compare(100, 33);
+  compare(100, 130);
+}
+
+}  // namespace ann_benchmarks
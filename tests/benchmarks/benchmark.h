@@ -0,0 +1,85 @@
+// Copyright 2019 The Darwin Neuroevolution Framework Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <core/format.h>
+
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <string>
+#include <vector>
+using namespace std;
+
+namespace benchmarks {
+
+//! A registered benchmark
+struct Benchmark {
+  string name;
+  function<void()> body;
+};
+
+//! The list of all the registered benchmarks
+inline vector<Benchmark>& registeredBenchmarks() {
+  static vector<Benchmark> benchmarks;
+  return benchmarks;
+}
+
+//! Registers a benchmark (see BENCHMARK())
+struct BenchmarkRegistration {
+  BenchmarkRegistration(const string& name, const function<void()>& body) {
+    registeredBenchmarks().push_back({ name, body });
+  }
+};
+
+//! Defines and registers a new benchmark
+//!
+//! ```cpp
+//! BENCHMARK(ParallelFor_Static) {
+//!   ... setup ...
+//!   auto elapsed = benchmarks::measure([&] { ... timed code ... });
+//!   benchmarks::report("static", elapsed);
+//! }
+//! ```
+//!
+#define BENCHMARK(name)                                         \
+  static void benchmark_##name();                               \
+  static benchmarks::BenchmarkRegistration registration_##name( \
+      #name, &benchmark_##name);                                \
+  static void benchmark_##name()
+
+//! Runs the body a number of times and returns the best elapsed time (in seconds)
+template <class Body>
+double measure(const Body& body, int repeats = 5) {
+  using Clock = chrono::steady_clock;
+  double best_time = numeric_limits<double>::max();
+  for (int i = 0; i < repeats; ++i) {
+    const auto start_timestamp = Clock::now();
+    body();
+    const chrono::duration<double> elapsed = Clock::now() - start_timestamp;
+    best_time = min(best_time, elapsed.count());
+  }
+  return best_time;
+}
+
+//! Prints a benchmark result line
+inline void report(const string& label, double seconds) {
+  printf("  %-48s %12.3f ms\n", label.c_str(), seconds * 1000);
+  fflush(stdout);
+}
+
+}  // namespace benchmarks
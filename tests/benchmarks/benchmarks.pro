@@ -0,0 +1,13 @@
+
+include(../tests_common.pri)
+
+SOURCES += \
+    main.cpp \
+    parallel_for_benchmarks.cpp \
+    ann_benchmarks.cpp \
+    neat_benchmarks.cpp \
+    world_pool_benchmarks.cpp \
+    cart_pole_physics_benchmarks.cpp
+
+HEADERS += \
+    benchmark.h
@@ -0,0 +1,80 @@
+// Copyright 2018 The Darwin Neuroevolution Framework Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "benchmark.h"
+
+#include <core/cart_pole_physics.h>
+
+#include <random>
+#include <vector>
+using namespace std;
+
+namespace cart_pole_physics_benchmarks {
+
+// the number of episode steps for each measurement
+constexpr size_t kWorkSize = size_t(1) << 22;
+
+constexpr float kTimeStep = 1.0f / 50.0f;
+
+static physics::CartPoleModel testModel(int poles) {
+  const float kLength[] = { 1.5f, 0.3f };
+  physics::CartPoleModel model;
+  model.poles = poles;
+  for (int pole = 0; pole < poles; ++pole) {
+    model.pole_mass[pole] = 0.04f * kLength[pole];
+    model.pole_half_length[pole] = kLength[pole] / 2;
+    model.pole_inertia[pole] = model.pole_mass[pole] * kLength[pole] * kLength[pole] / 3;
+  }
+  return model;
+}
+
+static void compare(int poles, size_t episodes) {
+  const auto model = testModel(poles);
+  const size_t steps = kWorkSize / episodes;
+
+  default_random_engine rnd(1);
+  uniform_real_distribution<float> dist_angle(-0.2f, 0.2f);
+  vector<physics::CartPoleState> initial_states(episodes);
+  for (auto& state : initial_states)
+    for (int pole = 0; pole < poles; ++pole)
+      state.pole_angle[pole] = dist_angle(rnd);
+
+  for (const auto& kernel : physics::CartPoleBatch::availableKernels()) {
+    physics::CartPoleBatch batch(model, episodes, kernel.kernel);
+    const auto elapsed = benchmarks::measure([&] {
+      for (size_t i = 0; i < episodes; ++i)
+        batch.setState(i, initial_states[i]);
+      for (size_t step = 0; step < steps; ++step) {
+        // oppose the cart velocity, so the episodes stay in a plausible range
+        for (size_t i = 0; i < episodes; ++i)
+          batch.setForce(i, batch.state(i).cart_velocity > 0 ? -1.0f : 1.0f);
+        batch.step(kTimeStep);
+      }
+    });
+
+    const auto label = core::format(
+        "%d pole(s), %zu episodes, %s", poles, episodes, kernel.name.c_str());
+    benchmarks::report(label, elapsed);
+  }
+}
+
+BENCHMARK(CartPolePhysics_Step) {
+  compare(1, 16);
+  compare(1, 256);
+  compare(2, 16);
+  compare(2, 256);
+}
+
+}  // namespace cart_pole_physics_benchmarks
@@ -0,0 +1,41 @@
+// Copyright 2019 The Darwin Neuroevolution Framework Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "benchmark.h"
+
+#include <core/thread_pool.h>
+
+#include <stdio.h>
+#include <string>
+using namespace std;
+
+// Usage: benchmarks [name_filter]
+//
+// Runs all the benchmarks with names containing the (optional) filter substring
+//
+int main(int argc, char* argv[]) {
+  const string filter = argc > 1 ? argv[1] : "";
+
+  pp::ParallelForSupport::init(nullptr);
+
+  for (const auto& benchmark : benchmarks::registeredBenchmarks()) {
+    if (benchmark.name.find(filter) != string::npos) {
+      printf("\n%s:\n", benchmark.name.c_str());
+      benchmark.body();
+    }
+  }
+
+  printf("\n");
+  return 0;
+}
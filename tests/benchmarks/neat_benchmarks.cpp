@@ -0,0 +1,186 @@
+// Copyright 2019 The Darwin Neuroevolution Framework Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "benchmark.h"
+
+#include <core/ann_activation_functions.h>
+#include <populations/neat/brain.h>
+#include <populations/neat/genotype.h>
+#include <populations/neat/neat.h>
+
+#include <algorithm>
+#include <memory>
+#include <queue>
+#include <random>
+#include <vector>
+using namespace std;
+
+namespace neat_benchmarks {
+
+constexpr int kInputs = 16;
+constexpr int kOutputs = 4;
+
+// the number of link evaluations for each measurement
+// (so the results for different network sizes are comparable)
+constexpr size_t kWorkSize = size_t(1) << 24;
+
+// the previous neat::Brain design, kept as a baseline: one heap object per node,
+// each owning its input links, with a virtual call for each node activation
+class NodeObjectsBrain {
+  struct Link {
+    neat::NodeId in;
+    float weight;
+  };
+
+  struct Node {
+    virtual ~Node() = default;
+    virtual void activate(float input) { value = ann::activate(input); }
+
+    float value = 0;
+    vector<Link> inputs;
+  };
+
+ public:
+  explicit NodeObjectsBrain(const neat::Genotype& genotype) {
+    nodes_.resize(genotype.nodes_count);
+    for (auto& node : nodes_)
+      node = make_unique<Node>();
+    for (const auto& gene : genotype.genes())
+      nodes_[gene.out]->inputs.push_back({ gene.in, gene.weight });
+
+    // reverse topological sort (the benchmark networks have no recurrent links)
+    vector<int> outs_count(nodes_.size());
+    for (const auto& node : nodes_)
+      for (const auto& link : node->inputs)
+        ++outs_count[link.in];
+
+    queue<neat::NodeId> top_queue;
+    for (neat::NodeId i = 0; i < outs_count.size(); ++i)
+      if (outs_count[i] == 0)
+        top_queue.push(i);
+
+    while (!top_queue.empty()) {
+      const auto node_id = top_queue.front();
+      top_queue.pop();
+      if (node_id > kInputs)
+        eval_order_.push_back(node_id);
+      for (const auto& link : nodes_[node_id]->inputs)
+        if (--outs_count[link.in] == 0)
+          top_queue.push(link.in);
+    }
+    reverse(eval_order_.begin(), eval_order_.end());
+  }
+
+  void setInput(int index, float value) {
+    CHECK(index < kInputs);
+    nodes_[1 + index]->value = value;
+  }
+
+  float output(int index) const {
+    CHECK(index < kOutputs);
+    return nodes_[1 + kInputs + index]->value;
+  }
+
+  void think() {
+    const neat::NodeId kFirstOutput = 1 + kInputs;
+    const neat::NodeId kFirstHidden = kFirstOutput + kOutputs;
+
+    nodes_[neat::kBiasNodeId]->value = 1.0f;
+    for (auto node_id : eval_order_) {
+      CHECK(node_id >= kFirstOutput);
+
+      const auto& node = nodes_[node_id];
+      float value = 0;
+      for (const auto& link : node->inputs)
+        value += nodes_[link.in]->value * link.weight;
+
+      if (neat::g_config.normalize_output || node_id >= kFirstHidden)
+        node->activate(value);
+      else
+        node->value = value;
+    }
+  }
+
+ private:
+  vector<unique_ptr<Node>> nodes_;
+  vector<neat::NodeId> eval_order_;
+};
+
+// a random feedforward network, with the requested number of hidden nodes and links
+static neat::Genotype randomGenotype(size_t hidden_nodes, size_t links) {
+  const size_t first_output = 1 + kInputs;
+  const size_t first_hidden = first_output + kOutputs;
+
+  neat::Genotype genotype;
+  genotype.nodes_count = first_hidden + hidden_nodes;
+
+  default_random_engine rnd(1);
+  uniform_real_distribution<float> dist_weight(-1, 1);
+
+  // the links go from the bias, inputs or lower numbered hidden nodes,
+  // to higher numbered hidden nodes or outputs (so there are no cycles)
+  const size_t sources_count = first_output + hidden_nodes;
+  for (size_t i = 0; i < links; ++i) {
+    size_t in = uniform_int_distribution<size_t>(0, sources_count - 1)(rnd);
+    if (in >= first_output)
+      in += kOutputs;
+
+    const size_t first_destination = in >= first_hidden ? in + 1 : first_hidden;
+    const size_t destinations = genotype.nodes_count - first_destination + kOutputs;
+    size_t out = uniform_int_distribution<size_t>(0, destinations - 1)(rnd);
+    out = out < kOutputs ? first_output + out : first_destination + out - kOutputs;
+
+    genotype.mutableGenes().emplace_back(in, out, dist_weight(rnd), i);
+  }
+  return genotype;
+}
+
+static void compare(size_t hidden_nodes, size_t links) {
+  neat::g_inputs = kInputs;
+  neat::g_outputs = kOutputs;
+  neat::g_config.use_lstm_nodes = false;
+  neat::g_config.normalize_input = false;
+  neat::g_config.normalize_output = true;
+  ann::setActivationFunction(neat::g_config.activation_function);
+  ann::setGateActivationFunction(neat::g_config.gate_activation_function);
+
+  const auto genotype = randomGenotype(hidden_nodes, links);
+  const size_t iterations = max(kWorkSize / links, size_t(1));
+
+  auto run = [&](auto& brain) {
+    return benchmarks::measure([&] {
+      for (size_t i = 0; i < iterations; ++i) {
+        // feed the output back, so the evaluations can't be optimized away
+        brain.setInput(int(i % kInputs), brain.output(int(i % kOutputs)));
+        brain.think();
+      }
+    });
+  };
+
+  NodeObjectsBrain baseline(genotype);
+  neat::Brain brain(&genotype);
+
+  const auto label = core::format("%zu links, %zu hidden nodes", links, hidden_nodes);
+  benchmarks::report(label + ", node objects", run(baseline));
+  benchmarks::report(label + ", flat plan", run(brain));
+}
+
+BENCHMARK(NeatBrain_Think) {
+  compare(2, 10);
+  compare(10, 100);
+  compare(100, 1000);
+  compare(1000, 10000);
+}
+
+}  // namespace neat_benchmarks
@@ -0,0 +1,76 @@
+// Copyright 2019 The Darwin Neuroevolution Framework Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "benchmark.h"
+
+#include <core/parallel_for_each.h>
+
+#include <math.h>
+#include <random>
+#include <vector>
+using namespace std;
+
+namespace parallel_for_benchmarks {
+
+// a synthetic workload, with the cost proportional to the number of steps
+static float simulate(int steps) {
+  float state = 1.0f;
+  for (int i = 0; i < steps; ++i)
+    state = sinf(state) + 1.0f;
+  return state;
+}
+
+// runs one benchmark configuration with each of the partitioners
+static void compare(const string& workload, const vector<int>& steps) {
+  vector<float> results(steps.size());
+
+  auto run = [&](pp::Partitioner partitioner) {
+    return benchmarks::measure([&] {
+      pp::for_each(
+          results,
+          [&](int index, float& result) { result = simulate(steps[index]); },
+          partitioner);
+    });
+  };
+
+  benchmarks::report(workload + ", static", run(pp::Partitioner::Static));
+  benchmarks::report(workload + ", guided", run(pp::Partitioner::Guided));
+}
+
+// many cheap iterations (the partitioning overhead dominates)
+BENCHMARK(ParallelFor_UniformCost) {
+  compare("1000000 x 1 step", vector<int>(1000000, 1));
+  compare("100000 x 100 steps", vector<int>(100000, 100));
+  compare("1000 x 10000 steps", vector<int>(1000, 10000));
+}
+
+// most episodes end early, a few run to the max steps (ex. harvester)
+BENCHMARK(ParallelFor_VariableCost) {
+  default_random_engine rnd(1);
+  bernoulli_distribution long_episode(0.05);
+  vector<int> steps(20000);
+  for (auto& value : steps)
+    value = long_episode(rnd) ? 5000 : 50;
+  compare("20000 x (95% 50 steps, 5% 5000 steps)", steps);
+}
+
+// the expensive iterations are clustered at the end of the range
+BENCHMARK(ParallelFor_SkewedCost) {
+  vector<int> steps(20000);
+  for (size_t i = 0; i < steps.size(); ++i)
+    steps[i] = i < steps.size() * 9 / 10 ? 50 : 2000;
+  compare("20000 x (50 steps, last 10% 2000 steps)", steps);
+}
+
+}  // namespace parallel_for_benchmarks
@@ -0,0 +1,76 @@
+// Copyright 2019 The Darwin Neuroevolution Framework Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "benchmark.h"
+
+#include <domains/cart_pole/cart_pole.h>
+#include <domains/cart_pole/world.h>
+#include <domains/double_cart_pole/double_cart_pole.h>
+#include <domains/double_cart_pole/world.h>
+#include <domains/unicycle/unicycle.h>
+#include <domains/unicycle/world.h>
+
+#include <memory>
+using namespace std;
+
+namespace world_pool_benchmarks {
+
+// the number of episodes for each measurement
+constexpr int kEpisodes = 10000;
+
+// compares the per-episode setup cost: constructing a new world vs. resetting
+// a recycled world, with and without a few simulation steps per episode
+// (the termination conditions are ignored, so all the episodes have the same length)
+template <class Domain, class World, class... Args>
+static void compare(const Domain& domain, const Args&... args) {
+  for (int steps : { 0, 10, 100 }) {
+    auto new_worlds = benchmarks::measure([&] {
+      for (int i = 0; i < kEpisodes; ++i) {
+        World world(args..., &domain);
+        for (int step = 0; step < steps; ++step)
+          world.simStep();
+      }
+    });
+
+    World recycled_world(args..., &domain);
+    auto recycled_worlds = benchmarks::measure([&] {
+      for (int i = 0; i < kEpisodes; ++i) {
+        recycled_world.reset(args...);
+        for (int step = 0; step < steps; ++step)
+          recycled_world.simStep();
+      }
+    });
+
+    const auto label = core::format("%d episodes, %d steps", kEpisodes, steps);
+    benchmarks::report(label + ", new worlds", new_worlds);
+    benchmarks::report(label + ", recycled worlds", recycled_worlds);
+  }
+}
+
+BENCHMARK(WorldPool_CartPole) {
+  cart_pole::CartPole domain(cart_pole::Config{});
+  compare<cart_pole::CartPole, cart_pole::World>(domain, 1.0f);
+}
+
+BENCHMARK(WorldPool_DoubleCartPole) {
+  double_cart_pole::DoubleCartPole domain(double_cart_pole::Config{});
+  compare<double_cart_pole::DoubleCartPole, double_cart_pole::World>(domain, 1.0f, -1.0f);
+}
+
+BENCHMARK(WorldPool_Unicycle) {
+  unicycle::Unicycle domain(unicycle::Config{});
+  compare<unicycle::Unicycle, unicycle::World>(domain, 1.0f, 0.0f);
+}
+
+}  // namespace world_pool_benchmarks
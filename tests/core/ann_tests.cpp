@@ -0,0 +1,237 @@
+// Copyright 2019 The Darwin Neuroevolution Framework Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <core/ann_activation_functions.h>
+#include <core/ann_dynamic.h>
+
+#include <third_party/gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+using namespace std;
+
+namespace ann_tests {
+
+TEST(AnnTest, AvailableLayerKernels) {
+  const auto kernels = ann::availableLayerKernels();
+  ASSERT_FALSE(kernels.empty());
+  EXPECT_EQ(kernels.front().name, "cpu");
+  for (const auto& kernel : kernels)
+    EXPECT_NE(kernel.evaluate, nullptr);
+}
+
+// every kernel must match the generic implementation, for every layer shape
+// (including the partial column strips and the register blocking remainders)
+TEST(AnnTest, EvaluateLayerKernels) {
+  const auto kernels = ann::availableLayerKernels();
+  const auto reference = kernels.front();
+
+  const size_t inputs_variations[] = { 1, 2, 3, 7, 16, 33, 100 };
+  const size_t outputs_variations[] = { 1,  2,  5,  7,  8,  9,  15,  16,  17, 31,
+                                        32, 33, 47, 63, 64, 65, 100, 127, 130 };
+
+  default_random_engine rnd(1);
+  uniform_real_distribution<float> dist(-1, 1);
+
+  for (size_t inputs : inputs_variations) {
+    for (size_t outputs : outputs_variations) {
+      ann::Matrix w(inputs + 1, outputs);
+      for (float& value : w.values)
+        value = dist(rnd);
+
+      vector<float> in(inputs);
+      for (float& value : in)
+        value = dist(rnd);
+
+      vector<float> expected(outputs);
+      reference.evaluate(in, expected, w);
+
+      for (const auto& kernel : kernels) {
+        SCOPED_TRACE(kernel.name);
+        vector<float> out(outputs, NAN);
+        kernel.evaluate(in, out, w);
+        for (size_t i = 0; i < outputs; ++i) {
+          const float tolerance = 1e-4f * max(1.0f, fabs(expected[i]));
+          ASSERT_NEAR(out[i], expected[i], tolerance)
+              << inputs << "x" << outputs << ", output " << i;
+        }
+      }
+    }
+  }
+}
+
+const ann::ActivationFunction kActivationFunctions[] = {
+  ann::ActivationFunction::Identity, ann::ActivationFunction::Logistic,
+  ann::ActivationFunction::Tanh,     ann::ActivationFunction::ReLU,
+  ann::ActivationFunction::Neat,     ann::ActivationFunction::ReExp,
+  ann::ActivationFunction::LogisticEx,
+};
+
+// the whole-array activation functions must match the scalar versions
+// (exactly, or within the documented error bound for the fast approximations)
+TEST(AnnTest, ActivationArrays) {
+  vector<float> samples = {
+    numeric_limits<float>::infinity(),
+    -numeric_limits<float>::infinity(),
+    numeric_limits<float>::quiet_NaN(),
+  };
+  for (float x = -100; x <= 100; x += 0.01f)
+    samples.push_back(x);
+  samples.push_back(0.0f);
+  samples.push_back(-0.0f);
+  samples.push_back(1e6f);
+  samples.push_back(-1e6f);
+
+  for (auto afn : kActivationFunctions) {
+    for (auto precision :
+         { ann::ActivationPrecision::Exact, ann::ActivationPrecision::Fast }) {
+      SCOPED_TRACE(core::toString(afn) + ", " + core::toString(precision));
+
+      ann::setActivationFunction(afn, precision);
+      const auto scalar_afn = ann::g_activation_function;
+
+      // leave out the last few values, to test the partial SIMD strips
+      constexpr size_t kUntouched = 3;
+      auto values = samples;
+      ann::activate(values.data(), values.size() - kUntouched);
+
+      for (size_t i = 0; i < values.size() - kUntouched; ++i) {
+        const float expected = scalar_afn(samples[i]);
+        if (std::isnan(expected))
+          ASSERT_TRUE(std::isnan(values[i])) << "x = " << samples[i];
+        else if (precision == ann::ActivationPrecision::Exact || std::isinf(expected))
+          ASSERT_EQ(values[i], expected) << "x = " << samples[i];
+        else
+          ASSERT_NEAR(values[i], expected, 1e-6f) << "x = " << samples[i];
+      }
+      for (size_t i = values.size() - kUntouched; i < values.size(); ++i)
+        EXPECT_EQ(values[i], samples[i]);
+
+      // NaN inputs produce the same results as the scalar versions
+      // (in every lane position, including the partial strips)
+      for (size_t lane = 0; lane < 17; ++lane) {
+        vector<float> nan_values(17, 1.0f);
+        nan_values[lane] = numeric_limits<float>::quiet_NaN();
+        ann::activate(nan_values.data(), nan_values.size());
+        const float expected = scalar_afn(numeric_limits<float>::quiet_NaN());
+        EXPECT_EQ(std::isnan(nan_values[lane]), std::isnan(expected));
+        if (!std::isnan(expected))
+          EXPECT_EQ(nan_values[lane], expected);
+      }
+    }
+  }
+}
+
+TEST(AnnTest, GateActivationArrays) {
+  for (auto afn : kActivationFunctions) {
+    ann::setGateActivationFunction(afn, ann::ActivationPrecision::Exact);
+    vector<float> values = { -2.5f, -1, 0, 0.5f, 3 };
+    ann::activateGate(values.data(), values.size());
+    EXPECT_EQ(values[0], ann::activateGate(-2.5f));
+    EXPECT_EQ(values[1], ann::activateGate(-1.0f));
+    EXPECT_EQ(values[2], ann::activateGate(0.0f));
+    EXPECT_EQ(values[3], ann::activateGate(0.5f));
+    EXPECT_EQ(values[4], ann::activateGate(3.0f));
+  }
+}
+
+// the fused LSTM kernels must match the straightforward, one cell at a time evaluation
+TEST(AnnTest, LstmCells) {
+  ann::initAnnLibrary();
+  ann::setActivationFunction(ann::ActivationFunction::Tanh);
+  ann::setGateActivationFunction(ann::ActivationFunction::Logistic);
+
+  default_random_engine rnd(1);
+  uniform_real_distribution<float> dist(-1, 1);
+
+  // includes partial SIMD strips and multiple kernel blocks
+  for (size_t count : { 1, 7, 8, 9, 63, 64, 65, 130 }) {
+    SCOPED_TRACE(count);
+
+    ann::Matrix lw(12, count);
+    for (float& value : lw.values)
+      value = dist(rnd);
+    vector<float> in(count);
+    vector<float> values(count);
+    vector<float> cells(count);
+    for (size_t k = 0; k < count; ++k) {
+      in[k] = dist(rnd);
+      values[k] = dist(rnd);
+      cells[k] = dist(rnd);
+    }
+
+    const float* w = lw.values.data();
+    ann::LstmCellWeights lstm_weights = {};
+    lstm_weights.wi = w + count * 0;
+    lstm_weights.ui = w + count * 1;
+    lstm_weights.bi = w + count * 2;
+    lstm_weights.wf = w + count * 3;
+    lstm_weights.uf = w + count * 4;
+    lstm_weights.bf = w + count * 5;
+    lstm_weights.wo = w + count * 6;
+    lstm_weights.uo = w + count * 7;
+    lstm_weights.bo = w + count * 8;
+    lstm_weights.wc = w + count * 9;
+    lstm_weights.uc = w + count * 10;
+    lstm_weights.bc = w + count * 11;
+
+    auto expected_values = values;
+    auto expected_cells = cells;
+    for (size_t k = 0; k < count; ++k) {
+      const auto& lw = lstm_weights;
+      const float x = in[k];
+      const float prev = expected_values[k];
+      const float cand_C = ann::activate(lw.wc[k] * x + lw.uc[k] * prev + lw.bc[k]);
+      const float i_gate = ann::activateGate(lw.wi[k] * x + lw.ui[k] * prev + lw.bi[k]);
+      const float f_gate = ann::activateGate(lw.wf[k] * x + lw.uf[k] * prev + lw.bf[k]);
+      const float o_gate = ann::activateGate(lw.wo[k] * x + lw.uo[k] * prev + lw.bo[k]);
+      expected_cells[k] = f_gate * expected_cells[k] + i_gate * cand_C;
+      expected_values[k] = o_gate * ann::activate(expected_cells[k]);
+    }
+
+    ann::evaluateLstmCells(in.data(), values.data(), cells.data(), lstm_weights, count);
+    for (size_t k = 0; k < count; ++k) {
+      EXPECT_NEAR(values[k], expected_values[k], 1e-5f);
+      EXPECT_NEAR(cells[k], expected_cells[k], 1e-5f);
+    }
+
+    // LSTM-lite (reusing the first 4 weight rows)
+    ann::LstmLiteCellWeights lite_weights = {};
+    lite_weights.wg = w + count * 0;
+    lite_weights.ug = w + count * 1;
+    lite_weights.bg = w + count * 2;
+    lite_weights.wc = w + count * 3;
+
+    for (size_t k = 0; k < count; ++k) {
+      const auto& lw = lite_weights;
+      const float gate =
+          ann::activateGate(lw.wg[k] * in[k] + lw.ug[k] * expected_cells[k] + lw.bg[k]);
+      const float v = in[k] + lw.wc[k] * expected_cells[k];
+      expected_cells[k] = v * gate;
+      expected_values[k] = ann::activate(v);
+    }
+
+    ann::evaluateLstmLiteCells(
+        in.data(), values.data(), cells.data(), lite_weights, count);
+    for (size_t k = 0; k < count; ++k) {
+      EXPECT_NEAR(values[k], expected_values[k], 1e-5f);
+      EXPECT_NEAR(cells[k], expected_cells[k], 1e-5f);
+    }
+  }
+}
+
+}  // namespace ann_tests
@@ -0,0 +1,245 @@
+// Copyright 2018 The Darwin Neuroevolution Framework Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <core/binary_io.h>
+#include <core/darwin.h>
+#include <core/exception.h>
+#include <core/lz4.h>
+
+#include <third_party/gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+using namespace std;
+
+namespace binary_io_tests {
+
+enum class Color : uint8_t { Red, Green, Blue };
+
+struct Point {
+  int x = 0;
+  int y = 0;
+
+  friend void to_binary(core::BinaryWriter& writer, const Point& point) {
+    writer.write(point.x);
+    writer.write(point.y);
+  }
+
+  friend void from_binary(core::BinaryReader& reader, Point& point) {
+    reader.read(point.x);
+    reader.read(point.y);
+  }
+
+  bool operator==(const Point& other) const { return x == other.x && y == other.y; }
+};
+
+// a genotype relying on the default (CBOR) binary payload
+struct TestGenotype : public darwin::Genotype {
+  vector<int> values;
+
+  unique_ptr<darwin::Brain> grow() const override { FATAL("Not implemented"); }
+  unique_ptr<darwin::Genotype> clone() const override { FATAL("Not implemented"); }
+
+  json save() const override {
+    json json_obj;
+    json_obj["values"] = values;
+    return json_obj;
+  }
+
+  void load(const json& json_obj) override {
+    values = json_obj.at("values").get<vector<int>>();
+  }
+};
+
+TEST(BinaryIoTest, Roundtrip) {
+  core::BinaryWriter writer;
+  writer.write(int8_t(-5));
+  writer.write(uint16_t(0xabcd));
+  writer.write(int32_t(-123456789));
+  writer.write(uint64_t(0x0123456789abcdef));
+  writer.write(1.5f);
+  writer.write(-2.25);
+  writer.write(true);
+  writer.write(Color::Blue);
+  writer.writeSize(0);
+  writer.writeSize(127);
+  writer.writeSize(128);
+  writer.writeSize(uint64_t(1) << 40);
+  writer.write(string("Hello, binary world!"));
+  writer.write(string());
+  writer.write(vector<float>{ 1.0f, -2.0f, 3.5f });
+  writer.write(array<int, 3>{ 1, 2, 3 });
+  writer.write(vector<Point>{ { 1, 2 }, { -3, 4 } });
+
+  core::BinaryReader reader(writer.data());
+  EXPECT_EQ(reader.read<int8_t>(), -5);
+  EXPECT_EQ(reader.read<uint16_t>(), 0xabcd);
+  EXPECT_EQ(reader.read<int32_t>(), -123456789);
+  EXPECT_EQ(reader.read<uint64_t>(), 0x0123456789abcdef);
+  EXPECT_EQ(reader.read<float>(), 1.5f);
+  EXPECT_EQ(reader.read<double>(), -2.25);
+  EXPECT_EQ(reader.read<bool>(), true);
+  EXPECT_EQ(reader.read<Color>(), Color::Blue);
+  EXPECT_EQ(reader.readSize(), 0);
+  EXPECT_EQ(reader.readSize(), 127);
+  EXPECT_EQ(reader.readSize(), 128);
+  EXPECT_EQ(reader.readSize(), uint64_t(1) << 40);
+  EXPECT_EQ(reader.read<string>(), "Hello, binary world!");
+  EXPECT_EQ(reader.read<string>(), "");
+  EXPECT_EQ(reader.read<vector<float>>(), (vector<float>{ 1.0f, -2.0f, 3.5f }));
+  EXPECT_EQ((reader.read<array<int, 3>>()), (array<int, 3>{ 1, 2, 3 }));
+  EXPECT_EQ(reader.read<vector<Point>>(), (vector<Point>{ { 1, 2 }, { -3, 4 } }));
+  EXPECT_TRUE(reader.atEnd());
+}
+
+TEST(BinaryIoTest, InvalidData) {
+  core::BinaryWriter writer;
+  writer.write(vector<int>{ 1, 2, 3, 4 });
+  const auto& data = writer.data();
+
+  // truncated data
+  for (size_t size = 0; size < data.size(); ++size) {
+    core::BinaryReader reader(data.data(), size);
+    EXPECT_THROW(reader.read<vector<int>>(), core::Exception);
+  }
+
+  // reading past the end
+  core::BinaryReader reader(data);
+  reader.read<vector<int>>();
+  EXPECT_THROW(reader.read<uint8_t>(), core::Exception);
+
+  // invalid bool value
+  const vector<uint8_t> invalid_bool = { 2 };
+  core::BinaryReader bool_reader(invalid_bool);
+  EXPECT_THROW(bool_reader.read<bool>(), core::Exception);
+}
+
+TEST(BinaryIoTest, Lz4_Roundtrip) {
+  default_random_engine rnd(1);
+  uniform_int_distribution<int> dist_byte(0, 255);
+  uniform_int_distribution<int> dist_symbol(0, 3);
+
+  vector<vector<uint8_t>> test_blocks;
+  test_blocks.emplace_back();
+  test_blocks.push_back({ 42 });
+  test_blocks.emplace_back(10000, 7);
+  test_blocks.emplace_back(1 << 20, 0);  // close to the max LZ4 expansion
+
+  vector<uint8_t> random_block(5000);
+  for (auto& value : random_block)
+    value = uint8_t(dist_byte(rnd));
+  test_blocks.push_back(random_block);
+
+  vector<uint8_t> text_block;
+  const string text = "the quick brown fox jumps over the lazy dog. ";
+  for (int i = 0; i < 100; ++i)
+    text_block.insert(text_block.end(), text.begin(), text.end());
+  test_blocks.push_back(text_block);
+
+  vector<uint8_t> mixed_block(20000);
+  for (auto& value : mixed_block)
+    value = uint8_t(dist_symbol(rnd));
+  test_blocks.push_back(mixed_block);
+
+  for (const auto& block : test_blocks) {
+    const auto compressed = lz4::compress(block.data(), block.size());
+    const auto decompressed =
+        lz4::decompress(compressed.data(), compressed.size(), block.size());
+    EXPECT_EQ(decompressed, block);
+  }
+
+  // repetitive data must compress well
+  const auto compressed = lz4::compress(text_block.data(), text_block.size());
+  EXPECT_LT(compressed.size(), text_block.size() / 10);
+}
+
+TEST(BinaryIoTest, Lz4_InvalidBlock) {
+  const string text = "abcabcabcabcabcabcabcabcabcabcabcabcabcabcabcabc";
+  const auto compressed = lz4::compress(
+      reinterpret_cast<const uint8_t*>(text.data()), text.size());
+
+  // wrong decompressed size
+  EXPECT_THROW(lz4::decompress(compressed.data(), compressed.size(), text.size() + 1),
+               core::Exception);
+  EXPECT_THROW(lz4::decompress(compressed.data(), compressed.size(), text.size() - 1),
+               core::Exception);
+
+  // a decompressed size which can't possibly be produced by the block
+  // (rejected upfront, without allocating the output buffer)
+  EXPECT_THROW(lz4::decompress(compressed.data(), compressed.size(), SIZE_MAX),
+               core::Exception);
+  EXPECT_THROW(lz4::decompress(compressed.data(), compressed.size(),
+                               (compressed.size() + 1) * 255),
+               core::Exception);
+
+  // truncated block
+  EXPECT_THROW(lz4::decompress(compressed.data(), compressed.size() - 1, text.size()),
+               core::Exception);
+
+  // invalid match offset
+  const vector<uint8_t> invalid_offset = { 0x14, 'a', 0x10, 0x00 };
+  EXPECT_THROW(lz4::decompress(invalid_offset.data(), invalid_offset.size(), 32),
+               core::Exception);
+}
+
+TEST(BinaryIoTest, Genotype_Envelope) {
+  TestGenotype genotype;
+  for (int i = 0; i < 1000; ++i)
+    genotype.values.push_back(i % 10);
+
+  for (auto compression :
+       { darwin::GenotypeCompression::None, darwin::GenotypeCompression::Lz4 }) {
+    const auto binary_genotype = genotype.saveBinary(compression);
+    TestGenotype loaded_genotype;
+    loaded_genotype.loadBinary(binary_genotype.data(), binary_genotype.size());
+    EXPECT_EQ(loaded_genotype.values, genotype.values);
+
+    // trailing data
+    auto extra_data = binary_genotype;
+    extra_data.push_back(0);
+    EXPECT_THROW(loaded_genotype.loadBinary(extra_data.data(), extra_data.size()),
+                 core::Exception);
+
+    // invalid magic number
+    auto invalid_magic = binary_genotype;
+    invalid_magic[0] ^= 0xff;
+    EXPECT_THROW(loaded_genotype.loadBinary(invalid_magic.data(), invalid_magic.size()),
+                 core::Exception);
+  }
+
+  // LZ4 compression must shrink the repetitive payload
+  EXPECT_LT(genotype.saveBinary(darwin::GenotypeCompression::Lz4).size(),
+            genotype.saveBinary(darwin::GenotypeCompression::None).size());
+}
+
+TEST(BinaryIoTest, Genotype_ContentHash) {
+  TestGenotype genotype;
+  genotype.values = { 1, 2, 3 };
+
+  // the content hash doesn't depend on the fitness
+  TestGenotype same_genotype;
+  same_genotype.values = genotype.values;
+  same_genotype.fitness = 100;
+  EXPECT_EQ(same_genotype.contentHash(), genotype.contentHash());
+
+  TestGenotype different_genotype;
+  different_genotype.values = { 1, 2, 4 };
+  EXPECT_NE(different_genotype.contentHash(), genotype.contentHash());
+}
+
+}  // namespace binary_io_tests
@@ -0,0 +1,229 @@
+// Copyright 2018 The Darwin Neuroevolution Framework Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <core/cart_pole_physics.h>
+
+#include <third_party/gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+using namespace std;
+
+namespace cart_pole_physics_tests {
+
+constexpr float kTimeStep = 1.0f / 50.0f;
+
+// uniform rods (4cm wide), hinged at one end
+physics::CartPoleModel testModel(int poles) {
+  const float kLength[] = { 1.5f, 0.3f };
+  physics::CartPoleModel model;
+  model.cart_mass = 1.0f;
+  model.poles = poles;
+  for (int pole = 0; pole < poles; ++pole) {
+    const float mass = 0.04f * kLength[pole];
+    model.pole_mass[pole] = mass;
+    model.pole_half_length[pole] = kLength[pole] / 2;
+    model.pole_inertia[pole] = mass * (0.04f * 0.04f + kLength[pole] * kLength[pole]) / 12;
+  }
+  return model;
+}
+
+// the total mechanical energy
+double energy(const physics::CartPoleModel& model, const physics::CartPoleState& state) {
+  const double v = state.cart_velocity;
+  double energy = 0.5 * model.cart_mass * v * v;
+  for (int pole = 0; pole < model.poles; ++pole) {
+    const double m = model.pole_mass[pole];
+    const double l = model.pole_half_length[pole];
+    const double theta = state.pole_angle[pole];
+    const double omega = state.pole_angular_velocity[pole];
+
+    // the velocity of the pole's center of mass
+    const double vx = v - l * cos(theta) * omega;
+    const double vy = -l * sin(theta) * omega;
+
+    energy += 0.5 * m * (vx * vx + vy * vy);
+    energy += 0.5 * model.pole_inertia[pole] * omega * omega;
+    energy += m * model.gravity * l * cos(theta);
+  }
+  return energy;
+}
+
+TEST(CartPolePhysicsTest, Direction) {
+  const auto model = testModel(1);
+
+  // a pole leaning left (counter-clockwise) falls to the left,
+  // pushing the cart to the right
+  physics::CartPoleState state;
+  state.pole_angle[0] = 0.1f;
+  physics::step(model, state, 0.0f, kTimeStep);
+  EXPECT_GT(state.pole_angle[0], 0.1f);
+  EXPECT_GT(state.pole_angular_velocity[0], 0.0f);
+  EXPECT_GT(state.cart_velocity, 0.0f);
+
+  // pushing the cart right tilts an upright pole to the left
+  physics::CartPoleState pushed;
+  physics::step(model, pushed, 1.0f, kTimeStep);
+  EXPECT_GT(pushed.cart_distance, 0.0f);
+  EXPECT_GT(pushed.cart_velocity, 0.0f);
+  EXPECT_GT(pushed.pole_angle[0], 0.0f);
+
+  // the balanced state is an equilibrium
+  physics::CartPoleState balanced;
+  physics::step(model, balanced, 0.0f, kTimeStep);
+  EXPECT_EQ(balanced.cart_distance, 0.0f);
+  EXPECT_EQ(balanced.pole_angle[0], 0.0f);
+}
+
+// without external forces, the energy and the horizontal momentum are conserved
+TEST(CartPolePhysicsTest, Conservation) {
+  for (int poles = 1; poles <= physics::kMaxPoles; ++poles) {
+    const auto model = testModel(poles);
+
+    physics::CartPoleState state;
+    state.cart_velocity = 0.5f;
+    state.pole_angle[0] = 0.2f;
+    state.pole_angle[1] = -0.1f;
+
+    auto momentum = [&](const physics::CartPoleState& state) {
+      double momentum = model.cart_mass * state.cart_velocity;
+      for (int pole = 0; pole < poles; ++pole) {
+        const double m = model.pole_mass[pole];
+        const double l = model.pole_half_length[pole];
+        momentum += m * (state.cart_velocity -
+                         l * cos(state.pole_angle[pole]) * state.pole_angular_velocity[pole]);
+      }
+      return momentum;
+    };
+
+    const double initial_energy = energy(model, state);
+    const double initial_momentum = momentum(state);
+
+    // (the poles are allowed to swing past the horizontal)
+    for (int step = 0; step < 100; ++step) {
+      physics::step(model, state, 0.0f, kTimeStep);
+      EXPECT_NEAR(energy(model, state), initial_energy, 1e-3);
+      EXPECT_NEAR(momentum(state), initial_momentum, 1e-4);
+    }
+  }
+}
+
+// every kernel must match the scalar step(), including the padding lanes
+TEST(CartPolePhysicsTest, BatchKernels) {
+  const auto kernels = physics::CartPoleBatch::availableKernels();
+  ASSERT_FALSE(kernels.empty());
+  EXPECT_EQ(kernels.front().name, "scalar");
+
+  default_random_engine rnd(1);
+  uniform_real_distribution<float> dist_angle(-1.5f, 1.5f);
+  uniform_real_distribution<float> dist_velocity(-2.0f, 2.0f);
+  uniform_real_distribution<float> dist_force(-10.0f, 10.0f);
+
+  for (int poles = 1; poles <= physics::kMaxPoles; ++poles) {
+    const auto model = testModel(poles);
+    for (size_t size : { 1, 8, 15, 16, 17, 50 }) {
+      vector<physics::CartPoleState> states(size);
+      for (auto& state : states) {
+        state.cart_distance = dist_velocity(rnd);
+        state.cart_velocity = dist_velocity(rnd);
+        for (int pole = 0; pole < poles; ++pole) {
+          state.pole_angle[pole] = dist_angle(rnd);
+          state.pole_angular_velocity[pole] = dist_velocity(rnd);
+        }
+      }
+
+      vector<vector<float>> forces(10, vector<float>(size));
+      for (auto& step_forces : forces)
+        for (float& force : step_forces)
+          force = dist_force(rnd);
+
+      for (const auto& kernel : kernels) {
+        SCOPED_TRACE(kernel.name);
+        physics::CartPoleBatch batch(model, size, kernel.kernel);
+        EXPECT_EQ(batch.size(), size);
+
+        auto expected_states = states;
+        for (size_t i = 0; i < size; ++i)
+          batch.setState(i, states[i]);
+
+        for (const auto& step_forces : forces) {
+          for (size_t i = 0; i < size; ++i) {
+            batch.setForce(i, step_forces[i]);
+            physics::step(model, expected_states[i], step_forces[i], kTimeStep);
+          }
+          batch.step(kTimeStep);
+        }
+
+        for (size_t i = 0; i < size; ++i) {
+          const auto state = batch.state(i);
+          const auto& expected = expected_states[i];
+          EXPECT_NEAR(state.cart_distance, expected.cart_distance, 1e-4);
+          EXPECT_NEAR(state.cart_velocity, expected.cart_velocity, 1e-4);
+          for (int pole = 0; pole < physics::kMaxPoles; ++pole) {
+            EXPECT_NEAR(state.pole_angle[pole], expected.pole_angle[pole], 1e-4);
+            EXPECT_NEAR(state.pole_angular_velocity[pole],
+                        expected.pole_angular_velocity[pole],
+                        1e-3);
+          }
+        }
+      }
+    }
+  }
+}
+
+// the forces only apply to the next step
+TEST(CartPolePhysicsTest, BatchForces) {
+  const auto model = testModel(1);
+  physics::CartPoleBatch batch(model, 2);
+
+  batch.setForce(0, 5.0f);
+  batch.step(kTimeStep);
+  const auto pushed = batch.state(0);
+  EXPECT_GT(pushed.cart_velocity, 0);
+  EXPECT_EQ(batch.state(1).cart_velocity, 0);
+
+  batch.step(kTimeStep);
+  physics::CartPoleState expected = pushed;
+  physics::step(model, expected, 0.0f, kTimeStep);
+  EXPECT_NEAR(batch.state(0).cart_velocity, expected.cart_velocity, 1e-5);
+}
+
+TEST(CartPolePhysicsTest, Validation) {
+  const auto model = testModel(2);
+
+  physics::CartPoleState before;
+  before.pole_angle[0] = 0.1f;
+  before.pole_angle[1] = -0.05f;
+
+  physics::CartPoleState after = before;
+  physics::step(model, after, 1.0f, kTimeStep);
+
+  physics::Validation validation;
+  validation.check(model, before, 1.0f, kTimeStep, after);
+  EXPECT_EQ(validation.steps(), 1);
+  EXPECT_EQ(validation.maxDeviation(), 0);
+
+  after.pole_angular_velocity[1] += 0.25f;
+  validation.check(model, before, 1.0f, kTimeStep, after);
+  EXPECT_EQ(validation.steps(), 2);
+  EXPECT_NEAR(validation.maxDeviation(), 0.25f, 1e-6);
+
+  validation.reset();
+  EXPECT_EQ(validation.steps(), 0);
+  EXPECT_EQ(validation.maxDeviation(), 0);
+}
+
+}  // namespace cart_pole_physics_tests
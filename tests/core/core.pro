@@ -8,9 +8,17 @@ SOURCES += \
     format_tests.cpp \
     compressed_fitness_tests.cpp \
     parallel_for_tests.cpp \
+    thread_pool_tests.cpp \
+    rng_tests.cpp \
     properties_variant_tests.cpp \
     misc_tests.cpp \
     selection_algorithms_tests.cpp \
-    tournament_tests.cpp
+    tournament_tests.cpp \
+    ann_tests.cpp \
+    cart_pole_physics_tests.cpp \
+    universe_tests.cpp \
+    binary_io_tests.cpp \
+    population_trace_tests.cpp \
+    progress_counter_tests.cpp
     
 include(../tests_common.pri)
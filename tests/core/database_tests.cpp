@@ -22,6 +22,7 @@
 #include <inttypes.h>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <tuple>
 using namespace std;
 
@@ -228,4 +229,87 @@ TEST_F(DatabaseTest, Pragmas) {
   }
 }
 
+TEST_F(DatabaseTest, Query) {
+  db->exec(
+      "create table cursor(id integer primary key, value real, name text, data blob)");
+
+  constexpr int kRows = 100;
+  for (int i = 0; i < kRows; ++i) {
+    db->exec("insert into cursor(value, name) values(?, ?)",
+             i * 0.5,
+             i % 10 == 0 ? optional<string>() : "name_" + to_string(i));
+  }
+  db->exec("update cursor set data = x'00ff0010' where id = 1");
+
+  int rows = 0;
+  for (const auto& [id, value, name] : db->query<int, double, string_view>(
+           "select id, value, name from cursor where id > ? order by id", 0)) {
+    const int i = id.value() - 1;
+    EXPECT_EQ(i, rows);
+    EXPECT_EQ(value.value(), i * 0.5);
+    if (i % 10 == 0)
+      EXPECT_FALSE(name.has_value());
+    else
+      EXPECT_EQ(name.value(), "name_" + to_string(i));
+    ++rows;
+  }
+  EXPECT_EQ(rows, kRows);
+
+  // BLOB values
+  auto query = db->query<string_view>("select data from cursor where id = 1");
+  ASSERT_TRUE(query.next());
+  EXPECT_EQ(get<0>(query.row()).value(), string_view("\x00\xff\x00\x10", 4));
+  EXPECT_FALSE(query.next());
+  EXPECT_FALSE(query.next());
+
+  // empty results
+  for (const auto& row : db->query<int>("select id from cursor where id < 0")) {
+    ADD_FAILURE() << "unexpected row: " << get<0>(row).value_or(0);
+  }
+
+  // column count mismatch
+  EXPECT_THROW(db->query<int>("select id, value from cursor"), core::Exception);
+
+  // result types don't match the query results
+  EXPECT_THROW(
+      {
+        for (const auto& row : db->query<string_view>("select value from cursor"))
+          (void)row;
+      },
+      core::Exception);
+}
+
+TEST_F(DatabaseTest, StatementsCache) {
+  db->exec("create table cache(id integer primary key, value int)");
+
+  const string insert_sql = "insert into cache(value) values(?)";
+  for (int i = 0; i < 10; ++i) {
+    auto statement = db->prepare(insert_sql);
+    statement->bind(i);
+    EXPECT_FALSE(statement->step());
+  }
+
+  // nested uses of the same statement
+  const string select_sql = "select value from cache where value >= ? order by value";
+  int outer_rows = 0;
+  for (const auto& [outer] : db->query<int>(select_sql, 5)) {
+    int inner_rows = 0;
+    for (const auto& [inner] : db->query<int>(select_sql, outer.value())) {
+      EXPECT_GE(inner.value(), outer.value());
+      ++inner_rows;
+    }
+    EXPECT_EQ(inner_rows, 10 - outer.value());
+    ++outer_rows;
+  }
+  EXPECT_EQ(outer_rows, 5);
+
+  // a cached statement must not keep the previous parameters or results
+  const string count_sql = "select count(*) from cache where value >= ?";
+  EXPECT_EQ(db->exec<int>(count_sql, 7).singleValue(), 3);
+  EXPECT_EQ(db->exec<int>(count_sql, 2).singleValue(), 8);
+
+  // (unbound parameters are NULL)
+  EXPECT_EQ(db->exec<int>(count_sql).singleValue(), 0);
+}
+
 }  // namespace database_tests
@@ -14,6 +14,7 @@
 
 #include <core/utils.h>
 #include <core/parallel_for_each.h>
+#include <core/rng.h>
 
 #include <third_party/gtest/gtest.h>
 
@@ -35,7 +36,8 @@ TEST(ParallelForTest, Basic) {
   }
 }
 
-static void parallelForLoop(int array_size) {
+static void parallelForLoop(int array_size,
+                            pp::Partitioner partitioner = pp::Partitioner::Static) {
   vector<int> array(array_size);
 
   // initialize with [1..size]
@@ -45,10 +47,12 @@ static void parallelForLoop(int array_size) {
   atomic<int64_t> sum = 0;
 
   // parallel-for-loop
-  pp::for_each(array, [&](int index, int& value) {
-    sum += value;
-    value = -index;
-  });
+  pp::for_each(array,
+               [&](int index, int& value) {
+                 sum += value;
+                 value = -index;
+               },
+               partitioner);
 
   // validation
   const int64_t n = array_size;
@@ -75,4 +79,78 @@ TEST(ParallelForTest, LargeArrays) {
   parallelForLoop(1000000);
 }
 
+TEST(ParallelForTest, GuidedPartitioner) {
+  for (int array_size = 0; array_size < 100; ++array_size) {
+    parallelForLoop(array_size, pp::Partitioner::Guided);
+  }
+  parallelForLoop(25000, pp::Partitioner::Guided);
+  parallelForLoop(1000000, pp::Partitioner::Guided);
+}
+
+TEST(ParallelForTest, Partition) {
+  for (auto partitioner : { pp::Partitioner::Static, pp::Partitioner::Guided }) {
+    for (int threads_count : { 1, 3, 64 }) {
+      for (int size : { 1, 2, 5, 100, 6401, 100000 }) {
+        const auto bounds = pp::partition(size, threads_count, partitioner);
+        ASSERT_GE(bounds.size(), 2);
+        EXPECT_EQ(bounds.front(), 0);
+        EXPECT_EQ(bounds.back(), size);
+        for (size_t i = 1; i < bounds.size(); ++i) {
+          EXPECT_LT(bounds[i - 1], bounds[i]);
+        }
+      }
+    }
+  }
+
+  // guided shards must be non-increasing in size
+  const auto bounds = pp::partition(100000, 8, pp::Partitioner::Guided);
+  for (size_t i = 2; i < bounds.size(); ++i) {
+    EXPECT_LE(bounds[i] - bounds[i - 1], bounds[i - 1] - bounds[i - 2]);
+  }
+}
+
+static vector<uint64_t> randomValues(uint64_t master_seed, pp::Partitioner partitioner) {
+  rng::setReproducibleMode(true, master_seed);
+  vector<uint64_t> values(10000);
+  pp::for_each(
+      values,
+      [](int, uint64_t& value) {
+        auto& rnd = rng::threadGenerator();
+        rnd();
+        value = rnd();
+      },
+      partitioner);
+  rng::setReproducibleMode(false);
+  return values;
+}
+
+TEST(ParallelForTest, ReproducibleModeScope) {
+  vector<int> reproducible(1000);
+
+  // the loop body follows the calling thread's mode
+  {
+    rng::ReproducibleScope reproducible_scope(true, 1);
+    pp::for_each(reproducible,
+                 [](int, int& value) { value = rng::reproducibleMode() ? 1 : 0; });
+  }
+  for (int value : reproducible)
+    EXPECT_EQ(value, 1);
+
+  pp::for_each(reproducible,
+               [](int, int& value) { value = rng::reproducibleMode() ? 1 : 0; });
+  for (int value : reproducible)
+    EXPECT_EQ(value, 0);
+}
+
+TEST(ParallelForTest, ReproducibleMode) {
+  const auto values = randomValues(1, pp::Partitioner::Static);
+
+  // same master seed, different scheduling
+  EXPECT_EQ(randomValues(1, pp::Partitioner::Static), values);
+  EXPECT_EQ(randomValues(1, pp::Partitioner::Guided), values);
+
+  // different master seed
+  EXPECT_NE(randomValues(2, pp::Partitioner::Static), values);
+}
+
 }  // namespace parallel_for_tests
@@ -0,0 +1,183 @@
+// Copyright 2018 The Darwin Neuroevolution Framework Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <core/binary_io.h>
+#include <core/exception.h>
+#include <core/population_trace.h>
+
+#include <third_party/gtest/gtest.h>
+
+#include <math.h>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <random>
+#include <vector>
+using namespace std;
+
+namespace population_trace_tests {
+
+using darwin::FitnessTraceEncoding;
+using darwin::PopulationTrace;
+
+vector<uint8_t> encode(const PopulationTrace& trace) {
+  core::BinaryWriter writer;
+  writer.write(trace);
+  return writer.data();
+}
+
+PopulationTrace decode(const vector<uint8_t>& data) {
+  core::BinaryReader reader(data);
+  auto trace = reader.read<PopulationTrace>();
+  EXPECT_TRUE(reader.atEnd());
+  return trace;
+}
+
+vector<float> rankedFitness(size_t size) {
+  default_random_engine rnd(1);
+  normal_distribution<float> dist_fitness(100.0f, 25.0f);
+  vector<float> values(size);
+  for (float& value : values)
+    value = dist_fitness(rnd);
+  sort(values.begin(), values.end(), greater<float>());
+  return values;
+}
+
+TEST(PopulationTraceTest, Fitness_Float32) {
+  PopulationTrace trace;
+  trace.fitness_encoding = FitnessTraceEncoding::Float32;
+  trace.ranked_fitness = rankedFitness(1000);
+
+  const auto decoded_trace = decode(encode(trace));
+  EXPECT_EQ(decoded_trace.fitness_encoding, FitnessTraceEncoding::Float32);
+  EXPECT_EQ(decoded_trace.ranked_fitness, trace.ranked_fitness);
+  EXPECT_TRUE(decoded_trace.operator_codes.empty());
+}
+
+TEST(PopulationTraceTest, Fitness_Delta) {
+  PopulationTrace trace;
+  trace.fitness_encoding = FitnessTraceEncoding::Delta;
+  trace.ranked_fitness = rankedFitness(1000);
+
+  // the delta encoding is lossless, including the special values
+  trace.ranked_fitness.push_back(0.0f);
+  trace.ranked_fitness.push_back(-0.0f);
+  trace.ranked_fitness.push_back(-1.5f);
+  trace.ranked_fitness.push_back(numeric_limits<float>::lowest());
+  trace.ranked_fitness.push_back(-numeric_limits<float>::infinity());
+  trace.ranked_fitness.insert(trace.ranked_fitness.begin(),
+                              numeric_limits<float>::infinity());
+
+  const auto data = encode(trace);
+  const auto decoded_trace = decode(data);
+  EXPECT_EQ(decoded_trace.fitness_encoding, FitnessTraceEncoding::Delta);
+  ASSERT_EQ(decoded_trace.ranked_fitness.size(), trace.ranked_fitness.size());
+  for (size_t i = 0; i < trace.ranked_fitness.size(); ++i) {
+    EXPECT_EQ(decoded_trace.ranked_fitness[i], trace.ranked_fitness[i]);
+    EXPECT_EQ(signbit(decoded_trace.ranked_fitness[i]),
+              signbit(trace.ranked_fitness[i]));
+  }
+
+  // the deltas between sorted values are smaller than the raw values
+  PopulationTrace raw_trace = trace;
+  raw_trace.fitness_encoding = FitnessTraceEncoding::Float32;
+  EXPECT_LT(data.size(), encode(raw_trace).size());
+}
+
+TEST(PopulationTraceTest, Fitness_Quantized) {
+  PopulationTrace trace;
+  trace.fitness_encoding = FitnessTraceEncoding::Quantized;
+  trace.ranked_fitness = rankedFitness(1000);
+
+  const auto decoded_trace = decode(encode(trace));
+  EXPECT_EQ(decoded_trace.fitness_encoding, FitnessTraceEncoding::Quantized);
+  ASSERT_EQ(decoded_trace.ranked_fitness.size(), trace.ranked_fitness.size());
+
+  const float best = trace.ranked_fitness.front();
+  const float worst = trace.ranked_fitness.back();
+  const float max_error = (best - worst) / 65535 * 0.51f;
+  EXPECT_EQ(decoded_trace.ranked_fitness.front(), best);
+  for (size_t i = 0; i < trace.ranked_fitness.size(); ++i)
+    EXPECT_NEAR(decoded_trace.ranked_fitness[i], trace.ranked_fitness[i], max_error);
+
+  // constant values
+  trace.ranked_fitness.assign(100, 5.0f);
+  EXPECT_EQ(decode(encode(trace)).ranked_fitness, trace.ranked_fitness);
+
+  // non-finite values are not quantized
+  trace.ranked_fitness = { numeric_limits<float>::infinity(), 1.0f, 0.0f };
+  const auto fallback_trace = decode(encode(trace));
+  EXPECT_EQ(fallback_trace.fitness_encoding, FitnessTraceEncoding::Delta);
+  EXPECT_EQ(fallback_trace.ranked_fitness, trace.ranked_fitness);
+}
+
+TEST(PopulationTraceTest, Genealogy) {
+  PopulationTrace trace;
+  trace.addGenealogy("", {});
+  trace.addGenealogy("e", { 0 });
+  trace.addGenealogy("c", { 3, 1 });
+  trace.addGenealogy("m", { 2 });
+  trace.addGenealogy("c", { 10, 20 });
+
+  EXPECT_EQ(trace.genetic_operators, (vector<string>{ "e", "c", "m" }));
+  constexpr auto kNoOperator = PopulationTrace::kNoOperator;
+  EXPECT_EQ(trace.operator_codes, (vector<uint8_t>{ kNoOperator, 0, 1, 2, 1 }));
+  EXPECT_EQ(trace.parents_counts, (vector<uint8_t>{ 0, 1, 2, 1, 2 }));
+  EXPECT_EQ(trace.parents, (vector<int32_t>{ 0, 3, 1, 2, 10, 20 }));
+
+  const auto decoded_trace = decode(encode(trace));
+  EXPECT_TRUE(decoded_trace.ranked_fitness.empty());
+  EXPECT_EQ(decoded_trace.genetic_operators, trace.genetic_operators);
+  EXPECT_EQ(decoded_trace.operator_codes, trace.operator_codes);
+  EXPECT_EQ(decoded_trace.parents_counts, trace.parents_counts);
+  EXPECT_EQ(decoded_trace.parents, trace.parents);
+}
+
+TEST(PopulationTraceTest, InvalidData) {
+  PopulationTrace trace;
+  trace.fitness_encoding = FitnessTraceEncoding::Delta;
+  trace.ranked_fitness = rankedFitness(10);
+  trace.addGenealogy("c", { 3, 1 });
+  trace.addGenealogy("m", { 2 });
+  const auto data = encode(trace);
+
+  // truncated data
+  for (size_t size = 0; size < data.size(); ++size) {
+    core::BinaryReader reader(data.data(), size);
+    EXPECT_THROW(reader.read<PopulationTrace>(), core::Exception);
+  }
+
+  // unknown format version
+  auto invalid_version = data;
+  invalid_version[0] = 0xff;
+  EXPECT_THROW(decode(invalid_version), core::Exception);
+
+  // unknown fitness encoding
+  auto invalid_encoding = data;
+  invalid_encoding[1] = 0xff;
+  EXPECT_THROW(decode(invalid_encoding), core::Exception);
+
+  // invalid operator code
+  PopulationTrace invalid_trace = trace;
+  invalid_trace.operator_codes[1] = 5;
+  EXPECT_THROW(decode(encode(invalid_trace)), core::Exception);
+
+  // mismatched parents count
+  invalid_trace = trace;
+  invalid_trace.parents.push_back(7);
+  EXPECT_THROW(decode(encode(invalid_trace)), core::Exception);
+}
+
+}  // namespace population_trace_tests
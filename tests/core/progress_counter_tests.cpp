@@ -0,0 +1,100 @@
+// Copyright 2018 The Darwin Neuroevolution Framework Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <core/utils.h>
+#include <core/progress_counter.h>
+
+#include <third_party/gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+using namespace std;
+
+namespace progress_counter_tests {
+
+TEST(ProgressCounterTest, Throttling) {
+  darwin::ProgressCounter counter;
+
+  // the first increment always triggers a notification
+  EXPECT_TRUE(counter.add(1));
+  EXPECT_FALSE(counter.add(2));
+  EXPECT_FALSE(counter.add(3));
+  EXPECT_EQ(counter.pending(), 6);
+
+  this_thread::sleep_for(darwin::ProgressCounter::kNotificationInterval);
+  EXPECT_TRUE(counter.add(4));
+  EXPECT_FALSE(counter.add(5));
+
+  EXPECT_EQ(counter.fold(), 15);
+  EXPECT_EQ(counter.pending(), 0);
+  EXPECT_EQ(counter.fold(), 0);
+}
+
+TEST(ProgressCounterTest, MultipleThreads) {
+  using Clock = chrono::steady_clock;
+
+  // more threads than stripes, so some of the stripes are shared
+  constexpr int kThreads = darwin::ProgressCounter::kStripes * 2 + 1;
+  constexpr int kIncrements = 20000;
+
+  darwin::ProgressCounter counter;
+  atomic<int> notifications = 0;
+  atomic<int> finished_threads = 0;
+
+  const auto start_time = Clock::now();
+
+  vector<thread> threads;
+  for (int i = 0; i < kThreads; ++i) {
+    threads.emplace_back([&, i] {
+      for (int j = 0; j < kIncrements; ++j) {
+        if (counter.add(size_t(i % 3 + 1)))
+          ++notifications;
+      }
+      ++finished_threads;
+    });
+  }
+
+  // fold the progress while the threads are still reporting
+  // (emulating the stage transitions and the snapshots)
+  size_t folded_progress = 0;
+  while (finished_threads < kThreads) {
+    EXPECT_LE(counter.pending(), size_t(kThreads) * kIncrements * 3);
+    folded_progress += counter.fold();
+    this_thread::yield();
+  }
+
+  for (auto& thread : threads)
+    thread.join();
+
+  const auto elapsed = Clock::now() - start_time;
+
+  // the final progress is the pending progress after the last add()
+  folded_progress += counter.fold();
+  EXPECT_EQ(counter.pending(), 0);
+
+  size_t expected_progress = 0;
+  for (int i = 0; i < kThreads; ++i)
+    expected_progress += size_t(i % 3 + 1) * kIncrements;
+  EXPECT_EQ(folded_progress, expected_progress);
+
+  // at most one notification per interval (plus the first one)
+  const auto max_notifications =
+      elapsed / darwin::ProgressCounter::kNotificationInterval + 1;
+  EXPECT_GE(notifications, 1);
+  EXPECT_LE(notifications, max_notifications);
+}
+
+}  // namespace progress_counter_tests
@@ -0,0 +1,148 @@
+// Copyright 2019 The Darwin Neuroevolution Framework Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <core/rng.h>
+
+#include <third_party/gtest/gtest.h>
+
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+using namespace std;
+
+namespace rng_tests {
+
+TEST(RngTest, KnownValues) {
+  // reference values: SplitMix64 seeding + the reference xoshiro256** implementation
+  rng::Xoshiro256 rnd(0);
+  EXPECT_EQ(rnd(), 11091344671253066420ull);
+  EXPECT_EQ(rnd(), 13793997310169335082ull);
+  EXPECT_EQ(rnd(), 1900383378846508768ull);
+  EXPECT_EQ(rnd(), 7684712102626143532ull);
+}
+
+TEST(RngTest, Seeding) {
+  rng::Generator rnd_1(123);
+  rng::Generator rnd_2(123);
+  rng::Generator rnd_3(124);
+  EXPECT_EQ(rnd_1, rnd_2);
+  EXPECT_NE(rnd_1, rnd_3);
+
+  for (int i = 0; i < 100; ++i)
+    EXPECT_EQ(rnd_1(), rnd_2());
+
+  rnd_3.seed(123);
+  EXPECT_EQ(rnd_3, rng::Generator(123));
+}
+
+TEST(RngTest, Streams) {
+  constexpr uint64_t kSeed = 42;
+
+  // stream generators are reproducible
+  auto rnd_a = rng::streamGenerator(kSeed, 7);
+  auto rnd_b = rng::streamGenerator(kSeed, 7);
+  EXPECT_EQ(rnd_a, rnd_b);
+
+  // ... and distinct for different streams or seeds
+  set<uint64_t> first_values;
+  for (uint64_t stream = 0; stream < 1000; ++stream) {
+    first_values.insert(rng::streamGenerator(kSeed, stream)());
+    first_values.insert(rng::streamGenerator(kSeed + 1, stream)());
+  }
+  EXPECT_EQ(first_values.size(), 2000);
+}
+
+TEST(RngTest, Distributions) {
+  rng::Generator rnd(1);
+
+  uniform_real_distribution<float> dist_real(-1.0f, 1.0f);
+  uniform_int_distribution<int> dist_int(0, 9);
+  vector<int> histogram(10);
+  double sum = 0;
+
+  constexpr int kSamples = 100000;
+  for (int i = 0; i < kSamples; ++i) {
+    const float value = dist_real(rnd);
+    EXPECT_GE(value, -1.0f);
+    EXPECT_LT(value, 1.0f);
+    sum += value;
+    ++histogram[dist_int(rnd)];
+  }
+
+  EXPECT_NEAR(sum / kSamples, 0.0, 0.01);
+  for (int count : histogram)
+    EXPECT_NEAR(count, kSamples / 10, kSamples / 100);
+}
+
+TEST(RngTest, ThreadGenerators) {
+  // each thread has its own generator
+  uint64_t value_1 = 0;
+  uint64_t value_2 = 0;
+  const rng::Generator* generator_1 = nullptr;
+  const rng::Generator* generator_2 = nullptr;
+
+  thread thread_1([&] {
+    generator_1 = &rng::threadGenerator();
+    value_1 = rng::threadGenerator()();
+  });
+  thread thread_2([&] {
+    generator_2 = &rng::threadGenerator();
+    value_2 = rng::threadGenerator()();
+  });
+  thread_1.join();
+  thread_2.join();
+
+  EXPECT_NE(value_1, value_2);
+
+  // the same generator instance is returned for the calling thread
+  EXPECT_EQ(&rng::threadGenerator(), &rng::threadGenerator());
+}
+
+TEST(RngTest, ReproducibleScope) {
+  EXPECT_FALSE(rng::reproducibleMode());
+  const rng::Generator original_generator = rng::threadGenerator();
+
+  uint64_t first_value = 0;
+  {
+    rng::ReproducibleScope reproducible_scope(true, 1);
+    EXPECT_TRUE(rng::reproducibleMode());
+    first_value = rng::threadGenerator()();
+
+    // the reproducible mode doesn't leak into the other threads
+    bool other_thread_reproducible = true;
+    thread other_thread([&] { other_thread_reproducible = rng::reproducibleMode(); });
+    other_thread.join();
+    EXPECT_FALSE(other_thread_reproducible);
+
+    // nested scopes restore the outer scope's state
+    {
+      rng::ReproducibleScope nested_scope(false, 0);
+      EXPECT_FALSE(rng::reproducibleMode());
+    }
+    EXPECT_TRUE(rng::reproducibleMode());
+  }
+
+  // the previous mode and generator state are restored
+  EXPECT_FALSE(rng::reproducibleMode());
+  EXPECT_EQ(rng::threadGenerator(), original_generator);
+
+  // same master seed, same values
+  {
+    rng::ReproducibleScope reproducible_scope(true, 1);
+    EXPECT_EQ(rng::threadGenerator()(), first_value);
+  }
+}
+
+}  // namespace rng_tests
@@ -0,0 +1,161 @@
+// Copyright 2019 The Darwin Neuroevolution Framework Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <core/utils.h>
+#include <core/thread_pool.h>
+#include <core/work_stealing_deque.h>
+
+#include <third_party/gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+using namespace std;
+
+namespace thread_pool_tests {
+
+TEST(WorkStealingDequeTest, OwnerOnly) {
+  vector<int> values(1000);
+  pp::WorkStealingDeque<int> deque(4);
+  EXPECT_TRUE(deque.empty());
+  EXPECT_EQ(deque.pop(), nullptr);
+  EXPECT_EQ(deque.steal(), nullptr);
+
+  // push enough values to force a few buffer reallocations
+  for (auto& value : values)
+    deque.push(&value);
+  EXPECT_FALSE(deque.empty());
+
+  // steal from the top (FIFO)
+  EXPECT_EQ(deque.steal(), &values[0]);
+  EXPECT_EQ(deque.steal(), &values[1]);
+
+  // pop from the bottom (LIFO)
+  for (size_t i = values.size() - 1; i >= 2; --i)
+    EXPECT_EQ(deque.pop(), &values[i]);
+
+  EXPECT_TRUE(deque.empty());
+  EXPECT_EQ(deque.pop(), nullptr);
+  EXPECT_EQ(deque.steal(), nullptr);
+}
+
+TEST(WorkStealingDequeTest, ConcurrentSteal) {
+  constexpr int kItems = 200000;
+  constexpr int kThieves = 4;
+
+  vector<atomic<int>> visits(kItems);
+  vector<int> values(kItems);
+  for (int i = 0; i < kItems; ++i)
+    values[i] = i;
+
+  pp::WorkStealingDeque<int> deque(16);
+  atomic<bool> done = false;
+
+  vector<thread> thieves;
+  for (int i = 0; i < kThieves; ++i) {
+    thieves.emplace_back([&] {
+      while (!done) {
+        if (auto value = deque.steal())
+          ++visits[*value];
+      }
+    });
+  }
+
+  // the owner interleaves pushes and pops
+  for (int i = 0; i < kItems; ++i) {
+    deque.push(&values[i]);
+    if (i % 3 == 0) {
+      if (auto value = deque.pop())
+        ++visits[*value];
+    }
+  }
+  while (auto value = deque.pop())
+    ++visits[*value];
+
+  done = true;
+  for (auto& thief : thieves)
+    thief.join();
+
+  // each value must be visited exactly once
+  for (int i = 0; i < kItems; ++i)
+    EXPECT_EQ(visits[i], 1) << "index " << i;
+}
+
+static void processBatch(pp::ThreadPool& thread_pool, int batch_size) {
+  vector<atomic<int>> visits(batch_size);
+
+  auto batch = make_unique<pp::WorkBatch>();
+  for (int i = 0; i < batch_size; ++i) {
+    batch->pushWork([&, index = i] { ++visits[index]; });
+  }
+  thread_pool.processBatch(std::move(batch));
+
+  for (int i = 0; i < batch_size; ++i)
+    EXPECT_EQ(visits[i], 1);
+}
+
+TEST(ThreadPoolTest, Batches) {
+  for (int threads_count : { 1, 2, 7, 32 }) {
+    pp::ThreadPool thread_pool(threads_count);
+    EXPECT_EQ(thread_pool.threadsCount(), threads_count);
+    for (int batch_size : { 1, 2, 3, 31, 32, 33, 1000, 100000 }) {
+      processBatch(thread_pool, batch_size);
+    }
+  }
+}
+
+TEST(ThreadPoolTest, ConcurrentBatches) {
+  pp::ThreadPool thread_pool(4);
+  vector<thread> producers;
+  for (int i = 0; i < 4; ++i) {
+    producers.emplace_back([&] {
+      for (int j = 0; j < 100; ++j)
+        processBatch(thread_pool, 50 + j);
+    });
+  }
+  for (auto& producer : producers)
+    producer.join();
+}
+
+struct CancelingController : public pp::Controller {
+  atomic<bool> cancel = false;
+
+  void checkpoint() override {
+    if (cancel)
+      throw pp::CanceledException();
+  }
+};
+
+TEST(ThreadPoolTest, Cancellation) {
+  CancelingController controller;
+  pp::ThreadPool thread_pool(4, &controller);
+
+  atomic<int> executed = 0;
+  auto batch = make_unique<pp::WorkBatch>();
+  for (int i = 0; i < 10000; ++i) {
+    batch->pushWork([&] {
+      if (++executed == 100)
+        controller.cancel = true;
+    });
+  }
+  EXPECT_THROW(thread_pool.processBatch(std::move(batch)), pp::CanceledException);
+  EXPECT_LT(executed, 10000);
+
+  // the thread pool must be usable after a canceled batch
+  controller.cancel = false;
+  processBatch(thread_pool, 1000);
+}
+
+}  // namespace thread_pool_tests
@@ -19,7 +19,10 @@
 #include <third_party/gtest/gtest.h>
 
 #include <algorithm>
+#include <atomic>
+#include <memory>
 #include <random>
+#include <thread>
 #include <vector>
 using namespace std;
 
@@ -232,6 +235,96 @@ TEST_P(TournamentTest, SwissTournament_Full) {
   testTournament(&tournament);
 }
 
+struct DummyBrain : public darwin::Brain {
+  // the number of live brains
+  static atomic<int> instances;
+
+  DummyBrain() { ++instances; }
+  ~DummyBrain() override { --instances; }
+
+  void setInput(int, float) override {}
+  float output(int) const override { return 0; }
+  void think() override {}
+  void resetState() override {}
+};
+
+atomic<int> DummyBrain::instances = 0;
+
+struct CountingGenotype : public TestGenotype {
+  mutable atomic<int> grow_count = 0;
+
+  unique_ptr<darwin::Brain> grow() const override {
+    ++grow_count;
+    return make_unique<DummyBrain>();
+  }
+};
+
+TEST(BrainCacheTest, GrowOncePerTournament) {
+  CountingGenotype genotype1;
+  CountingGenotype genotype2;
+
+  tournament::BrainCache::newTournament();
+  auto brain1 = tournament::BrainCache::brain(&genotype1);
+  auto brain2 = tournament::BrainCache::brain(&genotype2);
+  EXPECT_NE(brain1, brain2);
+  EXPECT_EQ(tournament::BrainCache::brain(&genotype1), brain1);
+  EXPECT_EQ(tournament::BrainCache::brain(&genotype2), brain2);
+  EXPECT_EQ(genotype1.grow_count, 1);
+  EXPECT_EQ(genotype2.grow_count, 1);
+
+  // a new tournament invalidates the cached brains
+  tournament::BrainCache::newTournament();
+  tournament::BrainCache::brain(&genotype1);
+  EXPECT_EQ(genotype1.grow_count, 2);
+  EXPECT_EQ(genotype2.grow_count, 1);
+}
+
+TEST(BrainCacheTest, MaxBrains) {
+  constexpr size_t kMaxBrains = tournament::BrainCache::kMaxBrains;
+  vector<CountingGenotype> genotypes(kMaxBrains + 1);
+
+  tournament::BrainCache::newTournament();
+  for (size_t i = 0; i < kMaxBrains; ++i)
+    tournament::BrainCache::brain(&genotypes[i]);
+  const auto last_brain = tournament::BrainCache::brain(&genotypes[kMaxBrains - 1]);
+  EXPECT_EQ(DummyBrain::instances, int(kMaxBrains));
+
+  // one more brain releases all the others, except the most recent one
+  tournament::BrainCache::brain(&genotypes[kMaxBrains]);
+  EXPECT_EQ(DummyBrain::instances, 2);
+  EXPECT_EQ(tournament::BrainCache::brain(&genotypes[kMaxBrains - 1]), last_brain);
+  EXPECT_EQ(genotypes[kMaxBrains - 1].grow_count, 1);
+  tournament::BrainCache::brain(&genotypes[0]);
+  EXPECT_EQ(genotypes[0].grow_count, 2);
+
+  tournament::BrainCache::newTournament();
+  EXPECT_EQ(DummyBrain::instances, 0);
+}
+
+// a new tournament releases the brains cached by all the threads
+TEST(BrainCacheTest, NewTournamentReleasesAllThreads) {
+  CountingGenotype genotype;
+  atomic<bool> brain_ready = false;
+  atomic<bool> done = false;
+
+  tournament::BrainCache::newTournament();
+  thread worker([&] {
+    tournament::BrainCache::brain(&genotype);
+    brain_ready = true;
+    while (!done)
+      this_thread::yield();
+  });
+
+  while (!brain_ready)
+    this_thread::yield();
+  EXPECT_EQ(DummyBrain::instances, 1);
+  tournament::BrainCache::newTournament();
+  EXPECT_EQ(DummyBrain::instances, 0);
+
+  done = true;
+  worker.join();
+}
+
 // instantiate the test cases with various population sizes
 // (must be even values - some of the tournament implementations require it)
 INSTANTIATE_TEST_CASE_P(All, TournamentTest, testing::Values(2, 4, 100));
@@ -0,0 +1,257 @@
+// Copyright 2018 The Darwin Neuroevolution Framework Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <core/universe.h>
+#include <core/database.h>
+#include <core/exception.h>
+
+#include <third_party/gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+using namespace std;
+
+#include <experimental/filesystem>
+namespace fs = std::experimental::filesystem;
+
+namespace universe_tests {
+
+struct UniverseTest : public testing::Test {
+  UniverseTest() {
+    path = universePath();
+    fs::remove(path);
+
+    universe = darwin::Universe::create(path);
+    auto experiment = universe->newExperiment(nullopt, "{}", nullopt);
+    auto variation = universe->newVariation(experiment->id, "{}");
+    trace_id = universe->newTrace(variation->id, "{}")->id;
+  }
+
+  ~UniverseTest() {
+    universe.reset();
+    fs::remove(path);
+  }
+
+ protected:
+  static string universePath() {
+    const auto test_info = ::testing::UnitTest::GetInstance()->current_test_info();
+    return string(TEST_TEMP_PATH) + "/" + test_info->test_case_name() + "_" +
+           test_info->name() + ".darwin";
+  }
+
+  void addGenerations(int first, int count) {
+    for (int i = first; i < first + count; ++i) {
+      darwin::DbGeneration db_generation;
+      db_generation.trace_id = trace_id;
+      db_generation.generation = i;
+      db_generation.summary = "{}";
+      universe->newGeneration(db_generation);
+    }
+  }
+
+  // counts the generations through an independent connection
+  // (so it only sees the committed generations)
+  int savedGenerations() const {
+    db::Connection db(path, db::OpenMode::ExistingDatabase);
+    return db.exec<int>("select count(*) from Generation where trace_id = ?", trace_id)
+        .singleValue()
+        .value();
+  }
+
+ protected:
+  unique_ptr<darwin::Universe> universe;
+  string path;
+  db::RowId trace_id = 0;
+};
+
+TEST_F(UniverseTest, GenerationWriter_Flush) {
+  darwin::GenerationWriterConfig config;
+  config.max_rows = 16;
+  config.max_latency_ms = 60 * 60 * 1000;
+  config.queue_capacity = 32;
+  universe->setGenerationWriterConfig(config);
+
+  // more generations than the queue capacity
+  addGenerations(0, 100);
+  universe->flush();
+  EXPECT_EQ(savedGenerations(), 100);
+
+  // flushing an empty queue
+  universe->flush();
+  EXPECT_EQ(savedGenerations(), 100);
+
+  // the generations are saved in order
+  db::Connection db(path, db::OpenMode::ExistingDatabase);
+  const auto results = db.exec<int>("select generation from Generation order by id");
+  ASSERT_EQ(results.size(), 100);
+  for (int i = 0; i < 100; ++i)
+    EXPECT_EQ(get<0>(results[i]).value(), i);
+}
+
+TEST_F(UniverseTest, GenerationWriter_MaxLatency) {
+  darwin::GenerationWriterConfig config;
+  config.max_rows = 1000;
+  config.queue_capacity = 1000;
+  config.max_latency_ms = 10;
+  universe->setGenerationWriterConfig(config);
+
+  // a partial batch must be committed once it reaches the max latency
+  addGenerations(0, 5);
+  const auto deadline = chrono::steady_clock::now() + chrono::seconds(10);
+  while (savedGenerations() < 5 && chrono::steady_clock::now() < deadline)
+    this_thread::sleep_for(chrono::milliseconds(5));
+  EXPECT_EQ(savedGenerations(), 5);
+}
+
+TEST_F(UniverseTest, GenerationWriter_Shutdown) {
+  darwin::GenerationWriterConfig config;
+  config.max_rows = 1000;
+  config.queue_capacity = 1000;
+  config.max_latency_ms = 60 * 60 * 1000;
+  universe->setGenerationWriterConfig(config);
+
+  // closing the universe must drain the queued generations
+  addGenerations(0, 10);
+  universe.reset();
+  EXPECT_EQ(savedGenerations(), 10);
+
+  universe = darwin::Universe::open(path);
+  addGenerations(10, 10);
+  universe->flush();
+  EXPECT_EQ(savedGenerations(), 20);
+}
+
+TEST_F(UniverseTest, Champions) {
+  const auto first_champion = make_shared<const db::Blob>(db::Blob{ 1, 2, 3 });
+  const auto second_champion = make_shared<const db::Blob>(db::Blob{ 4, 5, 6, 7 });
+
+  // a different genotype with the same content hash as the first champion
+  const auto colliding_champion = make_shared<const db::Blob>(db::Blob{ 1, 2, 4 });
+
+  // generation -> (champion hash, champion genotype)
+  // (the champion genotype is optional if the trace already has the champion)
+  const vector<pair<uint64_t, shared_ptr<const db::Blob>>> champions = {
+    { 100, first_champion },
+    { 100, first_champion },
+    { 0xfedcba9876543210, second_champion },
+    { 100, make_shared<const db::Blob>(*first_champion) },
+    { 0xfedcba9876543210, nullptr },
+    { 100, colliding_champion },
+  };
+
+  for (size_t i = 0; i < champions.size(); ++i) {
+    darwin::DbGeneration db_generation;
+    db_generation.trace_id = trace_id;
+    db_generation.generation = int(i);
+    db_generation.summary = "{}";
+    db_generation.champion_hash = champions[i].first;
+    db_generation.champion_genotype = champions[i].second;
+    universe->newGeneration(db_generation);
+  }
+
+  // a generation without a champion
+  addGenerations(int(champions.size()), 1);
+  universe->flush();
+
+  // each champion genotype is saved only once
+  db::Connection db(path, db::OpenMode::ExistingDatabase);
+  EXPECT_EQ(db.exec<int>("select count(*) from Champion").singleValue(), 3);
+
+  EXPECT_EQ(universe->loadChampion(trace_id, 0), *first_champion);
+  EXPECT_EQ(universe->loadChampion(trace_id, 1), *first_champion);
+  EXPECT_EQ(universe->loadChampion(trace_id, 2), *second_champion);
+  EXPECT_EQ(universe->loadChampion(trace_id, 3), *first_champion);
+  EXPECT_EQ(universe->loadChampion(trace_id, 4), *second_champion);
+  EXPECT_EQ(universe->loadChampion(trace_id, 5), *colliding_champion);
+  EXPECT_EQ(universe->loadChampion(trace_id, int(champions.size())), nullopt);
+
+  // referencing a champion which was not saved fails the whole batch,
+  // including a new champion saved by an earlier generation in the same batch
+  const auto third_champion = make_shared<const db::Blob>(db::Blob{ 8, 9 });
+  const int failed_generation = int(champions.size()) + 1;
+
+  darwin::DbGeneration db_generation;
+  db_generation.trace_id = trace_id;
+  db_generation.generation = failed_generation;
+  db_generation.summary = "{}";
+  db_generation.champion_hash = 200;
+  db_generation.champion_genotype = third_champion;
+  universe->newGeneration(db_generation);
+
+  db_generation.generation = failed_generation + 1;
+  db_generation.champion_hash = 12345;
+  db_generation.champion_genotype = nullptr;
+  universe->newGeneration(db_generation);
+  EXPECT_THROW(universe->flush(), core::Exception);
+  EXPECT_EQ(db.exec<int>("select count(*) from Champion").singleValue(), 3);
+
+  // the next generations with the same champion still save it
+  db_generation.generation = failed_generation;
+  db_generation.champion_hash = 200;
+  db_generation.champion_genotype = third_champion;
+  universe->newGeneration(db_generation);
+  universe->flush();
+  EXPECT_EQ(universe->loadChampion(trace_id, failed_generation), *third_champion);
+  EXPECT_EQ(db.exec<int>("select count(*) from Champion").singleValue(), 4);
+
+  // a hash-only reference to a colliding hash is ambiguous
+  db_generation.generation = failed_generation + 1;
+  db_generation.champion_hash = 100;
+  db_generation.champion_genotype = nullptr;
+  universe->newGeneration(db_generation);
+  EXPECT_THROW(universe->flush(), core::Exception);
+}
+
+TEST_F(UniverseTest, PopulationTrace) {
+  darwin::PopulationTrace population_trace;
+  population_trace.fitness_encoding = darwin::FitnessTraceEncoding::Delta;
+  population_trace.ranked_fitness = { 10.0f, 7.5f, 7.5f, -1.0f };
+  population_trace.addGenealogy("e", { 0 });
+  population_trace.addGenealogy("c", { 1, 0 });
+  population_trace.addGenealogy("m", { 2 });
+  population_trace.addGenealogy("", {});
+
+  core::BinaryWriter writer;
+  writer.write(population_trace);
+
+  darwin::DbGeneration db_generation;
+  db_generation.trace_id = trace_id;
+  db_generation.generation = 0;
+  db_generation.summary = "{}";
+  db_generation.population_trace = writer.data();
+  universe->newGeneration(db_generation);
+
+  // a generation without a population trace
+  addGenerations(1, 1);
+  universe->flush();
+
+  const auto loaded_trace = universe->loadPopulationTrace(trace_id, 0);
+  ASSERT_TRUE(loaded_trace.has_value());
+  EXPECT_EQ(loaded_trace->ranked_fitness, population_trace.ranked_fitness);
+  EXPECT_EQ(loaded_trace->genetic_operators, population_trace.genetic_operators);
+  EXPECT_EQ(loaded_trace->operator_codes, population_trace.operator_codes);
+  EXPECT_EQ(loaded_trace->parents_counts, population_trace.parents_counts);
+  EXPECT_EQ(loaded_trace->parents, population_trace.parents);
+
+  EXPECT_FALSE(universe->loadPopulationTrace(trace_id, 1).has_value());
+  EXPECT_FALSE(universe->loadPopulationTrace(trace_id, 2).has_value());
+}
+
+}  // namespace universe_tests
@@ -17,8 +17,10 @@
 
 #include <core/darwin.h>
 #include <tests/domains/test_brain.h>
+#include <tests/domains/world_reset.h>
 #include <third_party/gtest/gtest.h>
 
+#include <atomic>
 #include <memory>
 #include <vector>
 using namespace std;
@@ -37,6 +39,28 @@ struct TestBrain : public core_test::TestBrain {
   }
 };
 
+struct TestBatchBrain : public darwin::BatchBrain {
+  const vector<float> force_values;
+
+  explicit TestBatchBrain(const vector<float>& force_values)
+      : force_values(force_values) {}
+
+  size_t size() const override { return force_values.size(); }
+
+  void setInputs(int batch_index, const float*) override {
+    EXPECT_GE(batch_index, 0);
+    EXPECT_LT(batch_index, force_values.size());
+  }
+
+  float output(int batch_index, int index) const override {
+    EXPECT_EQ(index, 0);
+    return force_values[batch_index];
+  }
+
+  void thinkBatch() override {}
+  void resetState() override {}
+};
+
 struct TestGenotype : public darwin::Genotype {
   float force_value = 0;
   const cart_pole::CartPole* domain = nullptr;
@@ -45,6 +69,16 @@ struct TestGenotype : public darwin::Genotype {
     return make_unique<TestBrain>(force_value, domain->inputs(), domain->outputs());
   }
 
+  unique_ptr<darwin::BatchBrain> growBatch(size_t size) const override {
+    if (!batch_support)
+      return nullptr;
+    return make_unique<TestBatchBrain>(vector<float>(size, force_value));
+  }
+
+  bool supportsBatch() const override { return batch_support; }
+
+  bool batch_support = false;
+
   unique_ptr<darwin::Genotype> clone() const override { FATAL("Not implemented"); }
 
   json save() const override { FATAL("Not implemented"); }
@@ -72,6 +106,27 @@ struct TestPopulation : public darwin::Population {
 
   int generation() const override { return 0; }
 
+  unique_ptr<darwin::BatchBrain> growBatch(size_t first_index,
+                                           size_t count) const override {
+    if (!batch_support)
+      return nullptr;
+    ++batch_brains;
+    vector<float> force_values;
+    for (size_t i = first_index; i < first_index + count; ++i)
+      force_values.push_back(genotypes_[i].force_value);
+    return make_unique<TestBatchBrain>(force_values);
+  }
+
+  bool supportsBatch() const override { return batch_support; }
+
+  void setGenotypeBatchSupport(bool batch_support) {
+    for (auto& genotype : genotypes_)
+      genotype.batch_support = batch_support;
+  }
+
+  bool batch_support = false;
+  mutable atomic<int> batch_brains = 0;
+
   vector<size_t> rankingIndex() const override { FATAL("Not implemented"); }
   void createPrimordialGeneration(int) override { FATAL("Not implemented"); }
   void createNextGeneration() override { FATAL("Not implemented"); }
@@ -128,6 +183,64 @@ TEST(CartPoleTest, World_PoleInertia) {
   EXPECT_LT(simulation(-1.0f), config.max_steps);
 }
 
+// the pooled worlds are reset between episodes, instead of being re-created
+TEST(CartPoleTest, World_Reset) {
+  cart_pole::Config config;
+  config.discrete_controls = false;
+  config.max_angle = 60.0f;
+  config.max_steps = 250;
+  cart_pole::CartPole cart_pole(config);
+
+  auto simulation = [&](cart_pole::World& world) {
+    vector<float> trajectory;
+    for (int step = 0; step < config.max_steps; ++step) {
+      world.moveCart(step % 20 < 10 ? +1.0f : -1.0f);
+      const bool alive = world.simStep();
+      trajectory.push_back(world.cartDistance());
+      trajectory.push_back(world.cartVelocity());
+      trajectory.push_back(world.poleAngle());
+      trajectory.push_back(world.poleAngularVelocity());
+      if (!alive)
+        break;
+    }
+    return trajectory;
+  };
+
+  cart_pole::World recycled_world(-5.0f, &cart_pole);
+  simulation(recycled_world);
+
+  for (float initial_angle : { 0.0f, 10.0f, -2.5f }) {
+    cart_pole::World world(initial_angle, &cart_pole);
+    recycled_world.reset(initial_angle);
+    core_test::checkRecycledWorld(recycled_world, world, simulation);
+  }
+}
+
+// each Box2D step must match the analytic engine (within the configured tolerance)
+TEST(CartPoleTest, World_PhysicsValidation) {
+  cart_pole::Config config;
+  config.physics = physics::Engine::Validate;
+  config.discrete_controls = false;
+  config.max_angle = 60.0f;
+  config.max_steps = 250;
+  cart_pole::CartPole cart_pole(config);
+
+  int total_steps = 0;
+  for (float initial_angle : { 0.0f, 10.0f, -5.0f }) {
+    cart_pole::World world(initial_angle, &cart_pole);
+    for (int step = 0; step < config.max_steps; ++step) {
+      world.moveCart(step % 20 < 10 ? +1.0f : -1.0f);
+      ++total_steps;
+      if (!world.simStep())
+        break;
+    }
+  }
+
+  const auto validation = cart_pole.physicsValidation();
+  EXPECT_EQ(validation->steps(), total_steps);
+  EXPECT_LE(validation->maxDeviation(), config.physics_tolerance);
+}
+
 TEST(CartPoleTest, EvaluatePopulation_SingleInput) {
   constexpr int kMaxSteps = 100;
 
@@ -189,4 +302,120 @@ TEST(CartPoleTest, EvaluatePopulation_EveryInput) {
   EXPECT_GT(population[4]->fitness, 0);
 }
 
+TEST(CartPoleTest, EvaluatePopulation_Batched) {
+  constexpr int kMaxSteps = 250;
+
+  cart_pole::Config config;
+  config.max_initial_angle = 0.0f;
+  config.max_steps = kMaxSteps;
+  config.test_worlds = 2;
+  config.discrete_controls = false;
+  config.batch_size = 2;
+
+  const vector<float> force_values = { 0.0f, +1.0f, -1.0f, +2.0f, -0.5f };
+
+  cart_pole::CartPole cart_pole(config);
+  TestPopulation population(&cart_pole, force_values);
+  cart_pole.evaluatePopulation(&population);
+
+  TestPopulation batched_population(&cart_pole, force_values);
+  batched_population.batch_support = true;
+  cart_pole.evaluatePopulation(&batched_population);
+
+  // the batched evaluation must produce the same results
+  EXPECT_EQ(population[0]->fitness, kMaxSteps);
+  for (size_t i = 0; i < population.size(); ++i) {
+    EXPECT_EQ(batched_population[i]->fitness, population[i]->fitness);
+  }
+}
+
+TEST(CartPoleTest, EvaluatePopulation_PhysicsValidation) {
+  cart_pole::Config config;
+  config.physics = physics::Engine::Validate;
+  config.max_initial_angle = 0.0f;
+  config.max_steps = 100;
+  config.test_worlds = 2;
+  config.discrete_controls = false;
+  config.batch_size = 2;
+  config.lock_step_test_worlds = true;
+
+  const vector<float> force_values = { 0.0f, +1.0f, -1.0f };
+
+  cart_pole::CartPole cart_pole(config);
+  TestPopulation population(&cart_pole, force_values);
+  population.batch_support = true;
+  population.setGenotypeBatchSupport(true);
+  cart_pole.evaluatePopulation(&population);
+
+  // the validation mode ignores the batched evaluation options
+  EXPECT_EQ(population.batch_brains, 0);
+  EXPECT_GT(cart_pole.physicsValidation()->steps(), 0);
+  EXPECT_LE(cart_pole.physicsValidation()->maxDeviation(), config.physics_tolerance);
+}
+
+TEST(CartPoleTest, EvaluatePopulation_LockStepTestWorlds) {
+  constexpr int kMaxSteps = 250;
+
+  cart_pole::Config config;
+  config.max_initial_angle = 0.0f;
+  config.max_steps = kMaxSteps;
+  config.test_worlds = 3;
+  config.discrete_controls = false;
+  config.lock_step_test_worlds = true;
+
+  const vector<float> force_values = { 0.0f, +1.0f, -1.0f, +2.0f, -0.5f };
+
+  cart_pole::CartPole cart_pole(config);
+  TestPopulation population(&cart_pole, force_values);
+  cart_pole.evaluatePopulation(&population);
+
+  TestPopulation lock_step_population(&cart_pole, force_values);
+  lock_step_population.setGenotypeBatchSupport(true);
+  cart_pole.evaluatePopulation(&lock_step_population);
+
+  // evaluating the test worlds in lock-step must produce the same results
+  EXPECT_EQ(population[0]->fitness, kMaxSteps);
+  for (size_t i = 0; i < population.size(); ++i) {
+    EXPECT_EQ(lock_step_population[i]->fitness, population[i]->fitness);
+  }
+}
+
+TEST(CartPoleTest, EvaluatePopulation_AnalyticPhysics) {
+  constexpr int kMaxSteps = 250;
+
+  cart_pole::Config config;
+  config.physics = physics::Engine::Analytic;
+  config.max_initial_angle = 0.0f;
+  config.max_steps = kMaxSteps;
+  config.test_worlds = 2;
+  config.discrete_controls = false;
+  config.batch_size = 2;
+
+  const vector<float> force_values = { 0.0f, +1.0f, -1.0f, +2.0f, -2.0f };
+
+  cart_pole::CartPole cart_pole(config);
+  TestPopulation population(&cart_pole, force_values);
+  cart_pole.evaluatePopulation(&population);
+
+  // force = 0.0f
+  EXPECT_EQ(population[0]->fitness, kMaxSteps);
+
+  // force = +/-1.0f
+  EXPECT_GT(population[0]->fitness, population[1]->fitness);
+  EXPECT_EQ(population[1]->fitness, population[2]->fitness);
+
+  // force = +/-2.0f
+  EXPECT_GT(population[2]->fitness, population[3]->fitness);
+  EXPECT_EQ(population[3]->fitness, population[4]->fitness);
+  EXPECT_GT(population[4]->fitness, 0);
+
+  // the batched evaluation must produce the same results
+  TestPopulation batched_population(&cart_pole, force_values);
+  batched_population.batch_support = true;
+  cart_pole.evaluatePopulation(&batched_population);
+  for (size_t i = 0; i < population.size(); ++i) {
+    EXPECT_EQ(batched_population[i]->fitness, population[i]->fitness);
+  }
+}
+
 }  // namespace cart_pole_tests
@@ -8,4 +8,5 @@ SOURCES += \
     unicycle_tests.cpp
 
 HEADERS += \
-    test_brain.h
+    test_brain.h \
+    world_reset.h
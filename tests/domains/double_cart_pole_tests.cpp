@@ -17,6 +17,7 @@
 
 #include <core/darwin.h>
 #include <tests/domains/test_brain.h>
+#include <tests/domains/world_reset.h>
 #include <third_party/gtest/gtest.h>
 
 #include <memory>
@@ -134,6 +135,66 @@ TEST(DoubleCartPoleTest, World_PoleInertia) {
   EXPECT_LT(simulation(-1.0f), config.max_steps);
 }
 
+// resetting both poles and the cart (and the two hinges) of a used world
+TEST(DoubleCartPoleTest, World_Reset) {
+  double_cart_pole::Config config;
+  config.discrete_controls = false;
+  config.max_angle = 60.0f;
+  config.max_steps = 250;
+  double_cart_pole::DoubleCartPole cart_pole(config);
+
+  auto simulation = [&](double_cart_pole::World& world) {
+    vector<float> trajectory;
+    for (int step = 0; step < config.max_steps; ++step) {
+      world.moveCart(step % 20 < 10 ? +1.0f : -1.0f);
+      const bool alive = world.simStep();
+      trajectory.push_back(world.cartDistance());
+      trajectory.push_back(world.cartVelocity());
+      trajectory.push_back(world.pole1Angle());
+      trajectory.push_back(world.pole1AngularVelocity());
+      trajectory.push_back(world.pole2Angle());
+      trajectory.push_back(world.pole2AngularVelocity());
+      if (!alive)
+        break;
+    }
+    return trajectory;
+  };
+
+  double_cart_pole::World recycled_world(-5.0f, 3.0f, &cart_pole);
+  simulation(recycled_world);
+
+  for (float initial_angle : { 0.0f, 10.0f, -2.5f }) {
+    double_cart_pole::World world(initial_angle, -initial_angle, &cart_pole);
+    recycled_world.reset(initial_angle, -initial_angle);
+    core_test::checkRecycledWorld(recycled_world, world, simulation);
+  }
+}
+
+// each Box2D step must match the analytic engine (within the configured tolerance)
+TEST(DoubleCartPoleTest, World_PhysicsValidation) {
+  double_cart_pole::Config config;
+  config.physics = physics::Engine::Validate;
+  config.discrete_controls = false;
+  config.max_angle = 60.0f;
+  config.max_steps = 250;
+  double_cart_pole::DoubleCartPole cart_pole(config);
+
+  int total_steps = 0;
+  for (float initial_angle : { 0.0f, 10.0f, -5.0f }) {
+    double_cart_pole::World world(initial_angle, -initial_angle / 2, &cart_pole);
+    for (int step = 0; step < config.max_steps; ++step) {
+      world.moveCart(step % 20 < 10 ? +1.0f : -1.0f);
+      ++total_steps;
+      if (!world.simStep())
+        break;
+    }
+  }
+
+  const auto validation = cart_pole.physicsValidation();
+  EXPECT_EQ(validation->steps(), total_steps);
+  EXPECT_LE(validation->maxDeviation(), config.physics_tolerance);
+}
+
 TEST(DoubleCartPoleTest, EvaluatePopulation_SingleInput) {
   constexpr int kMaxSteps = 100;
 
@@ -195,4 +256,34 @@ TEST(DoubleCartPoleTest, EvaluatePopulation_EveryInput) {
   EXPECT_GT(population[4]->fitness, 0);
 }
 
+TEST(DoubleCartPoleTest, EvaluatePopulation_AnalyticPhysics) {
+  constexpr int kMaxSteps = 250;
+
+  double_cart_pole::Config config;
+  config.physics = physics::Engine::Analytic;
+  config.max_initial_angle = 0.0f;
+  config.max_steps = kMaxSteps;
+  config.max_force = 5.0f;
+  config.test_worlds = 3;
+  config.discrete_controls = false;
+
+  const vector<float> force_values = { 0.0f, +1.0f, -1.0f, +2.0f, -2.0f };
+
+  double_cart_pole::DoubleCartPole cart_pole(config);
+  TestPopulation population(&cart_pole, force_values);
+  cart_pole.evaluatePopulation(&population);
+
+  // force = 0.0f
+  EXPECT_EQ(population[0]->fitness, kMaxSteps);
+
+  // force = +/-1.0f
+  EXPECT_GT(population[0]->fitness, population[1]->fitness);
+  EXPECT_EQ(population[1]->fitness, population[2]->fitness);
+
+  // force = +/-2.0f
+  EXPECT_GT(population[2]->fitness, population[3]->fitness);
+  EXPECT_EQ(population[3]->fitness, population[4]->fitness);
+  EXPECT_GT(population[4]->fitness, 0);
+}
+
 }  // namespace double_cart_pole_tests
@@ -17,6 +17,7 @@
 
 #include <core/darwin.h>
 #include <tests/domains/test_brain.h>
+#include <tests/domains/world_reset.h>
 #include <third_party/gtest/gtest.h>
 
 #include <memory>
@@ -130,6 +131,40 @@ TEST(UnicycleTest, World_PoleInertia) {
   EXPECT_LT(simulation(-1.0f), config.max_steps);
 }
 
+// the wheel keeps rolling on the ground, so a reset world must not carry
+// over the wheel contact from the previous episode
+TEST(UnicycleTest, World_Reset) {
+  unicycle::Config config;
+  config.discrete_controls = false;
+  config.max_steps = 250;
+  unicycle::Unicycle unicycle(config);
+
+  auto simulation = [&](unicycle::World& world) {
+    vector<float> trajectory;
+    for (int step = 0; step < config.max_steps; ++step) {
+      world.turnWheel(step % 20 < 10 ? +1.0f : -1.0f);
+      const bool alive = world.simStep();
+      trajectory.push_back(world.wheelDistance());
+      trajectory.push_back(world.wheelVelocity());
+      trajectory.push_back(world.poleAngle());
+      trajectory.push_back(world.poleAngularVelocity());
+      trajectory.push_back(world.fitnessBonus());
+      if (!alive)
+        break;
+    }
+    return trajectory;
+  };
+
+  unicycle::World recycled_world(-5.0f, 1.0f, &unicycle);
+  simulation(recycled_world);
+
+  for (float initial_angle : { 0.0f, 10.0f, -2.5f }) {
+    unicycle::World world(initial_angle, -0.5f, &unicycle);
+    recycled_world.reset(initial_angle, -0.5f);
+    core_test::checkRecycledWorld(recycled_world, world, simulation);
+  }
+}
+
 TEST(UnicycleTest, EvaluatePopulation_SingleInput) {
   constexpr int kMaxSteps = 100;
 
@@ -0,0 +1,49 @@
+// Copyright 2019 The Darwin Neuroevolution Framework Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <third_party/gtest/gtest.h>
+
+#include <vector>
+using namespace std;
+
+namespace core_test {
+
+// the max difference between the trajectories of a recycled and a new world
+//
+// a reset doesn't restore the internal layout of the Box2D broad-phase, so the
+// new contacts may be created (and solved) in a different order
+//
+constexpr float kWorldResetTolerance = 1e-4f;
+
+// checks a recycled world against a newly created one
+// (the recycled world must be reset to the initial state of the new world, and
+// simulation() runs the same control sequence, returning the observed trajectory)
+template <class WORLD, class SIMULATION>
+void checkRecycledWorld(WORLD& recycled_world,
+                        WORLD& new_world,
+                        const SIMULATION& simulation) {
+  // no contacts (or cached impulses) survive the reset
+  EXPECT_EQ(recycled_world.box2dWorld()->GetContactCount(), 0);
+
+  const vector<float> recycled_trajectory = simulation(recycled_world);
+  const vector<float> new_trajectory = simulation(new_world);
+  ASSERT_EQ(recycled_trajectory.size(), new_trajectory.size());
+  for (size_t i = 0; i < new_trajectory.size(); ++i)
+    EXPECT_NEAR(recycled_trajectory[i], new_trajectory[i], kWorldResetTolerance);
+}
+
+}  // namespace core_test
@@ -14,9 +14,12 @@
 
 #include "dummy_domain.h"
 
+#include <core/ann_activation_functions.h>
 #include <core/darwin.h>
 #include <core/utils.h>
+#include <populations/cgp/brain.h>
 #include <populations/cgp/cgp.h>
+#include <populations/cgp/functions.h>
 #include <populations/cgp/genotype.h>
 #include <populations/cgp/population.h>
 
@@ -26,12 +29,341 @@ using nlohmann::json;
 #include <tests/testcase_output.h>
 #include <third_party/gtest/gtest.h>
 
-#include <vector>
+#include <algorithm>
+#include <array>
+#include <assert.h>
+#include <cmath>
+#include <cstring>
 #include <limits>
+#include <random>
+#include <vector>
 using namespace std;
 
 namespace cgp_tests {
 
+// the reference CGP interpreter (the original cgp::Brain implementation), used to
+// validate the optimized execution engine (which must produce bit-identical results)
+namespace reference {
+
+using namespace cgp;
+
+class ReferenceBrain {
+  struct Instruction {
+    FunctionId function;
+    array<IndexType, kMaxFunctionArity> sources;
+  };
+
+ public:
+  explicit ReferenceBrain(const Genotype* genotype);
+
+  void setInput(int index, float value);
+  float output(int index) const;
+  void think();
+  void resetState();
+
+ private:
+  IndexType dfsNodeEval(IndexType node_index, vector<IndexType>& nodes_map);
+
+ private:
+  const Genotype* genotype_ = nullptr;
+
+  vector<Instruction> instructions_;
+  vector<float> registers_;
+  vector<float> memory_;
+  vector<int> outputs_map_;
+};
+
+ReferenceBrain::ReferenceBrain(const Genotype* genotype) : genotype_(genotype) {
+  auto domain = genotype_->population()->domain();
+
+  // start with the inputs set
+  // (registers_[0] == NaN values and unused connections point to it)
+  registers_.resize(domain->inputs() + 1);
+  registers_[0] = numeric_limits<float>::signaling_NaN();
+
+  // stores the output register index if the node was visited, otherwise 0
+  vector<IndexType> nodes_map(genotype_->functionGenes().size());
+
+  for (const auto& output_gene : genotype_->outputGenes()) {
+    auto register_index = dfsNodeEval(output_gene.connection, nodes_map);
+    outputs_map_.push_back(register_index);
+  }
+  CHECK(registers_.size() == instructions_.size() + domain->inputs() + 1);
+
+  memory_.resize(instructions_.size());
+}
+
+void ReferenceBrain::setInput(int index, float value) {
+  assert(index >= 0 && index < int(genotype_->population()->domain()->inputs()));
+  registers_[index + 1] = value;
+}
+
+float ReferenceBrain::output(int index) const {
+  assert(index >= 0 && index < int(outputs_map_.size()));
+
+  // NaNs results are likely in a brain based on a random genotype,
+  // so gracefully map NaNs to +infinity (a valid, but unusual output value, which is
+  // likely to result in poor fitness - so the corresponding genotype is penalized)
+  const float value = registers_[outputs_map_[index]];
+  return isnan(value) ? numeric_limits<float>::infinity() : value;
+}
+
+IndexType ReferenceBrain::dfsNodeEval(IndexType node_index,
+                                      vector<IndexType>& nodes_map) {
+  auto domain = genotype_->population()->domain();
+  const size_t inputs_count = domain->inputs();
+
+  // input node?
+  if (node_index < inputs_count) {
+    return node_index + 1;
+  }
+
+  const auto function_node_index = IndexType(node_index - inputs_count);
+  CHECK(function_node_index < nodes_map.size());
+
+  constexpr IndexType kPending = IndexType(-1);
+
+  auto register_index = nodes_map[function_node_index];
+  CHECK(register_index != kPending);
+  if (register_index != 0) {
+    CHECK(register_index >= inputs_count + 1);
+    CHECK(register_index < registers_.size());
+    return register_index;
+  }
+
+  // if not yet visited, do a post-order DFS traversal
+  nodes_map[function_node_index] = kPending;
+
+  const auto& gene = genotype_->functionGenes()[function_node_index];
+  Instruction instruction;
+  instruction.function = gene.function;
+  const int function_arity = kFunctionDef[gene.function].arity;
+  for (int i = 0; i < kMaxFunctionArity; ++i) {
+    instruction.sources[i] = (i < function_arity)
+                                 ? dfsNodeEval(gene.connections[i], nodes_map)
+                                 : IndexType(0);
+  }
+  const IndexType dst = IndexType(registers_.size());
+  instructions_.push_back(instruction);
+  registers_.emplace_back(0.0f);
+
+  nodes_map[function_node_index] = dst;
+  return dst;
+}
+
+void ReferenceBrain::think() {
+  auto domain = genotype_->population()->domain();
+  const size_t instr_reg_base = domain->inputs() + 1;
+  for (size_t instr_index = 0; instr_index < instructions_.size(); ++instr_index) {
+    const size_t result_index = instr_reg_base + instr_index;
+    const auto& instr = instructions_[instr_index];
+    assert(instr.sources[0] < result_index);
+    assert(instr.sources[1] < result_index);
+    float& result = registers_[result_index];
+    float& memory = memory_[instr_index];
+    const float& first_arg = registers_[instr.sources[0]];
+    const float& second_arg = registers_[instr.sources[1]];
+    switch (instr.function) {
+      case FunctionId::ConstZero:
+        result = 0.0f;
+        break;
+      case FunctionId::ConstOne:
+        result = 1.0f;
+        break;
+      case FunctionId::ConstTwo:
+        result = 2.0f;
+        break;
+      case FunctionId::ConstPi:
+        result = 3.141592653589f;
+        break;
+      case FunctionId::ConstE:
+        result = 2.718281828459f;
+        break;
+      case FunctionId::Identity:
+        result = first_arg;
+        break;
+      case FunctionId::Add:
+        result = first_arg + second_arg;
+        break;
+      case FunctionId::Subtract:
+        result = first_arg - second_arg;
+        break;
+      case FunctionId::Multiply:
+        result = first_arg * second_arg;
+        break;
+      case FunctionId::Divide:
+        result = first_arg / second_arg;
+        break;
+      case FunctionId::Negate:
+        result = -first_arg;
+        break;
+      case FunctionId::Fmod:
+        result = fmod(first_arg, second_arg);
+        break;
+      case FunctionId::Reminder:
+        result = remainder(first_arg, second_arg);
+        break;
+      case FunctionId::Fdim:
+        result = fdim(first_arg, second_arg);
+        break;
+      case FunctionId::Ceil:
+        result = ceil(first_arg);
+        break;
+      case FunctionId::Floor:
+        result = floor(first_arg);
+        break;
+      case FunctionId::Abs:
+        result = fabs(first_arg);
+        break;
+      case FunctionId::Average:
+        result = (first_arg + second_arg) / 2;
+        break;
+      case FunctionId::Min:
+        result = fmin(first_arg, second_arg);
+        break;
+      case FunctionId::Max:
+        result = fmax(first_arg, second_arg);
+        break;
+      case FunctionId::Square:
+        result = first_arg * first_arg;
+        break;
+      case FunctionId::Log:
+        result = log(first_arg);
+        break;
+      case FunctionId::Log2:
+        result = log2(first_arg);
+        break;
+      case FunctionId::Sqrt:
+        result = sqrt(first_arg);
+        break;
+      case FunctionId::Power:
+        result = pow(first_arg, second_arg);
+        break;
+      case FunctionId::Exp:
+        result = exp(first_arg);
+        break;
+      case FunctionId::Exp2:
+        result = exp2(first_arg);
+        break;
+      case FunctionId::Sin:
+        result = sin(first_arg);
+        break;
+      case FunctionId::Cos:
+        result = cos(first_arg);
+        break;
+      case FunctionId::Tan:
+        result = tan(first_arg);
+        break;
+      case FunctionId::Asin:
+        result = asin(first_arg);
+        break;
+      case FunctionId::Acos:
+        result = acos(first_arg);
+        break;
+      case FunctionId::Atan:
+        result = atan(first_arg);
+        break;
+      case FunctionId::Sinh:
+        result = sinh(first_arg);
+        break;
+      case FunctionId::Cosh:
+        result = cosh(first_arg);
+        break;
+      case FunctionId::Tanh:
+        result = tanh(first_arg);
+        break;
+      case FunctionId::AfnIdentity:
+        result = ann::afnIdentity(first_arg);
+        break;
+      case FunctionId::AfnLogistic:
+        result = ann::afnLogistic(first_arg);
+        break;
+      case FunctionId::AfnTanh:
+        result = ann::afnTanh(first_arg);
+        break;
+      case FunctionId::AfnReLU:
+        result = ann::afnReLU(first_arg);
+        break;
+      case FunctionId::AfnNeat:
+        result = ann::afnNeat(first_arg);
+        break;
+      case FunctionId::CmpEq:
+        result = first_arg == second_arg;
+        break;
+      case FunctionId::CmpNe:
+        result = first_arg != second_arg;
+        break;
+      case FunctionId::CmpGt:
+        result = first_arg > second_arg;
+        break;
+      case FunctionId::CmpGe:
+        result = first_arg >= second_arg;
+        break;
+      case FunctionId::CmpLt:
+        result = first_arg < second_arg;
+        break;
+      case FunctionId::CmpLe:
+        result = first_arg <= second_arg;
+        break;
+      case FunctionId::And:
+        result = bool(first_arg) && bool(second_arg);
+        break;
+      case FunctionId::Or:
+        result = bool(first_arg) || bool(second_arg);
+        break;
+      case FunctionId::Not:
+        result = !bool(first_arg);
+        break;
+      case FunctionId::Xor:
+        result = bool(first_arg) != bool(second_arg);
+        break;
+      case FunctionId::IfOrZero:
+        result = bool(first_arg) ? second_arg : 0;
+        break;
+      case FunctionId::Velocity:
+        result = first_arg - memory;
+        memory = first_arg;
+        break;
+      case FunctionId::HighWatermark:
+        memory = max(memory, first_arg);
+        result = memory;
+        break;
+      case FunctionId::LowWatermark:
+        memory = min(memory, first_arg);
+        result = memory;
+        break;
+      case FunctionId::MemoryCell:
+        if (second_arg >= 0) {
+          memory = first_arg;
+        }
+        result = memory;
+        break;
+      case FunctionId::SoftMemoryCell: {
+        const float gate = ann::afnLogistic(second_arg);
+        memory = first_arg * gate + memory * (1 - gate);
+        result = memory;
+      } break;
+      case FunctionId::TimeDelay:
+        result = memory;
+        memory = first_arg;
+        break;
+      default:
+        // evolvable constant?
+        if (instr.function < 0) {
+          result = genotype_->getEvolvableConstant(instr.function);
+          break;
+        }
+        FATAL("Unexpected function id");
+    }
+  }
+}
+
+void ReferenceBrain::resetState() {
+  std::fill(memory_.begin(), memory_.end(), 0.0f);
+}
+
+}  // namespace reference
+
 struct CgpTest : public testing::Test {
   static constexpr int kInputs = 5;
   static constexpr int kOutputs = 4;
@@ -149,4 +481,277 @@ TEST_F(CgpTest, Genotype) {
   EXPECT_EQ(loaded_genotype, genotype);
 }
 
+TEST_F(CgpTest, Genotype_Binary) {
+  const auto cgp_population = dynamic_cast<const cgp::Population*>(population.get());
+  ASSERT_NE(cgp_population, nullptr);
+
+  cgp::Genotype genotype(cgp_population);
+  genotype.createPrimordialSeed();
+
+  constexpr int kTestMutationCount = 100;
+  for (int i = 0; i < kTestMutationCount; ++i) {
+    cgp::FixedCountMutation fixed_count_mutation_config;
+    fixed_count_mutation_config.mutation_count = 10;
+    genotype.fixedCountMutation(fixed_count_mutation_config);
+  }
+
+  for (auto compression : { darwin::GenotypeCompression::None,
+                            darwin::GenotypeCompression::Lz4 }) {
+    const auto binary_genotype = genotype.saveBinary(compression);
+    cgp::Genotype loaded_genotype(cgp_population);
+    loaded_genotype.loadBinary(binary_genotype.data(), binary_genotype.size());
+    EXPECT_EQ(loaded_genotype, genotype);
+  }
+}
+
+TEST_F(CgpTest, Brain_Fingerprint) {
+  const auto cgp_population = dynamic_cast<const cgp::Population*>(population.get());
+  ASSERT_NE(cgp_population, nullptr);
+
+  cgp::Genotype parent(cgp_population);
+  parent.createPrimordialSeed();
+  const auto parent_fingerprint = cgp::Brain(&parent).fingerprint();
+
+  cgp::Genotype clone = parent;
+  EXPECT_EQ(cgp::Brain(&clone).fingerprint(), parent_fingerprint);
+
+  // genotypes with the same fingerprint must have the same behavior
+  constexpr int kTestMutations = 100;
+  constexpr int kTestSteps = 10;
+  for (int i = 0; i < kTestMutations; ++i) {
+    cgp::Genotype child = parent;
+    cgp::FixedCountMutation fixed_count_mutation_config;
+    fixed_count_mutation_config.mutation_count = 1;
+    child.fixedCountMutation(fixed_count_mutation_config);
+
+    cgp::Brain parent_brain(&parent);
+    cgp::Brain child_brain(&child);
+    const bool same_fingerprint = child_brain.fingerprint() == parent_fingerprint;
+    EXPECT_EQ(child_brain.samePhenotype(parent_brain), same_fingerprint);
+    if (!same_fingerprint)
+      continue;
+
+    for (int step = 0; step < kTestSteps; ++step) {
+      for (int input = 0; input < kInputs; ++input) {
+        parent_brain.setInput(input, float(step * kInputs + input));
+        child_brain.setInput(input, float(step * kInputs + input));
+      }
+      parent_brain.think();
+      child_brain.think();
+      for (int output = 0; output < kOutputs; ++output) {
+        EXPECT_EQ(parent_brain.output(output), child_brain.output(output));
+      }
+    }
+  }
+}
+
+TEST_F(CgpTest, InheritNeutralFitness) {
+  auto factory = darwin::registry()->populations.find("cgp");
+  ASSERT_NE(factory, nullptr);
+
+  config->inherit_neutral_fitness = true;
+  domain->setSkipsInheritedFitness(true);
+  auto population = factory->create(*config, *domain);
+  ASSERT_NE(population, nullptr);
+
+  constexpr int kPopulationSize = 100;
+  population->createPrimordialGeneration(kPopulationSize);
+  vector<uint64_t> fingerprints(kPopulationSize);
+  for (size_t i = 0; i < population->size(); ++i) {
+    EXPECT_FALSE(population->isFitnessInherited(i));
+    auto genotype = dynamic_cast<const cgp::Genotype*>(population->genotype(i));
+    fingerprints[i] = cgp::Brain(genotype).fingerprint();
+    population->genotype(i)->fitness = float(i);
+  }
+
+  population->createNextGeneration();
+  size_t inherited_count = 0;
+  for (size_t i = 0; i < population->size(); ++i) {
+    if (!population->isFitnessInherited(i))
+      continue;
+    ++inherited_count;
+
+    // the fitness must come from a parent with the same phenotype
+    auto genotype = dynamic_cast<const cgp::Genotype*>(population->genotype(i));
+    const auto fingerprint = cgp::Brain(genotype).fingerprint();
+    bool found_parent = false;
+    for (int parent : genotype->genealogy.parents) {
+      if (fingerprints[parent] == fingerprint && genotype->fitness == float(parent))
+        found_parent = true;
+    }
+    EXPECT_TRUE(found_parent);
+  }
+
+  // at least the unmutated elite genotypes inherit the fitness
+  EXPECT_GT(inherited_count, 0);
+  EXPECT_EQ(population->profileCounters()["inherited_fitness"], inherited_count);
+}
+
+// the fitness is not inherited if the domain would evaluate all the genotypes anyway
+TEST_F(CgpTest, InheritNeutralFitness_DomainOptIn) {
+  auto factory = darwin::registry()->populations.find("cgp");
+  ASSERT_NE(factory, nullptr);
+
+  config->inherit_neutral_fitness = true;
+  ASSERT_FALSE(domain->skipsInheritedFitness());
+  auto population = factory->create(*config, *domain);
+  ASSERT_NE(population, nullptr);
+
+  constexpr int kPopulationSize = 100;
+  population->createPrimordialGeneration(kPopulationSize);
+  population->createNextGeneration();
+  for (size_t i = 0; i < population->size(); ++i) {
+    EXPECT_FALSE(population->isFitnessInherited(i));
+  }
+  EXPECT_TRUE(population->profileCounters().empty());
+}
+
+static bool bitwiseEqual(float a, float b) {
+  uint32_t a_bits = 0;
+  uint32_t b_bits = 0;
+  memcpy(&a_bits, &a, sizeof(a));
+  memcpy(&b_bits, &b, sizeof(b));
+  return a_bits == b_bits;
+}
+
+// runs random genotypes through both cgp::Brain and the reference interpreter
+static void differentialTest(const cgp::Population* population) {
+  constexpr int kTestGenotypes = 200;
+  constexpr int kTestSteps = 50;
+
+  // special values are mixed in, to exercise the NaN and infinity handling
+  const float kSpecialValues[] = { 0.0f,
+                                   -0.0f,
+                                   1.0f,
+                                   -1.0f,
+                                   1e30f,
+                                   -1e-30f,
+                                   numeric_limits<float>::infinity(),
+                                   -numeric_limits<float>::infinity(),
+                                   numeric_limits<float>::quiet_NaN() };
+
+  default_random_engine rnd(1);
+  uniform_real_distribution<float> dist_value(-10, 10);
+  uniform_int_distribution<size_t> dist_special(0, size(kSpecialValues) * 4);
+
+  const int inputs = int(population->domain()->inputs());
+  const int outputs = int(population->domain()->outputs());
+
+  cgp::Genotype genotype(population);
+  genotype.createPrimordialSeed();
+  for (int i = 0; i < kTestGenotypes; ++i) {
+    cgp::FixedCountMutation fixed_count_mutation_config;
+    fixed_count_mutation_config.mutation_count = 5;
+    genotype.fixedCountMutation(fixed_count_mutation_config);
+
+    cgp::Brain brain(&genotype);
+    reference::ReferenceBrain reference_brain(&genotype);
+
+    for (int step = 0; step < kTestSteps; ++step) {
+      // reset the state half way through the episode
+      if (step == kTestSteps / 2) {
+        brain.resetState();
+        reference_brain.resetState();
+      }
+
+      for (int input = 0; input < inputs; ++input) {
+        const size_t special_index = dist_special(rnd);
+        const float value = special_index < size(kSpecialValues)
+                                ? kSpecialValues[special_index]
+                                : dist_value(rnd);
+        brain.setInput(input, value);
+        reference_brain.setInput(input, value);
+      }
+
+      brain.think();
+      reference_brain.think();
+
+      for (int output = 0; output < outputs; ++output) {
+        EXPECT_TRUE(bitwiseEqual(brain.output(output), reference_brain.output(output)));
+      }
+    }
+  }
+}
+
+TEST_F(CgpTest, Brain_Differential) {
+  const auto cgp_population = dynamic_cast<const cgp::Population*>(population.get());
+  ASSERT_NE(cgp_population, nullptr);
+  differentialTest(cgp_population);
+}
+
+TEST_F(CgpTest, Brain_Differential_DeepPrograms) {
+  auto factory = darwin::registry()->populations.find("cgp");
+  ASSERT_NE(factory, nullptr);
+
+  config->rows = 1;
+  config->columns = 500;
+  config->levels_back = 500;
+  auto population = factory->create(*config, *domain);
+
+  const auto cgp_population = dynamic_cast<const cgp::Population*>(population.get());
+  ASSERT_NE(cgp_population, nullptr);
+  differentialTest(cgp_population);
+}
+
+// each lane of a cgp::BatchBrain must match a separate cgp::Brain
+TEST_F(CgpTest, BatchBrain) {
+  const auto cgp_population = dynamic_cast<const cgp::Population*>(population.get());
+  ASSERT_NE(cgp_population, nullptr);
+
+  constexpr int kTestGenotypes = 50;
+  constexpr int kTestSteps = 50;
+  constexpr int kLanes = 13;
+
+  default_random_engine rnd(1);
+  uniform_real_distribution<float> dist_value(-10, 10);
+  uniform_int_distribution<int> dist_last_step(1, kTestSteps);
+
+  cgp::Genotype genotype(cgp_population);
+  genotype.createPrimordialSeed();
+  for (int i = 0; i < kTestGenotypes; ++i) {
+    cgp::FixedCountMutation fixed_count_mutation_config;
+    fixed_count_mutation_config.mutation_count = 5;
+    genotype.fixedCountMutation(fixed_count_mutation_config);
+
+    ASSERT_TRUE(genotype.supportsBatch());
+    auto batch_brain = genotype.growBatch(kLanes);
+    ASSERT_NE(batch_brain, nullptr);
+    ASSERT_EQ(batch_brain->size(), kLanes);
+
+    // the lanes are active for a random number of steps
+    // (emulating episodes which terminate early)
+    vector<unique_ptr<darwin::Brain>> brains(kLanes);
+    vector<int> last_steps(kLanes);
+    for (int lane = 0; lane < kLanes; ++lane) {
+      brains[lane] = genotype.grow();
+      last_steps[lane] = dist_last_step(rnd);
+    }
+
+    for (int step = 0; step < kTestSteps; ++step) {
+      for (int lane = 0; lane < kLanes; ++lane) {
+        if (step < last_steps[lane]) {
+          float values[kInputs] = {};
+          for (int input = 0; input < kInputs; ++input) {
+            values[input] = dist_value(rnd);
+            brains[lane]->setInput(input, values[input]);
+          }
+          batch_brain->setInputs(lane, values);
+          brains[lane]->think();
+        }
+      }
+
+      batch_brain->thinkBatch();
+
+      for (int lane = 0; lane < kLanes; ++lane) {
+        if (step < last_steps[lane]) {
+          for (int output = 0; output < kOutputs; ++output) {
+            EXPECT_TRUE(bitwiseEqual(batch_brain->output(lane, output),
+                                     brains[lane]->output(output)));
+          }
+        }
+      }
+    }
+  }
+}
+
 }  // namespace cgp_tests
@@ -0,0 +1,202 @@
+// Copyright 2019 The Darwin Neuroevolution Framework Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "dummy_domain.h"
+
+#include <core/exception.h>
+#include <core/utils.h>
+#include <populations/cne/arena.h>
+#include <populations/cne/cne.h>
+#include <populations/cne/feedforward.h>
+
+#include <third_party/gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <set>
+using namespace std;
+
+namespace cne_arena_tests {
+
+struct TestParam {
+  size_t inputs = 0;
+  size_t outputs = 0;
+  vector<size_t> hidden_layers;
+};
+
+struct CneArenaTest : public testing::TestWithParam<TestParam> {
+  static constexpr int kPopulationSize = 50;
+
+  void SetUp() override {
+    const auto& test_param = GetParam();
+
+    auto factory = darwin::registry()->populations.find("cne.feedforward_arena");
+    CHECK(factory != nullptr);
+
+    domain = make_unique<DummyDomain>(test_param.inputs, test_param.outputs);
+
+    cne::Config config;
+    config.hidden_layers = test_param.hidden_layers;
+    population = factory->create(config, *domain);
+    CHECK(population);
+
+    population->createPrimordialGeneration(kPopulationSize);
+  }
+
+  cne::arena::Genotype* genotype(size_t index) {
+    return static_cast<cne::arena::Genotype*>(population->genotype(index));
+  }
+
+  void createNextGeneration() {
+    default_random_engine rnd(1);
+    uniform_int_distribution<int> dist(-3, 3);
+    for (size_t i = 0; i < population->size(); ++i)
+      population->genotype(i)->fitness = float(dist(rnd));
+    population->createNextGeneration();
+  }
+
+  unique_ptr<DummyDomain> domain;
+  unique_ptr<darwin::Population> population;
+};
+
+TEST_P(CneArenaTest, Layout) {
+  const auto& test_param = GetParam();
+  cne::arena::Layout layout;
+
+  const auto& layers = layout.layers();
+  ASSERT_EQ(layers.size(), test_param.hidden_layers.size() + 1);
+  EXPECT_EQ(layers.front().rows, test_param.inputs + 1);
+  EXPECT_EQ(layers.back().cols, test_param.outputs);
+
+  const size_t aligned_floats = cne::arena::Layout::kAlignment / sizeof(float);
+  EXPECT_EQ(layout.stride() % aligned_floats, 0);
+  for (const auto& layer : layers) {
+    EXPECT_EQ(layer.offset % aligned_floats, 0);
+    EXPECT_LE(layer.offset + layer.rows * layer.cols, layout.stride());
+  }
+
+  // the slices are aligned too
+  for (size_t i = 0; i < population->size(); ++i) {
+    auto address = reinterpret_cast<uintptr_t>(genotype(i)->layer(0).data);
+    EXPECT_EQ(address % cne::arena::Layout::kAlignment, 0);
+  }
+}
+
+TEST_P(CneArenaTest, SaveLoad) {
+  auto src_genotype = genotype(0);
+  auto json_src = src_genotype->save();
+
+  // the arena genotypes are compatible with the feedforward genotypes
+  cne::feedforward::Genotype ff_genotype;
+  ff_genotype.load(json_src);
+  EXPECT_EQ(ff_genotype.save(), json_src);
+  EXPECT_EQ(src_genotype->clone()->save(), json_src);
+
+  auto dst_genotype = genotype(1);
+  dst_genotype->load(json_src);
+  EXPECT_EQ(dst_genotype->save(), json_src);
+
+  // binary encoding
+  const auto binary_src = src_genotype->saveBinary(darwin::GenotypeCompression::Lz4);
+  cne::feedforward::Genotype ff_binary_genotype;
+  ff_binary_genotype.loadBinary(binary_src.data(), binary_src.size());
+  EXPECT_EQ(ff_binary_genotype.save(), json_src);
+
+  auto dst_binary_genotype = genotype(2);
+  dst_binary_genotype->loadBinary(binary_src.data(), binary_src.size());
+  EXPECT_EQ(dst_binary_genotype->save(), json_src);
+}
+
+// loading a genotype created with a different hidden layers configuration
+TEST_P(CneArenaTest, LoadMismatchedGenotype) {
+  for (const vector<size_t>& hidden_layers :
+       { vector<size_t>{ 2 }, vector<size_t>{ 2, 2 }, vector<size_t>{ 64 } }) {
+    if (hidden_layers == GetParam().hidden_layers)
+      continue;
+
+    const auto original_hidden_layers = cne::g_config.hidden_layers;
+    cne::g_config.hidden_layers = hidden_layers;
+    const cne::feedforward::Genotype mismatched_genotype;
+    cne::g_config.hidden_layers = original_hidden_layers;
+
+    const auto json_obj = mismatched_genotype.save();
+    EXPECT_THROW(genotype(0)->load(json_obj), core::Exception);
+
+    const auto binary = mismatched_genotype.saveBinary(darwin::GenotypeCompression::None);
+    EXPECT_THROW(genotype(0)->loadBinary(binary.data(), binary.size()), core::Exception);
+  }
+}
+
+TEST_P(CneArenaTest, BrainEquivalence) {
+  const auto& test_param = GetParam();
+
+  createNextGeneration();
+
+  for (size_t i = 0; i < population->size(); ++i) {
+    // the brains reference the genotypes, so keep the clone alive
+    const auto ff_genotype = genotype(i)->clone();
+    auto ff_brain = ff_genotype->grow();
+    auto arena_brain = genotype(i)->grow();
+
+    default_random_engine rnd(i);
+    uniform_real_distribution<float> dist(-1, 1);
+    for (int step = 0; step < 5; ++step) {
+      for (size_t j = 0; j < test_param.inputs; ++j) {
+        const float value = dist(rnd);
+        arena_brain->setInput(int(j), value);
+        ff_brain->setInput(int(j), value);
+      }
+      arena_brain->think();
+      ff_brain->think();
+      for (size_t j = 0; j < test_param.outputs; ++j)
+        EXPECT_EQ(arena_brain->output(int(j)), ff_brain->output(int(j)));
+    }
+  }
+}
+
+TEST_P(CneArenaTest, DoubleBuffering) {
+  // collect the addresses of the genotype slices
+  auto collectSlices = [&] {
+    set<const float*> slices;
+    for (size_t i = 0; i < population->size(); ++i)
+      slices.insert(genotype(i)->layer(0).data);
+    return slices;
+  };
+
+  const auto slices_a = collectSlices();
+  createNextGeneration();
+  const auto slices_b = collectSlices();
+  createNextGeneration();
+  const auto slices_c = collectSlices();
+
+  // the generations alternate between the two arenas
+  EXPECT_EQ(slices_a.size(), population->size());
+  EXPECT_EQ(slices_b.size(), population->size());
+  EXPECT_NE(slices_a, slices_b);
+  EXPECT_EQ(slices_a, slices_c);
+}
+
+vector<TestParam> everyTestVariation() {
+  return {
+    { 1, 1, {} },
+    { 5, 3, {} },
+    { 4, 4, { 8 } },
+    { 3, 2, { 16, 1, 7 } },
+  };
+}
+
+INSTANTIATE_TEST_CASE_P(All, CneArenaTest, testing::ValuesIn(everyTestVariation()));
+
+}  // namespace cne_arena_tests
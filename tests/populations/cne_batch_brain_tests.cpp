@@ -0,0 +1,114 @@
+// Copyright 2019 The Darwin Neuroevolution Framework Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "dummy_domain.h"
+
+#include <core/utils.h>
+#include <core/darwin.h>
+#include <populations/cne/cne.h>
+
+#include <third_party/gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+using namespace std;
+
+namespace cne_batch_brain_tests {
+
+struct CneBatchBrainTest : public testing::TestWithParam<string> {
+  static constexpr int kInputs = 3;
+  static constexpr int kOutputs = 2;
+  static constexpr int kPopulationSize = 21;
+
+  void SetUp() override {
+    auto factory = darwin::registry()->populations.find(GetParam());
+    CHECK(factory != nullptr);
+
+    domain = make_unique<DummyDomain>(kInputs, kOutputs);
+
+    cne::Config config;
+    config.hidden_layers = { 5, 9 };
+    population = factory->create(config, *domain);
+    CHECK(population);
+
+    population->createPrimordialGeneration(kPopulationSize);
+  }
+
+  unique_ptr<DummyDomain> domain;
+  unique_ptr<darwin::Population> population;
+};
+
+TEST_P(CneBatchBrainTest, Equivalence) {
+  // an odd range, to exercise the partially filled lane groups
+  constexpr size_t kFirstIndex = 2;
+  constexpr size_t kCount = 17;
+
+  EXPECT_TRUE(population->supportsBatch());
+
+  auto batch_brain = population->growBatch(kFirstIndex, kCount);
+  ASSERT_NE(batch_brain, nullptr);
+  EXPECT_EQ(batch_brain->size(), kCount);
+
+  vector<unique_ptr<darwin::Brain>> brains;
+  for (size_t i = 0; i < kCount; ++i)
+    brains.push_back(population->genotype(kFirstIndex + i)->grow());
+
+  default_random_engine rnd(1);
+  uniform_real_distribution<float> dist(-1, 1);
+
+  for (int step = 0; step < 10; ++step) {
+    for (size_t i = 0; i < kCount; ++i) {
+      float input_values[kInputs];
+      for (int j = 0; j < kInputs; ++j) {
+        input_values[j] = dist(rnd);
+        brains[i]->setInput(j, input_values[j]);
+      }
+      batch_brain->setInputs(int(i), input_values);
+      brains[i]->think();
+    }
+
+    batch_brain->thinkBatch();
+
+    for (size_t i = 0; i < kCount; ++i) {
+      for (int j = 0; j < kOutputs; ++j) {
+        const float expected = brains[i]->output(j);
+        const float tolerance = max(1e-4f, fabs(expected) * 1e-4f);
+        EXPECT_NEAR(batch_brain->output(int(i), j), expected, tolerance);
+      }
+    }
+  }
+}
+
+TEST(CneBatchBrainTest, NotSupported) {
+  auto factory = darwin::registry()->populations.find("cne.full_rnn");
+  CHECK(factory != nullptr);
+
+  DummyDomain domain(2, 2);
+  cne::Config config;
+  auto population = factory->create(config, domain);
+  population->createPrimordialGeneration(10);
+
+  EXPECT_FALSE(population->supportsBatch());
+  EXPECT_EQ(population->growBatch(0, 10), nullptr);
+}
+
+INSTANTIATE_TEST_CASE_P(All,
+                        CneBatchBrainTest,
+                        testing::Values("cne.feedforward", "cne.rnn", "cne.lstm"));
+
+}  // namespace cne_batch_brain_tests
@@ -102,6 +102,53 @@ TEST(CneGenesTest, LSTM_Lite_Gene_LoadSave) {
   checkMatrix(gene_clone.lw, 100, 1);
 }
 
+// the gate-major LSTM weights must be kept in sync with lw
+template <class GENE>
+void checkGateMajorWeights(const GENE& gene) {
+  ASSERT_EQ(gene.gate_major_lw.rows, gene.lw.cols);
+  ASSERT_EQ(gene.gate_major_lw.cols, gene.lw.rows);
+  for (size_t i = 0; i < gene.lw.rows; ++i) {
+    for (size_t j = 0; j < gene.lw.cols; ++j) {
+      ASSERT_EQ(gene.gate_major_lw[j][i], gene.lw[i][j]);
+    }
+  }
+}
+
+template <class GENE>
+void testGateMajorWeights() {
+  constexpr size_t kInputs = 3;
+  constexpr size_t kOutputs = 5;
+
+  GENE gene(kInputs, kOutputs);
+  checkGateMajorWeights(gene);
+  gene.randomize();
+  checkGateMajorWeights(gene);
+  gene.mutate(1.0f);
+  checkGateMajorWeights(gene);
+
+  GENE parent(kInputs, kOutputs);
+  parent.randomize();
+  GENE child(kInputs, kOutputs);
+  child.crossover(gene, parent, 0.5f);
+  checkGateMajorWeights(child);
+
+  GENE json_clone = json(gene);
+  checkGateMajorWeights(json_clone);
+  EXPECT_EQ(json_clone.gate_major_lw.values, gene.gate_major_lw.values);
+
+  initializeMatrix(gene.lw, 100, 1);
+  gene.updateGateMajorWeights();
+  checkGateMajorWeights(gene);
+}
+
+TEST(CneGenesTest, LSTM_Gene_GateMajorWeights) {
+  testGateMajorWeights<cne::lstm::Gene>();
+}
+
+TEST(CneGenesTest, LSTM_Lite_Gene_GateMajorWeights) {
+  testGateMajorWeights<cne::lstm_lite::Gene>();
+}
+
 TEST(CneGenesTest, RNN_Gene_LoadSave) {
   core_test::TestCaseOutput output;
 
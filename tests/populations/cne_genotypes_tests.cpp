@@ -68,6 +68,15 @@ void testGenotypeSaveLoad() {
   auto json_dst = dst_genotype.save();
 
   EXPECT_EQ(json_src, json_dst);
+
+  // binary encoding
+  for (auto compression : { darwin::GenotypeCompression::None,
+                            darwin::GenotypeCompression::Lz4 }) {
+    const auto binary_src = src_genotype.saveBinary(compression);
+    GENOTYPE binary_dst_genotype;
+    binary_dst_genotype.loadBinary(binary_src.data(), binary_src.size());
+    EXPECT_EQ(binary_dst_genotype.save(), json_src);
+  }
 }
 
 TEST_P(CneGenotypesTest, FF_Genotype_Roundtrip) {
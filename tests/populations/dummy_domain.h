@@ -26,7 +26,11 @@ class DummyDomain : public darwin::Domain {
 
   bool evaluatePopulation(darwin::Population*) const override { return true; }
 
+  bool skipsInheritedFitness() const override { return skips_inherited_fitness_; }
+  void setSkipsInheritedFitness(bool skip) { skips_inherited_fitness_ = skip; }
+
  private:
   size_t inputs_ = 0;
   size_t outputs_ = 0;
+  bool skips_inherited_fitness_ = false;
 };
@@ -19,6 +19,7 @@
 #include <populations/neat/brain.h>
 #include <populations/neat/genotype.h>
 #include <populations/neat/neat.h>
+#include <populations/neat/population.h>
 
 #include <third_party/json/json.h>
 using nlohmann::json;
@@ -26,7 +27,9 @@ using nlohmann::json;
 #include <tests/testcase_output.h>
 #include <third_party/gtest/gtest.h>
 
+#include <algorithm>
 #include <atomic>
+#include <cmath>
 #include <vector>
 #include <random>
 using namespace std;
@@ -74,6 +77,57 @@ TEST_F(NeatTest, Gene_LoadSave) {
   EXPECT_EQ(gene_clone.recurrent, true);
 }
 
+// the innovation numbers use the full 32bit range, without clobbering the flags
+TEST_F(NeatTest, Gene_InnovationRange) {
+  atomic<neat::Innovation> next_innovation = neat::kMaxInnovation;
+  const auto innovation = neat::Genotype::newInnovation(next_innovation);
+  EXPECT_EQ(innovation, neat::kMaxInnovation);
+
+  neat::Gene gene(neat::kMaxNodeId, 1, 0.5f, innovation);
+  gene.recurrent = true;
+  EXPECT_EQ(gene.innovation, neat::kMaxInnovation);
+  EXPECT_EQ(gene.in, neat::kMaxNodeId);
+  EXPECT_EQ(gene.enabled, true);
+  EXPECT_EQ(gene.recurrent, true);
+
+  json json_obj = gene;
+  neat::Gene gene_clone = json_obj;
+  EXPECT_EQ(gene_clone.innovation, neat::kMaxInnovation);
+  EXPECT_EQ(gene_clone.in, neat::kMaxNodeId);
+  EXPECT_EQ(gene_clone.out, 1);
+  EXPECT_EQ(gene_clone.enabled, true);
+  EXPECT_EQ(gene_clone.recurrent, true);
+
+  json_obj["in"] = neat::kMaxNodeId + 1;
+  EXPECT_THROW(gene_clone = json_obj, core::Exception);
+}
+
+TEST_F(NeatTest, Brain_Evaluation) {
+  neat::g_config.use_lstm_nodes = false;
+  neat::g_config.normalize_input = false;
+  neat::g_config.normalize_output = false;
+
+  // bias = 0, inputs = [1, 2], outputs = [3, 4, 5], hidden = 6
+  neat::Genotype genotype;
+  genotype.nodes_count = 7;
+  genotype.mutableGenes().emplace_back(1, 6, 0.5f, 0);
+  genotype.mutableGenes().emplace_back(2, 6, -1.0f, 1);
+  genotype.mutableGenes().emplace_back(0, 6, 0.25f, 2);
+  genotype.mutableGenes().emplace_back(6, 3, 2.0f, 3);
+  genotype.mutableGenes().emplace_back(1, 4, 1.5f, 4);
+  genotype.mutableGenes().emplace_back(6, 4, -0.5f, 5);
+
+  neat::Brain brain(&genotype);
+  brain.setInput(0, 0.75f);
+  brain.setInput(1, -0.5f);
+  brain.think();
+
+  const float hidden = ann::activate(0.5f * 0.75f - 1.0f * -0.5f + 0.25f);
+  EXPECT_FLOAT_EQ(brain.output(0), 2.0f * hidden);
+  EXPECT_FLOAT_EQ(brain.output(1), 1.5f * 0.75f - 0.5f * hidden);
+  EXPECT_FLOAT_EQ(brain.output(2), 0.0f);
+}
+
 TEST_F(NeatTest, Genotype) {
   neat::Genotype genotype;
   genotype.createPrimordialSeed();
@@ -90,10 +144,10 @@ TEST_F(NeatTest, Genotype) {
   loaded_genotype.load(json_obj);
 
   EXPECT_EQ(loaded_genotype.nodes_count, genotype.nodes_count);
-  EXPECT_EQ(loaded_genotype.genes.size(), genotype.genes.size());
-  for (size_t i = 0; i < genotype.genes.size(); ++i) {
-    const auto& gene = genotype.genes[i];
-    const auto& loaded_gene = loaded_genotype.genes[i];
+  EXPECT_EQ(loaded_genotype.genes().size(), genotype.genes().size());
+  for (size_t i = 0; i < genotype.genes().size(); ++i) {
+    const auto& gene = genotype.genes()[i];
+    const auto& loaded_gene = loaded_genotype.genes()[i];
     EXPECT_EQ(gene.innovation, loaded_gene.innovation);
     EXPECT_EQ(gene.in, loaded_gene.in);
     EXPECT_EQ(gene.out, loaded_gene.out);
@@ -103,6 +157,112 @@ TEST_F(NeatTest, Genotype) {
   }
 }
 
+TEST_F(NeatTest, Genotype_Binary) {
+  neat::Genotype genotype;
+  genotype.createPrimordialSeed();
+
+  constexpr int kTestMutationCount = 1000;
+  atomic<neat::Innovation> next_innovation = 0;
+  for (int i = 0; i < kTestMutationCount; ++i) {
+    genotype.mutate(next_innovation, true);
+    genotype.mutate(next_innovation, false);
+  }
+
+  const auto binary_genotype = genotype.saveBinary(darwin::GenotypeCompression::Lz4);
+  neat::Genotype loaded_genotype;
+  loaded_genotype.loadBinary(binary_genotype.data(), binary_genotype.size());
+  EXPECT_EQ(loaded_genotype.save(), genotype.save());
+  EXPECT_EQ(loaded_genotype.topologicalOrder(), genotype.topologicalOrder());
+
+  // the binary encoding is much more compact than JSON
+  EXPECT_LT(binary_genotype.size(), genotype.save().dump().size() / 2);
+
+  // truncated data
+  neat::Genotype truncated_genotype;
+  EXPECT_THROW(
+      truncated_genotype.loadBinary(binary_genotype.data(), binary_genotype.size() - 1),
+      core::Exception);
+
+  // the nodes count must be bounded by the node ids referenced from the genes
+  for (size_t nodes_count : { genotype.nodes_count + 1, size_t(neat::kMaxNodeId) + 2 }) {
+    neat::Genotype invalid_genotype = genotype;
+    invalid_genotype.nodes_count = nodes_count;
+    const auto invalid_binary =
+        invalid_genotype.saveBinary(darwin::GenotypeCompression::None);
+    neat::Genotype rejected_genotype;
+    EXPECT_THROW(
+        rejected_genotype.loadBinary(invalid_binary.data(), invalid_binary.size()),
+        core::Exception);
+    EXPECT_THROW(rejected_genotype.load(invalid_genotype.save()), core::Exception);
+  }
+}
+
+// every node appears exactly once, and the non-recurrent links
+// always go from an earlier to a later node
+static void checkTopologicalOrder(const neat::Genotype& genotype) {
+  const auto order = genotype.topologicalOrder();
+  ASSERT_EQ(order.size(), genotype.nodes_count);
+
+  vector<size_t> position(genotype.nodes_count, genotype.nodes_count);
+  for (size_t i = 0; i < order.size(); ++i) {
+    ASSERT_LT(order[i], genotype.nodes_count);
+    ASSERT_EQ(position[order[i]], genotype.nodes_count);
+    position[order[i]] = i;
+  }
+
+  for (const auto& gene : genotype.genes()) {
+    if (!gene.recurrent) {
+      EXPECT_LT(position[gene.in], position[gene.out]);
+    }
+  }
+}
+
+TEST_F(NeatTest, Genotype_TopologicalOrder) {
+  constexpr int kTestMutationCount = 500;
+
+  neat::g_config.new_link_chance = 0.5f;
+  neat::g_config.new_node_chance = 0.2f;
+
+  neat::Genotype genotype;
+  atomic<neat::Innovation> next_innovation = genotype.createPrimordialSeed();
+  checkTopologicalOrder(genotype);
+
+  for (int i = 0; i < kTestMutationCount; ++i) {
+    genotype.mutate(next_innovation, false);
+    checkTopologicalOrder(genotype);
+
+    // the order (which is also the evaluation order) only depends on the genes,
+    // not on the history of the mutations
+    neat::Genotype resorted_genotype = genotype;
+    resorted_genotype.mutableGenes();
+    ASSERT_EQ(genotype.topologicalOrder(), resorted_genotype.topologicalOrder());
+  }
+
+  // the grown brain must be the same as the brain for a loaded genotype
+  // (including the recurrent links, which depend on the evaluation order)
+  neat::Genotype loaded_genotype;
+  loaded_genotype.load(genotype.save());
+  checkTopologicalOrder(loaded_genotype);
+
+  constexpr int kTestSteps = 10;
+  neat::Brain brain(&genotype);
+  neat::Brain loaded_brain(&loaded_genotype);
+  for (int step = 0; step < kTestSteps; ++step) {
+    for (int input = 0; input < kInputs; ++input) {
+      brain.setInput(input, 0.5f - input + step);
+      loaded_brain.setInput(input, 0.5f - input + step);
+    }
+    brain.think();
+    loaded_brain.think();
+    for (int output = 0; output < kOutputs; ++output) {
+      // (the recurrent values may overflow, in which case both outputs must be NaN)
+      const float value = brain.output(output);
+      const float loaded_value = loaded_brain.output(output);
+      EXPECT_TRUE(value == loaded_value || (isnan(value) && isnan(loaded_value)));
+    }
+  }
+}
+
 TEST_F(NeatTest, Crossover) {
   constexpr int kTestPopulationSize = 100;
   constexpr int kTestGenerations = 500;
@@ -136,4 +296,150 @@ TEST_F(NeatTest, Crossover) {
   }
 }
 
+// the genes are sorted by innovation number, and the links index can find
+// the first gene for every link
+static void checkGenotype(neat::Genotype& genotype) {
+  const auto& genes = genotype.genes();
+  for (size_t i = 1; i < genes.size(); ++i)
+    EXPECT_LE(genes[i - 1].innovation, genes[i].innovation);
+
+  for (size_t i = 0; i < genes.size(); ++i) {
+    const auto* gene = genotype.findLink(genes[i].in, genes[i].out);
+    ASSERT_NE(gene, nullptr);
+    const auto first_gene = std::find_if(genes.begin(), genes.end(), [&](const auto& g) {
+      return g.in == genes[i].in && g.out == genes[i].out;
+    });
+    EXPECT_EQ(gene, &*first_gene);
+  }
+
+  const auto missing_node = neat::NodeId(genotype.nodes_count);
+  EXPECT_EQ(genotype.findLink(missing_node, missing_node), nullptr);
+
+  checkTopologicalOrder(genotype);
+}
+
+TEST_F(NeatTest, Genotype_MutableGenes) {
+  // bias = 0, inputs = [1, 2], outputs = [3, 4, 5]
+  neat::Genotype genotype;
+  genotype.mutableGenes().emplace_back(1, 3, 0.5f, 0);
+  genotype.mutableGenes().emplace_back(2, 4, 1.0f, 1);
+  ASSERT_NE(genotype.findLink(1, 3), nullptr);
+  EXPECT_EQ(genotype.findLink(1, 5), nullptr);
+
+  // replacing the genes with the same number of genes must invalidate the indexes
+  genotype.mutableGenes() = { neat::Gene(1, 5, 0.5f, 0), neat::Gene(4, 3, 1.0f, 1) };
+  EXPECT_EQ(genotype.findLink(1, 3), nullptr);
+  ASSERT_NE(genotype.findLink(1, 5), nullptr);
+  EXPECT_EQ(genotype.findLink(1, 5)->weight, 0.5f);
+  checkTopologicalOrder(genotype);
+
+  // the links index is only kept while mutating the genotype
+  atomic<neat::Innovation> next_innovation = 2;
+  genotype.mutate(next_innovation, false);
+  const size_t topology_index_bytes = genotype.indexMemoryUsage();
+  EXPECT_GT(topology_index_bytes, 0);
+  genotype.findLink(1, 5);
+  EXPECT_GT(genotype.indexMemoryUsage(), topology_index_bytes);
+}
+
+TEST_F(NeatTest, Genotype_SortedGenes) {
+  constexpr int kTestPopulationSize = 50;
+  constexpr int kTestGenerations = 100;
+
+  default_random_engine rnd(1);
+  uniform_int_distribution<size_t> dist_parent(0, kTestPopulationSize - 1);
+  uniform_real_distribution<float> dist_preference(0, 1);
+
+  vector<neat::Genotype> population(kTestPopulationSize);
+  atomic<neat::Innovation> next_innovation = 0;
+  for (auto& genotype : population)
+    next_innovation = genotype.createPrimordialSeed();
+
+  for (int generation = 0; generation < kTestGenerations; ++generation) {
+    vector<neat::Genotype> next_population(kTestPopulationSize);
+    for (auto& child : next_population) {
+      const auto& parent1 = population[dist_parent(rnd)];
+      const auto& parent2 = population[dist_parent(rnd)];
+      child.inherit(parent1, parent2, dist_preference(rnd));
+      child.mutate(next_innovation, false);
+    }
+    population = std::move(next_population);
+  }
+
+  for (auto& genotype : population) {
+    checkGenotype(genotype);
+    EXPECT_GT(genotype.memoryUsage(), genotype.genes().size() * sizeof(neat::Gene));
+  }
+
+  // loading a genotype with unsorted genes
+  auto& genotype = population.front();
+  json json_obj = genotype.save();
+  auto& json_genes = json_obj.at("genes");
+  std::reverse(json_genes.begin(), json_genes.end());
+  neat::Genotype loaded_genotype;
+  loaded_genotype.load(json_obj);
+  checkGenotype(loaded_genotype);
+  EXPECT_EQ(loaded_genotype.genes().size(), genotype.genes().size());
+  EXPECT_DOUBLE_EQ(loaded_genotype.compatibility(genotype), 0.0);
+
+  // adding genes out of order
+  neat::Genotype unsorted_genotype;
+  unsorted_genotype.nodes_count = genotype.nodes_count;
+  for (auto it = genotype.genes().rbegin(); it != genotype.genes().rend(); ++it)
+    unsorted_genotype.addGene(*it);
+  checkGenotype(unsorted_genotype);
+  EXPECT_DOUBLE_EQ(unsorted_genotype.compatibility(genotype), 0.0);
+}
+
+// each genotype must be assigned to the first compatible species
+// (the same results as assigning the genotypes one at a time)
+static void checkSpecies(const neat::Population* population) {
+  const auto& species = population->species();
+  ASSERT_FALSE(species.empty());
+
+  const double threshold = neat::g_config.compatibility_threshold;
+  vector<int> assignments(population->size(), -1);
+  for (size_t i = 0; i < species.size(); ++i) {
+    const auto& genotypes = species[i].genotypes;
+    ASSERT_FALSE(genotypes.empty());
+    EXPECT_TRUE(std::is_sorted(genotypes.begin(), genotypes.end()));
+    for (int index : genotypes) {
+      EXPECT_EQ(assignments[index], -1);
+      assignments[index] = int(i);
+    }
+  }
+
+  for (size_t index = 0; index < population->size(); ++index) {
+    ASSERT_NE(assignments[index], -1);
+    auto genotype = dynamic_cast<const neat::Genotype*>(population->genotype(index));
+    for (int i = 0; i < assignments[index]; ++i) {
+      EXPECT_FALSE(genotype->compatibility(species[i].origin) < threshold);
+    }
+  }
+}
+
+TEST_F(NeatTest, Speciate) {
+  constexpr int kPopulationSize = 500;
+  constexpr int kTestGenerations = 10;
+
+  // a low threshold, so there are many species
+  neat::g_config.compatibility_threshold = 1.0;
+
+  auto neat_population = dynamic_cast<neat::Population*>(population.get());
+  ASSERT_NE(neat_population, nullptr);
+
+  default_random_engine rnd(1);
+  uniform_real_distribution<float> dist_fitness(0, 100);
+
+  neat_population->createPrimordialGeneration(kPopulationSize);
+  checkSpecies(neat_population);
+  for (int generation = 0; generation < kTestGenerations; ++generation) {
+    for (size_t i = 0; i < neat_population->size(); ++i)
+      neat_population->genotype(i)->fitness = dist_fitness(rnd);
+    neat_population->createNextGeneration();
+    checkSpecies(neat_population);
+  }
+  EXPECT_GT(neat_population->species().size(), 1);
+}
+
 }  // namespace neat_tests
@@ -8,6 +8,8 @@ SOURCES += \
     brains_tests.cpp \
     cne_crossover_tests.cpp \
     cne_mutation_tests.cpp \
+    cne_arena_tests.cpp \
+    cne_batch_brain_tests.cpp \
     neat_tests.cpp \
     cgp_tests.cpp \
     populations_smoke_tests.cpp
@@ -16,6 +16,9 @@
 
 #include <core/darwin.h>
 #include <core/parallel_for_each.h>
+#include <core/rng.h>
+#include <core/scope_guard.h>
+#include <core/thread_pool.h>
 #include <core/utils.h>
 
 #include <third_party/gtest/gtest.h>
@@ -92,6 +95,56 @@ TEST_P(PopulationsTest, RandomFitnessValues) {
   validate();
 }
 
+// the state of a population after each generation
+struct EvolutionSnapshot {
+  vector<vector<uint8_t>> genotypes;
+  vector<float> fitness;
+
+  bool operator==(const EvolutionSnapshot& other) const {
+    return genotypes == other.genotypes && fitness == other.fitness;
+  }
+};
+
+TEST_P(PopulationsTest, ReproducibleMode) {
+  constexpr int kInputs = 2;
+  constexpr int kOutputs = 2;
+  constexpr int kGenerations = 5;
+  constexpr uint64_t kMasterSeed = 1234;
+
+  // runs a few generations in the reproducible mode, using the specified
+  // number of threads (the fitness values are derived from the genotypes)
+  const auto evolve = [&](int threads_count) {
+    auto original_thread_pool = pp::ParallelForSupport::replaceThreadPool(
+        make_unique<pp::ThreadPool>(threads_count));
+    rng::setReproducibleMode(true, kMasterSeed);
+    SCOPE_EXIT {
+      rng::setReproducibleMode(false);
+      pp::ParallelForSupport::replaceThreadPool(std::move(original_thread_pool));
+    };
+
+    initialize(kInputs, kOutputs);
+
+    vector<EvolutionSnapshot> snapshots;
+    for (int generation = 0; generation < kGenerations; ++generation) {
+      EvolutionSnapshot snapshot;
+      for (size_t i = 0; i < population->size(); ++i) {
+        darwin::Genotype* genotype = population->genotype(i);
+        genotype->fitness = float(genotype->contentHash() % 1000);
+        snapshot.genotypes.push_back(
+            genotype->saveBinary(darwin::GenotypeCompression::None));
+        snapshot.fitness.push_back(genotype->fitness);
+      }
+      snapshots.push_back(std::move(snapshot));
+      population->createNextGeneration();
+    }
+    return snapshots;
+  };
+
+  const auto single_thread = evolve(1);
+  EXPECT_TRUE(evolve(4) == single_thread);
+  EXPECT_TRUE(evolve(7) == single_thread);
+}
+
 vector<string> everyPopulation() {
   auto registry = darwin::registry();
   CHECK(!registry->populations.empty());
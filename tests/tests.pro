@@ -6,4 +6,5 @@ SUBDIRS += \
     darwin \
     populations \
     domains \
-    third_party
+    third_party \
+    benchmarks